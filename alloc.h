@@ -0,0 +1,247 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ALLOC_H_
+#define ALLOC_H_
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <new>
+#include <type_traits>
+
+#include "checked.h"
+#include "trap.h"
+
+namespace internal {
+
+constexpr bool is_power_of_2(size_t n) {
+  return n != 0 && (n & (n - 1)) == 0;
+}
+
+/// Rounds `size` up to a multiple of `align`, which must be a power of 2.
+constexpr integers::result<size_t> align_up(integers::result<size_t> size,
+                                            size_t align) {
+  integers::result<size_t> r = size.add(align - 1);
+  r.value &= ~(align - 1);
+  r.overflowed |= !is_power_of_2(align);
+  return r;
+}
+
+[[noreturn]] inline void throw_bad_array_new_length() {
+#if defined(__cpp_exceptions)
+  throw std::bad_array_new_length();
+#else
+  trap();
+#endif
+}
+
+}  // namespace internal
+
+/// ## Allocation Sizes
+///
+/// The most common integer overflow bug is in computing the size of an
+/// allocation: `count * sizeof(T) + header`. These helpers compute such sizes
+/// with the `checked_*` functions, ORing the overflow flags together, so that
+/// each size needs only 1 branch (or none, when you just pass the resulting
+/// `result<size_t>` along). The allocation functions then refuse to allocate
+/// if the size overflowed, so that you can’t forget to check.
+namespace integers {
+
+/// ### `checked_array_bytes`
+///
+/// Returns the number of bytes needed for a `header` of some number of bytes,
+/// followed by padding to `align`, followed by an array of `count` `T`s.
+/// Reports overflow if the size does not fit in `size_t`, or if `align` is not
+/// a power of 2.
+///
+///   auto [bytes, overflowed] =
+///       checked_array_bytes<Entry>(count, sizeof(Header));
+template <typename T>
+constexpr result<size_t> checked_array_bytes(size_t count,
+                                             size_t header = 0,
+                                             size_t align = alignof(T)) {
+  const result<size_t> offset =
+      internal::align_up(result<size_t>{header, false}, align);
+  result<size_t> r = checked_mul<size_t>(count, sizeof(T)).add(offset.value);
+  r.overflowed |= offset.overflowed;
+  return r;
+}
+
+/// ## `checked_layout`
+///
+/// Computes the offsets of several arrays (or other objects) in 1 allocation,
+/// e.g. for a struct-of-arrays layout:
+///
+///   checked_layout layout;
+///   const size_t header = layout.add<Header>(1);
+///   const size_t xs = layout.add<float>(count);
+///   const size_t ids = layout.add<uint32_t>(count);
+///   const result<size_t> bytes = layout.size();
+///   if (!bytes) {
+///     return Error::kTooBig;
+///   }
+///   char* base = static_cast<char*>(checked_aligned_alloc(layout));
+///
+/// Each `add` pads the layout to the alignment of the new array. Overflow is
+/// sticky and checked only once, in `size`; if it overflowed, the offsets that
+/// `add` returned are meaningless.
+class checked_layout {
+ public:
+  /// ### `add`
+  ///
+  /// Appends an array of `count` `T`s, aligned to `align` (which must be a
+  /// power of 2), and returns its offset.
+  template <typename T>
+  constexpr size_t add(size_t count, size_t align = alignof(T)) {
+    const result<size_t> start = internal::align_up(size_, align);
+    size_ = checked_mul<size_t>(count, sizeof(T)).add(start.value);
+    size_.overflowed |= start.overflowed;
+    alignment_ = std::max(alignment_, align);
+    return start.value;
+  }
+
+  /// ### `alignment`
+  ///
+  /// Returns the largest alignment of any array added so far (at least 1).
+  constexpr size_t alignment() const { return alignment_; }
+
+  /// ### `size`
+  ///
+  /// Returns the total size in bytes, padded to a multiple of `alignment`
+  /// (as `sizeof` pads a struct), and whether any step overflowed.
+  constexpr result<size_t> size() const {
+    return internal::align_up(size_, alignment_);
+  }
+
+ private:
+  result<size_t> size_{0, false};
+  size_t alignment_ = 1;
+};
+
+/// ## Allocation
+///
+/// ### `checked_malloc`
+///
+/// Returns `malloc(size.value)`, or sets `errno` to `ENOMEM` and returns
+/// `nullptr` if `size` overflowed.
+inline void* checked_malloc(result<size_t> size) {
+  if (size.overflowed) {
+    errno = ENOMEM;
+    return nullptr;
+  }
+  return malloc(size.value);
+}
+
+/// ### `checked_aligned_alloc`
+///
+/// Allocates `layout.size()` bytes with `layout.alignment()`, using `malloc`
+/// if that alignment is fundamental, and `aligned_alloc` otherwise. Sets
+/// `errno` to `ENOMEM` and returns `nullptr` if the size overflowed. Free the
+/// memory with `free`.
+inline void* checked_aligned_alloc(const checked_layout& layout) {
+  const result<size_t> size = layout.size();
+  if (layout.alignment() <= alignof(max_align_t)) {
+    return checked_malloc(size);
+  }
+  if (size.overflowed) {
+    errno = ENOMEM;
+    return nullptr;
+  }
+  return aligned_alloc(layout.alignment(), size.value);
+}
+
+/// ### `checked_malloc_array`
+///
+/// Allocates uninitialized memory for `count` `T`s, like `reallocarray(NULL,
+/// count, sizeof(T))`. Sets `errno` to `ENOMEM` and returns `nullptr` if the
+/// size overflows. Free the memory with `free`.
+template <typename T>
+T* checked_malloc_array(size_t count) {
+  const result<size_t> size = checked_array_bytes<T>(count);
+  if constexpr (alignof(T) > alignof(max_align_t)) {
+    if (size.overflowed) {
+      errno = ENOMEM;
+      return nullptr;
+    }
+    return static_cast<T*>(aligned_alloc(alignof(T), size.value));
+  } else {
+    return static_cast<T*>(checked_malloc(size));
+  }
+}
+
+/// ### `checked_operator_new`
+///
+/// Allocates uninitialized memory for `count` `T`s with `operator new`,
+/// aligned for `T`. If the size overflows, throws `std::bad_array_new_length`
+/// (as a `new T[count]` expression does), or `trap`s if exceptions are
+/// disabled. Free the memory with `checked_operator_delete`.
+template <typename T>
+T* checked_operator_new(size_t count) {
+  const result<size_t> size = checked_array_bytes<T>(count);
+  if (size.overflowed) {
+    ::internal::throw_bad_array_new_length();
+  }
+  if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+    return static_cast<T*>(
+        ::operator new(size.value, std::align_val_t{alignof(T)}));
+  } else {
+    return static_cast<T*>(::operator new(size.value));
+  }
+}
+
+/// ### `checked_operator_delete`
+///
+/// Frees memory allocated by `checked_operator_new<T>`.
+template <typename T>
+void checked_operator_delete(T* p) {
+  if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+    ::operator delete(p, std::align_val_t{alignof(T)});
+  } else {
+    ::operator delete(p);
+  }
+}
+
+/// ## `checked_allocator<T>`
+///
+/// A standard allocator that computes sizes with `checked_array_bytes`, for
+/// containers (and allocator adaptors) that do not check `max_size()`
+/// themselves.
+template <typename T>
+struct checked_allocator {
+  using value_type = T;
+
+  checked_allocator() = default;
+
+  template <typename U>
+  constexpr checked_allocator(const checked_allocator<U>&) {}
+
+  T* allocate(size_t count) { return checked_operator_new<T>(count); }
+
+  void deallocate(T* p, size_t) { checked_operator_delete(p); }
+
+  friend constexpr bool operator==(checked_allocator, checked_allocator) {
+    return true;
+  }
+
+  friend constexpr bool operator!=(checked_allocator, checked_allocator) {
+    return false;
+  }
+};
+
+}  // namespace integers
+
+#endif  // ALLOC_H_
@@ -0,0 +1,199 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <errno.h>
+#include <stdint.h>
+
+#include <iostream>
+#include <limits>
+#include <new>
+#include <vector>
+
+#include "alloc.h"
+#include "test_support.h"
+
+using namespace integers;
+using namespace std;
+
+namespace {
+
+struct Header {
+  uint32_t magic;
+  uint16_t version;
+};
+
+struct alignas(64) Line {
+  char bytes[64];
+};
+
+constexpr size_t size_max = numeric_limits<size_t>::max();
+
+static_assert(checked_array_bytes<uint32_t>(10).value == 40);
+static_assert(checked_array_bytes<uint64_t>(3, sizeof(Header)).value == 32);
+static_assert(checked_array_bytes<uint64_t>(size_max / 8 + 1).overflowed);
+
+void TestArrayBytes() {
+  {
+    const auto [bytes, overflowed] = checked_array_bytes<uint16_t>(1000);
+    EXPECT(!overflowed);
+    EXPECT(bytes == 2000);
+  }
+  {
+    // The header is padded to the array’s alignment.
+    EXPECT(checked_array_bytes<uint32_t>(2, 5).value == 16);
+    EXPECT(checked_array_bytes<uint32_t>(2, 8).value == 16);
+    EXPECT(checked_array_bytes<uint32_t>(2, 5, 64).value == 72);
+    EXPECT(checked_array_bytes<char>(2, 5).value == 7);
+  }
+  {
+    EXPECT(checked_array_bytes<uint64_t>(size_max / 8).value == size_max - 7);
+    EXPECT(checked_array_bytes<uint64_t>(size_max / 8, 8).overflowed);
+    EXPECT(checked_array_bytes<uint64_t>(size_max / 4).overflowed);
+    EXPECT(checked_array_bytes<char>(1, size_max).overflowed);
+    EXPECT(checked_array_bytes<char>(0, size_max - 1, 4).overflowed);
+  }
+  {
+    // `align` must be a power of 2.
+    EXPECT(checked_array_bytes<char>(1, 0, 0).overflowed);
+    EXPECT(checked_array_bytes<char>(1, 0, 3).overflowed);
+    EXPECT(!checked_array_bytes<char>(1, 0, 4096).overflowed);
+  }
+}
+
+void TestLayout() {
+  {
+    checked_layout layout;
+    const size_t header = layout.add<Header>(1);
+    const size_t xs = layout.add<float>(3);
+    const size_t ids = layout.add<uint64_t>(3);
+    const size_t flags = layout.add<bool>(3);
+    EXPECT(header == 0);
+    EXPECT(xs == 8);
+    EXPECT(ids == 24);
+    EXPECT(flags == 48);
+    EXPECT(layout.alignment() == alignof(uint64_t));
+    const result<size_t> size = layout.size();
+    EXPECT(size);
+    EXPECT(size.value == 56);
+  }
+  {
+    constexpr size_t half = size_max / 2;
+    checked_layout layout;
+    (void)layout.add<char>(half);
+    EXPECT(layout.size());
+    (void)layout.add<char>(half);
+    EXPECT(layout.size());
+    (void)layout.add<uint32_t>(1);
+    EXPECT(!layout.size());
+    // Overflow is sticky.
+    checked_layout copy = layout;
+    (void)copy.add<char>(0);
+    EXPECT(!copy.size());
+  }
+  {
+    checked_layout layout;
+    (void)layout.add<char>(1, 5);
+    EXPECT(!layout.size());
+  }
+  {
+    constexpr size_t kOffset = [] {
+      checked_layout layout;
+      (void)layout.add<char>(3);
+      return layout.add<uint32_t>(1);
+    }();
+    static_assert(kOffset == 4);
+  }
+}
+
+void TestMalloc() {
+  {
+    uint32_t* words = checked_malloc_array<uint32_t>(1000);
+    EXPECT(words != nullptr);
+    words[999] = 42;
+    free(words);
+  }
+  {
+    errno = 0;
+    EXPECT(checked_malloc_array<uint32_t>(size_max / 2) == nullptr);
+    EXPECT(errno == ENOMEM);
+  }
+  {
+    errno = 0;
+    EXPECT(checked_malloc(checked_array_bytes<Header>(size_max / 4)) ==
+           nullptr);
+    EXPECT(errno == ENOMEM);
+  }
+  {
+    Line* lines = checked_malloc_array<Line>(3);
+    EXPECT(lines != nullptr);
+    EXPECT(reinterpret_cast<uintptr_t>(lines) % alignof(Line) == 0);
+    free(lines);
+  }
+  {
+    checked_layout layout;
+    (void)layout.add<Header>(1);
+    const size_t offset = layout.add<Line>(2);
+    char* base = static_cast<char*>(checked_aligned_alloc(layout));
+    EXPECT(base != nullptr);
+    EXPECT(reinterpret_cast<uintptr_t>(base + offset) % alignof(Line) == 0);
+    free(base);
+    (void)layout.add<Line>(size_max / 64);
+    errno = 0;
+    EXPECT(checked_aligned_alloc(layout) == nullptr);
+    EXPECT(errno == ENOMEM);
+  }
+}
+
+void TestOperatorNew() {
+  {
+    Line* lines = checked_operator_new<Line>(2);
+    EXPECT(reinterpret_cast<uintptr_t>(lines) % alignof(Line) == 0);
+    checked_operator_delete(lines);
+  }
+  {
+    bool threw = false;
+    try {
+      (void)checked_operator_new<uint64_t>(size_max / 4);
+    } catch (const bad_array_new_length&) {
+      threw = true;
+    }
+    EXPECT(threw);
+  }
+}
+
+void TestAllocator() {
+  vector<uint32_t, checked_allocator<uint32_t>> v(100, 7);
+  v.push_back(8);
+  EXPECT(v.size() == 101);
+  EXPECT(v[100] == 8);
+  EXPECT(checked_allocator<uint32_t>{} == checked_allocator<uint32_t>{});
+  checked_allocator<uint32_t> a;
+  bool threw = false;
+  try {
+    (void)a.allocate(size_max / 2);
+  } catch (const bad_array_new_length&) {
+    threw = true;
+  }
+  EXPECT(threw);
+}
+
+}  // namespace
+
+int main() {
+  TestArrayBytes();
+  TestLayout();
+  TestMalloc();
+  TestOperatorNew();
+  TestAllocator();
+}
@@ -0,0 +1,34 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ASSUME_H_
+#define ASSUME_H_
+
+/// ### `INTEGERS_ASSUME`
+///
+/// Tells the compiler that `condition` is true, so that it can remove
+/// redundant checks downstream. If `condition` is false, the behavior is
+/// undefined; only use it for facts that the code has already established.
+#if __has_builtin(__builtin_assume)
+#define INTEGERS_ASSUME(condition) __builtin_assume(condition)
+#else
+#define INTEGERS_ASSUME(condition) \
+  do {                             \
+    if (!(condition)) {            \
+      __builtin_unreachable();     \
+    }                              \
+  } while (false)
+#endif
+
+#endif  // ASSUME_H_
@@ -0,0 +1,207 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ATOMIC_H_
+#define ATOMIC_H_
+
+#include <atomic>
+
+#include "checked.h"
+#include "is_integral.h"
+#include "trap.h"
+#include "trapping.h"
+
+namespace internal {
+
+// Returns the strongest memory order that a failed compare-exchange (which
+// is only a load) may use, for a compare-exchange that uses `order` when it
+// succeeds.
+constexpr std::memory_order load_order(std::memory_order order) {
+  switch (order) {
+    case std::memory_order_release:
+      return std::memory_order_relaxed;
+    case std::memory_order_acq_rel:
+      return std::memory_order_acquire;
+    default:
+      return order;
+  }
+}
+
+}  // namespace internal
+
+namespace integers {
+
+/// ## `trapping_atomic<T>`
+///
+/// This template class is an atomic integer, for counters that several
+/// threads update (reference counts, quotas, and so on), which `trap`s
+/// instead of wrapping around if an update overflows or underflows.
+/// `std::atomic<uint32_t>` silently wraps, which for a reference count means
+/// a premature free.
+///
+/// There are 2 kinds of update:
+///
+/// * `fetch_add` and `fetch_sub` (and the operators) are as fast as with
+///   `std::atomic`: a single `lock xadd` on x86-64 (or `ldadd` with AArch64
+///   LSE), followed by an ordinary overflow check of the old value and the
+///   delta. On overflow, they undo the update (with the opposite atomic
+///   operation) and then `trap`, so if `trap` returns control (see trap.h),
+///   the counter is as it was. The catch is that the wrapped-around value is
+///   stored for that moment, so other threads might observe it (e.g. a
+///   reference count that wrapped to 0) before this one undoes it and
+///   `trap`s. Where no thread may ever act on a wrapped value, use:
+/// * `checked_fetch_add` and `checked_fetch_sub`, which never store an
+///   overflowed value: they compute the new value and store it with a
+///   compare-exchange loop, and instead of `trap`ping, they return the old
+///   value with `overflowed` set (see `result<R>` in checked.h) and leave the
+///   counter unchanged. They are slower under contention, since a thread must
+///   retry whenever another thread changes the value between its load and its
+///   compare-exchange.
+///
+/// Every operation takes a `std::memory_order`, which defaults to
+/// `std::memory_order_seq_cst`, as in `std::atomic`. `relaxed` suffices for
+/// statistics counters; reference counts typically increment with `relaxed`
+/// and decrement with `acq_rel`.
+///
+/// `T` must be a type for which `std::atomic<T>` is always lock-free.
+template <typename T>
+class trapping_atomic {
+  assert_is_integral(T);
+  static_assert(std::atomic<T>::is_always_lock_free,
+                "std::atomic<T> must be lock-free");
+
+ public:
+  /// ### `trapping_atomic`
+  ///
+  /// Initializes the value to `value`, or 0. (Initialization is not atomic.)
+  constexpr trapping_atomic() noexcept : value_(0) {}
+  constexpr trapping_atomic(T value) noexcept : value_(value) {}
+
+  trapping_atomic(const trapping_atomic&) = delete;
+  trapping_atomic& operator=(const trapping_atomic&) = delete;
+
+  /// ### `load`
+  ///
+  /// Returns the current value.
+  T load(std::memory_order order = std::memory_order_seq_cst) const noexcept {
+    return value_.load(order);
+  }
+
+  /// ### `store`
+  ///
+  /// Replaces the current value with `value`.
+  void store(T value,
+             std::memory_order order = std::memory_order_seq_cst) noexcept {
+    value_.store(value, order);
+  }
+
+  /// ### `operator T`
+  ///
+  /// Returns `load()`.
+  operator T() const noexcept { return load(); }
+
+  /// ### `fetch_add`
+  ///
+  /// Atomically adds `delta`, and returns the previous value. If the sum
+  /// overflows, subtracts `delta` again, and `trap`s. (This and the other
+  /// operations that can `trap` are not `noexcept`, since `trap` can throw;
+  /// see trap.h.)
+  T fetch_add(T delta, std::memory_order order = std::memory_order_seq_cst) {
+    const T previous = value_.fetch_add(delta, order);
+    T sum;
+    if (add_overflow(previous, delta, &sum)) {
+      value_.fetch_sub(delta, order);
+      trap();
+    }
+    return previous;
+  }
+
+  /// ### `fetch_sub`
+  ///
+  /// Atomically subtracts `delta`, and returns the previous value. If the
+  /// difference overflows, adds `delta` again, and `trap`s.
+  T fetch_sub(T delta, std::memory_order order = std::memory_order_seq_cst) {
+    const T previous = value_.fetch_sub(delta, order);
+    T difference;
+    if (sub_overflow(previous, delta, &difference)) {
+      value_.fetch_add(delta, order);
+      trap();
+    }
+    return previous;
+  }
+
+  /// ### `checked_fetch_add`
+  ///
+  /// Atomically adds `delta`, unless the sum would overflow. Returns the
+  /// previous value, and whether the sum overflowed (in which case the value
+  /// is unchanged).
+  result<T> checked_fetch_add(
+      T delta,
+      std::memory_order order = std::memory_order_seq_cst) noexcept {
+    T previous = value_.load(internal::load_order(order));
+    T sum;
+    do {
+      if (add_overflow(previous, delta, &sum)) {
+        return {previous, true};
+      }
+    } while (!value_.compare_exchange_weak(previous, sum, order,
+                                           internal::load_order(order)));
+    return {previous, false};
+  }
+
+  /// ### `checked_fetch_sub`
+  ///
+  /// Atomically subtracts `delta`, unless the difference would overflow.
+  /// Returns the previous value, and whether the difference overflowed (in
+  /// which case the value is unchanged).
+  result<T> checked_fetch_sub(
+      T delta,
+      std::memory_order order = std::memory_order_seq_cst) noexcept {
+    T previous = value_.load(internal::load_order(order));
+    T difference;
+    do {
+      if (sub_overflow(previous, delta, &difference)) {
+        return {previous, true};
+      }
+    } while (!value_.compare_exchange_weak(previous, difference, order,
+                                           internal::load_order(order)));
+    return {previous, false};
+  }
+
+  /// ### `operator+=`, `operator-=`
+  ///
+  /// Like `fetch_add` and `fetch_sub`, but return the new value.
+  T operator+=(T delta) {
+    return static_cast<T>(fetch_add(delta) + delta);
+  }
+  T operator-=(T delta) {
+    return static_cast<T>(fetch_sub(delta) - delta);
+  }
+
+  /// ### `operator++`, `operator--`
+  ///
+  /// Increment or decrement by 1. The prefix forms return the new value, and
+  /// the postfix forms return the previous value.
+  T operator++() { return *this += T{1}; }
+  T operator--() { return *this -= T{1}; }
+  T operator++(int) { return fetch_add(T{1}); }
+  T operator--(int) { return fetch_sub(T{1}); }
+
+ private:
+  std::atomic<T> value_;
+};
+
+}  // namespace integers
+
+#endif  // ATOMIC_H_
@@ -0,0 +1,194 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include "atomic.h"
+#include "test_support.h"
+
+using namespace integers;
+using namespace std;
+
+namespace {
+
+using i8 = int8_t;
+using u8 = uint8_t;
+using i16 = int16_t;
+using u16 = uint16_t;
+using i32 = int32_t;
+using u32 = uint32_t;
+using i64 = int64_t;
+using u64 = uint64_t;
+
+template <typename T>
+void GenericTestFetchAdd() {
+  constexpr T max = numeric_limits<T>::max();
+  constexpr T min = numeric_limits<T>::min();
+  {
+    trapping_atomic<T> x{T{max - 1}};
+    EXPECT(x.fetch_add(T{1}) == max - 1);
+    EXPECT(x.load() == max);
+    // Each failed add undoes itself before it `trap`s, so the value is
+    // unchanged when `trap` returns control to the test (see
+    // test_support.h).
+    EXPECT_DEATH(x.fetch_add(T{1}));
+    EXPECT(x.load() == max);
+    EXPECT_DEATH(x++);
+    EXPECT_DEATH(++x);
+    EXPECT_DEATH(x += T{1});
+    EXPECT(x.load() == max);
+    EXPECT(x.fetch_add(T{0}, memory_order_relaxed) == max);
+  }
+  {
+    trapping_atomic<T> x{T{min + 1}};
+    EXPECT(x.fetch_sub(T{1}, memory_order_acq_rel) == min + 1);
+    EXPECT(x == min);
+    EXPECT_DEATH(x.fetch_sub(T{1}));
+    EXPECT(x.load() == min);
+    EXPECT_DEATH(x--);
+    EXPECT_DEATH(--x);
+    EXPECT_DEATH(x -= T{1});
+    EXPECT(x.load() == min);
+  }
+  {
+    trapping_atomic<T> x;
+    EXPECT(++x == T{1});
+    EXPECT(x++ == T{1});
+    EXPECT((x += T{3}) == T{5});
+    EXPECT(x-- == T{5});
+    EXPECT(--x == T{3});
+    EXPECT((x -= T{3}) == T{0});
+    x.store(T{7}, memory_order_release);
+    EXPECT(x.load(memory_order_acquire) == T{7});
+  }
+  if constexpr (is_signed_v<T>) {
+    trapping_atomic<T> x{T{-1}};
+    EXPECT(x.fetch_add(T{-1}) == T{-1});
+    EXPECT(x.fetch_sub(T{-3}) == T{-2});
+    EXPECT(x == T{1});
+    x.store(max);
+    EXPECT_DEATH(x.fetch_sub(T{-1}, memory_order_seq_cst));
+  }
+}
+
+template <typename T>
+void GenericTestCheckedFetchAdd() {
+  constexpr T max = numeric_limits<T>::max();
+  constexpr T min = numeric_limits<T>::min();
+  {
+    trapping_atomic<T> x{max};
+    const result<T> r = x.checked_fetch_add(T{1});
+    EXPECT(r.overflowed);
+    EXPECT(r.value == max);
+    // The value is unchanged.
+    EXPECT(x == max);
+    EXPECT(!x.checked_fetch_add(T{0}, memory_order_relaxed).overflowed);
+    EXPECT(!x.checked_fetch_sub(T{1}, memory_order_acq_rel).overflowed);
+    EXPECT(x == max - 1);
+  }
+  {
+    trapping_atomic<T> x{min};
+    EXPECT(x.checked_fetch_sub(T{1}, memory_order_release).overflowed);
+    EXPECT(x == min);
+    EXPECT(x.checked_fetch_add(T{1}, memory_order_acquire).value == min);
+    EXPECT(x == min + 1);
+  }
+}
+
+template <class... T>
+void CallGenericTests() {
+  (GenericTestFetchAdd<T>(), ...);
+  (GenericTestCheckedFetchAdd<T>(), ...);
+}
+
+void TestAllTypes() {
+  CallGenericTests<i8, u8, i16, u16, i32, u32, i64, u64>();
+}
+
+void TestConcurrentCounts() {
+  constexpr int kThreads = 8;
+  constexpr u32 kIterations = 100000;
+  trapping_atomic<u32> relaxed;
+  trapping_atomic<u32> sequential;
+  trapping_atomic<u32> checked_count;
+  vector<thread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back([&] {
+      for (u32 j = 0; j < kIterations; ++j) {
+        relaxed.fetch_add(1, memory_order_relaxed);
+        ++sequential;
+        EXPECT(!checked_count.checked_fetch_add(1, memory_order_acq_rel)
+                    .overflowed);
+      }
+    });
+  }
+  for (thread& t : threads) {
+    t.join();
+  }
+  EXPECT(relaxed == kThreads * kIterations);
+  EXPECT(sequential == kThreads * kIterations);
+  EXPECT(checked_count == kThreads * kIterations);
+}
+
+void TestConcurrentQuota() {
+  // Threads race to take units from a quota; the checked form never lets it
+  // go below 0, so exactly `kQuota` of the attempts succeed.
+  constexpr u32 kQuota = 1000;
+  trapping_atomic<u32> quota{kQuota};
+  trapping_atomic<u32> taken;
+  vector<thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&] {
+      for (int j = 0; j < 1000; ++j) {
+        if (!quota.checked_fetch_sub(1, memory_order_acq_rel).overflowed) {
+          taken.fetch_add(1, memory_order_relaxed);
+        }
+      }
+    });
+  }
+  for (thread& t : threads) {
+    t.join();
+  }
+  EXPECT(quota == 0);
+  EXPECT(taken == kQuota);
+}
+
+void TestRefcount() {
+  trapping_atomic<u8> refs{u8{1}};
+  for (int i = 0; i < 254; ++i) {
+    refs.fetch_add(1, memory_order_relaxed);
+  }
+  EXPECT(refs == 255);
+  // 1 reference too many would wrap to 0 and free the object.
+  EXPECT_DEATH(refs.fetch_add(1, memory_order_relaxed));
+  EXPECT(refs == 255);
+  for (int i = 0; i < 254; ++i) {
+    EXPECT(refs.fetch_sub(1, memory_order_acq_rel) != 1);
+  }
+  EXPECT(refs.fetch_sub(1, memory_order_acq_rel) == 1);
+  // Releasing a reference that was never taken.
+  EXPECT_DEATH(refs.fetch_sub(1, memory_order_acq_rel));
+}
+
+}  // namespace
+
+int main() {
+  TestAllTypes();
+  TestConcurrentCounts();
+  TestConcurrentQuota();
+  TestRefcount();
+}
@@ -0,0 +1,781 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef BATCH_H_
+#define BATCH_H_
+
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <limits>
+#include <type_traits>
+
+#if __has_include(<span>)
+#include <span>
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "clamping.h"
+#include "in_range.h"
+#include "is_integral.h"
+#include "trap.h"
+#include "trapping.h"
+
+namespace internal {
+
+/// The number of elements the batch functions process between checks of the
+/// accumulated overflow flag. Small enough that the per-block flags fit in L1,
+/// large enough that the check is amortized over several vectors.
+inline constexpr size_t kBatchBlockSize = 256;
+
+/// Returns true if the sign bit of `x` is set. Works for signed and unsigned
+/// `T`, and compiles to a shift (no branch).
+template <typename T>
+constexpr bool sign_bit(T x) {
+  using U = make_unsigned_t<T>;
+  return static_cast<U>(static_cast<U>(x) >> (CHAR_BIT * sizeof(T) - 1)) != 0;
+}
+
+/// The type that can hold the full product of two `T`s, or `void` if there is
+/// no such standard type.
+template <typename T>
+using wide_product_t = std::conditional_t<
+    (sizeof(T) == 1),
+    std::conditional_t<is_signed_v<T>, int16_t, uint16_t>,
+    std::conditional_t<
+        (sizeof(T) == 2),
+        std::conditional_t<is_signed_v<T>, int32_t, uint32_t>,
+        std::conditional_t<
+            (sizeof(T) == 4),
+            std::conditional_t<is_signed_v<T>, int64_t, uint64_t>, void>>>;
+
+// The `*_lane` functions compute a single element and return its overflow
+// flag, without branching. When all the types are the same, they use the
+// classic bit tricks (which compilers vectorize); otherwise, they fall back to
+// the scalar `*_overflow` built-ins.
+
+template <typename T, typename U, typename R>
+bool add_lane(T x, U y, R* result) {
+  if constexpr (std::is_same_v<T, U> && std::is_same_v<T, R>) {
+    using W = make_unsigned_t<T>;
+    const W r = static_cast<W>(static_cast<W>(x) + static_cast<W>(y));
+    *result = static_cast<R>(r);
+    if constexpr (is_unsigned_v<T>) {
+      return r < x;
+    } else {
+      // Overflow iff both operands have the same sign, and the result’s sign
+      // differs from it.
+      return sign_bit(static_cast<W>((static_cast<W>(x) ^ r) &
+                                     (static_cast<W>(y) ^ r)));
+    }
+  } else {
+    return integers::add_overflow(x, y, result);
+  }
+}
+
+template <typename T, typename U, typename R>
+bool sub_lane(T x, U y, R* result) {
+  if constexpr (std::is_same_v<T, U> && std::is_same_v<T, R>) {
+    using W = make_unsigned_t<T>;
+    const W r = static_cast<W>(static_cast<W>(x) - static_cast<W>(y));
+    *result = static_cast<R>(r);
+    if constexpr (is_unsigned_v<T>) {
+      return x < y;
+    } else {
+      // Overflow iff the operands have different signs, and the result’s sign
+      // differs from `x`’s.
+      return sign_bit(static_cast<W>((static_cast<W>(x) ^ static_cast<W>(y)) &
+                                     (static_cast<W>(x) ^ r)));
+    }
+  } else {
+    return integers::sub_overflow(x, y, result);
+  }
+}
+
+template <typename T, typename U, typename R>
+bool mul_lane(T x, U y, R* result) {
+  if constexpr (std::is_same_v<T, U> && std::is_same_v<T, R> &&
+                !std::is_void_v<wide_product_t<T>>) {
+    using W = wide_product_t<T>;
+    const W r = static_cast<W>(static_cast<W>(x) * static_cast<W>(y));
+    *result = static_cast<R>(r);
+    if constexpr (is_unsigned_v<T>) {
+      return r > static_cast<W>(std::numeric_limits<R>::max());
+    } else {
+      return (r < static_cast<W>(std::numeric_limits<R>::min())) |
+             (r > static_cast<W>(std::numeric_limits<R>::max()));
+    }
+  } else {
+    return integers::mul_overflow(x, y, result);
+  }
+}
+
+/// Calls `lane(i)` for every `i` in [0, `count`), a block at a time. Returns
+/// the first `i` for which `lane` returned true, or `count`. Within a block,
+/// the flags are recorded without branching, so that the loop can be
+/// vectorized; the flags are only inspected once per block.
+template <typename Lane>
+size_t batch_first_overflow(size_t count, Lane lane) {
+  // These are bytes, not `bool`s, because compilers do not vectorize `bool`
+  // reductions.
+  uint8_t flags[kBatchBlockSize];
+  for (size_t begin = 0; begin < count; begin += kBatchBlockSize) {
+    const size_t n =
+        count - begin < kBatchBlockSize ? count - begin : kBatchBlockSize;
+    uint8_t overflowed = 0;
+    for (size_t i = 0; i < n; i++) {
+      flags[i] = lane(begin + i);
+      overflowed |= flags[i];
+    }
+    if (overflowed != 0) {
+      for (size_t i = 0; i < n; i++) {
+        if (flags[i]) {
+          return begin + i;
+        }
+      }
+    }
+  }
+  return count;
+}
+
+/// Describes a range check of `T`s against `R` that needs only an addition
+/// and a mask: `x` is in the range of `R` iff `(U(x) + kBias) & kMask` is 0.
+/// (`kBias` moves the range of `R` to start at 0, when both are signed, and
+/// `kMask` selects the bits above its end.) That holds for every element of an
+/// array iff it holds for the bitwise OR of all the `U(x) + kBias`, so a whole
+/// block is checked with 1 branch, like checking its minimum and maximum, but
+/// with a cheaper reduction (`por` instead of `pminsd` and `pmaxsd`, which
+/// SSE2 lacks for 32- and 64-bit elements).
+template <typename T, typename R>
+struct cast_check {
+  using U = make_unsigned_t<T>;
+  static constexpr bool kBothSigned = is_signed_v<T> && is_signed_v<R>;
+  static constexpr U kBias =
+      kBothSigned ? static_cast<U>(U{0} - static_cast<U>(static_cast<T>(
+                                              std::numeric_limits<R>::min())))
+                  : U{0};
+  // The biased maximum of `R`. Only meaningful if `R`’s maximum is in the
+  // range of `T`.
+  static constexpr U kBiasedMax = static_cast<U>(
+      static_cast<U>(static_cast<T>(std::numeric_limits<R>::max())) + kBias);
+  static constexpr U kMask = static_cast<U>(
+      ~(in_range<T>(std::numeric_limits<R>::max())
+            ? kBiasedMax
+            : static_cast<U>(std::numeric_limits<T>::max())));
+};
+
+// `cast_vector` converts as many leading elements as fill whole vectors, a
+// block at a time, and stops at the first block with an element that does not
+// fit. It returns how many elements it converted, all of which fit: 0, if the
+// target has no vector conversion from `T` to `R`. With SSE2, it converts
+// between types of the same size, and to types of half the size (with
+// `packsswb`, `packssdw`, or `shufps`).
+
+#if defined(__SSE2__)
+
+template <typename U>
+__m128i sse2_set1(U x) {
+  if constexpr (sizeof(U) == 1) {
+    return _mm_set1_epi8(static_cast<char>(x));
+  } else if constexpr (sizeof(U) == 2) {
+    return _mm_set1_epi16(static_cast<short>(x));
+  } else if constexpr (sizeof(U) == 4) {
+    return _mm_set1_epi32(static_cast<int>(x));
+  } else {
+    return _mm_set1_epi64x(static_cast<long long>(x));
+  }
+}
+
+template <typename T>
+__m128i sse2_add(__m128i a, __m128i b) {
+  if constexpr (sizeof(T) == 1) {
+    return _mm_add_epi8(a, b);
+  } else if constexpr (sizeof(T) == 2) {
+    return _mm_add_epi16(a, b);
+  } else if constexpr (sizeof(T) == 4) {
+    return _mm_add_epi32(a, b);
+  } else {
+    return _mm_add_epi64(a, b);
+  }
+}
+
+// Returns the low half of each element of `a` and then of `b`. Sign-extending
+// the low halves first makes the saturating packs exact.
+template <typename T>
+__m128i sse2_narrow(__m128i a, __m128i b) {
+  if constexpr (sizeof(T) == 2) {
+    return _mm_packs_epi16(_mm_srai_epi16(_mm_slli_epi16(a, 8), 8),
+                           _mm_srai_epi16(_mm_slli_epi16(b, 8), 8));
+  } else if constexpr (sizeof(T) == 4) {
+    return _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16),
+                           _mm_srai_epi32(_mm_slli_epi32(b, 16), 16));
+  } else {
+    return _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a),
+                                           _mm_castsi128_ps(b),
+                                           _MM_SHUFFLE(2, 0, 2, 0)));
+  }
+}
+
+template <typename T, typename R>
+size_t cast_vector(const T* x, R* result, size_t count) {
+  if constexpr (sizeof(T) > 8 ||
+                (sizeof(R) != sizeof(T) && 2 * sizeof(R) != sizeof(T))) {
+    return 0;
+  } else {
+    using Check = cast_check<T, R>;
+    constexpr size_t kLanes = sizeof(__m128i) / sizeof(T);
+    // The number of input elements per output vector.
+    constexpr size_t kStep = sizeof(__m128i) / sizeof(R);
+    const size_t whole = count - count % kStep;
+    const __m128i bias = sse2_set1(Check::kBias);
+    const __m128i mask = sse2_set1(Check::kMask);
+    for (size_t begin = 0; begin < whole; begin += kBatchBlockSize) {
+      const size_t end =
+          whole - begin < kBatchBlockSize ? whole : begin + kBatchBlockSize;
+      __m128i bits = _mm_setzero_si128();
+      for (size_t i = begin; i < end; i += kStep) {
+        const __m128i a =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i));
+        bits = _mm_or_si128(bits, sse2_add<T>(a, bias));
+        if constexpr (kStep == kLanes) {
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(result + i), a);
+        } else {
+          const __m128i b =
+              _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i + kLanes));
+          bits = _mm_or_si128(bits, sse2_add<T>(b, bias));
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(result + i),
+                           sse2_narrow<T>(a, b));
+        }
+      }
+      if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(bits, mask),
+                                           _mm_setzero_si128())) != 0xffff) {
+        return begin;
+      }
+    }
+    return whole;
+  }
+}
+
+#else
+
+template <typename T, typename R>
+size_t cast_vector(const T*, R*, size_t) {
+  return 0;
+}
+
+#endif
+
+/// Converts each `x[i]` to an `R`, as `static_cast` does, and stores it in
+/// `result[i]`. Returns the index of the first `x[i]` that is not in the
+/// range of `R`, or `count`. Each block is checked once, with `cast_check`;
+/// only a block that does not fit is searched for the failing index.
+template <typename T, typename R>
+size_t cast_first_overflow(const T* x, R* result, size_t count) {
+  if constexpr (in_range<R>(std::numeric_limits<T>::min()) &&
+                in_range<R>(std::numeric_limits<T>::max())) {
+    // Every `T` fits in `R`.
+    for (size_t i = 0; i < count; i++) {
+      result[i] = static_cast<R>(x[i]);
+    }
+    return count;
+  } else {
+    using Check = cast_check<T, R>;
+    using U = typename Check::U;
+    for (size_t begin = cast_vector(x, result, count); begin < count;
+         begin += kBatchBlockSize) {
+      const size_t n =
+          count - begin < kBatchBlockSize ? count - begin : kBatchBlockSize;
+      U bits = 0;
+      for (size_t i = begin; i < begin + n; i++) {
+        result[i] = static_cast<R>(x[i]);
+        bits |= static_cast<U>(static_cast<U>(x[i]) + Check::kBias);
+      }
+      if ((bits & Check::kMask) != 0) {
+        for (size_t i = begin; i < begin + n; i++) {
+          if (!in_range<R>(x[i])) {
+            return i;
+          }
+        }
+      }
+    }
+    return count;
+  }
+}
+
+// The `clamping_*_vector` functions compute as many leading elements as fill
+// whole vectors with the CPU’s saturating instructions, and return how many
+// that was: 0, if the target has no such instruction for `T`. SSE2 has them
+// for 8- and 16-bit elements (`paddsb`, `paddusw`, et c.). Elsewhere, the
+// scalar loops are left to the compiler’s vectorizer.
+
+#if defined(__SSE2__)
+
+template <typename T, typename Op>
+size_t sse2_map(const T* x, const T* y, T* result, size_t count, Op op) {
+  constexpr size_t kLanes = sizeof(__m128i) / sizeof(T);
+  size_t i = 0;
+  for (; i + kLanes <= count; i += kLanes) {
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i));
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(result + i), op(a, b));
+  }
+  return i;
+}
+
+template <typename T>
+size_t clamping_add_vector(const T* x, const T* y, T* result, size_t count) {
+  if constexpr (sizeof(T) == 1 && is_signed_v<T>) {
+    return sse2_map(x, y, result, count, [](__m128i a, __m128i b) {
+      return _mm_adds_epi8(a, b);
+    });
+  } else if constexpr (sizeof(T) == 1) {
+    return sse2_map(x, y, result, count, [](__m128i a, __m128i b) {
+      return _mm_adds_epu8(a, b);
+    });
+  } else if constexpr (sizeof(T) == 2 && is_signed_v<T>) {
+    return sse2_map(x, y, result, count, [](__m128i a, __m128i b) {
+      return _mm_adds_epi16(a, b);
+    });
+  } else if constexpr (sizeof(T) == 2) {
+    return sse2_map(x, y, result, count, [](__m128i a, __m128i b) {
+      return _mm_adds_epu16(a, b);
+    });
+  } else {
+    return 0;
+  }
+}
+
+template <typename T>
+size_t clamping_sub_vector(const T* x, const T* y, T* result, size_t count) {
+  if constexpr (sizeof(T) == 1 && is_signed_v<T>) {
+    return sse2_map(x, y, result, count, [](__m128i a, __m128i b) {
+      return _mm_subs_epi8(a, b);
+    });
+  } else if constexpr (sizeof(T) == 1) {
+    return sse2_map(x, y, result, count, [](__m128i a, __m128i b) {
+      return _mm_subs_epu8(a, b);
+    });
+  } else if constexpr (sizeof(T) == 2 && is_signed_v<T>) {
+    return sse2_map(x, y, result, count, [](__m128i a, __m128i b) {
+      return _mm_subs_epi16(a, b);
+    });
+  } else if constexpr (sizeof(T) == 2) {
+    return sse2_map(x, y, result, count, [](__m128i a, __m128i b) {
+      return _mm_subs_epu16(a, b);
+    });
+  } else {
+    return 0;
+  }
+}
+
+#else
+
+template <typename T>
+size_t clamping_add_vector(const T*, const T*, T*, size_t) {
+  return 0;
+}
+
+template <typename T>
+size_t clamping_sub_vector(const T*, const T*, T*, size_t) {
+  return 0;
+}
+
+#endif
+
+}  // namespace internal
+
+namespace integers {
+
+/// ## Batch Checking Operations
+///
+/// These functions apply the primitive checking operations to whole arrays.
+/// Instead of branching on each element’s overflow flag (as a loop over
+/// `trapping<T>` would), they accumulate the flags across a block of elements
+/// and check once per block. With `T`, `U`, and `R` all the same type, each
+/// element is computed with branch-free arithmetic that Clang vectorizes at
+/// `-O2`, and GCC at `-O3` (e.g. to SSE2, AVX2, AVX-512, or NEON, depending on
+/// the target flags you build with). The remainder of the array that does
+/// not fill a vector falls back to the same scalar code.
+///
+/// `x`, `y`, and `result` must each point to `count` elements. `result` may be
+/// the same array as `x` or `y`.
+///
+/// ### `add_overflow_n`
+///
+/// Adds each `x[i]` to `y[i]` and stores the result in `result[i]`. Returns the
+/// index of the first element whose operation overflowed, or `count` if none
+/// did. If an element overflows, elements after it may or may not have been
+/// computed.
+template <typename T, typename U, typename R>
+[[nodiscard]] size_t add_overflow_n(const T* x,
+                                    const U* y,
+                                    R* result,
+                                    size_t count) {
+  assert_is_integral(T);
+  assert_is_integral(U);
+  assert_is_integral(R);
+  return internal::batch_first_overflow(count, [=](size_t i) {
+    return internal::add_lane(x[i], y[i], &result[i]);
+  });
+}
+
+/// ### `sub_overflow_n`
+///
+/// Subtracts each `y[i]` from `x[i]` and stores the result in `result[i]`.
+/// Returns the index of the first element whose operation overflowed, or
+/// `count` if none did. If an element overflows, elements after it may or may
+/// not have been computed.
+template <typename T, typename U, typename R>
+[[nodiscard]] size_t sub_overflow_n(const T* x,
+                                    const U* y,
+                                    R* result,
+                                    size_t count) {
+  assert_is_integral(T);
+  assert_is_integral(U);
+  assert_is_integral(R);
+  return internal::batch_first_overflow(count, [=](size_t i) {
+    return internal::sub_lane(x[i], y[i], &result[i]);
+  });
+}
+
+/// ### `mul_overflow_n`
+///
+/// Multiplies each `x[i]` by `y[i]` and stores the result in `result[i]`.
+/// Returns the index of the first element whose operation overflowed, or
+/// `count` if none did. If an element overflows, elements after it may or may
+/// not have been computed.
+///
+/// Types of up to 32 bits are multiplied in the next wider type (which
+/// vectorizes); 64-bit types use the scalar built-in for every element.
+template <typename T, typename U, typename R>
+[[nodiscard]] size_t mul_overflow_n(const T* x,
+                                    const U* y,
+                                    R* result,
+                                    size_t count) {
+  assert_is_integral(T);
+  assert_is_integral(U);
+  assert_is_integral(R);
+  return internal::batch_first_overflow(count, [=](size_t i) {
+    return internal::mul_lane(x[i], y[i], &result[i]);
+  });
+}
+
+/// ### `trapping_add_n`
+///
+/// Adds each `x[i]` to `y[i]` and stores the result in `result[i]`. If any
+/// operation overflows, this function will `trap`.
+template <typename T, typename U, typename R>
+void trapping_add_n(const T* x, const U* y, R* result, size_t count) {
+  if (add_overflow_n(x, y, result, count) != count) {
+    trap();
+  }
+}
+
+/// ### `trapping_sub_n`
+///
+/// Subtracts each `y[i]` from `x[i]` and stores the result in `result[i]`. If
+/// any operation overflows, this function will `trap`.
+template <typename T, typename U, typename R>
+void trapping_sub_n(const T* x, const U* y, R* result, size_t count) {
+  if (sub_overflow_n(x, y, result, count) != count) {
+    trap();
+  }
+}
+
+/// ### `trapping_mul_n`
+///
+/// Multiplies each `x[i]` by `y[i]` and stores the result in `result[i]`. If
+/// any operation overflows, this function will `trap`.
+template <typename T, typename U, typename R>
+void trapping_mul_n(const T* x, const U* y, R* result, size_t count) {
+  if (mul_overflow_n(x, y, result, count) != count) {
+    trap();
+  }
+}
+
+/// ### `cast_truncate_n`
+///
+/// Converts each `x[i]` to an `R` and stores it in `result[i]`. Returns the
+/// index of the first element that `R` cannot hold, or `count` if all fit.
+/// If an element does not fit, the elements after it (and it) may hold
+/// unspecified values.
+///
+/// This is the batch version of `cast_truncate`, for narrowing whole
+/// columns (e.g. `int64_t` to `int32_t`, or signed to unsigned). It checks
+/// the range of each block of elements at once, instead of each element, and
+/// with SSE2 it converts a vector at a time.
+/// `result` may not overlap `x`, unless `x` and `result` are the same array
+/// and `T` and `R` have the same size.
+template <typename T, typename R>
+[[nodiscard]] size_t cast_truncate_n(const T* x, R* result, size_t count) {
+  assert_is_integral(T);
+  assert_is_integral(R);
+  return internal::cast_first_overflow(x, result, count);
+}
+
+/// ### `trapping_cast_n`
+///
+/// Converts each `x[i]` to an `R` and stores it in `result[i]`. If any
+/// element does not fit in `R`, this function will `trap`.
+template <typename T, typename R>
+void trapping_cast_n(const T* x, R* result, size_t count) {
+  if (cast_truncate_n(x, result, count) != count) {
+    trap();
+  }
+}
+
+/// ## Batch Clamping Operations
+///
+/// These functions apply the clamping operations to whole arrays of a single
+/// type `T`. With SSE2, which has saturating vector instructions for 8- and
+/// 16-bit types, they use them directly; the remaining elements (and every
+/// element, for other types and targets) are computed with the same
+/// branch-free arithmetic as the batch checking operations, which compilers
+/// can vectorize with compare-and-select.
+///
+/// `x`, `y`, and `result` must each point to `count` elements. `result` may be
+/// the same array as `x` or `y`.
+///
+/// ### `clamping_add_n`
+///
+/// Adds each `x[i]` to `y[i]`, clamping the sum to the range of `T`, and stores
+/// the result in `result[i]`.
+template <typename T>
+void clamping_add_n(const T* x, const T* y, T* result, size_t count) {
+  assert_is_integral(T);
+  for (size_t i = internal::clamping_add_vector(x, y, result, count);
+       i < count; i++) {
+    const T a = x[i];
+    T r = 0;
+    const bool overflowed = internal::add_lane(a, y[i], &r);
+    const T saturated = internal::saturate<T>(!internal::is_negative(a));
+    result[i] = overflowed ? saturated : r;
+  }
+}
+
+/// ### `clamping_sub_n`
+///
+/// Subtracts each `y[i]` from `x[i]`, clamping the difference to the range of
+/// `T`, and stores the result in `result[i]`.
+template <typename T>
+void clamping_sub_n(const T* x, const T* y, T* result, size_t count) {
+  assert_is_integral(T);
+  for (size_t i = internal::clamping_sub_vector(x, y, result, count);
+       i < count; i++) {
+    const T a = x[i];
+    T r = 0;
+    const bool overflowed = internal::sub_lane(a, y[i], &r);
+    const T saturated = internal::saturate<T>(internal::is_signed_v<T> &&
+                                              !internal::is_negative(a));
+    result[i] = overflowed ? saturated : r;
+  }
+}
+
+/// ### `clamping_mul_n`
+///
+/// Multiplies each `x[i]` by `y[i]`, clamping the product to the range of `T`,
+/// and stores the result in `result[i]`. (SSE2 has no saturating integer
+/// multiply, so this is always the branch-free scalar code; 8- through 32-bit
+/// types multiply in the next wider type, which vectorizes.)
+template <typename T>
+void clamping_mul_n(const T* x, const T* y, T* result, size_t count) {
+  assert_is_integral(T);
+  for (size_t i = 0; i < count; i++) {
+    const T a = x[i];
+    const T b = y[i];
+    T r = 0;
+    const bool overflowed = internal::mul_lane(a, b, &r);
+    const T saturated = internal::saturate<T>(internal::is_negative(a) ==
+                                              internal::is_negative(b));
+    result[i] = overflowed ? saturated : r;
+  }
+}
+
+#ifdef __cpp_lib_span
+/// ### Range overloads
+///
+/// Each of the batch functions also accepts `x`, `y`, and `result` as
+/// anything that converts to a `std::span` (in C++20): a `std::vector`,
+/// `std::array`, built-in array, or `std::span`. For example:
+///
+///   trapping_add_n(counts, deltas, counts);
+///
+/// `x`, `y`, and `result` must all have the same size; if not, these functions
+/// `trap`.
+template <typename X, typename Y, typename Out>
+  requires requires(const X& x, const Y& y, Out& result) {
+    std::span(x);
+    std::span(y);
+    std::span(result);
+  }
+[[nodiscard]] size_t add_overflow_n(const X& x, const Y& y, Out&& result) {
+  const std::span xs(x);
+  const std::span ys(y);
+  const std::span rs(result);
+  if (xs.size() != ys.size() || xs.size() != rs.size()) {
+    trap();
+  }
+  return add_overflow_n(xs.data(), ys.data(), rs.data(), xs.size());
+}
+
+template <typename X, typename Y, typename Out>
+  requires requires(const X& x, const Y& y, Out& result) {
+    std::span(x);
+    std::span(y);
+    std::span(result);
+  }
+[[nodiscard]] size_t sub_overflow_n(const X& x, const Y& y, Out&& result) {
+  const std::span xs(x);
+  const std::span ys(y);
+  const std::span rs(result);
+  if (xs.size() != ys.size() || xs.size() != rs.size()) {
+    trap();
+  }
+  return sub_overflow_n(xs.data(), ys.data(), rs.data(), xs.size());
+}
+
+template <typename X, typename Y, typename Out>
+  requires requires(const X& x, const Y& y, Out& result) {
+    std::span(x);
+    std::span(y);
+    std::span(result);
+  }
+[[nodiscard]] size_t mul_overflow_n(const X& x, const Y& y, Out&& result) {
+  const std::span xs(x);
+  const std::span ys(y);
+  const std::span rs(result);
+  if (xs.size() != ys.size() || xs.size() != rs.size()) {
+    trap();
+  }
+  return mul_overflow_n(xs.data(), ys.data(), rs.data(), xs.size());
+}
+
+template <typename X, typename Y, typename Out>
+  requires requires(const X& x, const Y& y, Out& result) {
+    std::span(x);
+    std::span(y);
+    std::span(result);
+  }
+void trapping_add_n(const X& x, const Y& y, Out&& result) {
+  if (add_overflow_n(x, y, result) != std::span(x).size()) {
+    trap();
+  }
+}
+
+template <typename X, typename Y, typename Out>
+  requires requires(const X& x, const Y& y, Out& result) {
+    std::span(x);
+    std::span(y);
+    std::span(result);
+  }
+void trapping_sub_n(const X& x, const Y& y, Out&& result) {
+  if (sub_overflow_n(x, y, result) != std::span(x).size()) {
+    trap();
+  }
+}
+
+template <typename X, typename Y, typename Out>
+  requires requires(const X& x, const Y& y, Out& result) {
+    std::span(x);
+    std::span(y);
+    std::span(result);
+  }
+void trapping_mul_n(const X& x, const Y& y, Out&& result) {
+  if (mul_overflow_n(x, y, result) != std::span(x).size()) {
+    trap();
+  }
+}
+
+template <typename X, typename Out>
+  requires requires(const X& x, Out& result) {
+    std::span(x);
+    std::span(result);
+  }
+[[nodiscard]] size_t cast_truncate_n(const X& x, Out&& result) {
+  const std::span xs(x);
+  const std::span rs(result);
+  if (xs.size() != rs.size()) {
+    trap();
+  }
+  return cast_truncate_n(xs.data(), rs.data(), xs.size());
+}
+
+template <typename X, typename Out>
+  requires requires(const X& x, Out& result) {
+    std::span(x);
+    std::span(result);
+  }
+void trapping_cast_n(const X& x, Out&& result) {
+  if (cast_truncate_n(x, result) != std::span(x).size()) {
+    trap();
+  }
+}
+
+template <typename X, typename Y, typename Out>
+  requires requires(const X& x, const Y& y, Out& result) {
+    std::span(x);
+    std::span(y);
+    std::span(result);
+  }
+void clamping_add_n(const X& x, const Y& y, Out&& result) {
+  const std::span xs(x);
+  const std::span ys(y);
+  const std::span rs(result);
+  if (xs.size() != ys.size() || xs.size() != rs.size()) {
+    trap();
+  }
+  clamping_add_n(xs.data(), ys.data(), rs.data(), xs.size());
+}
+
+template <typename X, typename Y, typename Out>
+  requires requires(const X& x, const Y& y, Out& result) {
+    std::span(x);
+    std::span(y);
+    std::span(result);
+  }
+void clamping_sub_n(const X& x, const Y& y, Out&& result) {
+  const std::span xs(x);
+  const std::span ys(y);
+  const std::span rs(result);
+  if (xs.size() != ys.size() || xs.size() != rs.size()) {
+    trap();
+  }
+  clamping_sub_n(xs.data(), ys.data(), rs.data(), xs.size());
+}
+
+template <typename X, typename Y, typename Out>
+  requires requires(const X& x, const Y& y, Out& result) {
+    std::span(x);
+    std::span(y);
+    std::span(result);
+  }
+void clamping_mul_n(const X& x, const Y& y, Out&& result) {
+  const std::span xs(x);
+  const std::span ys(y);
+  const std::span rs(result);
+  if (xs.size() != ys.size() || xs.size() != rs.size()) {
+    trap();
+  }
+  clamping_mul_n(xs.data(), ys.data(), rs.data(), xs.size());
+}
+#endif
+
+}  // namespace integers
+
+#endif  // BATCH_H_
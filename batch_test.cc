@@ -0,0 +1,366 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <array>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "batch.h"
+#include "test_support.h"
+
+using namespace integers;
+using namespace std;
+
+namespace {
+
+using i8 = int8_t;
+using u8 = uint8_t;
+using i16 = int16_t;
+using u16 = uint16_t;
+using i32 = int32_t;
+using u32 = uint32_t;
+using i64 = int64_t;
+using u64 = uint64_t;
+
+// Long enough to cover several blocks and a ragged tail.
+constexpr size_t kCount = 1000;
+
+// Fills `x` with values that sweep the whole range of `T`, so that the batch
+// results can be compared against the scalar primitives on every kind of
+// input (including the extremes).
+template <typename T>
+vector<T> Sweep(size_t count, size_t seed) {
+  vector<T> x(count);
+  using U = internal::make_unsigned_t<T>;
+  U value = static_cast<U>(seed * 0x9E3779B97F4A7C15ULL);
+  for (size_t i = 0; i < count; i++) {
+    value = static_cast<U>(value * 6364136223846793005ULL +
+                           1442695040888963407ULL);
+    x[i] = static_cast<T>(value);
+    if (i % 17 == 0) {
+      x[i] = numeric_limits<T>::max();
+    } else if (i % 19 == 0) {
+      x[i] = numeric_limits<T>::min();
+    } else if (i % 23 == 0) {
+      x[i] = 0;
+    }
+  }
+  return x;
+}
+
+// Returns the index of the first element for which `op` reports overflow, and
+// checks that `batch` computed the same results up to that index.
+template <typename T, typename Op>
+size_t ScalarReference(const vector<T>& x,
+                       const vector<T>& y,
+                       const vector<T>& batch,
+                       Op op) {
+  for (size_t i = 0; i < x.size(); i++) {
+    T expected;
+    if (op(x[i], y[i], &expected)) {
+      return i;
+    }
+    EXPECT(expected == batch[i]);
+  }
+  return x.size();
+}
+
+template <typename T>
+void GenericTestAgreesWithScalar() {
+  const vector<T> x = Sweep<T>(kCount, 1);
+  const vector<T> y = Sweep<T>(kCount, 2);
+  vector<T> result(kCount);
+
+  {
+    const size_t i = add_overflow_n(x.data(), y.data(), result.data(), kCount);
+    EXPECT(i == ScalarReference(x, y, result, [](T a, T b, T* r) {
+             return add_overflow(a, b, r);
+           }));
+  }
+  {
+    const size_t i = sub_overflow_n(x.data(), y.data(), result.data(), kCount);
+    EXPECT(i == ScalarReference(x, y, result, [](T a, T b, T* r) {
+             return sub_overflow(a, b, r);
+           }));
+  }
+  {
+    const size_t i = mul_overflow_n(x.data(), y.data(), result.data(), kCount);
+    EXPECT(i == ScalarReference(x, y, result, [](T a, T b, T* r) {
+             return mul_overflow(a, b, r);
+           }));
+  }
+}
+
+template <typename T>
+void GenericTestFirstIndex() {
+  constexpr T max = numeric_limits<T>::max();
+  constexpr T min = numeric_limits<T>::min();
+  vector<T> x(kCount, T{1});
+  vector<T> y(kCount, T{1});
+  vector<T> result(kCount);
+
+  EXPECT(kCount == add_overflow_n(x.data(), y.data(), result.data(), kCount));
+  EXPECT(result[kCount - 1] == T{2});
+  EXPECT(kCount == sub_overflow_n(x.data(), y.data(), result.data(), kCount));
+  EXPECT(result[kCount - 1] == T{0});
+  EXPECT(kCount == mul_overflow_n(x.data(), y.data(), result.data(), kCount));
+  EXPECT(result[kCount - 1] == T{1});
+
+  // Overflow in the tail, after several clean blocks:
+  x[kCount - 3] = max;
+  EXPECT(kCount - 3 ==
+         add_overflow_n(x.data(), y.data(), result.data(), kCount));
+  y[kCount - 3] = T{2};
+  EXPECT(kCount - 3 ==
+         mul_overflow_n(x.data(), y.data(), result.data(), kCount));
+
+  // More than one overflow; the first must win:
+  x[300] = max;
+  y[300] = max;
+  EXPECT(300 == add_overflow_n(x.data(), y.data(), result.data(), kCount));
+  EXPECT(300 == mul_overflow_n(x.data(), y.data(), result.data(), kCount));
+
+  x[7] = min;
+  y[7] = T{1};
+  EXPECT(7 == sub_overflow_n(x.data(), y.data(), result.data(), kCount));
+
+  EXPECT(0 == add_overflow_n(x.data(), y.data(), result.data(), 0));
+}
+
+template <typename T>
+void GenericTestTrapping() {
+  constexpr T max = numeric_limits<T>::max();
+  vector<T> x(kCount, T{1});
+  vector<T> y(kCount, T{1});
+  vector<T> result(kCount);
+
+  trapping_add_n(x.data(), y.data(), result.data(), kCount);
+  trapping_sub_n(x.data(), y.data(), result.data(), kCount);
+  trapping_mul_n(x.data(), y.data(), result.data(), kCount);
+
+  x[kCount / 2] = max;
+  y[kCount / 2] = max;
+  EXPECT_DEATH(trapping_add_n(x.data(), y.data(), result.data(), kCount));
+  EXPECT_DEATH(trapping_mul_n(x.data(), y.data(), result.data(), kCount));
+}
+
+template <typename T>
+void GenericTestClamping() {
+  const vector<T> x = Sweep<T>(kCount, 3);
+  const vector<T> y = Sweep<T>(kCount, 4);
+  vector<T> result(kCount);
+
+  clamping_add_n(x.data(), y.data(), result.data(), kCount);
+  for (size_t i = 0; i < kCount; i++) {
+    EXPECT(result[i] == clamping_add<T>(x[i], y[i]));
+  }
+  clamping_sub_n(x.data(), y.data(), result.data(), kCount);
+  for (size_t i = 0; i < kCount; i++) {
+    EXPECT(result[i] == clamping_sub<T>(x[i], y[i]));
+  }
+  clamping_mul_n(x.data(), y.data(), result.data(), kCount);
+  for (size_t i = 0; i < kCount; i++) {
+    EXPECT(result[i] == clamping_mul<T>(x[i], y[i]));
+  }
+
+  // In place, and with a count that is not a multiple of any vector width.
+  vector<T> z = x;
+  clamping_add_n(z.data(), y.data(), z.data(), kCount - 5);
+  for (size_t i = 0; i < kCount - 5; i++) {
+    EXPECT(z[i] == clamping_add<T>(x[i], y[i]));
+  }
+  for (size_t i = kCount - 5; i < kCount; i++) {
+    EXPECT(z[i] == x[i]);
+  }
+}
+
+// Checks `cast_truncate_n` from `T` to `R` against `in_range` and
+// `static_cast`, on values that sweep all of `T`.
+template <typename T, typename R>
+void GenericTestCast() {
+  const vector<T> x = Sweep<T>(kCount, 5);
+  vector<R> result(kCount);
+  const size_t i = cast_truncate_n(x.data(), result.data(), kCount);
+  size_t expected = kCount;
+  for (size_t j = 0; j < kCount; j++) {
+    if (!internal::in_range<R>(x[j])) {
+      expected = j;
+      break;
+    }
+    EXPECT(result[j] == static_cast<R>(x[j]));
+  }
+  EXPECT(i == expected);
+
+  // Values that all fit, with the first that does not in a later block.
+  vector<T> small(kCount);
+  for (size_t j = 0; j < kCount; j++) {
+    small[j] = static_cast<T>(j % 100);
+  }
+  EXPECT(kCount == cast_truncate_n(small.data(), result.data(), kCount));
+  EXPECT(result[kCount - 1] == static_cast<R>(small[kCount - 1]));
+  trapping_cast_n(small.data(), result.data(), kCount);
+  if constexpr (!internal::in_range<R>(numeric_limits<T>::max())) {
+    small[700] = numeric_limits<T>::max();
+    small[900] = numeric_limits<T>::max();
+    EXPECT(700 == cast_truncate_n(small.data(), result.data(), kCount));
+    EXPECT_DEATH(trapping_cast_n(small.data(), result.data(), kCount));
+    small[700] = small[900] = T{0};
+    // At the edges of blocks and vectors, and in the scalar tail.
+    for (const size_t j : {size_t{0}, size_t{255}, size_t{256}, size_t{511},
+                           size_t{992}, kCount - 1}) {
+      small[j] = numeric_limits<T>::max();
+      EXPECT(j == cast_truncate_n(small.data(), result.data(), kCount));
+      EXPECT(j == 0 || result[j - 1] == static_cast<R>(small[j - 1]));
+      small[j] = static_cast<T>(j % 100);
+    }
+  }
+  if constexpr (!internal::in_range<R>(numeric_limits<T>::min())) {
+    small[kCount - 1] = numeric_limits<T>::min();
+    EXPECT(kCount - 1 == cast_truncate_n(small.data(), result.data(), kCount));
+    EXPECT_DEATH(trapping_cast_n(small.data(), result.data(), kCount));
+  }
+  EXPECT(0 == cast_truncate_n(small.data(), result.data(), 0));
+}
+
+template <typename T, class... R>
+void CallCastTests() {
+  (GenericTestCast<T, R>(), ...);
+}
+
+template <class... T>
+void CallGenericTests() {
+  (GenericTestAgreesWithScalar<T>(), ...);
+  (GenericTestFirstIndex<T>(), ...);
+  (GenericTestTrapping<T>(), ...);
+  (GenericTestClamping<T>(), ...);
+}
+
+void TestAllTypes() {
+  CallGenericTests<i8, u8, i16, u16, i32, u32, i64, u64>();
+}
+
+void TestCast() {
+  CallCastTests<i8, i8, u8, i16, u16, i32, u32, i64, u64>();
+  CallCastTests<u8, i8, u8, i16, u16, i32, u32, i64, u64>();
+  CallCastTests<i16, i8, u8, i16, u16, i32, u32, i64, u64>();
+  CallCastTests<u16, i8, u8, i16, u16, i32, u32, i64, u64>();
+  CallCastTests<i32, i8, u8, i16, u16, i32, u32, i64, u64>();
+  CallCastTests<u32, i8, u8, i16, u16, i32, u32, i64, u64>();
+  CallCastTests<i64, i8, u8, i16, u16, i32, u32, i64, u64>();
+  CallCastTests<u64, i8, u8, i16, u16, i32, u32, i64, u64>();
+}
+
+#if defined(INTEGERS_HAVE_INT128)
+void TestInt128() {
+  CallGenericTests<int128_t, uint128_t>();
+  CallCastTests<int128_t, i8, u8, i32, u32, i64, u64, int128_t, uint128_t>();
+  CallCastTests<uint128_t, i8, u8, i32, u32, i64, u64, int128_t, uint128_t>();
+  CallCastTests<i64, int128_t, uint128_t>();
+  CallCastTests<u64, int128_t, uint128_t>();
+}
+#endif
+
+void TestInPlace() {
+  vector<i32> x(kCount, 3);
+  const vector<i32> y(kCount, 4);
+  EXPECT(kCount == add_overflow_n(x.data(), y.data(), x.data(), kCount));
+  EXPECT(x[0] == 7 && x[kCount - 1] == 7);
+  EXPECT(kCount == mul_overflow_n(x.data(), x.data(), x.data(), kCount));
+  EXPECT(x[0] == 49 && x[kCount - 1] == 49);
+}
+
+void TestMixedTypes() {
+  // Offset + length pairs, with the result narrower than the operands.
+  const vector<u64> offsets{0, 10, 0xFFFF, 0xFFFFFFFF};
+  const vector<u32> lengths{1, 20, 1, 1};
+  vector<u32> ends(offsets.size());
+  EXPECT(3 == add_overflow_n(offsets.data(), lengths.data(), ends.data(),
+                             offsets.size()));
+  EXPECT(ends[0] == 1 && ends[1] == 30 && ends[2] == 0x10000);
+
+  const vector<i64> negative{-5, -10};
+  const vector<u8> positive{5, 20};
+  vector<u8> sums(negative.size());
+  EXPECT(0 == sub_overflow_n(negative.data(), positive.data(), sums.data(),
+                             negative.size()));
+  EXPECT(2 == add_overflow_n(negative.data(), positive.data(), sums.data(),
+                             negative.size()));
+  EXPECT(sums[0] == 0 && sums[1] == 10);
+}
+
+#ifdef __cpp_lib_span
+void TestSpan() {
+  const vector<u16> x(kCount, 255);
+  vector<u16> result(kCount);
+  EXPECT(kCount == mul_overflow_n(span<const u16>{x}, span<const u16>{x},
+                                  span<u16>{result}));
+  EXPECT(result[0] == 65025 && result[kCount - 1] == 65025);
+  EXPECT_DEATH(trapping_mul_n(span<const u16>{x}, span<const u16>{x},
+                              span<u16>{result}.first(3)));
+  clamping_mul_n(span<const u16>{x}, span<const u16>{x}, span<u16>{result});
+  EXPECT(result[0] == 65025);
+  const vector<u16> big(kCount, 256);
+  clamping_mul_n(span<const u16>{big}, span<const u16>{big},
+                 span<u16>{result});
+  EXPECT(result[0] == 65535 && result[kCount - 1] == 65535);
+
+  // Containers and spans of non-`const` elements convert, too.
+  vector<i32> counts = {1, 2, 3};
+  const array<i32, 3> deltas = {10, 20, 30};
+  trapping_add_n(counts, deltas, counts);
+  EXPECT(counts[0] == 11 && counts[2] == 33);
+  EXPECT(3 == sub_overflow_n(span(counts), deltas, span(counts).first(3)));
+  EXPECT(counts[0] == 1 && counts[2] == 3);
+  i32 products[3] = {};
+  EXPECT(3 == mul_overflow_n(counts, counts, products));
+  EXPECT(products[2] == 9);
+  vector<u16> maxima(kCount);
+  clamping_add_n(big, x, maxima);
+  clamping_sub_n(span(maxima), big, span(maxima));
+  EXPECT(maxima[0] == 255);
+  EXPECT_DEATH(trapping_add_n(counts, deltas, span(products).first(2)));
+
+  vector<u8> bytes(kCount);
+  EXPECT(kCount == cast_truncate_n(span<const u16>{x}, span<u8>{bytes}));
+  EXPECT(bytes[kCount - 1] == 255);
+  EXPECT(0 == cast_truncate_n(span<const u16>{big}, span<u8>{bytes}));
+  EXPECT_DEATH(trapping_cast_n(span<const u16>{big}, span<u8>{bytes}));
+  EXPECT_DEATH(
+      trapping_cast_n(span<const u16>{x}, span<u8>{bytes}.first(3)));
+
+  vector<i32> wide = {-1, 0, 127};
+  array<i8, 3> narrow = {};
+  trapping_cast_n(wide, narrow);
+  EXPECT(narrow[0] == -1 && narrow[2] == 127);
+  wide[1] = 128;
+  EXPECT(1 == cast_truncate_n(span(wide), span(narrow)));
+  EXPECT_DEATH(trapping_cast_n(wide, narrow));
+}
+#endif
+
+}  // namespace
+
+int main() {
+  TestAllTypes();
+  TestCast();
+#if defined(INTEGERS_HAVE_INT128)
+  TestInt128();
+#endif
+  TestInPlace();
+  TestMixedTypes();
+#ifdef __cpp_lib_span
+  TestSpan();
+#endif
+}
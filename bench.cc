@@ -0,0 +1,1152 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmarks comparing `trapping<T>` (and friends) against the built-in
+// integer types. Build and run with `make bench`; see `make bench_size` for
+// the object code size of each kernel.
+//
+// Each operation is measured 2 ways:
+//
+// * throughput: `r[i] = x[i] op y[i]` over arrays, so independent operations
+//   can overlap (and, for raw integers, vectorize);
+// * latency: `acc = acc op y[i]`, a dependent chain, so each operation must
+//   wait for the previous one.
+//
+// The results are nanoseconds per operation, the best of several runs.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "atomic.h"
+#include "batch.h"
+#include "checked.h"
+#include "clamping.h"
+#include "divider.h"
+#include "fixed.h"
+#include "iota.h"
+#include "parse.h"
+#include "reduce.h"
+#include "trapping.h"
+
+using namespace integers;
+
+namespace {
+
+constexpr size_t kCount = 4096;
+constexpr int kRuns = 100;
+
+// Keeps the compiler from optimizing away the computation of `value`.
+template <typename T>
+void DoNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+template <typename T>
+const char* TypeName() {
+  if constexpr (std::is_same_v<T, int8_t>) {
+    return "i8";
+  } else if constexpr (std::is_same_v<T, uint8_t>) {
+    return "u8";
+  } else if constexpr (std::is_same_v<T, int16_t>) {
+    return "i16";
+  } else if constexpr (std::is_same_v<T, uint16_t>) {
+    return "u16";
+  } else if constexpr (std::is_same_v<T, int32_t>) {
+    return "i32";
+  } else if constexpr (std::is_same_v<T, uint32_t>) {
+    return "u32";
+  } else if constexpr (std::is_same_v<T, int64_t>) {
+    return "i64";
+  } else {
+    return "u64";
+  }
+}
+
+// Returns the best time, in nanoseconds per operation, of `kRuns` runs of
+// `f`, which performs `operations` operations.
+template <typename F>
+double NsPerOp(size_t operations, F f) {
+  double best = std::numeric_limits<double>::max();
+  for (int run = 0; run < kRuns; run++) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const auto end = std::chrono::steady_clock::now();
+    const double ns =
+        std::chrono::duration<double, std::nano>(end - start).count();
+    if (ns < best) {
+      best = ns;
+    }
+  }
+  return best / static_cast<double>(operations);
+}
+
+void PrintHeader(const char* title) {
+  printf("\n%s\n", title);
+  printf("%-16s %-4s %10s %10s %7s %10s %10s %7s\n", "operation", "type",
+         "raw tput", "chk tput", "ratio", "raw lat", "chk lat", "ratio");
+}
+
+void PrintRow(const char* name,
+              const char* type,
+              double raw_throughput,
+              double checked_throughput,
+              double raw_latency,
+              double checked_latency) {
+  printf("%-16s %-4s %10.3f %10.3f %7.2f %10.3f %10.3f %7.2f\n", name, type,
+         raw_throughput, checked_throughput,
+         checked_throughput / raw_throughput, raw_latency, checked_latency,
+         checked_latency / raw_latency);
+}
+
+// Each operation is a struct with a static `Apply`, templated on the value
+// type `V`, which is either a raw `T` or a `trapping<T>`. `Identity` is a right
+// operand that leaves the left operand unchanged (for the latency chains), and
+// `Operand` returns right operands that cannot overflow with the inputs from
+// `Input`. `Start` is the initial value for the latency chains.
+
+template <typename T>
+T Input(size_t i) {
+  // Small, mostly positive values in every type.
+  return static_cast<T>(16 + (i % 32));
+}
+
+struct Operation {
+  // The initial value for the latency chains.
+  template <typename T>
+  static T Start() {
+    return Input<T>(0);
+  }
+};
+
+struct Add : Operation {
+  static constexpr const char* kName = "operator+";
+  template <typename V>
+  static V Apply(V x, V y) {
+    return static_cast<V>(x + y);
+  }
+  template <typename T>
+  static T Operand(size_t i) {
+    return static_cast<T>(i % 8);
+  }
+  template <typename T>
+  static T Identity() {
+    return T{0};
+  }
+};
+
+struct Sub : Operation {
+  static constexpr const char* kName = "operator-";
+  template <typename V>
+  static V Apply(V x, V y) {
+    return static_cast<V>(x - y);
+  }
+  template <typename T>
+  static T Operand(size_t i) {
+    return static_cast<T>(i % 8);
+  }
+  template <typename T>
+  static T Identity() {
+    return T{0};
+  }
+};
+
+struct Mul : Operation {
+  static constexpr const char* kName = "operator*";
+  template <typename V>
+  static V Apply(V x, V y) {
+    return static_cast<V>(x * y);
+  }
+  template <typename T>
+  static T Operand(size_t i) {
+    return static_cast<T>(1 + i % 2);
+  }
+  template <typename T>
+  static T Identity() {
+    return T{1};
+  }
+};
+
+struct Div : Operation {
+  static constexpr const char* kName = "operator/";
+  template <typename V>
+  static V Apply(V x, V y) {
+    return static_cast<V>(x / y);
+  }
+  template <typename T>
+  static T Operand(size_t i) {
+    return static_cast<T>(1 + i % 7);
+  }
+  template <typename T>
+  static T Identity() {
+    return T{1};
+  }
+};
+
+struct Mod : Operation {
+  static constexpr const char* kName = "operator%";
+  template <typename V>
+  static V Apply(V x, V y) {
+    return static_cast<V>(x % y);
+  }
+  template <typename T>
+  static T Operand(size_t i) {
+    return static_cast<T>(1 + i % 7);
+  }
+  template <typename T>
+  static T Identity() {
+    // Not an identity, but `x % max` is `x` for the non-negative inputs.
+    return std::numeric_limits<T>::max();
+  }
+};
+
+struct Or : Operation {
+  static constexpr const char* kName = "operator|";
+  template <typename V>
+  static V Apply(V x, V y) {
+    return static_cast<V>(x | y);
+  }
+  template <typename T>
+  static T Operand(size_t i) {
+    return static_cast<T>(i % 8);
+  }
+  template <typename T>
+  static T Identity() {
+    return T{0};
+  }
+};
+
+struct And : Operation {
+  static constexpr const char* kName = "operator&";
+  template <typename V>
+  static V Apply(V x, V y) {
+    return static_cast<V>(x & y);
+  }
+  template <typename T>
+  static T Operand(size_t i) {
+    return static_cast<T>(i % 8);
+  }
+  template <typename T>
+  static T Identity() {
+    return std::numeric_limits<T>::max();
+  }
+};
+
+struct Xor : Operation {
+  static constexpr const char* kName = "operator^";
+  template <typename V>
+  static V Apply(V x, V y) {
+    return static_cast<V>(x ^ y);
+  }
+  template <typename T>
+  static T Operand(size_t i) {
+    return static_cast<T>(i % 8);
+  }
+  template <typename T>
+  static T Identity() {
+    return T{0};
+  }
+};
+
+struct ShiftLeft : Operation {
+  static constexpr const char* kName = "operator<<";
+  template <typename V>
+  static V Apply(V x, V y) {
+    return static_cast<V>(x << y);
+  }
+  template <typename T>
+  static T Operand(size_t) {
+    return T{1};
+  }
+  // Not an identity, but 0 stays 0.
+  template <typename T>
+  static T Identity() {
+    return T{1};
+  }
+  template <typename T>
+  static T Start() {
+    return T{0};
+  }
+};
+
+struct ShiftRight : Operation {
+  static constexpr const char* kName = "operator>>";
+  template <typename V>
+  static V Apply(V x, V y) {
+    return static_cast<V>(x >> y);
+  }
+  template <typename T>
+  static T Operand(size_t i) {
+    return static_cast<T>(1 + i % 2);
+  }
+  // Not an identity, but the chain soon reaches 0, which stays 0.
+  template <typename T>
+  static T Identity() {
+    return T{1};
+  }
+};
+
+// The helper functions operate on raw `T`s, so for these, `V` is always `T`
+// and `Apply` is the trapping version; `Raw` is the built-in equivalent.
+
+struct TrappingAdd : Operation {
+  static constexpr const char* kName = "trapping_add";
+  template <typename T>
+  static T Apply(T x, T y) {
+    return trapping_add<T>(x, y);
+  }
+  template <typename T>
+  static T Raw(T x, T y) {
+    return static_cast<T>(x + y);
+  }
+  template <typename T>
+  static T Operand(size_t i) {
+    return Add::Operand<T>(i);
+  }
+  template <typename T>
+  static T Identity() {
+    return Add::Identity<T>();
+  }
+};
+
+struct TrappingSub : Operation {
+  static constexpr const char* kName = "trapping_sub";
+  template <typename T>
+  static T Apply(T x, T y) {
+    return trapping_sub<T>(x, y);
+  }
+  template <typename T>
+  static T Raw(T x, T y) {
+    return static_cast<T>(x - y);
+  }
+  template <typename T>
+  static T Operand(size_t i) {
+    return Sub::Operand<T>(i);
+  }
+  template <typename T>
+  static T Identity() {
+    return Sub::Identity<T>();
+  }
+};
+
+struct TrappingMul : Operation {
+  static constexpr const char* kName = "trapping_mul";
+  template <typename T>
+  static T Apply(T x, T y) {
+    return trapping_mul<T>(x, y);
+  }
+  template <typename T>
+  static T Raw(T x, T y) {
+    return static_cast<T>(x * y);
+  }
+  template <typename T>
+  static T Operand(size_t i) {
+    return Mul::Operand<T>(i);
+  }
+  template <typename T>
+  static T Identity() {
+    return Mul::Identity<T>();
+  }
+};
+
+struct TrappingDiv : Operation {
+  static constexpr const char* kName = "trapping_div";
+  template <typename T>
+  static T Apply(T x, T y) {
+    return trapping_div<T>(x, y);
+  }
+  template <typename T>
+  static T Raw(T x, T y) {
+    return static_cast<T>(x / y);
+  }
+  template <typename T>
+  static T Operand(size_t i) {
+    return Div::Operand<T>(i);
+  }
+  template <typename T>
+  static T Identity() {
+    return Div::Identity<T>();
+  }
+};
+
+struct TrappingMod : Operation {
+  static constexpr const char* kName = "trapping_mod";
+  template <typename T>
+  static T Apply(T x, T y) {
+    return trapping_mod<T>(x, y);
+  }
+  template <typename T>
+  static T Raw(T x, T y) {
+    return static_cast<T>(x % y);
+  }
+  template <typename T>
+  static T Operand(size_t i) {
+    return Mod::Operand<T>(i);
+  }
+  template <typename T>
+  static T Identity() {
+    return Mod::Identity<T>();
+  }
+};
+
+struct TrappingCast : Operation {
+  static constexpr const char* kName = "trapping_cast";
+  // Round-trips through an 8-bit type (which can hold all the inputs).
+  template <typename T>
+  using Narrow = std::conditional_t<(sizeof(T) == 1) == std::is_signed_v<T>,
+                                    uint8_t, int8_t>;
+  template <typename T>
+  static T Apply(T x, T y) {
+    return static_cast<T>(trapping_cast<Narrow<T>>(x) | y);
+  }
+  template <typename T>
+  static T Raw(T x, T y) {
+    return static_cast<T>(static_cast<Narrow<T>>(x) | y);
+  }
+  template <typename T>
+  static T Operand(size_t i) {
+    return static_cast<T>(i % 8);
+  }
+  template <typename T>
+  static T Identity() {
+    return T{0};
+  }
+};
+
+template <typename V, typename T, typename F>
+double Throughput(const std::vector<T>& x, const std::vector<T>& y, F f) {
+  std::vector<V> vx(x.begin(), x.end());
+  std::vector<V> vy(y.begin(), y.end());
+  std::vector<V> r(x.size());
+  return NsPerOp(x.size(), [&] {
+    for (size_t i = 0; i < x.size(); i++) {
+      r[i] = f(vx[i], vy[i]);
+    }
+    DoNotOptimize(r.data());
+  });
+}
+
+template <typename V, typename T, typename F>
+double Latency(T start, const std::vector<T>& identities, F f) {
+  std::vector<V> vy(identities.begin(), identities.end());
+  // Read the start value through `volatile`, so that the compiler cannot fold
+  // the chain away (e.g. `0 << 1 << 1...`).
+  volatile T seed = start;
+  return NsPerOp(vy.size(), [&] {
+    V acc{static_cast<T>(seed)};
+    for (size_t i = 0; i < vy.size(); i++) {
+      acc = f(acc, vy[i]);
+    }
+    DoNotOptimize(acc);
+  });
+}
+
+template <typename Op, typename T>
+void BenchOperator() {
+  std::vector<T> x(kCount);
+  std::vector<T> y(kCount);
+  std::vector<T> identities(kCount, Op::template Identity<T>());
+  for (size_t i = 0; i < kCount; i++) {
+    x[i] = Input<T>(i);
+    y[i] = Op::template Operand<T>(i);
+  }
+  auto raw = [](T a, T b) { return Op::template Apply<T>(a, b); };
+  auto checked = [](trapping<T> a, trapping<T> b) {
+    return Op::template Apply<trapping<T>>(a, b);
+  };
+  PrintRow(Op::kName, TypeName<T>(), Throughput<T>(x, y, raw),
+           Throughput<trapping<T>>(x, y, checked),
+           Latency<T>(Op::template Start<T>(), identities, raw),
+           Latency<trapping<T>>(Op::template Start<T>(), identities, checked));
+}
+
+template <typename Op, typename T>
+void BenchHelper() {
+  std::vector<T> x(kCount);
+  std::vector<T> y(kCount);
+  std::vector<T> identities(kCount, Op::template Identity<T>());
+  for (size_t i = 0; i < kCount; i++) {
+    x[i] = Input<T>(i);
+    y[i] = Op::template Operand<T>(i);
+  }
+  auto raw = [](T a, T b) { return Op::template Raw<T>(a, b); };
+  auto checked = [](T a, T b) { return Op::template Apply<T>(a, b); };
+  PrintRow(Op::kName, TypeName<T>(), Throughput<T>(x, y, raw),
+           Throughput<T>(x, y, checked),
+           Latency<T>(Op::template Start<T>(), identities, raw),
+           Latency<T>(Op::template Start<T>(), identities, checked));
+}
+
+template <typename Op, typename... T>
+void BenchOperatorAllTypes() {
+  (BenchOperator<Op, T>(), ...);
+}
+
+template <typename Op, typename... T>
+void BenchHelperAllTypes() {
+  (BenchHelper<Op, T>(), ...);
+}
+
+#define ALL_TYPES int8_t, uint8_t, int16_t, uint16_t, int32_t, uint32_t, \
+                  int64_t, uint64_t
+
+void BenchOperators() {
+  PrintHeader("trapping<T> operators vs. raw T (ns/op)");
+  BenchOperatorAllTypes<Add, ALL_TYPES>();
+  BenchOperatorAllTypes<Sub, ALL_TYPES>();
+  BenchOperatorAllTypes<Mul, ALL_TYPES>();
+  BenchOperatorAllTypes<Div, ALL_TYPES>();
+  BenchOperatorAllTypes<Mod, ALL_TYPES>();
+  BenchOperatorAllTypes<Or, ALL_TYPES>();
+  BenchOperatorAllTypes<And, ALL_TYPES>();
+  BenchOperatorAllTypes<Xor, ALL_TYPES>();
+  BenchOperatorAllTypes<ShiftLeft, ALL_TYPES>();
+  BenchOperatorAllTypes<ShiftRight, ALL_TYPES>();
+}
+
+void BenchHelpers() {
+  PrintHeader("trapping_* helpers vs. raw T (ns/op)");
+  BenchHelperAllTypes<TrappingAdd, ALL_TYPES>();
+  BenchHelperAllTypes<TrappingSub, ALL_TYPES>();
+  BenchHelperAllTypes<TrappingMul, ALL_TYPES>();
+  BenchHelperAllTypes<TrappingDiv, ALL_TYPES>();
+  BenchHelperAllTypes<TrappingMod, ALL_TYPES>();
+  BenchHelperAllTypes<TrappingCast, ALL_TYPES>();
+}
+
+#undef ALL_TYPES
+
+// ## Kernels
+//
+// These are `noinline` and have `extern "C"` names starting with `Kernel`, so
+// that `make bench_size` can report their object code size.
+
+struct Record {
+  uint32_t offset;
+  uint32_t length;
+};
+
+// An offset chain, as in a file format parser: check that each record lies
+// within the file, and sum the lengths.
+extern "C" __attribute__((noinline)) size_t KernelOffsetsRaw(const Record* r,
+                                                             size_t count,
+                                                             size_t file_size) {
+  size_t total = 0;
+  for (size_t i = 0; i < count; i++) {
+    const size_t end = size_t{r[i].offset} + r[i].length;
+    if (end > file_size) {
+      abort();
+    }
+    total += r[i].length;
+  }
+  return total;
+}
+
+extern "C" __attribute__((noinline)) size_t
+KernelOffsetsTrapping(const Record* r, size_t count, size_t file_size) {
+  trapping<size_t> total = size_t{0};
+  for (size_t i = 0; i < count; i++) {
+    trapping<size_t> end = size_t{r[i].offset};
+    end += r[i].length;
+    if (end > file_size) {
+      abort();
+    }
+    total += r[i].length;
+  }
+  return total;
+}
+
+extern "C" __attribute__((noinline)) size_t
+KernelOffsetsChecked(const Record* r, size_t count, size_t file_size) {
+  checked<size_t> total;
+  for (size_t i = 0; i < count; i++) {
+    checked<size_t> end = size_t{r[i].offset};
+    end += r[i].length;
+    if (end.value() > file_size) {
+      abort();
+    }
+    total += r[i].length;
+  }
+  return total.value();
+}
+
+// A reduction: sum `int32_t`s into an `int64_t`.
+extern "C" __attribute__((noinline)) int64_t KernelSumRaw(const int32_t* x,
+                                                          size_t count) {
+  int64_t sum = 0;
+  for (size_t i = 0; i < count; i++) {
+    sum += x[i];
+  }
+  return sum;
+}
+
+extern "C" __attribute__((noinline)) int64_t KernelSumTrapping(const int32_t* x,
+                                                               size_t count) {
+  trapping<int64_t> sum = int64_t{0};
+  for (size_t i = 0; i < count; i++) {
+    sum += x[i];
+  }
+  return sum;
+}
+
+extern "C" __attribute__((noinline)) int64_t KernelSumChecked(const int32_t* x,
+                                                              size_t count) {
+  checked<int64_t> sum;
+  for (size_t i = 0; i < count; i++) {
+    sum += x[i];
+  }
+  return sum.value();
+}
+
+extern "C" __attribute__((noinline)) int64_t KernelSumReduce(const int32_t* x,
+                                                             size_t count) {
+  return trapping_sum<int64_t>(x, count);
+}
+
+// The allocation size pattern from demo.cc: `count * sizeof(T) + header`.
+struct Friend {
+  int age;
+  char name[1024];
+  bool wears_a_watch;
+  char bio[4096];
+};
+
+constexpr size_t kHeader = 64;
+
+extern "C" __attribute__((noinline)) size_t KernelAllocSizeRaw(size_t count) {
+  return count * sizeof(Friend) + kHeader;
+}
+
+extern "C" __attribute__((noinline)) size_t KernelAllocSizeTrapping(
+    size_t count) {
+  trapping<size_t> total = count;
+  total *= sizeof(Friend);
+  total += kHeader;
+  return total;
+}
+
+extern "C" __attribute__((noinline)) size_t KernelAllocSizeTrappingMul(
+    size_t count) {
+  return trapping_add<size_t>(trapping_mul<size_t>(count, sizeof(Friend)),
+                              kHeader);
+}
+
+extern "C" __attribute__((noinline)) size_t KernelAllocSizeMulOverflow(
+    size_t count) {
+  size_t total;
+  if (mul_overflow(count, sizeof(Friend), &total) ||
+      add_overflow(total, kHeader, &total)) {
+    abort();
+  }
+  return total;
+}
+
+extern "C" __attribute__((noinline)) size_t KernelAllocSizeChecked(
+    size_t count) {
+  checked<size_t> total = count;
+  total *= sizeof(Friend);
+  total += kHeader;
+  return total.value();
+}
+
+// Element-wise addition of arrays: a scalar loop over `trapping<T>` vs. the
+// batch function.
+extern "C" __attribute__((noinline)) void KernelAddArraysRaw(const int32_t* x,
+                                                             const int32_t* y,
+                                                             int32_t* r,
+                                                             size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    r[i] = x[i] + y[i];
+  }
+}
+
+extern "C" __attribute__((noinline)) void KernelAddArraysTrapping(
+    const int32_t* x,
+    const int32_t* y,
+    int32_t* r,
+    size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    r[i] = trapping<int32_t>(x[i]) + y[i];
+  }
+}
+
+extern "C" __attribute__((noinline)) void KernelAddArraysBatch(const int32_t* x,
+                                                               const int32_t* y,
+                                                               int32_t* r,
+                                                               size_t count) {
+  trapping_add_n(x, y, r, count);
+}
+
+// Mixing two 16-bit audio streams: clamp-after-widen by hand, a scalar loop
+// over `clamping<T>`, and the batch function (which uses `paddsw` or `vqadd`).
+extern "C" __attribute__((noinline)) void KernelMixWiden(const int16_t* x,
+                                                         const int16_t* y,
+                                                         int16_t* r,
+                                                         size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    const int32_t sum = int32_t{x[i]} + int32_t{y[i]};
+    r[i] = static_cast<int16_t>(sum > INT16_MAX   ? INT16_MAX
+                                : sum < INT16_MIN ? INT16_MIN
+                                                  : sum);
+  }
+}
+
+extern "C" __attribute__((noinline)) void KernelMixClamping(const int16_t* x,
+                                                            const int16_t* y,
+                                                            int16_t* r,
+                                                            size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    r[i] = clamping<int16_t>(x[i]) + y[i];
+  }
+}
+
+extern "C" __attribute__((noinline)) void KernelMixBatch(const int16_t* x,
+                                                         const int16_t* y,
+                                                         int16_t* r,
+                                                         size_t count) {
+  clamping_add_n(x, y, r, count);
+}
+
+// A Q15 multiply-accumulate, as in a filter: widen, round, and clamp by hand;
+// a scalar loop over `fixed`; and the batch function.
+using q15 = integers::fixed<int16_t, 15, saturate_policy>;
+
+extern "C" __attribute__((noinline)) void KernelMacWiden(const int16_t* x,
+                                                         const int16_t* y,
+                                                         int16_t* acc,
+                                                         size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    const int32_t sum =
+        acc[i] + ((int32_t{x[i]} * int32_t{y[i]} + (1 << 14)) >> 15);
+    acc[i] = static_cast<int16_t>(sum > INT16_MAX   ? INT16_MAX
+                                  : sum < INT16_MIN ? INT16_MIN
+                                                    : sum);
+  }
+}
+
+extern "C" __attribute__((noinline)) void KernelMacFixed(const q15* x,
+                                                         const q15* y,
+                                                         q15* acc,
+                                                         size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    acc[i] += x[i] * y[i];
+  }
+}
+
+extern "C" __attribute__((noinline)) void KernelMacBatch(const q15* x,
+                                                         const q15* y,
+                                                         q15* acc,
+                                                         size_t count) {
+  fixed_mac_n(x, y, acc, count);
+}
+
+// Narrowing a column of 64-bit values to 32 bits: a raw truncating loop, a
+// scalar loop of `trapping_cast`, and the batch function.
+extern "C" __attribute__((noinline)) void KernelNarrowRaw(const int64_t* x,
+                                                          int32_t* r,
+                                                          size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    r[i] = static_cast<int32_t>(x[i]);
+  }
+}
+
+extern "C" __attribute__((noinline)) void KernelNarrowTrapping(
+    const int64_t* x,
+    int32_t* r,
+    size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    r[i] = trapping_cast<int32_t>(x[i]);
+  }
+}
+
+extern "C" __attribute__((noinline)) void KernelNarrowBatch(const int64_t* x,
+                                                            int32_t* r,
+                                                            size_t count) {
+  trapping_cast_n(x, r, count);
+}
+
+struct Field {
+  char text[24];
+  size_t length;
+};
+
+// Sums decimal fields (e.g. from a CSV file).
+extern "C" __attribute__((noinline)) uint64_t
+KernelParseStrtoull(const Field* fields, size_t count) {
+  uint64_t sum = 0;
+  for (size_t i = 0; i < count; i++) {
+    sum += strtoull(fields[i].text, nullptr, 10);
+  }
+  return sum;
+}
+
+extern "C" __attribute__((noinline)) uint64_t
+KernelParseChecked(const Field* fields, size_t count) {
+  uint64_t sum = 0;
+  for (size_t i = 0; i < count; i++) {
+    sum += checked_parse<uint64_t>({fields[i].text, fields[i].length})
+               .value_or(0);
+  }
+  return sum;
+}
+
+// Hash table bucketing: `hash % bucket_count`, where the bucket count is only
+// known at run time.
+extern "C" __attribute__((noinline)) uint64_t
+KernelBucketRaw(const uint64_t* hashes, size_t count, uint64_t buckets) {
+  uint64_t sum = 0;
+  for (size_t i = 0; i < count; i++) {
+    sum += hashes[i] % buckets;
+  }
+  return sum;
+}
+
+extern "C" __attribute__((noinline)) uint64_t
+KernelBucketTrapping(const uint64_t* hashes, size_t count, uint64_t buckets) {
+  uint64_t sum = 0;
+  for (size_t i = 0; i < count; i++) {
+    sum += trapping_mod<uint64_t>(hashes[i], buckets);
+  }
+  return sum;
+}
+
+extern "C" __attribute__((noinline)) uint64_t
+KernelBucketDivider(const uint64_t* hashes, size_t count, uint64_t buckets) {
+  const trapping_divider<uint64_t> divider(buckets);
+  uint64_t sum = 0;
+  for (size_t i = 0; i < count; i++) {
+    sum += hashes[i] % divider;
+  }
+  return sum;
+}
+
+// A strided loop whose counter is also used as a value: a `trapping<T>`
+// counter checks each increment, while `checked_iota` checks the bounds once,
+// so that the loop has only 1 exit. (For a stride of 1, GCC removes the
+// `trapping<T>` check itself, since `x < count` implies that `x + 1` cannot
+// overflow.)
+extern "C" __attribute__((noinline)) int32_t KernelStrideRaw(const int32_t* x,
+                                                             int32_t count) {
+  int32_t sum = 0;
+  for (int32_t i = 0; i < count; i += 2) {
+    sum += x[i] * i;
+  }
+  return sum;
+}
+
+extern "C" __attribute__((noinline)) int32_t
+KernelStrideTrapping(const int32_t* x, int32_t count) {
+  int32_t sum = 0;
+  for (trapping<int32_t> i = 0; i < count; i += 2) {
+    sum += x[static_cast<int32_t>(i)] * static_cast<int32_t>(i);
+  }
+  return sum;
+}
+
+extern "C" __attribute__((noinline)) int32_t KernelStrideIota(const int32_t* x,
+                                                              int32_t count) {
+  int32_t sum = 0;
+  for (const int32_t i : checked_iota(0, count, 2)) {
+    sum += x[i] * i;
+  }
+  return sum;
+}
+
+void PrintKernel(const char* name, double raw, double ns) {
+  printf("%-28s %10.3f %7.2f\n", name, ns, ns / raw);
+}
+
+void BenchKernels() {
+  printf("\n%-28s %10s %7s\n", "kernel (ns/element)", "time", "vs raw");
+
+  {
+    std::vector<Record> records(kCount);
+    for (size_t i = 0; i < kCount; i++) {
+      records[i] = {static_cast<uint32_t>(i * 16), 16};
+    }
+    const size_t file_size = kCount * 16;
+    auto run = [&](size_t (*f)(const Record*, size_t, size_t)) {
+      return NsPerOp(kCount, [&] {
+        DoNotOptimize(f(records.data(), kCount, file_size));
+      });
+    };
+    const double raw = run(KernelOffsetsRaw);
+    PrintKernel("offsets raw", raw, raw);
+    PrintKernel("offsets trapping<size_t>", raw, run(KernelOffsetsTrapping));
+    PrintKernel("offsets checked<size_t>", raw, run(KernelOffsetsChecked));
+  }
+
+  {
+    std::vector<int32_t> x(kCount);
+    for (size_t i = 0; i < kCount; i++) {
+      x[i] = static_cast<int32_t>(i * 2654435761U);
+    }
+    auto run = [&](int64_t (*f)(const int32_t*, size_t)) {
+      return NsPerOp(kCount, [&] { DoNotOptimize(f(x.data(), kCount)); });
+    };
+    const double raw = run(KernelSumRaw);
+    PrintKernel("sum raw", raw, raw);
+    PrintKernel("sum trapping<int64_t>", raw, run(KernelSumTrapping));
+    PrintKernel("sum checked<int64_t>", raw, run(KernelSumChecked));
+    PrintKernel("sum trapping_sum", raw, run(KernelSumReduce));
+  }
+
+  {
+    std::vector<size_t> counts(kCount);
+    for (size_t i = 0; i < kCount; i++) {
+      counts[i] = i;
+    }
+    auto run = [&](size_t (*f)(size_t)) {
+      return NsPerOp(kCount, [&] {
+        for (size_t c : counts) {
+          DoNotOptimize(f(c));
+        }
+      });
+    };
+    const double raw = run(KernelAllocSizeRaw);
+    PrintKernel("alloc size raw", raw, raw);
+    PrintKernel("alloc size trapping<size_t>", raw,
+                run(KernelAllocSizeTrapping));
+    PrintKernel("alloc size trapping_mul", raw,
+                run(KernelAllocSizeTrappingMul));
+    PrintKernel("alloc size mul_overflow", raw,
+                run(KernelAllocSizeMulOverflow));
+    PrintKernel("alloc size checked<size_t>", raw, run(KernelAllocSizeChecked));
+  }
+
+  {
+    std::vector<int32_t> x(kCount, 3);
+    std::vector<int32_t> y(kCount, 4);
+    std::vector<int32_t> r(kCount);
+    auto run = [&](void (*f)(const int32_t*, const int32_t*, int32_t*,
+                             size_t)) {
+      return NsPerOp(kCount, [&] {
+        f(x.data(), y.data(), r.data(), kCount);
+        DoNotOptimize(r.data());
+      });
+    };
+    const double raw = run(KernelAddArraysRaw);
+    PrintKernel("add arrays raw", raw, raw);
+    PrintKernel("add arrays trapping<i32>", raw, run(KernelAddArraysTrapping));
+    PrintKernel("add arrays trapping_add_n", raw, run(KernelAddArraysBatch));
+  }
+
+  {
+    std::vector<int16_t> x(kCount);
+    std::vector<int16_t> y(kCount);
+    for (size_t i = 0; i < kCount; i++) {
+      x[i] = static_cast<int16_t>(i * 2654435761U);
+      y[i] = static_cast<int16_t>(i * 40503U);
+    }
+    std::vector<int16_t> r(kCount);
+    auto run = [&](void (*f)(const int16_t*, const int16_t*, int16_t*,
+                             size_t)) {
+      return NsPerOp(kCount, [&] {
+        f(x.data(), y.data(), r.data(), kCount);
+        DoNotOptimize(r.data());
+      });
+    };
+    const double raw = run(KernelMixWiden);
+    PrintKernel("mix i16 widen and clamp", raw, raw);
+    PrintKernel("mix i16 clamping<i16>", raw, run(KernelMixClamping));
+    PrintKernel("mix i16 clamping_add_n", raw, run(KernelMixBatch));
+  }
+
+  {
+    std::vector<int16_t> x(kCount);
+    std::vector<int16_t> y(kCount);
+    for (size_t i = 0; i < kCount; i++) {
+      x[i] = static_cast<int16_t>(i * 2654435761U);
+      y[i] = static_cast<int16_t>(i * 40503U);
+    }
+    std::vector<int16_t> acc(kCount);
+    auto run_raw = [&](void (*f)(const int16_t*, const int16_t*, int16_t*,
+                                 size_t)) {
+      return NsPerOp(kCount, [&] {
+        f(x.data(), y.data(), acc.data(), kCount);
+        DoNotOptimize(acc.data());
+      });
+    };
+    std::vector<q15> qx(kCount);
+    std::vector<q15> qy(kCount);
+    for (size_t i = 0; i < kCount; i++) {
+      qx[i] = q15::from_raw(x[i]);
+      qy[i] = q15::from_raw(y[i]);
+    }
+    std::vector<q15> qacc(kCount);
+    auto run = [&](void (*f)(const q15*, const q15*, q15*, size_t)) {
+      return NsPerOp(kCount, [&] {
+        f(qx.data(), qy.data(), qacc.data(), kCount);
+        DoNotOptimize(qacc.data());
+      });
+    };
+    const double raw = run_raw(KernelMacWiden);
+    PrintKernel("mac q15 widen and clamp", raw, raw);
+    PrintKernel("mac q15 fixed", raw, run(KernelMacFixed));
+    PrintKernel("mac q15 fixed_mac_n", raw, run(KernelMacBatch));
+  }
+
+  {
+    std::vector<int64_t> x(kCount);
+    for (size_t i = 0; i < kCount; i++) {
+      x[i] = static_cast<int32_t>(i * 2654435761U);
+    }
+    std::vector<int32_t> r(kCount);
+    auto run = [&](void (*f)(const int64_t*, int32_t*, size_t)) {
+      return NsPerOp(kCount, [&] {
+        f(x.data(), r.data(), kCount);
+        DoNotOptimize(r.data());
+      });
+    };
+    const double raw = run(KernelNarrowRaw);
+    PrintKernel("narrow i64 raw", raw, raw);
+    PrintKernel("narrow i64 trapping_cast", raw, run(KernelNarrowTrapping));
+    PrintKernel("narrow i64 trapping_cast_n", raw, run(KernelNarrowBatch));
+  }
+
+  {
+    // 1- to 20-digit numbers.
+    std::vector<Field> fields(kCount);
+    for (size_t i = 0; i < kCount; i++) {
+      const uint64_t value = (i * 0x9e3779b97f4a7c15) >> (i % 64);
+      fields[i].length = static_cast<size_t>(
+          snprintf(fields[i].text, sizeof(fields[i].text), "%llu",
+                   static_cast<unsigned long long>(value)));
+    }
+    auto run = [&](uint64_t (*f)(const Field*, size_t)) {
+      return NsPerOp(kCount, [&] { DoNotOptimize(f(fields.data(), kCount)); });
+    };
+    const double raw = run(KernelParseStrtoull);
+    PrintKernel("parse u64 strtoull", raw, raw);
+    PrintKernel("parse u64 checked_parse", raw, run(KernelParseChecked));
+  }
+
+  {
+    std::vector<uint64_t> hashes(kCount);
+    for (size_t i = 0; i < kCount; i++) {
+      hashes[i] = i * 0x9e3779b97f4a7c15U;
+    }
+    // Not a constant, so that the compiler cannot strength-reduce the raw `%`.
+    const uint64_t buckets = 1000 + static_cast<uint64_t>(rand() % 2);
+    auto run = [&](uint64_t (*f)(const uint64_t*, size_t, uint64_t)) {
+      return NsPerOp(kCount,
+                     [&] { DoNotOptimize(f(hashes.data(), kCount, buckets)); });
+    };
+    const double raw = run(KernelBucketRaw);
+    PrintKernel("bucket u64 raw %", raw, raw);
+    PrintKernel("bucket u64 trapping_mod", raw, run(KernelBucketTrapping));
+    PrintKernel("bucket u64 trapping_divider", raw, run(KernelBucketDivider));
+  }
+
+  {
+    std::vector<int32_t> x(kCount, 1);
+    auto run = [&](int32_t (*f)(const int32_t*, int32_t)) {
+      return NsPerOp(kCount / 2, [&] {
+        DoNotOptimize(f(x.data(), static_cast<int32_t>(kCount)));
+      });
+    };
+    const double raw = run(KernelStrideRaw);
+    PrintKernel("stride 2 raw", raw, raw);
+    PrintKernel("stride 2 trapping<i32>", raw, run(KernelStrideTrapping));
+    PrintKernel("stride 2 checked_iota", raw, run(KernelStrideIota));
+  }
+}
+
+// ## Contention
+//
+// Each of `threads` threads increments 1 shared counter `kIncrements` times.
+// The results are nanoseconds of wall time per increment (i.e. divided by
+// `threads * kIncrements`), the best of `kContentionRuns` runs, so the cost
+// of contention shows up as the thread count grows.
+
+constexpr uint64_t kIncrements = 100000;
+constexpr int kContentionRuns = 5;
+
+template <typename Counter, typename F>
+double NsPerIncrement(int threads, F increment) {
+  double best = std::numeric_limits<double>::max();
+  for (int run = 0; run < kContentionRuns; run++) {
+    alignas(64) Counter counter{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++) {
+      pool.emplace_back([&] {
+        while (!go.load(std::memory_order_acquire)) {
+        }
+        for (uint64_t i = 0; i < kIncrements; i++) {
+          increment(counter);
+        }
+      });
+    }
+    const auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (std::thread& t : pool) {
+      t.join();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    if (counter.load() != static_cast<uint64_t>(threads) * kIncrements) {
+      abort();
+    }
+    const double ns =
+        std::chrono::duration<double, std::nano>(end - start).count();
+    if (ns < best) {
+      best = ns;
+    }
+  }
+  return best / static_cast<double>(static_cast<uint64_t>(threads) *
+                                    kIncrements);
+}
+
+void BenchContention() {
+  using Raw = std::atomic<uint64_t>;
+  using Trapping = trapping_atomic<uint64_t>;
+  printf("\n%-8s %9s %9s %9s %9s %9s %9s\n", "threads", "raw rlx",
+         "trap rlx", "trap a/r", "trap sc", "cas rlx", "cas sc");
+  for (int threads = 1; threads <= 64; threads *= 2) {
+    const double raw = NsPerIncrement<Raw>(
+        threads, [](Raw& c) { c.fetch_add(1, std::memory_order_relaxed); });
+    const double relaxed = NsPerIncrement<Trapping>(threads, [](Trapping& c) {
+      c.fetch_add(1, std::memory_order_relaxed);
+    });
+    const double acq_rel = NsPerIncrement<Trapping>(threads, [](Trapping& c) {
+      c.fetch_add(1, std::memory_order_acq_rel);
+    });
+    const double seq_cst = NsPerIncrement<Trapping>(
+        threads, [](Trapping& c) { c.fetch_add(1); });
+    const double cas_relaxed =
+        NsPerIncrement<Trapping>(threads, [](Trapping& c) {
+          DoNotOptimize(c.checked_fetch_add(1, std::memory_order_relaxed));
+        });
+    const double cas_seq_cst = NsPerIncrement<Trapping>(
+        threads, [](Trapping& c) { DoNotOptimize(c.checked_fetch_add(1)); });
+    printf("%-8d %9.3f %9.3f %9.3f %9.3f %9.3f %9.3f\n", threads, raw,
+           relaxed, acq_rel, seq_cst, cas_relaxed, cas_seq_cst);
+  }
+}
+
+}  // namespace
+
+int main() {
+  BenchOperators();
+  BenchHelpers();
+  BenchKernels();
+  BenchContention();
+}
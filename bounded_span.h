@@ -0,0 +1,280 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef BOUNDED_SPAN_H_
+#define BOUNDED_SPAN_H_
+
+#include <stddef.h>
+
+#include <type_traits>
+
+#include "assume.h"
+#include "ranged.h"
+#include "trap.h"
+
+namespace integers {
+
+template <typename T>
+class bounded_span;
+
+/// ## `checked_index`
+///
+/// An index that has been checked against the size of a `bounded_span`. Only
+/// `bounded_span::check` and `bounded_span::indices` can make one.
+///
+/// A `checked_index` remembers the size it was checked against, so it is
+/// valid for any `bounded_span` at least that large (such as the one that
+/// made it, or a copy). Indexing with it compares the 2 sizes, rather than
+/// the index itself; that comparison is loop-invariant, and when it is the
+/// same span, the compiler can often prove it and remove it.
+class checked_index {
+ public:
+  /// ### `value`
+  ///
+  /// Returns the index, and tells the compiler that it is less than the size
+  /// it was checked against.
+  constexpr size_t value() const {
+    INTEGERS_ASSUME(value_ < bound_);
+    return value_;
+  }
+
+  /// ### `operator size_t`
+  ///
+  /// Returns `value()`.
+  constexpr operator size_t() const { return value(); }
+
+  friend constexpr bool operator==(checked_index lhs, checked_index rhs) {
+    return lhs.value_ == rhs.value_;
+  }
+
+  friend constexpr bool operator!=(checked_index lhs, checked_index rhs) {
+    return !(lhs == rhs);
+  }
+
+ private:
+  constexpr checked_index(size_t value, size_t bound)
+      : value_(value), bound_(bound) {}
+
+  template <typename T>
+  friend class bounded_span;
+
+  size_t value_;
+  size_t bound_;
+};
+
+/// ## `bounded_span<T>`
+///
+/// A pointer and a size, like C++20 `std::span<T>`, which you index with
+/// `checked_index`es instead of `size_t`s. You check an index once, with
+/// `check`, and then index with it as often as you like; or you loop over
+/// `indices()`, which are in bounds by construction. For example,
+///
+///   const bounded_span<const uint8_t> input(buffer);
+///   const checked_index tag = input.check(header_size);  // `trap`s if not.
+///   switch (input[tag]) { ... }
+///   for (const checked_index i : input.indices()) {
+///     crc = Update(crc, input[i]);  // No check.
+///   }
+///
+/// The index needs no check when it is in bounds by construction, such as a
+/// `ranged<size_t, 0, 255>` into a span of at least 256 elements. Indexing with
+/// a `ranged` checks only that its `Max` is less than the span’s size.
+///
+/// `at(size_t)`, `subspan`, and `first` check their arguments, and `trap` if
+/// they are out of bounds.
+template <typename T>
+class bounded_span {
+  using Self = bounded_span<T>;
+
+ public:
+  using element_type = T;
+  using value_type = std::remove_cv_t<T>;
+
+  /// ### `bounded_span`
+  ///
+  /// Constructs an empty span.
+  constexpr bounded_span() = default;
+
+  /// ### `bounded_span`
+  ///
+  /// Constructs a span of the `size` elements starting at `data`.
+  constexpr bounded_span(T* data, size_t size) : data_(data), size_(size) {}
+
+  /// ### `bounded_span`
+  ///
+  /// Constructs a span of all the elements of `array`.
+  template <size_t N>
+  constexpr bounded_span(T (&array)[N]) : data_(array), size_(N) {}
+
+  /// ### `bounded_span`
+  ///
+  /// Constructs a span of all the elements of `container` (e.g. a
+  /// `std::vector`, `std::array`, `std::span`, or `std::string`), which must
+  /// outlive it.
+  template <typename Container,
+            typename = std::enable_if_t<
+                !std::is_same_v<std::remove_cv_t<Container>, Self> &&
+                std::is_convertible_v<
+                    decltype(std::declval<Container&>().data()), T*>>,
+            typename = decltype(std::declval<Container&>().size())>
+  constexpr bounded_span(Container& container)
+      : data_(container.data()), size_(container.size()) {}
+
+  /// ### `bounded_span`
+  ///
+  /// Converts e.g. a `bounded_span<T>` to a `bounded_span<const T>`.
+  template <typename U,
+            std::enable_if_t<!std::is_same_v<T, U> &&
+                                 std::is_convertible_v<U (*)[], T (*)[]>,
+                             int> = 0>
+  constexpr bounded_span(bounded_span<U> other)
+      : data_(other.data()), size_(other.size()) {}
+
+  constexpr T* data() const { return data_; }
+  constexpr size_t size() const { return size_; }
+  constexpr bool empty() const { return size_ == 0; }
+  constexpr T* begin() const { return data_; }
+  constexpr T* end() const { return data_ + size_; }
+
+  /// ### `check`
+  ///
+  /// Returns `index` as a `checked_index`, or `trap`s if it is not less than
+  /// `size()`.
+  constexpr checked_index check(size_t index) const {
+    if (index >= size_) {
+      trap();
+    }
+    return checked_index(index, size_);
+  }
+
+  /// ### `operator[]`
+  ///
+  /// Returns the element at `index`. `trap`s only if `index` was checked
+  /// against a larger span.
+  constexpr T& operator[](checked_index index) const {
+    if (index.bound_ > size_) {
+      trap();
+    }
+    return data_[index.value()];
+  }
+
+  /// ### `operator[]`
+  ///
+  /// Returns the element at `index`. `trap`s if `Max` is not less than
+  /// `size()`; the value of `index` itself is in bounds by construction.
+  template <size_t Min, size_t Max>
+  constexpr T& operator[](ranged<size_t, Min, Max> index) const {
+    if (Max >= size_) {
+      trap();
+    }
+    return data_[static_cast<size_t>(index)];
+  }
+
+  /// ### `at`
+  ///
+  /// Returns the element at `index`, or `trap`s if it is out of bounds. This
+  /// is `(*this)[check(index)]`.
+  constexpr T& at(size_t index) const { return (*this)[check(index)]; }
+
+  /// ### `subspan`
+  ///
+  /// Returns the span of `count` elements starting at `offset`. `trap`s if
+  /// they are not all in this span.
+  constexpr Self subspan(size_t offset, size_t count) const {
+    if (offset > size_ || count > size_ - offset) {
+      trap();
+    }
+    return Self(data_ + offset, count);
+  }
+
+  /// ### `subspan`
+  ///
+  /// Returns the span of the elements from `offset` to the end. `trap`s if
+  /// `offset` is greater than `size()`.
+  constexpr Self subspan(size_t offset) const {
+    if (offset > size_) {
+      trap();
+    }
+    return Self(data_ + offset, size_ - offset);
+  }
+
+  /// ### `first`
+  ///
+  /// Returns the span of the first `count` elements. `trap`s if `count` is
+  /// greater than `size()`.
+  constexpr Self first(size_t count) const { return subspan(0, count); }
+
+  /// ### `index_range`
+  ///
+  /// The type of `indices()`: a range of the `checked_index`es from 0 to
+  /// `size()` - 1, for range-based `for` loops.
+  class index_range {
+   public:
+    class iterator {
+     public:
+      constexpr checked_index operator*() const {
+        return checked_index(index_, bound_);
+      }
+      constexpr iterator& operator++() {
+        ++index_;
+        return *this;
+      }
+      friend constexpr bool operator==(iterator lhs, iterator rhs) {
+        return lhs.index_ == rhs.index_;
+      }
+      friend constexpr bool operator!=(iterator lhs, iterator rhs) {
+        return lhs.index_ != rhs.index_;
+      }
+
+     private:
+      friend class index_range;
+      constexpr iterator(size_t index, size_t bound)
+          : index_(index), bound_(bound) {}
+
+      size_t index_;
+      size_t bound_;
+    };
+
+    constexpr iterator begin() const { return iterator(0, size_); }
+    constexpr iterator end() const { return iterator(size_, size_); }
+
+   private:
+    friend class bounded_span;
+    constexpr explicit index_range(size_t size) : size_(size) {}
+
+    size_t size_;
+  };
+
+  /// ### `indices`
+  ///
+  /// Returns the range of the valid indices, 0 to `size()` - 1. Indexing this
+  /// span (or a copy) with them needs no run-time check.
+  constexpr index_range indices() const { return index_range(size_); }
+
+ private:
+  T* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+template <typename T, size_t N>
+bounded_span(T (&)[N]) -> bounded_span<T>;
+
+template <typename Container>
+bounded_span(Container&)
+    -> bounded_span<std::remove_pointer_t<
+        decltype(std::declval<Container&>().data())>>;
+
+}  // namespace integers
+
+#endif  // BOUNDED_SPAN_H_
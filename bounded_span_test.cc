@@ -0,0 +1,173 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdint.h>
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "bounded_span.h"
+#include "test_support.h"
+
+using namespace integers;
+using namespace std;
+
+namespace {
+
+void TestConstructors() {
+  {
+    const bounded_span<int> s;
+    EXPECT(s.empty());
+    EXPECT(s.size() == 0);
+    EXPECT(s.data() == nullptr);
+  }
+  {
+    int array[] = {1, 2, 3};
+    bounded_span s(array);
+    EXPECT((is_same_v<decltype(s), bounded_span<int>>));
+    EXPECT(s.size() == 3);
+    EXPECT(s.data() == array);
+  }
+  {
+    vector<uint8_t> v{1, 2, 3, 4};
+    bounded_span s(v);
+    EXPECT((is_same_v<decltype(s), bounded_span<uint8_t>>));
+    EXPECT(s.size() == 4);
+    const vector<uint8_t>& cv = v;
+    bounded_span c(cv);
+    EXPECT((is_same_v<decltype(c), bounded_span<const uint8_t>>));
+    const bounded_span<const uint8_t> converted = s;
+    EXPECT(converted.data() == v.data());
+  }
+  {
+    array<int, 5> a{};
+    const bounded_span<int> s(a);
+    EXPECT(s.size() == 5);
+    const string text = "hello";
+    const bounded_span<const char> t(text);
+    EXPECT(t.size() == 5);
+    EXPECT(t[t.check(4)] == 'o');
+  }
+}
+
+void TestCheck() {
+  vector<int> v{10, 20, 30};
+  const bounded_span<int> s(v);
+  const checked_index i = s.check(2);
+  EXPECT(i.value() == 2);
+  EXPECT(s[i] == 30);
+  s[i] = 31;
+  EXPECT(v[2] == 31);
+  EXPECT(s.at(0) == 10);
+  EXPECT_DEATH(s.check(3));
+  EXPECT_DEATH(s.check(SIZE_MAX));
+  EXPECT_DEATH((void)s.at(3));
+  EXPECT_DEATH(bounded_span<int>().check(0));
+}
+
+void TestForeignIndex() {
+  vector<int> v(10);
+  const bounded_span<int> large(v);
+  const bounded_span<int> small = large.first(5);
+  // An index checked against a span is valid for any span at least as large.
+  const checked_index i = small.check(4);
+  EXPECT(&large[i] == &v[4]);
+  const checked_index j = large.check(5);
+  EXPECT_DEATH((void)small[j]);
+  // Even when the index itself happens to fit.
+  const checked_index k = large.check(0);
+  EXPECT_DEATH((void)small[k]);
+}
+
+void TestRangedIndex() {
+  vector<uint32_t> table(256);
+  for (size_t i = 0; i < table.size(); ++i) {
+    table[i] = static_cast<uint32_t>(i * i);
+  }
+  const bounded_span<const uint32_t> s(table);
+  const ranged<size_t, 0, 255> byte(size_t{17});
+  EXPECT(s[byte] == 289);
+  const ranged<size_t, 0, 256> too_big(size_t{17});
+  EXPECT_DEATH((void)s[too_big]);
+  const ranged<size_t, 0, 17> small(size_t{17});
+  EXPECT(s.first(18)[small] == 289);
+  EXPECT_DEATH((void)s.first(17)[small]);
+}
+
+void TestSubspan() {
+  int array[] = {0, 1, 2, 3, 4, 5};
+  const bounded_span<int> s(array);
+  {
+    const bounded_span<int> t = s.subspan(2, 3);
+    EXPECT(t.size() == 3);
+    EXPECT(t.at(0) == 2);
+    EXPECT(t.at(2) == 4);
+    EXPECT(s.subspan(6, 0).empty());
+    EXPECT(s.subspan(4).size() == 2);
+    EXPECT(s.subspan(6).empty());
+    EXPECT(s.first(6).size() == 6);
+  }
+  EXPECT_DEATH(s.subspan(7, 0));
+  EXPECT_DEATH(s.subspan(2, 5));
+  // `offset + count` would wrap around.
+  EXPECT_DEATH(s.subspan(2, SIZE_MAX));
+  EXPECT_DEATH(s.subspan(7));
+  EXPECT_DEATH(s.first(7));
+}
+
+void TestIndices() {
+  int array[] = {5, 6, 7, 8};
+  const bounded_span<int> s(array);
+  size_t expected = 0;
+  int sum = 0;
+  for (const checked_index i : s.indices()) {
+    EXPECT(i == expected);
+    sum += s[i];
+    ++expected;
+  }
+  EXPECT(expected == 4);
+  EXPECT(sum == 26);
+  for (const checked_index i : bounded_span<int>().indices()) {
+    (void)i;
+    EXPECT(false);
+  }
+  int total = 0;
+  for (const int x : s) {
+    total += x;
+  }
+  EXPECT(total == 26);
+}
+
+constexpr int SumOfSquares() {
+  const int array[] = {1, 2, 3};
+  const bounded_span<const int> s(array);
+  int sum = 0;
+  for (const checked_index i : s.indices()) {
+    sum += s[i] * s[i];
+  }
+  return sum + s.at(0) - s[s.check(0)];
+}
+static_assert(SumOfSquares() == 14);
+
+}  // namespace
+
+int main() {
+  TestConstructors();
+  TestCheck();
+  TestForeignIndex();
+  TestRangedIndex();
+  TestSubspan();
+  TestIndices();
+}
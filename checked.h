@@ -0,0 +1,647 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CHECKED_H_
+#define CHECKED_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <limits>
+#include <type_traits>
+
+#include "is_integral.h"
+#include "trap.h"
+#include "trapping.h"
+
+namespace integers {
+
+/// ## `result<R>`
+///
+/// The result of a checking operation that does not `trap`: the computed
+/// `value`, and whether the operation `overflowed` (or divided by 0, or
+/// performed a lossy conversion). It is a plain aggregate, so it is returned
+/// in registers, not through memory like the `R*` out-parameter of the
+/// `*_overflow` functions. You can take it apart with a structured binding:
+///
+///   auto [size, overflowed] = checked_mul<size_t>(count, stride);
+///   if (overflowed) {
+///     return Error::kTooBig;
+///   }
+///
+/// The combinators (`add`, `sub`, `mul`, `div`, `mod`, `cast`, and
+/// `and_then`) continue a calculation, ORing the flags together, so that a
+/// whole chain needs only 1 branch, at the end:
+///
+///   auto total = checked_mul<size_t>(count, stride).add(header);
+///   if (!total) {
+///     return Error::kTooBig;
+///   }
+///   Allocate(total.value);
+///
+/// The combinators compute each step whether or not an earlier step
+/// overflowed, rather than branching. That is safe because the `checked_*`
+/// functions are defined for every input; but after an overflow, `value` is
+/// meaningless.
+template <typename R>
+struct [[nodiscard]] result {
+  assert_is_integral(R);
+
+  R value;
+  bool overflowed;
+
+  /// ### `operator bool`
+  ///
+  /// Returns true if the operation (and every one before it in the chain)
+  /// succeeded.
+  constexpr explicit operator bool() const { return !overflowed; }
+
+  /// ### `value_or`
+  ///
+  /// Returns `value`, or `fallback` if the operation overflowed.
+  constexpr R value_or(R fallback) const {
+    return overflowed ? fallback : value;
+  }
+
+  /// ### `value_or_trap`
+  ///
+  /// Returns `value`, or `trap`s if the operation overflowed.
+  constexpr R value_or_trap() const {
+    if (overflowed) {
+      trap();
+    }
+    return value;
+  }
+
+  /// ### `add`
+  ///
+  /// Returns the result of adding `y` to `value`.
+  template <typename U>
+  constexpr result<R> add(U y) const {
+    result<R> r{0, overflowed};
+    r.overflowed |= add_overflow(value, y, &r.value);
+    return r;
+  }
+
+  /// ### `sub`
+  ///
+  /// Returns the result of subtracting `y` from `value`.
+  template <typename U>
+  constexpr result<R> sub(U y) const {
+    result<R> r{0, overflowed};
+    r.overflowed |= sub_overflow(value, y, &r.value);
+    return r;
+  }
+
+  /// ### `mul`
+  ///
+  /// Returns the result of multiplying `value` by `y`.
+  template <typename U>
+  constexpr result<R> mul(U y) const {
+    result<R> r{0, overflowed};
+    r.overflowed |= mul_overflow(value, y, &r.value);
+    return r;
+  }
+
+  /// ### `div`
+  ///
+  /// Returns the result of dividing `value` by `divisor`.
+  template <typename U>
+  constexpr result<R> div(U divisor) const {
+    result<R> r{0, overflowed};
+    r.overflowed |= div_overflow(value, divisor, &r.value);
+    return r;
+  }
+
+  /// ### `mod`
+  ///
+  /// Returns the remainder of dividing `value` by `divisor`.
+  template <typename U>
+  constexpr result<R> mod(U divisor) const {
+    result<R> r{0, overflowed};
+    r.overflowed |= mod_overflow(value, divisor, &r.value);
+    return r;
+  }
+
+  /// ### `cast`
+  ///
+  /// Returns the result of converting `value` to a `U`.
+  template <typename U>
+  constexpr result<U> cast() const {
+    result<U> r{0, overflowed};
+    r.overflowed |= cast_truncate(value, &r.value);
+    return r;
+  }
+
+  /// ### `and_then`
+  ///
+  /// Returns the result of calling `f(value)`, where `f` returns a
+  /// `result<U>`. `f` is called even if this result overflowed, so it must
+  /// be safe to call with any value (as the `checked_*` functions are).
+  template <typename F>
+  constexpr auto and_then(F f) const {
+    auto r = f(value);
+    r.overflowed |= overflowed;
+    return r;
+  }
+};
+
+/// ## Result-Returning Operations
+///
+/// These are like the primitive checking operations (`add_overflow` et c.),
+/// but return a `result<R>` instead of writing through an out-parameter. On
+/// overflow, `value` is whatever the corresponding `*_overflow` function
+/// leaves in its out-parameter (the wrapped result for `+`, `-`, and `*`,
+/// and 0 otherwise).
+///
+/// ### `checked_cast`
+///
+/// Converts `value` to an `R`, and reports whether it did not fit.
+template <typename R, typename T>
+constexpr result<R> checked_cast(T value) {
+  result<R> r{0, false};
+  r.overflowed = cast_truncate(value, &r.value);
+  return r;
+}
+
+/// ### `checked_add`
+///
+/// Adds `x` and `y`, and reports whether the sum did not fit in an `R`.
+template <typename R, typename T, typename U>
+constexpr result<R> checked_add(T x, U y) {
+  result<R> r{0, false};
+  r.overflowed = add_overflow(x, y, &r.value);
+  return r;
+}
+
+/// ### `checked_sub`
+///
+/// Subtracts `y` from `x`, and reports whether the difference did not fit in
+/// an `R`.
+template <typename R, typename T, typename U>
+constexpr result<R> checked_sub(T x, U y) {
+  result<R> r{0, false};
+  r.overflowed = sub_overflow(x, y, &r.value);
+  return r;
+}
+
+/// ### `checked_mul`
+///
+/// Multiplies `x` and `y`, and reports whether the product did not fit in an
+/// `R`.
+template <typename R, typename T, typename U>
+constexpr result<R> checked_mul(T x, U y) {
+  result<R> r{0, false};
+  r.overflowed = mul_overflow(x, y, &r.value);
+  return r;
+}
+
+/// ### `checked_div`
+///
+/// Divides `dividend` by `divisor`, and reports whether the quotient did not
+/// fit in an `R`, or `divisor` was 0. As with `div_overflow`, the quotient is
+/// the mathematical one even for mixed-sign operands, so
+/// `checked_div<int>(-7, 2U)` gives -3.
+template <typename R, typename T, typename U>
+constexpr result<R> checked_div(T dividend, U divisor) {
+  result<R> r{0, false};
+  r.overflowed = div_overflow(dividend, divisor, &r.value);
+  return r;
+}
+
+/// ### `checked_mod`
+///
+/// Divides `dividend` by `divisor`, and reports whether the remainder did not
+/// fit in an `R`, or `divisor` was 0. As with `mod_overflow`, the remainder
+/// has the sign of `dividend`, even for mixed-sign operands.
+template <typename R, typename T, typename U>
+constexpr result<R> checked_mod(T dividend, U divisor) {
+  result<R> r{0, false};
+  r.overflowed = mod_overflow(dividend, divisor, &r.value);
+  return r;
+}
+
+/// ### `checked_shl`
+///
+/// Shifts `value` left by `amount` bits, as an `R`, and reports whether
+/// `amount` was out of range or bits fell off the left side (see
+/// `shl_overflow`).
+template <typename R, typename T, typename U>
+constexpr result<R> checked_shl(T value, U amount) {
+  result<R> r{0, false};
+  r.overflowed = shl_overflow(value, amount, &r.value);
+  return r;
+}
+
+/// ### `checked_shr`
+///
+/// Shifts `value` right by `amount` bits, and reports whether `amount` was
+/// out of range or the result did not fit in an `R`.
+template <typename R, typename T, typename U>
+constexpr result<R> checked_shr(T value, U amount) {
+  result<R> r{0, false};
+  r.overflowed = shr_overflow(value, amount, &r.value);
+  return r;
+}
+
+/// ## `checked<T>`
+///
+/// This template class implements integer types that remember whether any
+/// operation in a computation has overflowed, underflowed, divided by 0, or
+/// performed a lossy conversion. Unlike `trapping<T>`, which checks and
+/// `trap`s after every operation, `checked<T>` ORs the result of each
+/// `*_overflow` primitive into a ‘sticky’ flag, and checks the flag only when
+/// you ask for the value (with `value`, `check`, or `operator U`).
+///
+/// This removes the compare-and-branch after each operation, so that a chain
+/// of arithmetic like
+///
+///   checked<size_t> offset = base;
+///   offset += count * stride;
+///   offset += header;
+///   size_t result = offset.value();
+///
+/// compiles to straight-line code with a single check at the end. The catch
+/// is that, after an overflow, the intermediate values are meaningless: only
+/// the fact that an overflow happened is reliable.
+///
+/// `checked<T>` supports arithmetic, not bitwise operations or comparisons.
+/// To compare, either get the `value` (which checks) or use `trapping<T>`.
+template <typename T>
+class checked {
+  assert_is_integral(T);
+
+  using Self = checked<T>;
+
+ public:
+  /// ### `checked`
+  ///
+  /// The default constructor. Initializes the value to 0, with no overflow.
+  /// (Unlike `trapping<T>`, `checked<T>` is not trivial, since the sticky flag
+  /// must always start out cleared.)
+  checked() : value_(0), overflowed_(false) {}
+
+  /// ### `checked`
+  ///
+  /// Constructs and initializes.
+  template <typename U, std::enable_if_t<std::is_same_v<T, U>, int> = 0>
+  checked(U value) : value_(value), overflowed_(false) {}
+
+  /// ### `checked`
+  ///
+  /// Constructs and initializes. If `T` cannot represent `value`, sets the
+  /// sticky overflow flag (but does not `trap`).
+  template <typename U, std::enable_if_t<!std::is_same_v<T, U>, int> = 0>
+  explicit checked(U value)
+      : value_(0), overflowed_(cast_truncate(value, &value_)) {}
+
+  /// ### `overflowed`
+  ///
+  /// Returns true if any operation that contributed to this value overflowed.
+  bool overflowed() const { return overflowed_; }
+
+  /// ### `value`
+  ///
+  /// Returns the plain `T` value. `trap`s if any operation that contributed
+  /// to this value overflowed.
+  T value() const {
+    check();
+    return value_;
+  }
+
+  /// ### `check`
+  ///
+  /// `trap`s if any operation that contributed to this value overflowed.
+  void check() const {
+    if (overflowed_) {
+      trap();
+    }
+  }
+
+  /// ### `operator U`
+  ///
+  /// Returns the plain `T` value as a `U`. `trap`s if any operation that
+  /// contributed to this value overflowed, or if the value cannot be
+  /// represented as a `U`.
+  template <typename U>
+  operator U() const {
+    return trapping_cast<U>(value());
+  }
+
+  /// ### `operator+=`
+  ///
+  /// Increments by `x`, recording any overflow.
+  Self& operator+=(Self x) {
+    overflowed_ |= x.overflowed_;
+    overflowed_ |= add_overflow(value_, x.value_, &value_);
+    return *this;
+  }
+
+  /// ### `operator+=`
+  ///
+  /// Increments by `x`, recording any overflow. `x` need not fit in `T`; only
+  /// the result must.
+  template <typename U, std::enable_if_t<!std::is_same_v<Self, U>, int> = 0>
+  Self& operator+=(U x) {
+    overflowed_ |= add_overflow(value_, x, &value_);
+    return *this;
+  }
+
+  /// ### `operator+`
+  ///
+  /// Adds `rhs` to `lhs`, recording any overflow, and returns the result.
+  friend Self operator+(Self lhs, Self rhs) {
+    lhs += rhs;
+    return lhs;
+  }
+
+  /// ### `operator+`
+  ///
+  /// Adds `rhs` to `lhs`, recording any overflow, and returns the result.
+  template <typename U>
+  friend Self operator+(Self lhs, U rhs) {
+    lhs += rhs;
+    return lhs;
+  }
+
+  /// ### `operator+`
+  ///
+  /// Adds `rhs` to `lhs`, recording any overflow, and returns the result.
+  template <typename U>
+  friend Self operator+(U lhs, Self rhs) {
+    rhs += lhs;
+    return rhs;
+  }
+
+  /// ### `operator-=`
+  ///
+  /// Subtracts `x`, recording any overflow.
+  Self& operator-=(Self x) {
+    overflowed_ |= x.overflowed_;
+    overflowed_ |= sub_overflow(value_, x.value_, &value_);
+    return *this;
+  }
+
+  /// ### `operator-=`
+  ///
+  /// Subtracts `x`, recording any overflow. `x` need not fit in `T`; only the
+  /// result must.
+  template <typename U, std::enable_if_t<!std::is_same_v<Self, U>, int> = 0>
+  Self& operator-=(U x) {
+    overflowed_ |= sub_overflow(value_, x, &value_);
+    return *this;
+  }
+
+  /// ### `operator-`
+  ///
+  /// Subtracts `rhs` from `lhs`, recording any overflow, and returns the
+  /// result.
+  friend Self operator-(Self lhs, Self rhs) {
+    lhs -= rhs;
+    return lhs;
+  }
+
+  /// ### `operator-`
+  ///
+  /// Subtracts `rhs` from `lhs`, recording any overflow, and returns the
+  /// result.
+  template <typename U>
+  friend Self operator-(Self lhs, U rhs) {
+    lhs -= rhs;
+    return lhs;
+  }
+
+  /// ### `operator-`
+  ///
+  /// Subtracts `rhs` from `lhs`, recording any overflow, and returns the
+  /// result.
+  template <typename U>
+  friend Self operator-(U lhs, Self rhs) {
+    Self result;
+    result.overflowed_ = rhs.overflowed_;
+    result.overflowed_ |= sub_overflow(lhs, rhs.value_, &result.value_);
+    return result;
+  }
+
+  /// ### `operator-`
+  ///
+  /// Reverses the value’s sign, recording overflow if `T` is the minimum
+  /// value.
+  Self operator-() const {
+    static_assert(internal::is_signed_v<T>, "Cannot negate an unsigned value");
+    Self result = *this;
+    result.overflowed_ |= sub_overflow(T{0}, value_, &result.value_);
+    return result;
+  }
+
+  /// ### `operator*=`
+  ///
+  /// Multiplies by `x`, recording any overflow.
+  Self& operator*=(Self x) {
+    overflowed_ |= x.overflowed_;
+    overflowed_ |= mul_overflow(value_, x.value_, &value_);
+    return *this;
+  }
+
+  /// ### `operator*=`
+  ///
+  /// Multiplies by `x`, recording any overflow. `x` need not fit in `T`; only
+  /// the result must.
+  template <typename U, std::enable_if_t<!std::is_same_v<Self, U>, int> = 0>
+  Self& operator*=(U x) {
+    overflowed_ |= mul_overflow(value_, x, &value_);
+    return *this;
+  }
+
+  /// ### `operator*`
+  ///
+  /// Multiplies `lhs` by `rhs`, recording any overflow, and returns the
+  /// result.
+  friend Self operator*(Self lhs, Self rhs) {
+    lhs *= rhs;
+    return lhs;
+  }
+
+  /// ### `operator*`
+  ///
+  /// Multiplies `lhs` by `rhs`, recording any overflow, and returns the
+  /// result.
+  template <typename U>
+  friend Self operator*(Self lhs, U rhs) {
+    lhs *= rhs;
+    return lhs;
+  }
+
+  /// ### `operator*`
+  ///
+  /// Multiplies `lhs` by `rhs`, recording any overflow, and returns the
+  /// result.
+  template <typename U>
+  friend Self operator*(U lhs, Self rhs) {
+    rhs *= lhs;
+    return rhs;
+  }
+
+  /// ### `operator/=`
+  ///
+  /// Divides by `divisor`, storing the quotient in `*this`, and recording
+  /// overflow or division by 0. (On failure, the value is left unchanged.)
+  Self& operator/=(Self divisor) {
+    overflowed_ |= divisor.overflowed_;
+    overflowed_ |= div_overflow(value_, divisor.value_, &value_);
+    return *this;
+  }
+
+  /// ### `operator/=`
+  ///
+  /// Divides by `divisor`, storing the quotient in `*this`, and recording
+  /// overflow or division by 0. `divisor` need not fit in `T`; only the
+  /// result must.
+  template <typename U, std::enable_if_t<!std::is_same_v<Self, U>, int> = 0>
+  Self& operator/=(U divisor) {
+    overflowed_ |= div_overflow(value_, divisor, &value_);
+    return *this;
+  }
+
+  /// ### `operator/`
+  ///
+  /// Divides `dividend` by `divisor`, recording overflow or division by 0,
+  /// and returns the quotient.
+  friend Self operator/(Self dividend, Self divisor) {
+    dividend /= divisor;
+    return dividend;
+  }
+
+  /// ### `operator/`
+  ///
+  /// Divides `dividend` by `divisor`, recording overflow or division by 0,
+  /// and returns the quotient.
+  template <typename U>
+  friend Self operator/(Self dividend, U divisor) {
+    dividend /= divisor;
+    return dividend;
+  }
+
+  /// ### `operator/`
+  ///
+  /// Divides `dividend` by `divisor`, recording overflow or division by 0,
+  /// and returns the quotient.
+  template <typename U>
+  friend Self operator/(U dividend, Self divisor) {
+    Self result;
+    result.overflowed_ = divisor.overflowed_;
+    result.overflowed_ |=
+        div_overflow(dividend, divisor.value_, &result.value_);
+    return result;
+  }
+
+  /// ### `operator%=`
+  ///
+  /// Divides by `divisor`, storing the remainder in `*this`, and recording
+  /// overflow or division by 0. (On failure, the value is left unchanged.)
+  Self& operator%=(Self divisor) {
+    overflowed_ |= divisor.overflowed_;
+    overflowed_ |= mod_overflow(value_, divisor.value_, &value_);
+    return *this;
+  }
+
+  /// ### `operator%=`
+  ///
+  /// Divides by `divisor`, storing the remainder in `*this`, and recording
+  /// overflow or division by 0. `divisor` need not fit in `T`; only the
+  /// result must.
+  template <typename U, std::enable_if_t<!std::is_same_v<Self, U>, int> = 0>
+  Self& operator%=(U divisor) {
+    overflowed_ |= mod_overflow(value_, divisor, &value_);
+    return *this;
+  }
+
+  /// ### `operator%`
+  ///
+  /// Divides `dividend` by `divisor`, recording overflow or division by 0,
+  /// and returns the remainder.
+  friend Self operator%(Self dividend, Self divisor) {
+    dividend %= divisor;
+    return dividend;
+  }
+
+  /// ### `operator%`
+  ///
+  /// Divides `dividend` by `divisor`, recording overflow or division by 0,
+  /// and returns the remainder.
+  template <typename U>
+  friend Self operator%(Self dividend, U divisor) {
+    dividend %= divisor;
+    return dividend;
+  }
+
+  /// ### `operator%`
+  ///
+  /// Divides `dividend` by `divisor`, recording overflow or division by 0,
+  /// and returns the remainder.
+  template <typename U>
+  friend Self operator%(U dividend, Self divisor) {
+    Self result;
+    result.overflowed_ = divisor.overflowed_;
+    result.overflowed_ |=
+        mod_overflow(dividend, divisor.value_, &result.value_);
+    return result;
+  }
+
+  /// ### `operator++`
+  ///
+  /// Prefix increment. Increments the value, recording any overflow, and
+  /// returns `*this` with the new value.
+  Self& operator++() {
+    *this += T{1};
+    return *this;
+  }
+
+  /// ### `operator++`
+  ///
+  /// Postfix increment. Increments the value, recording any overflow, and
+  /// returns an object containing the previous value.
+  Self operator++(int) {
+    Self previous = *this;
+    *this += T{1};
+    return previous;
+  }
+
+  /// ### `operator--`
+  ///
+  /// Prefix decrement. Decrements the value, recording any overflow, and
+  /// returns `*this` with the new value.
+  Self& operator--() {
+    *this -= T{1};
+    return *this;
+  }
+
+  /// ### `operator--`
+  ///
+  /// Postfix decrement. Decrements the value, recording any overflow, and
+  /// returns an object containing the previous value.
+  Self operator--(int) {
+    Self previous = *this;
+    *this -= T{1};
+    return previous;
+  }
+
+ private:
+  T value_;
+  bool overflowed_;
+};
+
+}  // namespace integers
+
+#endif  // CHECKED_H_
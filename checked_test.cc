@@ -0,0 +1,391 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <limits>
+
+#include "checked.h"
+#include "test_support.h"
+
+using namespace integers;
+using namespace std;
+
+namespace {
+
+using i8 = int8_t;
+using u8 = uint8_t;
+using i16 = int16_t;
+using u16 = uint16_t;
+using i32 = int32_t;
+using u32 = uint32_t;
+using i64 = int64_t;
+using u64 = uint64_t;
+
+void TestConstructor() {
+  {
+    checked<int> x;
+    EXPECT(!x.overflowed());
+    EXPECT(x.value() == 0);
+  }
+  {
+    checked<int> x = 42;
+    EXPECT(!x.overflowed());
+    EXPECT(x.value() == 42);
+  }
+  {
+    checked<i8> x{512};
+    EXPECT(x.overflowed());
+    EXPECT_DEATH((void)x.value());
+  }
+  {
+    checked<u32> x{-1};
+    EXPECT(x.overflowed());
+    EXPECT_DEATH(x.check());
+  }
+}
+
+template <typename T>
+void GenericTestStickyAdd() {
+  constexpr T max = numeric_limits<T>::max();
+  {
+    checked<T> x = max;
+    x += T{1};
+    EXPECT(x.overflowed());
+    // Once set, the flag stays set even if later operations succeed.
+    x -= T{1};
+    EXPECT(x.overflowed());
+    EXPECT_DEATH((void)x.value());
+  }
+  {
+    checked<T> x = max;
+    x -= T{1};
+    x += T{1};
+    EXPECT(!x.overflowed());
+    EXPECT(x.value() == max);
+  }
+}
+
+template <typename T>
+void GenericTestStickySub() {
+  constexpr T min = numeric_limits<T>::min();
+  {
+    checked<T> x = min;
+    x -= T{1};
+    EXPECT(x.overflowed());
+    EXPECT_DEATH(x.check());
+  }
+  {
+    checked<T> x = min;
+    x = x - T{1} + T{1};
+    EXPECT(x.overflowed());
+  }
+}
+
+template <typename T>
+void GenericTestStickyMul() {
+  constexpr T max = numeric_limits<T>::max();
+  {
+    checked<T> x = max;
+    x *= T{2};
+    EXPECT(x.overflowed());
+    x /= T{2};
+    EXPECT(x.overflowed());
+  }
+  {
+    checked<T> x = max;
+    x *= T{1};
+    EXPECT(!x.overflowed());
+    EXPECT(x.value() == max);
+  }
+}
+
+template <typename T>
+void GenericTestStickyDiv() {
+  constexpr T max = numeric_limits<T>::max();
+  constexpr T min = numeric_limits<T>::min();
+  {
+    checked<T> x = max;
+    x /= T{0};
+    EXPECT(x.overflowed());
+    EXPECT(!(checked<T>{max} / T{2}).overflowed());
+  }
+  {
+    checked<T> x = max;
+    x %= T{0};
+    EXPECT(x.overflowed());
+    EXPECT(!(checked<T>{max} % T{2}).overflowed());
+  }
+  if constexpr (is_signed_v<T>) {
+    checked<T> x = min;
+    x /= T{-1};
+    EXPECT(x.overflowed());
+  }
+}
+
+template <class... T>
+void CallGenericTestSticky() {
+  (GenericTestStickyAdd<T>(), ...);
+  (GenericTestStickySub<T>(), ...);
+  (GenericTestStickyMul<T>(), ...);
+  (GenericTestStickyDiv<T>(), ...);
+}
+
+void TestSticky() {
+  CallGenericTestSticky<i8, u8, i16, u16, i32, u32, i64, u64>();
+}
+
+void TestPropagation() {
+  {
+    checked<u8> bad = u8{255};
+    bad += u8{1};
+    checked<u8> good = u8{1};
+    EXPECT((good + bad).overflowed());
+    EXPECT((bad + good).overflowed());
+    EXPECT((good * bad).overflowed());
+    EXPECT((good - bad).overflowed());
+    EXPECT((good / bad).overflowed());
+    EXPECT((good % bad).overflowed());
+  }
+  {
+    checked<i32> bad = numeric_limits<i32>::max();
+    ++bad;
+    EXPECT(bad.overflowed());
+    EXPECT((-bad).overflowed());
+    EXPECT((1 - bad).overflowed());
+  }
+  {
+    checked<i32> x = numeric_limits<i32>::min();
+    EXPECT((-x).overflowed());
+    EXPECT(!(-(x + 1)).overflowed());
+  }
+}
+
+void TestMixedTypes() {
+  {
+    // The right-hand side need not fit in `T`, as long as the result does.
+    checked<u32> x = 5U;
+    x += i64{-3};
+    EXPECT(!x.overflowed());
+    EXPECT(x.value() == 2U);
+  }
+  {
+    checked<u32> x = 5U;
+    x += i64{-6};
+    EXPECT(x.overflowed());
+  }
+  {
+    checked<u16> x = u16{3};
+    EXPECT((x * 30000).overflowed());
+    EXPECT(!(x * 20).overflowed());
+    EXPECT((30000 * x).overflowed());
+    EXPECT(((x * 20).value() == 60));
+  }
+  {
+    // Likewise, a divisor or dividend out of `T`’s range is fine, as long as
+    // the quotient or remainder fits.
+    checked<i8> x = i8{10};
+    EXPECT(!(x / 1000).overflowed());
+    EXPECT((x / 1000).value() == 0);
+    EXPECT((x % 1000).value() == 10);
+    EXPECT(!(x / 2).overflowed());
+    EXPECT((2000 / x).overflowed());
+    EXPECT((500 / x).value() == 50);
+    EXPECT((1000 % x).value() == 0);
+    EXPECT((x / 0L).overflowed());
+    x /= 1000U;
+    EXPECT(!x.overflowed() && x.value() == 0);
+  }
+  {
+    checked<i32> x = -7;
+    EXPECT((x / 2U).value() == -3);
+    EXPECT((x % 2U).value() == -1);
+    EXPECT((7U / checked<i32>{-2}).value() == -3);
+  }
+}
+
+void TestOperatorU() {
+  {
+    checked<i64> x = i64{42};
+    i16 y = static_cast<i16>(x);
+    EXPECT(y == 42);
+  }
+  {
+    checked<i64> x = numeric_limits<i64>::max();
+    i32 y;
+    EXPECT_DEATH(y = x);
+  }
+  {
+    checked<i64> x = numeric_limits<i64>::max();
+    x += 1;
+    i64 y;
+    EXPECT_DEATH(y = x);
+  }
+}
+
+void TestChain() {
+  const size_t count = 1000;
+  const size_t stride = 48;
+  const size_t header = 16;
+  {
+    checked<size_t> total = count;
+    total *= stride;
+    total += header;
+    EXPECT(total.value() == count * stride + header);
+  }
+  {
+    checked<size_t> total = numeric_limits<size_t>::max() / 2;
+    total *= stride;
+    total += header;
+    EXPECT(total.overflowed());
+    EXPECT_DEATH((void)total.value());
+  }
+}
+
+template <typename T>
+void GenericTestCheckedFunctions() {
+  constexpr T max = numeric_limits<T>::max();
+  constexpr T min = numeric_limits<T>::min();
+  {
+    auto [value, overflowed] = checked_add<T>(max, T{1});
+    EXPECT(overflowed);
+    EXPECT(value == min);
+    EXPECT(!checked_add<T>(max, T{0}).overflowed);
+    EXPECT(checked_add<T>(max - 1, T{1}).value == max);
+  }
+  {
+    auto [value, overflowed] = checked_sub<T>(min, T{1});
+    EXPECT(overflowed);
+    EXPECT(value == max);
+    EXPECT(checked_sub<T>(T{3}, T{2}).value == T{1});
+  }
+  {
+    EXPECT(checked_mul<T>(max, T{2}).overflowed);
+    EXPECT(!checked_mul<T>(max, T{1}).overflowed);
+    EXPECT(checked_mul<T>(T{5}, T{5}).value == T{25});
+  }
+  {
+    auto [value, overflowed] = checked_div<T>(max, T{0});
+    EXPECT(overflowed);
+    EXPECT(value == 0);
+    EXPECT(checked_mod<T>(max, T{0}).overflowed);
+    EXPECT(checked_div<T>(T{100}, T{7}).value == T{14});
+    EXPECT(checked_mod<T>(T{100}, T{7}).value == T{2});
+    if constexpr (is_signed_v<T>) {
+      EXPECT(checked_div<T>(min, T{-1}).overflowed);
+      EXPECT(checked_mod<T>(min, T{-1}).overflowed);
+    }
+  }
+  {
+    EXPECT(checked_cast<T>(max));
+    EXPECT(checked_cast<T>(max).value == max);
+    if constexpr (uintmax_t{max} < numeric_limits<uintmax_t>::max()) {
+      EXPECT(checked_cast<T>(uintmax_t{max} + 1).overflowed);
+    }
+    EXPECT(checked_cast<T>(-1).overflowed == is_unsigned_v<T>);
+  }
+}
+
+template <class... T>
+void CallGenericTestCheckedFunctions() {
+  (GenericTestCheckedFunctions<T>(), ...);
+}
+
+void TestCheckedFunctions() {
+  CallGenericTestCheckedFunctions<i8, u8, i16, u16, i32, u32, i64, u64>();
+
+  // Mixed-sign division is of the mathematical values.
+  EXPECT(checked_div<i32>(-7, 2U).value == -3);
+  EXPECT(checked_mod<i32>(-7, 2U).value == -1);
+  EXPECT(checked_div<u32>(-7, 2U).overflowed);
+  EXPECT(checked_div<i32>(7U, -2).value == -3);
+  EXPECT(!checked_div<i32>(0U, -1).overflowed);
+}
+
+void TestResultAccessors() {
+  {
+    const result<u8> r = checked_add<u8>(200, 55);
+    EXPECT(r);
+    EXPECT(r.value_or(7) == 255);
+    EXPECT(r.value_or_trap() == 255);
+  }
+  {
+    const result<u8> sum = checked_add<u8>(200, 56);
+    EXPECT(!sum);
+    EXPECT(sum.value_or(7) == 7);
+    EXPECT_DEATH((void)sum.value_or_trap());
+  }
+  {
+    constexpr result<i32> r = checked_mul<i32>(1 << 20, 1 << 10);
+    static_assert(r.value == 1 << 30);
+    static_assert(checked_mul<i32>(1 << 20, 1 << 11).overflowed);
+  }
+}
+
+void TestResultChain() {
+  const size_t count = 1000;
+  const size_t stride = 48;
+  const size_t header = 16;
+  {
+    const auto total = checked_mul<size_t>(count, stride).add(header);
+    EXPECT(total);
+    EXPECT(total.value == count * stride + header);
+  }
+  {
+    // An overflow early in the chain propagates, even if later steps succeed.
+    const auto total = checked_mul<size_t>(numeric_limits<size_t>::max() / 2,
+                                           stride)
+                           .add(header)
+                           .div(stride)
+                           .sub(1);
+    EXPECT(!total);
+  }
+  {
+    const auto r = checked_cast<u8>(300).add(1);
+    EXPECT(r.overflowed);
+    EXPECT(checked_sub<u8>(3, 2).mod(0).overflowed);
+    EXPECT(checked_add<u8>(3, 2).mul(60).overflowed);
+    EXPECT(checked_add<u8>(3, 2).mul(51).value == 255);
+  }
+  {
+    const auto r = checked_mul<i64>(1 << 16, 1 << 16).cast<i32>();
+    EXPECT(r.overflowed);
+    EXPECT(checked_mul<i64>(1 << 15, 1 << 15).cast<i32>().value == (1 << 30));
+    EXPECT((is_same_v<decltype(r), const result<i32>>));
+  }
+  {
+    const auto square = [](u32 x) { return checked_mul<u32>(x, x); };
+    EXPECT(checked_add<u32>(2, 3).and_then(square).value == 25);
+    EXPECT(checked_add<u32>(0xffff, 1).and_then(square).overflowed);
+    const auto shift = [](u32 x) { return checked_shl<u32>(x, 8); };
+    EXPECT(checked_add<u32>(0xff, 1).and_then(shift).value == 0x10000);
+    EXPECT(checked_shl<u32>(0x1000000, 0).and_then(shift).overflowed);
+    EXPECT(checked_shr<u8>(0xff00, 8).value == 0xff);
+    EXPECT(checked_shr<u8>(0xff00, 7).overflowed);
+    EXPECT(checked_sub<u32>(0, 1).and_then(square).overflowed);
+  }
+}
+
+}  // namespace
+
+int main() {
+  TestConstructor();
+  TestSticky();
+  TestPropagation();
+  TestMixedTypes();
+  TestOperatorU();
+  TestChain();
+  TestCheckedFunctions();
+  TestResultAccessors();
+  TestResultChain();
+}
@@ -12,38 +12,876 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#ifndef INTEGERS_H_
-#define INTEGERS_H_
+#ifndef CLAMPING_H_
+#define CLAMPING_H_
 
+#include <limits.h>
 #include <stdint.h>
 #include <stdlib.h>
 
-#include <algorithm>
 #include <limits>
 #include <type_traits>
 
+#include "in_range.h"
 #include "is_integral.h"
+#include "trap.h"
+#include "trapping.h"
+
+namespace internal {
+
+/// Returns |`x`|, which is representable in `uwidest_t` for every `T`.
+template <typename T>
+constexpr uwidest_t magnitude(T x) {
+  return is_negative(x) ? uwidest_t{0} - static_cast<uwidest_t>(x)
+                        : static_cast<uwidest_t>(x);
+}
+
+/// Returns the maximum value of `R` if `positive`, otherwise the minimum.
+template <typename R>
+constexpr R saturate(bool positive) {
+  return positive ? std::numeric_limits<R>::max()
+                  : std::numeric_limits<R>::min();
+}
+
+/// Returns true if the mathematical `x + y` is > 0. Only meaningful when the
+/// sum is not 0, which is the case whenever it did not fit in some `R`.
+template <typename T, typename U>
+constexpr bool sum_is_positive(T x, U y) {
+  if (is_negative(x) == is_negative(y)) {
+    return !is_negative(x);
+  }
+  return is_negative(y) ? magnitude(x) > magnitude(y)
+                        : magnitude(y) > magnitude(x);
+}
+
+/// Returns true if the mathematical `x - y` is > 0, under the same
+/// assumption as `sum_is_positive`.
+template <typename T, typename U>
+constexpr bool difference_is_positive(T x, U y) {
+  if (is_negative(x) != is_negative(y)) {
+    return !is_negative(x);
+  }
+  return is_negative(x) ? magnitude(x) < magnitude(y)
+                        : magnitude(x) > magnitude(y);
+}
+
+}  // namespace internal
 
 namespace integers {
 
 /// ## Clamping Operations
+///
+/// These functions compute the mathematical result and, if it cannot fit into
+/// type `R`, return the nearest value that can: the maximum value of `R` if
+/// the result is too large, or the minimum if it is too small. This is also
+/// known as saturating arithmetic, and is what you want for e.g. audio samples
+/// and pixel values.
+///
+/// When `T`, `U`, and `R` are all the same type, the result is computed with
+/// the overflow built-ins and a select, which compilers turn into a
+/// conditional move (no branch). For whole arrays, see the batch clamping
+/// operations in batch.h, which use the CPU’s saturating vector instructions.
+///
+/// Division or modulo by 0 has no sensible clamped result, so those `trap`.
+/// All these functions are `constexpr`.
+///
+/// ### `clamping_cast`
+///
+/// Converts `T`s to `R`s, clamping `value` to the range of `R`.
+template <typename R, typename T>
+constexpr R clamping_cast(T value) {
+  assert_is_integral(R);
+  assert_is_integral(T);
+  return internal::in_range<R>(value)
+             ? static_cast<R>(value)
+             : internal::saturate<R>(!internal::is_negative(value));
+}
+
+/// ### `clamping_add`
+///
+/// Adds `x` and `y` and returns the result. If the result cannot fit into type
+/// `R`, returns the nearest value that can.
+template <typename R, typename T, typename U>
+constexpr R clamping_add(T x, U y) {
+  assert_is_integral(R);
+  assert_is_integral(T);
+  assert_is_integral(U);
+
+  R result = 0;
+  const bool overflowed = add_overflow(x, y, &result);
+  if constexpr (std::is_same_v<T, U> && std::is_same_v<T, R>) {
+    // With one type, an overflow is always in the direction of `x`’s sign.
+    // Computing the saturated value unconditionally lets the compiler emit a
+    // conditional move.
+    const R saturated = internal::saturate<R>(!internal::is_negative(x));
+    return overflowed ? saturated : result;
+  } else {
+    return overflowed ? internal::saturate<R>(internal::sum_is_positive(x, y))
+                      : result;
+  }
+}
+
+/// ### `clamping_sub`
+///
+/// Subtracts `y` from `x` and returns the result. If the result cannot fit
+/// into type `R`, returns the nearest value that can.
+template <typename R, typename T, typename U>
+constexpr R clamping_sub(T x, U y) {
+  assert_is_integral(R);
+  assert_is_integral(T);
+  assert_is_integral(U);
+
+  R result = 0;
+  const bool overflowed = sub_overflow(x, y, &result);
+  if constexpr (std::is_same_v<T, U> && std::is_same_v<T, R>) {
+    // Signed subtraction overflows in the direction of `x`’s sign; unsigned
+    // subtraction can only go below 0.
+    const R saturated = internal::saturate<R>(internal::is_signed_v<R> &&
+                                              !internal::is_negative(x));
+    return overflowed ? saturated : result;
+  } else {
+    return overflowed
+               ? internal::saturate<R>(internal::difference_is_positive(x, y))
+               : result;
+  }
+}
+
+/// ### `clamping_mul`
+///
+/// Multiplies `x` and `y` and returns the result. If the result cannot fit
+/// into type `R`, returns the nearest value that can.
+template <typename R, typename T, typename U>
+constexpr R clamping_mul(T x, U y) {
+  assert_is_integral(R);
+  assert_is_integral(T);
+  assert_is_integral(U);
+
+  R result = 0;
+  const bool overflowed = mul_overflow(x, y, &result);
+  const R saturated = internal::saturate<R>(internal::is_negative(x) ==
+                                            internal::is_negative(y));
+  return overflowed ? saturated : result;
+}
+
+/// ### `clamping_div`
+///
+/// Divides `dividend` by `divisor` and returns the quotient. The quotient is
+/// the mathematical one, rounded toward 0, even when the usual arithmetic
+/// conversions would make a negative operand unsigned (so
+/// `clamping_div<int>(-7, 2U)` is -3, not `INT_MAX`, as with `trapping_div`).
+/// The minimum value divided by -1 clamps to the maximum value instead of
+/// being UB. If the quotient cannot fit into type `R`, returns the nearest
+/// value that can.
+///
+/// If `divisor` is 0, this function will `trap`.
+template <typename R, typename T, typename U>
+constexpr R clamping_div(T dividend, U divisor) {
+  assert_is_integral(R);
+  assert_is_integral(T);
+  assert_is_integral(U);
+  if (divisor == 0) {
+    trap();
+  }
+  using C = decltype(dividend / divisor);
+  if constexpr (internal::kDivisionConvertsSign<T, U>) {
+    const bool negative =
+        internal::is_negative(dividend) != internal::is_negative(divisor);
+    const C quotient = internal::unsigned_abs<C>(dividend) /
+                       internal::unsigned_abs<C>(divisor);
+    R result = 0;
+    return internal::cast_magnitude(quotient, negative, &result)
+               ? internal::saturate<R>(!negative)
+               : result;
+  } else {
+    if constexpr (internal::is_signed_v<C>) {
+      if (static_cast<C>(divisor) == C{-1}) {
+        return clamping_sub<R>(C{0}, static_cast<C>(dividend));
+      }
+    }
+    return clamping_cast<R>(dividend / divisor);
+  }
+}
 
-// TODO
+/// ### `clamping_mod`
+///
+/// Divides `dividend` by `divisor` and returns the remainder, which has the
+/// sign of `dividend` (even for mixed-sign operands, as with `clamping_div`).
+/// (The minimum value modulo -1 is 0, instead of being UB.) If the remainder
+/// cannot fit into type `R`, returns the nearest value that can.
+///
+/// If `divisor` is 0, this function will `trap`.
+template <typename R, typename T, typename U>
+constexpr R clamping_mod(T dividend, U divisor) {
+  assert_is_integral(R);
+  assert_is_integral(T);
+  assert_is_integral(U);
+  if (divisor == 0) {
+    trap();
+  }
+  using C = decltype(dividend % divisor);
+  if constexpr (internal::kDivisionConvertsSign<T, U>) {
+    const bool negative = internal::is_negative(dividend);
+    const C remainder = internal::unsigned_abs<C>(dividend) %
+                        internal::unsigned_abs<C>(divisor);
+    R result = 0;
+    return internal::cast_magnitude(remainder, negative, &result)
+               ? internal::saturate<R>(!negative)
+               : result;
+  } else {
+    if constexpr (internal::is_signed_v<C>) {
+      if (static_cast<C>(divisor) == C{-1}) {
+        return 0;
+      }
+    }
+    return clamping_cast<R>(dividend % divisor);
+  }
+}
 
 /// ## `clamping<T>`
 ///
-/// TODO: Documentation.
+/// This template class implements integer types with well-defined behavior on
+/// overflow, underflow, bit-shifting too far, and narrowing conversions. For
+/// each of those phenomena, this implementation will clamp (saturate) the
+/// result to the nearest value `T` can represent.
+///
+/// `clamping<T>` has the same operators as `trapping<T>` and `wrapping<T>`, so
+/// you can switch between the policies without changing call sites. The
+/// differences are:
+///
+/// * Arithmetic and conversions clamp instead of `trap`ping or wrapping.
+/// * Shifting left saturates if any bits would ‘fall off’ (or change the
+///   sign), and shifting by the number of bits in `T` or more is the limit of
+///   shifting by ever larger amounts: 0 (or -1, for negative values shifted
+///   right), or the maximum or minimum value (for non-zero values shifted
+///   left). Shifting by a negative amount `trap`s.
+/// * Division or modulo by 0 still `trap`s, since there is no sensible result.
+/// * Comparisons with other integer types compare the mathematical values
+///   (so `clamping<uint8_t>(255) < 256`), rather than `trap`ping when the
+///   other value is out of `T`’s range.
+///
+/// All operations are `constexpr`. To format values, see format.h (`to_chars`
+/// and `std::format`) and ostream.h.
+///
+/// Implementation guided by the fine advice at
+/// https://en.cppreference.com/w/cpp/language/operators.
 template <typename T>
 class clamping {
   assert_is_integral(T);
 
   using Self = clamping<T>;
 
+  static constexpr internal::uwidest_t kBits = CHAR_BIT * sizeof(T);
+
  public:
+  /// ### `clamping`
+  ///
+  /// The default constructor. The contents of the object are undefined. 😕
+  /// Best practice is to use `-ftrivial-auto-var-init=zero` or to
+  /// explicitly initialize the object.
+  clamping() = default;
+
+  /// ### `clamping`
+  ///
+  /// Constructs and initializes.
+  template <typename U, std::enable_if_t<std::is_same_v<T, U>, int> = 0>
+  constexpr clamping(U value) : value_(value) {}
+
+  /// ### `clamping`
+  ///
+  /// Constructs and initializes, clamping `value` to the range of `T`.
+  template <typename U, std::enable_if_t<!std::is_same_v<T, U>, int> = 0>
+  constexpr explicit clamping(U value) : value_(clamping_cast<T>(value)) {}
+
+  /// ### `operator+=`
+  ///
+  /// Increments by `x`, clamping on overflow.
+  constexpr Self& operator+=(T x) {
+    value_ = clamping_add<T>(value_, x);
+    return *this;
+  }
+
+  /// ### `operator+`
+  ///
+  /// Adds `rhs` to `lhs`, assigns the result to `lhs`, and returns it. Clamps
+  /// on overflow.
+  friend constexpr Self operator+(Self lhs, Self rhs) {
+    lhs += rhs;
+    return lhs;
+  }
+
+  /// ### `operator+`
+  ///
+  /// Adds `rhs` to `lhs`, assigns the result to `lhs`, and returns it. Clamps
+  /// on overflow. (`rhs` need not fit in `T`; only the result is clamped.)
+  template <typename U>
+  friend constexpr Self operator+(Self lhs, U rhs) {
+    lhs.value_ = clamping_add<T>(lhs.value_, rhs);
+    return lhs;
+  }
+
+  /// ### `operator+`
+  ///
+  /// Adds `rhs` to `lhs` and returns the result. Clamps on overflow.
+  template <typename U>
+  friend constexpr Self operator+(U lhs, Self rhs) {
+    rhs.value_ = clamping_add<T>(lhs, rhs.value_);
+    return rhs;
+  }
+
+  /// ### `operator+`
+  ///
+  /// Does nothing. (But it’s explicit about it!)
+  constexpr Self& operator+() { return *this; }
+
+  /// ### `operator-=`
+  ///
+  /// Subtracts `x`, clamping on overflow.
+  constexpr Self& operator-=(T x) {
+    value_ = clamping_sub<T>(value_, x);
+    return *this;
+  }
+
+  /// ### `operator-`
+  ///
+  /// Subtracts `rhs` from `lhs`, assigns the result to `lhs`, and returns
+  /// it. Clamps on overflow.
+  friend constexpr Self operator-(Self lhs, Self rhs) {
+    lhs -= rhs;
+    return lhs;
+  }
+
+  /// ### `operator-`
+  ///
+  /// Subtracts `rhs` from `lhs`, assigns the result to `lhs`, and returns
+  /// it. Clamps on overflow.
+  template <typename U>
+  friend constexpr Self operator-(Self lhs, U rhs) {
+    lhs.value_ = clamping_sub<T>(lhs.value_, rhs);
+    return lhs;
+  }
+
+  /// ### `operator-`
+  ///
+  /// Subtracts `rhs` from `lhs` and returns the result. Clamps on overflow.
+  template <typename U>
+  friend constexpr Self operator-(U lhs, Self rhs) {
+    rhs.value_ = clamping_sub<T>(lhs, rhs.value_);
+    return rhs;
+  }
+
+  /// ### `operator-`
+  ///
+  /// Returns the value with its sign reversed. The minimum value of a signed
+  /// `T` clamps to the maximum; for unsigned `T`s, every value but 0 clamps to
+  /// 0.
+  constexpr Self operator-() const {
+    return Self{clamping_sub<T>(T{0}, value_)};
+  }
+
+  /// ### `operator*=`
+  ///
+  /// Multiplies by `x`, clamping on overflow.
+  constexpr Self& operator*=(T x) {
+    value_ = clamping_mul<T>(value_, x);
+    return *this;
+  }
+
+  /// ### `operator*`
+  ///
+  /// Multiplies `lhs` by `rhs`, assigns the result to `lhs`, and returns
+  /// it. Clamps on overflow.
+  friend constexpr Self operator*(Self lhs, Self rhs) {
+    lhs *= rhs;
+    return lhs;
+  }
+
+  /// ### `operator*`
+  ///
+  /// Multiplies `lhs` by `rhs`, assigns the result to `lhs`, and returns
+  /// it. Clamps on overflow.
+  template <typename U>
+  friend constexpr Self operator*(Self lhs, U rhs) {
+    lhs.value_ = clamping_mul<T>(lhs.value_, rhs);
+    return lhs;
+  }
+
+  /// ### `operator*`
+  ///
+  /// Multiplies `lhs` by `rhs` and returns the result. Clamps on overflow.
+  template <typename U>
+  friend constexpr Self operator*(U lhs, Self rhs) {
+    rhs.value_ = clamping_mul<T>(lhs, rhs.value_);
+    return rhs;
+  }
+
+  /// ### `operator/=`
+  ///
+  /// Divides by `divisor`, storing the quotient in `*this`. Clamps on
+  /// overflow, and `trap`s if `divisor` is 0.
+  constexpr Self& operator/=(T divisor) {
+    value_ = clamping_div<T>(value_, divisor);
+    return *this;
+  }
+
+  /// ### `operator/`
+  ///
+  /// Divides `dividend` by `divisor`, storing the quotient in `dividend`, and
+  /// returns `dividend`. Clamps on overflow, and `trap`s if `divisor` is 0.
+  friend constexpr Self operator/(Self dividend, Self divisor) {
+    dividend /= divisor;
+    return dividend;
+  }
+
+  /// ### `operator/`
+  ///
+  /// Divides `dividend` by `divisor`, storing the quotient in `dividend`, and
+  /// returns `dividend`. Clamps on overflow, and `trap`s if `divisor` is 0.
+  template <typename U>
+  friend constexpr Self operator/(Self dividend, U divisor) {
+    dividend.value_ = clamping_div<T>(dividend.value_, divisor);
+    return dividend;
+  }
+
+  /// ### `operator/`
+  ///
+  /// Divides `dividend` by `divisor` and returns the quotient. Clamps on
+  /// overflow, and `trap`s if `divisor` is 0.
+  template <typename U>
+  friend constexpr Self operator/(U dividend, Self divisor) {
+    divisor.value_ = clamping_div<T>(dividend, divisor.value_);
+    return divisor;
+  }
+
+  /// ### `operator%=`
+  ///
+  /// Divides by `divisor`, storing the remainder in `*this`. `trap`s if
+  /// `divisor` is 0.
+  constexpr Self& operator%=(T divisor) {
+    value_ = clamping_mod<T>(value_, divisor);
+    return *this;
+  }
+
+  /// ### `operator%`
+  ///
+  /// Divides `dividend` by `divisor`, storing the remainder in `dividend`, and
+  /// returns `dividend`. `trap`s if `divisor` is 0.
+  friend constexpr Self operator%(Self dividend, Self divisor) {
+    dividend %= divisor;
+    return dividend;
+  }
+
+  /// ### `operator%`
+  ///
+  /// Divides `dividend` by `divisor`, storing the remainder in `dividend`, and
+  /// returns `dividend`. `trap`s if `divisor` is 0.
+  template <typename U>
+  friend constexpr Self operator%(Self dividend, U divisor) {
+    dividend.value_ = clamping_mod<T>(dividend.value_, divisor);
+    return dividend;
+  }
+
+  /// ### `operator%`
+  ///
+  /// Divides `dividend` by `divisor` and returns the remainder. `trap`s if
+  /// `divisor` is 0.
+  template <typename U>
+  friend constexpr Self operator%(U dividend, Self divisor) {
+    divisor.value_ = clamping_mod<T>(dividend, divisor.value_);
+    return divisor;
+  }
+
+  /// ### `operator|=`
+  ///
+  /// Takes the bitwise `|` of the value and `x`, and assigns it to `value_`.
+  /// Returns `*this`.
+  constexpr Self& operator|=(Self x) {
+    value_ |= x.value_;
+    return *this;
+  }
+
+  /// ### `operator|`
+  ///
+  /// Takes the bitwise `|` of `lhs` and `rhs`, assigns it to `lhs`, and returns
+  /// it.
+  friend constexpr Self operator|(Self lhs, Self rhs) {
+    lhs |= rhs;
+    return lhs;
+  }
+
+  /// ### `operator|`
+  ///
+  /// Takes the bitwise `|` of `lhs` and `rhs`, assigns it to `lhs`, and returns
+  /// it. `rhs` is first converted to `T` with `clamping_cast`.
+  template <typename U>
+  friend constexpr Self operator|(Self lhs, U rhs) {
+    lhs |= Self{rhs};
+    return lhs;
+  }
+
+  /// ### `operator|`
+  ///
+  /// Takes the bitwise `|` of `lhs` and `rhs`, and returns it. `lhs` is first
+  /// converted to `T` with `clamping_cast`.
+  template <typename U>
+  friend constexpr Self operator|(U lhs, Self rhs) {
+    rhs |= Self{lhs};
+    return rhs;
+  }
+
+  /// ### `operator&=`
+  ///
+  /// Takes the bitwise `&` of the value and `x`, and assigns it to `value_`.
+  /// Returns `*this`.
+  constexpr Self& operator&=(Self x) {
+    value_ &= x.value_;
+    return *this;
+  }
+
+  /// ### `operator&`
+  ///
+  /// Takes the bitwise `&` of `lhs` and `rhs`, assigns it to `lhs`, and returns
+  /// it.
+  friend constexpr Self operator&(Self lhs, Self rhs) {
+    lhs &= rhs;
+    return lhs;
+  }
+
+  /// ### `operator&`
+  ///
+  /// Takes the bitwise `&` of `lhs` and `rhs`, assigns it to `lhs`, and returns
+  /// it. `rhs` is first converted to `T` with `clamping_cast`.
+  template <typename U>
+  friend constexpr Self operator&(Self lhs, U rhs) {
+    lhs &= Self{rhs};
+    return lhs;
+  }
+
+  /// ### `operator&`
+  ///
+  /// Takes the bitwise `&` of `lhs` and `rhs`, and returns it. `lhs` is first
+  /// converted to `T` with `clamping_cast`.
+  template <typename U>
+  friend constexpr Self operator&(U lhs, Self rhs) {
+    rhs &= Self{lhs};
+    return rhs;
+  }
+
+  /// ### `operator^=`
+  ///
+  /// Takes the bitwise `^` of the value and `x`, and assigns it to `value_`.
+  /// Returns `*this`.
+  constexpr Self& operator^=(Self x) {
+    value_ ^= x.value_;
+    return *this;
+  }
+
+  /// ### `operator^`
+  ///
+  /// Takes the bitwise `^` of `lhs` and `rhs`, assigns it to `lhs`, and returns
+  /// it.
+  friend constexpr Self operator^(Self lhs, Self rhs) {
+    lhs ^= rhs;
+    return lhs;
+  }
+
+  /// ### `operator^`
+  ///
+  /// Takes the bitwise `^` of `lhs` and `rhs`, assigns it to `lhs`, and returns
+  /// it. `rhs` is first converted to `T` with `clamping_cast`.
+  template <typename U>
+  friend constexpr Self operator^(Self lhs, U rhs) {
+    lhs ^= Self{rhs};
+    return lhs;
+  }
+
+  /// ### `operator^`
+  ///
+  /// Takes the bitwise `^` of `lhs` and `rhs`, and returns it. `lhs` is first
+  /// converted to `T` with `clamping_cast`.
+  template <typename U>
+  friend constexpr Self operator^(U lhs, Self rhs) {
+    rhs ^= Self{lhs};
+    return rhs;
+  }
+
+  /// ### `operator>>=`
+  ///
+  /// Shifts the value right by `x` bits, and assigns the result to `value_`.
+  /// Returns `*this`. Shifting by the number of bits in `T` or more results in
+  /// 0, or -1 if the value is negative. `trap`s if `x` is negative.
+  template <typename U>
+  constexpr Self& operator>>=(U x) {
+    assert_is_integral(U);
+    if (internal::is_negative(x)) {
+      trap();
+    }
+    if (!(static_cast<internal::uwidest_t>(x) < kBits)) {
+      value_ = internal::is_negative(value_) ? static_cast<T>(-1) : T{0};
+      return *this;
+    }
+    value_ = static_cast<T>(value_ >> static_cast<int>(x));
+    return *this;
+  }
+
+  /// ### `operator>>=`
+  ///
+  /// Shifts the value right by `x` bits, and assigns the result to `value_`.
+  /// Returns `*this`.
+  constexpr Self& operator>>=(Self x) { return *this >>= x.value_; }
+
+  /// ### `operator>>`
+  ///
+  /// Shifts `lhs` right by `rhs` bits, assigns the result to `lhs`, and
+  /// returns it.
+  template <typename U>
+  friend constexpr Self operator>>(Self lhs, U rhs) {
+    lhs >>= rhs;
+    return lhs;
+  }
+
+  /// ### `operator<<=`
+  ///
+  /// Shifts the value left by `x` bits, and assigns the result to `value_`.
+  /// Returns `*this`. If any bits would ‘fall off’ the left side (or into the
+  /// sign bit), the result is the maximum value of `T` (or the minimum, if the
+  /// value is negative). `trap`s if `x` is negative.
+  template <typename U>
+  constexpr Self& operator<<=(U x) {
+    assert_is_integral(U);
+    if (internal::is_negative(x)) {
+      trap();
+    }
+    if (value_ == 0) {
+      return *this;
+    }
+    const T saturated = internal::saturate<T>(!internal::is_negative(value_));
+    if (!(static_cast<internal::uwidest_t>(x) < kBits)) {
+      value_ = saturated;
+      return *this;
+    }
+    const int n = static_cast<int>(x);
+    if (value_ > (std::numeric_limits<T>::max() >> n) ||
+        value_ < (std::numeric_limits<T>::min() >> n)) {
+      value_ = saturated;
+      return *this;
+    }
+    using W = internal::make_unsigned_t<T>;
+    value_ = static_cast<T>(static_cast<W>(static_cast<W>(value_) << n));
+    return *this;
+  }
+
+  /// ### `operator<<=`
+  ///
+  /// Shifts the value left by `x` bits, and assigns the result to `value_`.
+  /// Returns `*this`.
+  constexpr Self& operator<<=(Self x) { return *this <<= x.value_; }
+
+  /// ### `operator<<`
+  ///
+  /// Shifts `lhs` left by `rhs` bits, assigns the result to `lhs`, and
+  /// returns it.
+  template <typename U>
+  friend constexpr Self operator<<(Self lhs, U rhs) {
+    lhs <<= rhs;
+    return lhs;
+  }
+
+  /// ### `operator<`
+  ///
+  /// Returns true if `lhs` is less than `rhs`.
+  friend constexpr bool operator<(Self lhs, Self rhs) {
+    return lhs.value_ < rhs.value_;
+  }
+
+  /// ### `operator<`
+  ///
+  /// Returns true if `lhs` is mathematically less than `rhs`. (Like
+  /// `operator==`, this never converts either operand.)
+  template <typename U>
+  friend constexpr bool operator<(Self lhs, U rhs) {
+    return internal::less(lhs.value_, rhs);
+  }
+
+  /// ### `operator<`
+  ///
+  /// Returns true if `lhs` is mathematically less than `rhs`.
+  template <typename U>
+  friend constexpr bool operator<(U lhs, Self rhs) {
+    return internal::less(lhs, rhs.value_);
+  }
+
+  /// ### `operator>`
+  ///
+  /// Returns true if `lhs` is greater than `rhs`.
+  friend constexpr bool operator>(Self lhs, Self rhs) { return rhs < lhs; }
+
+  /// ### `operator>`
+  ///
+  /// Returns true if `lhs` is mathematically greater than `rhs`.
+  template <typename U>
+  friend constexpr bool operator>(Self lhs, U rhs) {
+    return rhs < lhs;
+  }
+
+  /// ### `operator>`
+  ///
+  /// Returns true if `lhs` is mathematically greater than `rhs`.
+  template <typename U>
+  friend constexpr bool operator>(U lhs, Self rhs) {
+    return rhs < lhs;
+  }
+
+  /// ### `operator<=`
+  ///
+  /// Returns true if `lhs` is less than or equal to `rhs`.
+  friend constexpr bool operator<=(Self lhs, Self rhs) { return !(lhs > rhs); }
+
+  /// ### `operator<=`
+  ///
+  /// Returns true if `lhs` is mathematically less than or equal to `rhs`.
+  template <typename U>
+  friend constexpr bool operator<=(Self lhs, U rhs) {
+    return !(lhs > rhs);
+  }
+
+  /// ### `operator<=`
+  ///
+  /// Returns true if `lhs` is mathematically less than or equal to `rhs`.
+  template <typename U>
+  friend constexpr bool operator<=(U lhs, Self rhs) {
+    return !(lhs > rhs);
+  }
+
+  /// ### `operator>=`
+  ///
+  /// Returns true if `lhs` is greater than or equal to `rhs`.
+  friend constexpr bool operator>=(Self lhs, Self rhs) { return !(rhs > lhs); }
+
+  /// ### `operator>=`
+  ///
+  /// Returns true if `lhs` is mathematically greater than or equal to `rhs`.
+  template <typename U>
+  friend constexpr bool operator>=(Self lhs, U rhs) {
+    return !(rhs > lhs);
+  }
+
+  /// ### `operator>=`
+  ///
+  /// Returns true if `lhs` is mathematically greater than or equal to `rhs`.
+  template <typename U>
+  friend constexpr bool operator>=(U lhs, Self rhs) {
+    return !(rhs > lhs);
+  }
+
+  /// ### `operator==`
+  ///
+  /// Returns true if `lhs` is equal to `rhs`.
+  friend constexpr bool operator==(Self lhs, Self rhs) {
+    return lhs.value_ == rhs.value_;
+  }
+
+  /// ### `operator==`
+  ///
+  /// Returns true if `lhs` is mathematically equal to `rhs`.
+  template <typename U>
+  friend constexpr bool operator==(Self lhs, U rhs) {
+    assert_is_integral(U);
+    return internal::in_range<T>(rhs) && lhs.value_ == static_cast<T>(rhs);
+  }
+
+  /// ### `operator==`
+  ///
+  /// Returns true if `lhs` is mathematically equal to `rhs`.
+  template <typename U>
+  friend constexpr bool operator==(U lhs, Self rhs) {
+    return rhs == lhs;
+  }
+
+  /// ### `operator!=`
+  ///
+  /// Returns true if `lhs` is not equal to `rhs`.
+  friend constexpr bool operator!=(Self lhs, Self rhs) { return !(lhs == rhs); }
+
+  /// ### `operator!=`
+  ///
+  /// Returns true if `lhs` is not equal to `rhs`.
+  template <typename U>
+  friend constexpr bool operator!=(Self lhs, U rhs) {
+    return !(lhs == rhs);
+  }
+
+  /// ### `operator!=`
+  ///
+  /// Returns true if `lhs` is not equal to `rhs`.
+  template <typename U>
+  friend constexpr bool operator!=(U lhs, Self rhs) {
+    return !(lhs == rhs);
+  }
+
+  /// ### `operator++`
+  ///
+  /// Prefix increment. Increments the value, unless it is already the
+  /// maximum, and returns `*this` with the new value.
+  constexpr Self& operator++() {
+    *this += T{1};
+    return *this;
+  }
+
+  /// ### `operator++`
+  ///
+  /// Postfix increment. Increments the value, unless it is already the
+  /// maximum, and returns an object containing the previous value.
+  constexpr Self operator++(int) {
+    Self previous = *this;
+    *this += T{1};
+    return previous;
+  }
+
+  /// ### `operator--`
+  ///
+  /// Prefix decrement. Decrements the value, unless it is already the
+  /// minimum, and returns `*this` with the new value.
+  constexpr Self& operator--() {
+    *this -= T{1};
+    return *this;
+  }
+
+  /// ### `operator--`
+  ///
+  /// Postfix decrement. Decrements the value, unless it is already the
+  /// minimum, and returns an object containing the previous value.
+  constexpr Self operator--(int) {
+    Self previous = *this;
+    *this -= T{1};
+    return previous;
+  }
+
+  /// ### `operator U`
+  ///
+  /// Returns the plain `T` value as a `U`, clamped to the range of `U`.
+  template <typename U>
+  constexpr operator U() const {
+    return clamping_cast<U>(value_);
+  }
+
+  /// ### `abs`
+  ///
+  /// Returns the absolute value of `x`. The minimum value of a signed `T`
+  /// clamps to the maximum.
+  friend constexpr Self abs(Self x) {
+    if constexpr (internal::is_unsigned_v<T>) {
+      return x;
+    } else {
+      return x.value_ < 0 ? -x : x;
+    }
+  }
+
  private:
   T value_;
 };
 
+static_assert(std::is_trivial_v<clamping<int>>,
+              "`clamping<T>` must be trivial");
 static_assert(sizeof(clamping<int8_t>) == sizeof(int8_t),
               "sizeof(clamping<int8_t>) must == sizeof(int8_t)");
 static_assert(sizeof(clamping<int16_t>) == sizeof(int16_t),
@@ -52,7 +890,11 @@ static_assert(sizeof(clamping<int32_t>) == sizeof(int32_t),
               "sizeof(clamping<int32_t>) must == sizeof(int32_t)");
 static_assert(sizeof(clamping<int64_t>) == sizeof(int64_t),
               "sizeof(clamping<int64_t>) must == sizeof(int64_t)");
+static_assert(alignof(clamping<int64_t>) == alignof(int64_t),
+              "alignof(clamping<int64_t>) must == alignof(int64_t)");
+static_assert(std::is_standard_layout_v<clamping<int>>,
+              "`clamping<T>` must be standard-layout");
 
 }  // namespace integers
 
-#endif  // INTEGERS_H_
+#endif  // CLAMPING_H_
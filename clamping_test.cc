@@ -14,11 +14,325 @@
 
 #include <iostream>
 #include <limits>
+#include <sstream>
 
 #include "clamping.h"
+#include "ostream.h"
 #include "test_support.h"
 
 using namespace integers;
 using namespace std;
 
-int main() {}
+namespace {
+
+using i8 = int8_t;
+using u8 = uint8_t;
+using i16 = int16_t;
+using u16 = uint16_t;
+using i32 = int32_t;
+using u32 = uint32_t;
+using i64 = int64_t;
+using u64 = uint64_t;
+
+constexpr i8 i8_max = numeric_limits<i8>::max();
+constexpr u8 u8_max = numeric_limits<u8>::max();
+constexpr i16 i16_max = numeric_limits<i16>::max();
+constexpr u16 u16_max = numeric_limits<u16>::max();
+constexpr i32 i32_max = numeric_limits<i32>::max();
+constexpr u32 u32_max = numeric_limits<u32>::max();
+constexpr i64 i64_max = numeric_limits<i64>::max();
+constexpr u64 u64_max = numeric_limits<u64>::max();
+
+constexpr i8 i8_min = numeric_limits<i8>::min();
+constexpr i16 i16_min = numeric_limits<i16>::min();
+constexpr i32 i32_min = numeric_limits<i32>::min();
+constexpr i64 i64_min = numeric_limits<i64>::min();
+
+static_assert(clamping_add<u8>(u8{200}, u8{100}) == u8_max);
+static_assert(clamping_sub<i16>(i16_min, i16{1}) == i16_min);
+static_assert((clamping<i8>{i8_max} + 1) == i8_max);
+
+void TestCast() {
+  EXPECT(clamping_cast<u8>(0x1234) == u8_max);
+  EXPECT(clamping_cast<u8>(-1) == 0);
+  EXPECT(clamping_cast<i8>(200) == i8_max);
+  EXPECT(clamping_cast<i8>(-200) == i8_min);
+  EXPECT(clamping_cast<i32>(u64_max) == i32_max);
+  EXPECT(clamping_cast<u64>(i64_min) == 0);
+  EXPECT(clamping_cast<i64>(u64_max) == i64_max);
+  EXPECT(clamping_cast<i16>(42) == 42);
+}
+
+template <typename T>
+void GenericTestSameType() {
+  constexpr T max = numeric_limits<T>::max();
+  constexpr T min = numeric_limits<T>::min();
+  EXPECT((clamping_add<T>(max, T{1})) == max);
+  EXPECT((clamping_add<T>(max, max)) == max);
+  EXPECT((clamping_sub<T>(min, T{1})) == min);
+  EXPECT((clamping_mul<T>(max, T{2})) == max);
+  EXPECT((clamping_mul<T>(max, T{1})) == max);
+  EXPECT((clamping_add<T>(T{1}, T{2})) == 3);
+  EXPECT((clamping_div<T>(max, T{2})) == max / 2);
+  EXPECT((clamping_mod<T>(max, T{2})) == 1);
+  EXPECT_DEATH((void)(clamping_div<T>(max, T{0})));
+  EXPECT_DEATH((void)(clamping_mod<T>(max, T{0})));
+  if constexpr (is_signed_v<T>) {
+    EXPECT((clamping_add<T>(min, T{-1})) == min);
+    EXPECT((clamping_add<T>(min, min)) == min);
+    EXPECT((clamping_sub<T>(max, T{-1})) == max);
+    EXPECT((clamping_sub<T>(T{-2}, max)) == min);
+    EXPECT((clamping_sub<T>(T{0}, min)) == max);
+    EXPECT((clamping_mul<T>(min, T{-1})) == max);
+    EXPECT((clamping_mul<T>(max, T{-2})) == min);
+    EXPECT((clamping_mul<T>(min, min)) == max);
+    EXPECT((clamping_div<T>(min, T{-1})) == max);
+    EXPECT((clamping_mod<T>(min, T{-1})) == 0);
+  } else {
+    EXPECT((clamping_sub<T>(T{1}, T{2})) == 0);
+    EXPECT((clamping_sub<T>(T{0}, max)) == 0);
+  }
+}
+
+template <class... T>
+void CallGenericTestSameType() {
+  (GenericTestSameType<T>(), ...);
+}
+
+void TestSameType() {
+  CallGenericTestSameType<i8, u8, i16, u16, i32, u32, i64, u64>();
+}
+
+// Checks every pair of 8-bit operands against the mathematical result.
+template <typename R, typename T, typename U>
+void GenericTestExhaustive() {
+  for (int x = numeric_limits<T>::min(); x <= numeric_limits<T>::max(); x++) {
+    for (int y = numeric_limits<U>::min(); y <= numeric_limits<U>::max();
+         y++) {
+      const T a = static_cast<T>(x);
+      const U b = static_cast<U>(y);
+      auto clamp = [](int v) {
+        return static_cast<R>(
+            v < numeric_limits<R>::min()
+                ? numeric_limits<R>::min()
+                : v > numeric_limits<R>::max() ? numeric_limits<R>::max() : v);
+      };
+      EXPECT((clamping_add<R>(a, b)) == clamp(x + y));
+      EXPECT((clamping_sub<R>(a, b)) == clamp(x - y));
+      EXPECT((clamping_mul<R>(a, b)) == clamp(x * y));
+    }
+  }
+}
+
+void TestExhaustive() {
+  GenericTestExhaustive<i8, i8, i8>();
+  GenericTestExhaustive<u8, u8, u8>();
+  GenericTestExhaustive<u8, i8, u8>();
+  GenericTestExhaustive<i8, u8, i8>();
+  GenericTestExhaustive<u8, i8, i8>();
+}
+
+void TestMixedTypes() {
+  EXPECT((clamping_add<u8>(i32{-5}, i32{3})) == 0);
+  EXPECT((clamping_add<u8>(i32{300}, i32{-5})) == u8_max);
+  EXPECT((clamping_sub<u32>(i64{5}, i64{-5})) == 10);
+  EXPECT((clamping_sub<u32>(u64{5}, u64_max)) == 0);
+  EXPECT((clamping_sub<i64>(u64_max, i64{1})) == i64_max);
+  EXPECT((clamping_sub<i64>(i64_min, u64_max)) == i64_min);
+  EXPECT((clamping_add<i64>(u64_max, i64_min)) == i64_max);
+  EXPECT((clamping_add<i64>(u64{1}, i64_min)) == i64_min + 1);
+  EXPECT((clamping_mul<u16>(i32{-1}, i32{5})) == 0);
+  EXPECT((clamping_mul<i16>(u64_max, i8{-1})) == i16_min);
+  EXPECT((clamping_div<i16>(i8_min, i8{-1})) == 128);
+  EXPECT((clamping_div<u8>(1000, 2)) == u8_max);
+
+  // Mixed-sign operands divide the mathematical values, instead of
+  // converting the negative one to unsigned.
+  EXPECT((clamping_div<i32>(-7, 2U)) == -3);
+  EXPECT((clamping_mod<i32>(-7, 2U)) == -1);
+  EXPECT((clamping_div<i32>(7U, -2)) == -3);
+  EXPECT((clamping_mod<i32>(7U, -2)) == 1);
+  EXPECT((clamping_div<u32>(-7, 2U)) == 0);
+  EXPECT((clamping_div<i32>(u32_max, -1)) == i32_min);
+  EXPECT((clamping_div<i32>(u64_max, 2)) == i32_max);
+  EXPECT((clamping_mod<u8>(i64_min + 1, u64_max)) == 0);
+  EXPECT((clamping<i32>(-7) / 2U) == -3);
+  EXPECT((clamping<i32>(-7) % 2U) == -1);
+  EXPECT((7U / clamping<i32>(-2)) == -3);
+}
+
+void TestConstructor() {
+  {
+    clamping<int> x = 42;
+    EXPECT(x == 42);
+  }
+  {
+    clamping<i8> x{512};
+    EXPECT(x == i8_max);
+  }
+  {
+    clamping<u16> x{-1};
+    EXPECT(x == 0);
+  }
+}
+
+template <typename T>
+void GenericTestOperators() {
+  using C = clamping<T>;
+  constexpr T max = numeric_limits<T>::max();
+  constexpr T min = numeric_limits<T>::min();
+
+  {
+    C x = max;
+    x += T{1};
+    EXPECT(x == max);
+    ++x;
+    EXPECT(x++ == max);
+    EXPECT(x == max);
+    x -= T{1};
+    EXPECT(x == max - 1);
+    EXPECT(x + C{max} == max);
+    EXPECT(1 + C{max} == max);
+  }
+  {
+    C x = min;
+    --x;
+    EXPECT(x == min);
+    EXPECT(x-- == min);
+    EXPECT(C{min} - 1 == min);
+  }
+  {
+    C x = max;
+    x *= T{2};
+    EXPECT(x == max);
+    x /= T{2};
+    EXPECT(x == max / 2);
+    EXPECT(C{max} % T{2} == 1);
+    EXPECT_DEATH(x /= T{0});
+    EXPECT_DEATH(x %= T{0});
+  }
+  if constexpr (is_signed_v<T>) {
+    C x = min;
+    EXPECT(-x == max);
+    EXPECT(abs(x) == max);
+    EXPECT(x / T{-1} == max);
+    EXPECT(x * T{2} == min);
+    EXPECT(abs(C{T{-5}}) == 5);
+  } else {
+    EXPECT(-C{T{1}} == 0);
+    EXPECT(-C{T{0}} == 0);
+  }
+}
+
+template <class... T>
+void CallGenericTestOperators() {
+  (GenericTestOperators<T>(), ...);
+}
+
+void TestOperators() {
+  CallGenericTestOperators<i8, u8, i16, u16, i32, u32, i64, u64>();
+}
+
+void TestMixedOperators() {
+  clamping<u8> x = u8{250};
+  EXPECT(x + 10 == u8_max);
+  EXPECT(10 + x == u8_max);
+  EXPECT(x - 251 == 0);
+  EXPECT(x - (-5) == u8_max);
+  EXPECT(x * -1 == 0);
+  EXPECT(x / 256 == 0);
+  EXPECT(x % 1000 == 250);
+  EXPECT((x | 0x1FF) == u8_max);
+  EXPECT((x & -1) == 0);
+}
+
+void TestShift() {
+  {
+    clamping<i32> x = 1;
+    EXPECT((x << 30) == 1 << 30);
+    EXPECT((x << 31) == i32_max);
+    EXPECT((x << 100) == i32_max);
+    EXPECT((x >> 1) == 0);
+    EXPECT((x >> 100) == 0);
+    EXPECT_DEATH(x <<= -1);
+    EXPECT_DEATH(x >>= -1);
+  }
+  {
+    clamping<i32> x = -1;
+    EXPECT((x << 31) == i32_min);
+    EXPECT((x << 32) == i32_min);
+    EXPECT((x >> 100) == -1);
+    EXPECT((clamping<i32>{-3} << 30) == i32_min);
+  }
+  {
+    clamping<u8> x = u8{0x81};
+    EXPECT((x << 1) == u8_max);
+    EXPECT((x >> 7) == 1);
+    EXPECT((x >> 8) == 0);
+    EXPECT((clamping<u8>{u8{0x7F}} << 1) == 0xFE);
+    EXPECT((clamping<u8>{u8{0}} << 100) == 0);
+  }
+  {
+    clamping<u64> x = u64{3};
+    EXPECT((x << 62) == 0xC000000000000000ULL);
+    EXPECT((x << 63) == u64_max);
+    EXPECT((x << clamping<u64>{u64{4}}) == 48);
+  }
+}
+
+void TestComparison() {
+  clamping<u16> x = u16_max;
+  EXPECT(x != -1);
+  EXPECT(x == 65535);
+  EXPECT(x != 65536);
+  EXPECT(x > u16{1});
+  EXPECT(u16{1} < x);
+  EXPECT(x >= x);
+  EXPECT(x <= u16_max);
+  // Mixed-type comparisons compare the mathematical values.
+  EXPECT(x < 65536);
+  EXPECT(-1 < x);
+  EXPECT(!(x <= -1));
+  EXPECT(65536U >= x);
+  EXPECT(clamping<i8>{i8{-1}} < u64_max);
+}
+
+void TestOperatorU() {
+  clamping<i32> x = -1;
+  EXPECT(static_cast<u8>(x) == 0);
+  EXPECT(static_cast<i8>(clamping<i32>{1000}) == i8_max);
+  EXPECT(static_cast<i16>(x) == -1);
+  EXPECT(static_cast<u32>(clamping<i64>{i64_max}) == u32_max);
+}
+
+void TestMix() {
+  // Mixing two loud samples clips, rather than wrapping around to silence.
+  clamping<i16> a = i16{30000};
+  clamping<i16> b = i16{10000};
+  EXPECT(a + b == i16_max);
+  EXPECT(-a - b == i16_min);
+  EXPECT((a + b) / i16{2} == i16_max / 2);
+}
+
+void TestOstream() {
+  ostringstream os;
+  os << clamping<i16>{i16_max} + 1;
+  EXPECT(os.str() == "32767");
+}
+
+}  // namespace
+
+int main() {
+  TestCast();
+  TestSameType();
+  TestExhaustive();
+  TestMixedTypes();
+  TestConstructor();
+  TestOperators();
+  TestMixedOperators();
+  TestShift();
+  TestComparison();
+  TestOperatorU();
+  TestMix();
+  TestOstream();
+}
@@ -0,0 +1,78 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// A typical client of the library, for `make compile_time` to measure how long
+// it takes to compile with the headers, with the precompiled header, and with
+// the `integers` module.
+
+#include <stdint.h>
+
+#if defined(INTEGERS_IMPORT)
+import integers;
+#else
+#include "integers.h"
+#endif
+
+using namespace integers;
+
+namespace {
+
+template <typename T>
+T UseTrapping(T a, T b) {
+  trapping<T> x{a};
+  const trapping<T> y{b};
+  x = x + y;
+  x = x - 1;
+  x = 2 * x;
+  x = x / y;
+  x = x % y;
+  x = x | y;
+  x = x & y;
+  x = x ^ y;
+  x <<= 1;
+  x >>= 1;
+  const bool c = x < y || x > 1 || 2 <= x || x == y || x != 3;
+  return static_cast<T>(x + T{c});
+}
+
+template <typename T>
+T UseOthers(T a, T b) {
+  checked<T> c{a};
+  c *= b;
+  c += 1;
+  const clamping<T> s = clamping<T>{a} * b;
+  const wrapping<T> w = wrapping<T>{a} - b;
+  const T r = checked_add<T>(a, b).mul(b).value_or(0);
+  return static_cast<T>(static_cast<T>(c) ^ static_cast<T>(s) ^
+                        static_cast<T>(w) ^ r);
+}
+
+template <typename T>
+T Use(T a, T b) {
+  return static_cast<T>(UseTrapping(a, b) ^ UseOthers(a, b));
+}
+
+}  // namespace
+
+int main(int argc, char**) {
+  const int a = argc;
+  return static_cast<int>(
+      Use<int8_t>(1, static_cast<int8_t>(a)) ^
+      Use<uint8_t>(1, static_cast<uint8_t>(a)) ^
+      Use<int16_t>(1, static_cast<int16_t>(a)) ^
+      Use<uint16_t>(1, static_cast<uint16_t>(a)) ^ Use<int32_t>(1, a) ^
+      static_cast<int32_t>(Use<uint32_t>(1, static_cast<uint32_t>(a)) ^
+                           static_cast<uint32_t>(Use<int64_t>(1, a)) ^
+                           Use<uint64_t>(1, static_cast<uint64_t>(a))));
+}
@@ -3,6 +3,9 @@
 #include <iostream>
 #include <limits>
 
+#include "alloc.h"
+#include "expression.h"
+#include "ostream.h"
 #include "trapping.h"
 
 using TrappingSizeT = integers::trapping<size_t>;
@@ -12,7 +15,7 @@ namespace {
 char Help[] =
     "Usage: demo solution count\n"
     "\n"
-    "`solution` is 1 of: 1, 2, 3, 4. There are 4 possible approaches to\n"
+    "`solution` is 1 of: 1, 2, 3, 4, 5, 6. There are 6 possible approaches to\n"
     "fixing the problem in this demo.\n"
     "\n"
     "This program simulates a vulnerable integer overflow condition by\n"
@@ -117,6 +120,32 @@ Friend* Checked4(size_t count) {
   Friend* friends = static_cast<Friend*>(malloc(total));
   return friends;
 }
+
+// This version evaluates the whole calculation as an expression. Since
+// `sizeof(Friend)` is a constant, the product is computed exactly in a wider
+// type and checked once, at the end, instead of after every operation.
+Friend* Checked5(size_t count) {
+  std::cerr << "Checked calculation, version 5 (expression):\n";
+  size_t total = integers::expr(count) * integers::constant<sizeof(Friend)>;
+
+  std::cerr << "count " << count << " * sizeof(Friend) " << sizeof(Friend)
+            << " = " << total << "\n";
+
+  Friend* friends = static_cast<Friend*>(malloc(total));
+  return friends;
+}
+
+// A version that uses an allocation helper, which computes and checks the size
+// itself. Instead of crashing on overflow, it fails like `malloc` does:
+// returning `nullptr`.
+Friend* Checked6(size_t count) {
+  std::cerr << "Checked calculation, version 6 (allocation helper):\n";
+  Friend* friends = integers::checked_malloc_array<Friend>(count);
+  if (friends == nullptr) {
+    std::cerr << "count " << count << " is too large\n";
+  }
+  return friends;
+}
 }  // namespace
 
 int main(int count, char* arguments[]) {
@@ -164,6 +193,12 @@ int main(int count, char* arguments[]) {
       case 4:
         friends = Checked4(friend_count);
         break;
+      case 5:
+        friends = Checked5(friend_count);
+        break;
+      case 6:
+        friends = Checked6(friend_count);
+        break;
     }
     std::cerr << friends << "\n";
   }
@@ -0,0 +1,265 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DIVIDER_H_
+#define DIVIDER_H_
+
+#include <stdint.h>
+
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "is_integral.h"
+#include "trap.h"
+#include "trapping.h"
+#include "wide.h"
+
+namespace internal {
+
+// Returns the index of the highest set bit of `x`, which must not be 0.
+template <typename U>
+constexpr int floor_log2(U x) {
+  if constexpr (sizeof(U) > sizeof(unsigned long long)) {
+    constexpr int kHalf = std::numeric_limits<U>::digits / 2;
+    const auto hi = static_cast<unsigned long long>(x >> kHalf);
+    if (hi != 0) {
+      return kHalf + floor_log2(hi);
+    }
+    return floor_log2(static_cast<unsigned long long>(x));
+  } else {
+    return std::numeric_limits<unsigned long long>::digits - 1 -
+           __builtin_clzll(static_cast<unsigned long long>(x));
+  }
+}
+
+// Returns the quotient and remainder of `hi` × 2<sup>N</sup> divided by `d`,
+// where N is the number of bits in `U`. `hi` must be less than `d`, so that
+// the quotient fits in `U`.
+template <typename U>
+constexpr std::pair<U, U> div_wide(U hi, U d) {
+  using D = double_width_t<U>;
+  constexpr int kBits = std::numeric_limits<U>::digits;
+  if constexpr (!std::is_void_v<D>) {
+    const D n = static_cast<D>(static_cast<D>(hi) << kBits);
+    return {static_cast<U>(n / d), static_cast<U>(n % d)};
+  } else {
+    // Shift-and-subtract long division, 1 bit at a time.
+    U q = 0;
+    U r = hi;
+    for (int i = 0; i < kBits; ++i) {
+      const bool carry = (r >> (kBits - 1)) != 0;
+      r = static_cast<U>(r << 1);
+      q = static_cast<U>(q << 1);
+      if (carry || r >= d) {
+        r = static_cast<U>(r - d);
+        q = static_cast<U>(q | 1U);
+      }
+    }
+    return {q, r};
+  }
+}
+
+}  // namespace internal
+
+namespace integers {
+
+/// ## `trapping_divider<T>`
+///
+/// Divides by a divisor that is fixed at run time, but used many times (e.g.
+/// a bucket count or page size), without a hardware divide instruction.
+///
+/// The constructor checks the divisor once, and `trap`s if it is 0. It then
+/// computes a ‘magic’ multiplier and shift, as in [Hacker’s
+/// Delight](https://en.wikipedia.org/wiki/Hacker%27s_Delight) (section 10)
+/// and [libdivide](https://libdivide.com), so that each division is a
+/// widening multiply, an add or two, and a shift. Powers of 2 are just shifts.
+/// On x86-64, that is a few cycles, instead of the 20 to 90 cycles of `div`.
+///
+/// Dividing by `-1` cannot overflow, unless the dividend is the minimum value
+/// of a signed `T`, so that one case is still checked on each division (with a
+/// compare that does not depend on the multiply).
+///
+/// Use with `/` and `%` (and `/=` and `%=`) on `trapping<T>`s, or on `T`s.
+/// For example,
+///
+///   const trapping_divider<size_t> bucket_count(table.size());
+///   for (const Entry& e : entries) {
+///     buckets[e.hash % bucket_count].push_back(e);
+///   }
+///
+/// Only dividends of type `T` (or `trapping<T>`) are accepted; there is no
+/// implicit conversion.
+template <typename T>
+class trapping_divider {
+  assert_is_integral(T);
+
+  using U = internal::make_unsigned_t<T>;
+  static constexpr int kBits = std::numeric_limits<U>::digits;
+
+ public:
+  /// ### `trapping_divider`
+  ///
+  /// Computes the multiplier and shift for dividing by `divisor`. `trap`s if
+  /// `divisor` is 0.
+  constexpr explicit trapping_divider(T divisor) : divisor_(divisor) {
+    if (divisor == 0) {
+      trap();
+    }
+    bool negative = false;
+    if constexpr (internal::is_signed_v<T>) {
+      negative = divisor < 0;
+    }
+    const U d = negative ? static_cast<U>(0U - static_cast<U>(divisor))
+                         : static_cast<U>(divisor);
+    const int log2 = internal::floor_log2(d);
+    shift_ = static_cast<uint8_t>(log2);
+    sign_ = negative ? static_cast<U>(~U{0}) : U{0};
+    if ((d & (d - 1U)) == 0) {
+      // A power of 2 needs only a shift, so `magic_` is 0.
+      return;
+    }
+
+    // For unsigned `T`, the multiplier is 2^(N + log2) / d, rounded up; if
+    // that does not fit in N bits, the quotient needs an extra add (`add_`).
+    // For signed `T`, the magnitude has 1 fewer bit.
+    const int exponent = internal::is_signed_v<T> ? log2 - 1 : log2;
+    auto [magic, remainder] =
+        internal::div_wide(static_cast<U>(U{1} << exponent), d);
+    const U error = static_cast<U>(d - remainder);
+    if (error < static_cast<U>(U{1} << log2)) {
+      shift_ = static_cast<uint8_t>(exponent);
+    } else {
+      magic = static_cast<U>(magic + magic);
+      const U twice_remainder = static_cast<U>(remainder + remainder);
+      if (twice_remainder >= d || twice_remainder < remainder) {
+        ++magic;
+      }
+      add_ = true;
+    }
+    ++magic;
+    magic_ = negative ? static_cast<U>(0U - magic) : magic;
+  }
+
+  /// ### `divisor`
+  ///
+  /// Returns the divisor.
+  constexpr T divisor() const { return divisor_; }
+
+  /// ### `divide`
+  ///
+  /// Returns `dividend / divisor()`, rounded toward 0 as with the built-in
+  /// `/`. `trap`s if `T` is signed, `dividend` is its minimum, and the
+  /// divisor is -1.
+  constexpr T divide(T dividend) const {
+    const U n = static_cast<U>(dividend);
+    if constexpr (internal::is_signed_v<T>) {
+      if (dividend == std::numeric_limits<T>::min() && divisor_ == -1) {
+        trap();
+      }
+      if (magic_ == 0) {
+        // Round toward 0, by adding d - 1 to negative dividends, then negate
+        // if the divisor is negative.
+        const U mask = static_cast<U>((U{1} << shift_) - 1U);
+        const U bias = static_cast<U>(static_cast<U>(dividend >> (kBits - 1)) &
+                                      mask);
+        const T q = static_cast<T>(static_cast<T>(static_cast<U>(n + bias)) >>
+                                   shift_);
+        return static_cast<T>(static_cast<U>(static_cast<U>(q) ^ sign_) -
+                              sign_);
+      }
+      U uq = static_cast<U>(mul_wide(static_cast<T>(magic_), dividend).hi);
+      if (add_) {
+        uq = static_cast<U>(uq + static_cast<U>((n ^ sign_) - sign_));
+      }
+      T q = static_cast<T>(static_cast<T>(uq) >> shift_);
+      if (q < 0) {
+        ++q;
+      }
+      return q;
+    } else {
+      if (magic_ == 0) {
+        return static_cast<T>(n >> shift_);
+      }
+      const U q = mul_wide(magic_, n).hi;
+      if (add_) {
+        return static_cast<T>(
+            static_cast<U>(static_cast<U>(static_cast<U>(n - q) >> 1) + q) >>
+            shift_);
+      }
+      return static_cast<T>(q >> shift_);
+    }
+  }
+
+  /// ### `modulo`
+  ///
+  /// Returns `dividend % divisor()`, with the sign of `dividend` as with the
+  /// built-in `%`. `trap`s in the same case as `divide`.
+  constexpr T modulo(T dividend) const {
+    const U q = static_cast<U>(divide(dividend));
+    const U product = static_cast<U>(q * static_cast<U>(divisor_));
+    return static_cast<T>(static_cast<U>(static_cast<U>(dividend) - product));
+  }
+
+  /// ### `operator/`, `operator%`
+  ///
+  /// Return the quotient or remainder, as `divide` and `modulo` do.
+  template <typename U2, std::enable_if_t<std::is_same_v<T, U2>, int> = 0>
+  friend constexpr T operator/(U2 dividend, const trapping_divider& divisor) {
+    return divisor.divide(dividend);
+  }
+
+  template <typename U2, std::enable_if_t<std::is_same_v<T, U2>, int> = 0>
+  friend constexpr T operator%(U2 dividend, const trapping_divider& divisor) {
+    return divisor.modulo(dividend);
+  }
+
+  friend constexpr trapping<T> operator/(trapping<T> dividend,
+                                         const trapping_divider& divisor) {
+    return trapping<T>(divisor.divide(static_cast<T>(dividend)));
+  }
+
+  friend constexpr trapping<T> operator%(trapping<T> dividend,
+                                         const trapping_divider& divisor) {
+    return trapping<T>(divisor.modulo(static_cast<T>(dividend)));
+  }
+
+  /// ### `operator/=`, `operator%=`
+  ///
+  /// Replace `dividend` with the quotient or remainder.
+  friend constexpr trapping<T>& operator/=(trapping<T>& dividend,
+                                           const trapping_divider& divisor) {
+    dividend = dividend / divisor;
+    return dividend;
+  }
+
+  friend constexpr trapping<T>& operator%=(trapping<T>& dividend,
+                                           const trapping_divider& divisor) {
+    dividend = dividend % divisor;
+    return dividend;
+  }
+
+ private:
+  T divisor_;
+  // 0 if the magnitude of the divisor is a power of 2.
+  U magic_ = 0;
+  // All 1s if the divisor is negative.
+  U sign_ = 0;
+  uint8_t shift_ = 0;
+  bool add_ = false;
+};
+
+}  // namespace integers
+
+#endif  // DIVIDER_H_
@@ -0,0 +1,247 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdint.h>
+
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "divider.h"
+#include "test_support.h"
+#include "trapping.h"
+
+using namespace integers;
+using namespace std;
+
+namespace {
+
+using i8 = int8_t;
+using u8 = uint8_t;
+using i16 = int16_t;
+using u16 = uint16_t;
+using i32 = int32_t;
+using u32 = uint32_t;
+using i64 = int64_t;
+using u64 = uint64_t;
+
+// xorshift64*, so that the test is deterministic.
+u64 Random() {
+  static u64 state = 0x9e3779b97f4a7c15U;
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  return state * 0x2545f4914f6cdd1dU;
+}
+
+template <typename T>
+T RandomValue() {
+  using U = internal::make_unsigned_t<T>;
+  U bits = 0;
+  for (size_t i = 0; i < sizeof(T); i += sizeof(u64)) {
+    bits = static_cast<U>(bits << (sizeof(T) > 8 ? 64 : 0)) ^
+           static_cast<U>(Random());
+  }
+  // Also test small magnitudes, which are the common divisors.
+  switch (Random() % 4) {
+    case 0:
+      return static_cast<T>(bits);
+    case 1:
+      return static_cast<T>(static_cast<U>(bits >> (sizeof(T) * 4)));
+    case 2:
+      return static_cast<T>(bits % 1000);
+    default:
+      return static_cast<T>(static_cast<U>(U{1} << (bits % (sizeof(T) * 8))) +
+                            static_cast<U>(Random() % 3) - 1U);
+  }
+}
+
+// Returns true if the built-in `/` and `%` are defined.
+template <typename T>
+bool CanDivide(T dividend, T divisor) {
+  if constexpr (internal::is_signed_v<T>) {
+    if (dividend == numeric_limits<T>::min() && divisor == -1) {
+      return false;
+    }
+  }
+  return divisor != 0;
+}
+
+template <typename T>
+void ExpectSame(const trapping_divider<T>& divider, T dividend) {
+  const T divisor = divider.divisor();
+  EXPECT(divider.divide(dividend) == static_cast<T>(dividend / divisor));
+  EXPECT(divider.modulo(dividend) == static_cast<T>(dividend % divisor));
+}
+
+template <typename T>
+void GenericTestExhaustive8() {
+  constexpr int min = numeric_limits<T>::min();
+  constexpr int max = numeric_limits<T>::max();
+  for (int d = min; d <= max; ++d) {
+    if (d == 0) {
+      continue;
+    }
+    const trapping_divider<T> divider(static_cast<T>(d));
+    for (int n = min; n <= max; ++n) {
+      if (CanDivide(static_cast<T>(n), static_cast<T>(d))) {
+        ExpectSame(divider, static_cast<T>(n));
+      }
+    }
+  }
+}
+
+template <typename T>
+void GenericTest16() {
+  constexpr int min = numeric_limits<T>::min();
+  constexpr int max = numeric_limits<T>::max();
+  // Every divisor, with dividends near the limits and at random; then every
+  // dividend, for random divisors.
+  for (int d = min; d <= max; ++d) {
+    if (d == 0) {
+      continue;
+    }
+    const trapping_divider<T> divider(static_cast<T>(d));
+    for (int n : {min, min + 1, -1, 0, 1, max - 1, max, d, d - 1, d + 1}) {
+      if (n >= min && n <= max &&
+          CanDivide(static_cast<T>(n), static_cast<T>(d))) {
+        ExpectSame(divider, static_cast<T>(n));
+      }
+    }
+    for (int i = 0; i < 16; ++i) {
+      const T n = RandomValue<T>();
+      if (CanDivide(n, static_cast<T>(d))) {
+        ExpectSame(divider, n);
+      }
+    }
+  }
+  for (int i = 0; i < 64; ++i) {
+    const T d = RandomValue<T>();
+    if (d == 0) {
+      continue;
+    }
+    const trapping_divider<T> divider(d);
+    for (int n = min; n <= max; ++n) {
+      if (CanDivide(static_cast<T>(n), d)) {
+        ExpectSame(divider, static_cast<T>(n));
+      }
+    }
+  }
+}
+
+template <typename T>
+void GenericTestRandom() {
+  constexpr T min = numeric_limits<T>::min();
+  constexpr T max = numeric_limits<T>::max();
+  vector<T> divisors = {T{1}, T{2}, T{3}, T{7}, T{10}, T{100}, max,
+                        static_cast<T>(max - 1), static_cast<T>(max / 2),
+                        static_cast<T>(max / 2 + 1), static_cast<T>(max / 3)};
+  if constexpr (internal::is_signed_v<T>) {
+    for (const T d : vector<T>(divisors)) {
+      divisors.push_back(static_cast<T>(-d));
+    }
+    divisors.push_back(min);
+    divisors.push_back(static_cast<T>(min + 1));
+  }
+  for (int i = 0; i < 1000; ++i) {
+    divisors.push_back(RandomValue<T>());
+  }
+  for (const T d : divisors) {
+    if (d == 0) {
+      continue;
+    }
+    const trapping_divider<T> divider(d);
+    // The neighbors of `d` wrap around.
+    using U = internal::make_unsigned_t<T>;
+    const T below = static_cast<T>(static_cast<U>(d) - 1U);
+    const T above = static_cast<T>(static_cast<U>(d) + 1U);
+    for (T n : {min, static_cast<T>(min + 1), T{0}, T{1},
+                static_cast<T>(max - 1), max, d, below, above}) {
+      if (CanDivide(n, d)) {
+        ExpectSame(divider, n);
+      }
+    }
+    for (int i = 0; i < 1000; ++i) {
+      const T n = RandomValue<T>();
+      if (CanDivide(n, d)) {
+        ExpectSame(divider, n);
+      }
+    }
+  }
+}
+
+template <typename T>
+void GenericTestTrap() {
+  EXPECT_DEATH(trapping_divider<T>{T{0}});
+  if constexpr (internal::is_signed_v<T>) {
+    constexpr T min = numeric_limits<T>::min();
+    const trapping_divider<T> minus_one(T{-1});
+    EXPECT(minus_one.divide(T{5}) == T{-5});
+    EXPECT(minus_one.divide(static_cast<T>(min + 1)) ==
+           numeric_limits<T>::max());
+    EXPECT(minus_one.modulo(T{5}) == T{0});
+    EXPECT_DEATH((void)minus_one.divide(min));
+    EXPECT_DEATH((void)minus_one.modulo(min));
+    EXPECT_DEATH((void)(trapping<T>{min} / minus_one));
+  }
+}
+
+template <typename T>
+void GenericTestOperators() {
+  const trapping_divider<T> seven(T{7});
+  {
+    trapping<T> x{T{100}};
+    EXPECT(static_cast<T>(x / seven) == T{14});
+    EXPECT(static_cast<T>(x % seven) == T{2});
+    x /= seven;
+    EXPECT(static_cast<T>(x) == T{14});
+    x %= seven;
+    EXPECT(static_cast<T>(x) == T{0});
+  }
+  {
+    const T x = 100;
+    EXPECT(x / seven == T{14});
+    EXPECT(x % seven == T{2});
+  }
+  {
+    constexpr trapping_divider<T> three(T{3});
+    static_assert(three.divide(T{100}) == T{33});
+    static_assert(three.modulo(T{100}) == T{1});
+  }
+}
+
+template <class... T>
+void CallGenericTests() {
+  (GenericTestRandom<T>(), ...);
+  (GenericTestTrap<T>(), ...);
+  (GenericTestOperators<T>(), ...);
+}
+
+void TestTypes() {
+  GenericTestExhaustive8<i8>();
+  GenericTestExhaustive8<u8>();
+  GenericTest16<i16>();
+  GenericTest16<u16>();
+#if defined(INTEGERS_HAVE_INT128)
+  CallGenericTests<i8, u8, i16, u16, i32, u32, i64, u64, int128_t, uint128_t>();
+#else
+  CallGenericTests<i8, u8, i16, u16, i32, u32, i64, u64>();
+#endif
+}
+
+}  // namespace
+
+int main() {
+  TestTypes();
+}
@@ -0,0 +1,430 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef EXPRESSION_H_
+#define EXPRESSION_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <limits>
+#include <type_traits>
+
+#include "is_integral.h"
+#include "ranged.h"
+#include "trap.h"
+#include "trapping.h"
+
+namespace internal {
+
+// The widest type in which an expression can be evaluated. (`uwidest_t` is
+// in is_integral.h.)
+#if defined(INTEGERS_HAVE_INT128)
+using widest_t = integers::int128_t;
+#else
+using widest_t = int64_t;
+#endif
+
+inline constexpr widest_t kWidestMax =
+    static_cast<widest_t>(~uwidest_t{0} >> 1);
+
+/// Returns true if `value` can be represented in `widest_t`.
+template <typename T>
+constexpr bool fits_in_widest(T value) {
+  if constexpr (internal::is_signed_v<T>) {
+    return true;
+  } else {
+    return static_cast<uwidest_t>(value) <= static_cast<uwidest_t>(kWidestMax);
+  }
+}
+
+/// Returns true if `value` can be represented as an `R`.
+template <typename R, typename W>
+constexpr bool wide_in_range(W value) {
+  if (value < 0) {
+    if constexpr (internal::is_signed_v<R>) {
+      return value >= static_cast<W>(std::numeric_limits<R>::min());
+    } else {
+      return false;
+    }
+  }
+  return static_cast<uwidest_t>(value) <=
+         static_cast<uwidest_t>(std::numeric_limits<R>::max());
+}
+
+/// The closed interval of values that an expression can have. `valid` is
+/// false if it, or any of its intermediate values, might not fit in
+/// `widest_t`.
+struct interval {
+  widest_t min;
+  widest_t max;
+  bool valid;
+
+  constexpr bool fits_in_64() const {
+    return valid && min >= std::numeric_limits<int64_t>::min() &&
+           max <= std::numeric_limits<int64_t>::max();
+  }
+
+  template <typename R>
+  constexpr bool fits_in() const {
+    return valid && wide_in_range<R>(min) && wide_in_range<R>(max);
+  }
+};
+
+template <typename T>
+constexpr interval make_interval(T min, T max) {
+  if (!fits_in_widest(max)) {
+    return {0, 0, false};
+  }
+  return {static_cast<widest_t>(min), static_cast<widest_t>(max), true};
+}
+
+/// The value of an expression evaluated with a check after each operation,
+/// as a magnitude and a sign, so that it can be anything in (-2^128, 2^128):
+/// neither `int128_t` nor `uint128_t` could hold every operand and result of
+/// the other. 0 is never `negative`.
+struct checked_value {
+  uwidest_t magnitude;
+  bool negative;
+
+  template <typename T>
+  static constexpr checked_value of(T value) {
+    return {unsigned_abs<uwidest_t>(value), is_negative(value)};
+  }
+
+  constexpr checked_value operator-() const {
+    return {magnitude, magnitude != 0 && !negative};
+  }
+};
+
+struct add_op {
+  static constexpr interval bounds(interval a, interval b) {
+    interval r{0, 0, a.valid && b.valid};
+    r.valid &= !__builtin_add_overflow(a.min, b.min, &r.min);
+    r.valid &= !__builtin_add_overflow(a.max, b.max, &r.max);
+    return r;
+  }
+
+  template <typename W>
+  static constexpr W apply(W a, W b) {
+    return a + b;
+  }
+
+  static constexpr checked_value checked(checked_value a, checked_value b) {
+    if (a.negative == b.negative) {
+      checked_value r{0, a.negative};
+      if (__builtin_add_overflow(a.magnitude, b.magnitude, &r.magnitude)) {
+        trap();
+      }
+      return r;
+    }
+    if (a.magnitude >= b.magnitude) {
+      return {a.magnitude - b.magnitude,
+              a.magnitude != b.magnitude && a.negative};
+    }
+    return {b.magnitude - a.magnitude, b.negative};
+  }
+};
+
+struct sub_op {
+  static constexpr interval bounds(interval a, interval b) {
+    interval r{0, 0, a.valid && b.valid};
+    r.valid &= !__builtin_sub_overflow(a.min, b.max, &r.min);
+    r.valid &= !__builtin_sub_overflow(a.max, b.min, &r.max);
+    return r;
+  }
+
+  template <typename W>
+  static constexpr W apply(W a, W b) {
+    return a - b;
+  }
+
+  static constexpr checked_value checked(checked_value a, checked_value b) {
+    return add_op::checked(a, -b);
+  }
+};
+
+struct mul_op {
+  static constexpr interval bounds(interval a, interval b) {
+    widest_t corners[4] = {};
+    bool valid = a.valid && b.valid;
+    valid &= !__builtin_mul_overflow(a.min, b.min, &corners[0]);
+    valid &= !__builtin_mul_overflow(a.min, b.max, &corners[1]);
+    valid &= !__builtin_mul_overflow(a.max, b.min, &corners[2]);
+    valid &= !__builtin_mul_overflow(a.max, b.max, &corners[3]);
+    interval r{corners[0], corners[0], valid};
+    for (widest_t corner : corners) {
+      r.min = corner < r.min ? corner : r.min;
+      r.max = corner > r.max ? corner : r.max;
+    }
+    return r;
+  }
+
+  template <typename W>
+  static constexpr W apply(W a, W b) {
+    return a * b;
+  }
+
+  static constexpr checked_value checked(checked_value a, checked_value b) {
+    checked_value r{0, a.negative != b.negative};
+    if (__builtin_mul_overflow(a.magnitude, b.magnitude, &r.magnitude)) {
+      trap();
+    }
+    r.negative = r.negative && r.magnitude != 0;
+    return r;
+  }
+};
+
+}  // namespace internal
+
+namespace integers {
+
+/// ## Expressions
+///
+/// A chain of `trapping<T>` operations, like the allocation size calculation
+///
+///   trapping<size_t> total = base + count * stride + header;
+///
+/// checks and branches after every operator. An expression instead records
+/// the whole calculation, works out at compile time the range of values that
+/// every intermediate result can have, and then evaluates it in a type wide
+/// enough that nothing can overflow — `int64_t` if that suffices (e.g. for
+/// 32-bit operands), otherwise `__int128` — with a single range check at the
+/// end. If no type is wide enough, it falls back to checking each operation,
+/// on magnitudes up to 128 bits and a sign, so that the result is still exact
+/// for any `int128_t` or `uint128_t` operand or result.
+///
+/// To use it, wrap the first operand in `expr`:
+///
+///   size_t total = expr(base) + expr(count) * constant<sizeof(Friend)> +
+///                  constant<kHeader>;
+///
+/// An operand can be:
+///
+/// * an integer or `trapping<T>`, which can have any value of its type;
+/// * a `ranged<T, Min, Max>`, which has the range [`Min`, `Max`]; or
+/// * a `constant<V>`, which has exactly the value `V`.
+///
+/// The tighter the operands’ ranges, the more likely that a narrow type
+/// suffices. For example, the product of two arbitrary `size_t`s does not fit
+/// in `__int128`, but a `size_t` times a constant does.
+///
+/// Wrap `trapping<T>` operands in `expr`, too (`trapping<T>`’s own operators
+/// would otherwise take precedence). Expressions support `+`, `-`, and `*`.
+/// Converting an expression to an integer type or to `trapping<T>` evaluates
+/// it, and `trap`s if the result does not fit. Everything is `constexpr`.
+///
+/// ### `expression`
+///
+/// The base of all expression types.
+template <typename E>
+class expression {
+ public:
+  /// ### `value`
+  ///
+  /// Evaluates the expression and returns the result as an `R`. `trap`s if
+  /// the result cannot be represented as an `R`.
+  template <typename R>
+  constexpr R value() const {
+    assert_is_integral(R);
+    const E& self = static_cast<const E&>(*this);
+    if constexpr (E::kFitsIn64) {
+      return finish<R>(self.template evaluate<int64_t>());
+    } else if constexpr (E::kValid) {
+      return finish<R>(self.template evaluate<internal::widest_t>());
+    } else {
+      const internal::checked_value result = self.evaluate_checked();
+      R r = 0;
+      if (internal::cast_magnitude(result.magnitude, result.negative, &r)) {
+        trap();
+      }
+      return r;
+    }
+  }
+
+  /// ### `operator R`
+  ///
+  /// Evaluates the expression. `trap`s if the result cannot be represented as
+  /// an `R`.
+  template <typename R,
+            std::enable_if_t<internal::is_integral_v<R>, int> = 0>
+  constexpr operator R() const {
+    return value<R>();
+  }
+
+  /// ### `operator trapping<T>`
+  ///
+  /// Evaluates the expression. `trap`s if the result cannot be represented as
+  /// a `T`.
+  template <typename T>
+  constexpr operator trapping<T>() const {
+    return trapping<T>(value<T>());
+  }
+
+ private:
+  template <typename R, typename W>
+  static constexpr R finish(W result) {
+    // If every possible result fits in `R`, there is nothing to check.
+    if constexpr (!E::kBounds.template fits_in<R>()) {
+      if (!internal::wide_in_range<R>(result)) {
+        trap();
+      }
+    }
+    return static_cast<R>(result);
+  }
+};
+
+}  // namespace integers
+
+namespace internal {
+
+template <typename T>
+struct is_expression : std::is_base_of<integers::expression<T>, T> {};
+
+/// An operand, whose value is in [`Min`, `Max`].
+template <typename T, T Min, T Max>
+struct leaf : integers::expression<leaf<T, Min, Max>> {
+  static constexpr interval kBounds = make_interval(Min, Max);
+  static constexpr bool kValid = kBounds.valid;
+  static constexpr bool kFitsIn64 = kBounds.fits_in_64();
+
+  constexpr explicit leaf(T v) : value(v) {}
+
+  template <typename W>
+  constexpr W evaluate() const {
+    return static_cast<W>(value);
+  }
+
+  constexpr checked_value evaluate_checked() const {
+    return checked_value::of(value);
+  }
+
+  T value;
+};
+
+/// An operation on two sub-expressions.
+template <typename Op, typename L, typename R>
+struct node : integers::expression<node<Op, L, R>> {
+  static constexpr interval kBounds = Op::bounds(L::kBounds, R::kBounds);
+  static constexpr bool kValid = kBounds.valid;
+  static constexpr bool kFitsIn64 =
+      L::kFitsIn64 && R::kFitsIn64 && kBounds.fits_in_64();
+
+  constexpr node(L l, R r) : lhs(l), rhs(r) {}
+
+  // Only called when `kBounds` shows that no intermediate value can overflow
+  // `W`.
+  template <typename W>
+  constexpr W evaluate() const {
+    return Op::template apply<W>(lhs.template evaluate<W>(),
+                                 rhs.template evaluate<W>());
+  }
+
+  constexpr checked_value evaluate_checked() const {
+    return Op::checked(lhs.evaluate_checked(), rhs.evaluate_checked());
+  }
+
+  L lhs;
+  R rhs;
+};
+
+template <typename T>
+constexpr auto as_expression(T x) {
+  if constexpr (is_expression<T>::value) {
+    return x;
+  } else {
+    assert_is_integral(T);
+    return leaf<T, std::numeric_limits<T>::min(),
+                std::numeric_limits<T>::max()>(x);
+  }
+}
+
+template <typename T>
+constexpr auto as_expression(integers::trapping<T> x) {
+  return as_expression(static_cast<T>(x));
+}
+
+template <typename T, T Min, T Max>
+constexpr auto as_expression(integers::ranged<T, Min, Max> x) {
+  return leaf<T, Min, Max>(static_cast<T>(x));
+}
+
+template <typename T, T V>
+constexpr auto as_expression(std::integral_constant<T, V>) {
+  return leaf<T, V, V>(V);
+}
+
+template <typename Op, typename L, typename R>
+constexpr auto make_node(L lhs, R rhs) {
+  auto l = as_expression(lhs);
+  auto r = as_expression(rhs);
+  return node<Op, decltype(l), decltype(r)>(l, r);
+}
+
+template <typename L, typename R>
+constexpr bool either_is_expression =
+    is_expression<L>::value || is_expression<R>::value;
+
+}  // namespace internal
+
+namespace integers {
+
+/// ### `constant`
+///
+/// A compile-time constant operand, e.g. `constant<sizeof(Header)>`.
+template <auto V>
+constexpr std::integral_constant<decltype(V), V> constant{};
+
+/// ### `expr`
+///
+/// Starts an expression with `x`, which can be any of the operand types
+/// described above.
+template <typename T>
+constexpr auto expr(T x) {
+  return internal::as_expression(x);
+}
+
+/// ### `operator+`
+///
+/// Returns an expression that adds `rhs` to `lhs`.
+template <typename L,
+          typename R,
+          std::enable_if_t<internal::either_is_expression<L, R>, int> = 0>
+constexpr auto operator+(L lhs, R rhs) {
+  return internal::make_node<internal::add_op>(lhs, rhs);
+}
+
+/// ### `operator-`
+///
+/// Returns an expression that subtracts `rhs` from `lhs`.
+template <typename L,
+          typename R,
+          std::enable_if_t<internal::either_is_expression<L, R>, int> = 0>
+constexpr auto operator-(L lhs, R rhs) {
+  return internal::make_node<internal::sub_op>(lhs, rhs);
+}
+
+/// ### `operator*`
+///
+/// Returns an expression that multiplies `lhs` by `rhs`.
+template <typename L,
+          typename R,
+          std::enable_if_t<internal::either_is_expression<L, R>, int> = 0>
+constexpr auto operator*(L lhs, R rhs) {
+  return internal::make_node<internal::mul_op>(lhs, rhs);
+}
+
+}  // namespace integers
+
+#endif  // EXPRESSION_H_
@@ -0,0 +1,148 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <limits>
+#include <type_traits>
+
+#include "expression.h"
+#include "test_support.h"
+
+using namespace integers;
+using namespace std;
+
+namespace {
+
+using i8 = int8_t;
+using u8 = uint8_t;
+using i32 = int32_t;
+using u32 = uint32_t;
+using i64 = int64_t;
+using u64 = uint64_t;
+
+constexpr u32 u32_max = numeric_limits<u32>::max();
+constexpr i64 i64_max = numeric_limits<i64>::max();
+constexpr i64 i64_min = numeric_limits<i64>::min();
+constexpr u64 u64_max = numeric_limits<u64>::max();
+
+// 32-bit operands and small constants evaluate in `int64_t`.
+static_assert(decltype(expr(u32{}) * constant<48U> + constant<16U>)::kFitsIn64);
+static_assert(decltype(expr(i32{}) * expr(i32{}))::kFitsIn64);
+static_assert(!decltype(expr(u32{}) * expr(u32{}) + expr(u32{}))::kFitsIn64);
+
+// A `size_t` times a constant needs `__int128`; two arbitrary `size_t`s do not
+// fit even in that.
+#ifdef __SIZEOF_INT128__
+static_assert(
+    decltype(expr(u64{}) * constant<48ULL> + constant<16ULL>)::kValid);
+static_assert(!decltype(expr(u64{}) * expr(u64{}))::kValid);
+#endif
+
+// The bounds of `ranged` operands are used.
+static_assert(decltype(expr(ranged<i64, 0, 1000>{}) *
+                       expr(ranged<i64, -1000, 1000>{}))::kFitsIn64);
+
+// Expressions are `constexpr`.
+static_assert(static_cast<u8>(expr(u8{200}) + u8{100} - 50) == 250);
+
+void TestFinalCheck() {
+  // Intermediate values need not fit in the result type; only the result
+  // must.
+  {
+    const u8 x = 200;
+    const u8 y = 100;
+    EXPECT((static_cast<u8>(expr(x) + y - 50)) == 250);
+    EXPECT_DEATH((void)(static_cast<u8>(expr(x) + y - 40)));
+  }
+  {
+    const u32 a = 3;
+    const u32 b = 5;
+    EXPECT((static_cast<u32>(expr(a) - b + 10)) == 8);
+    EXPECT_DEATH((void)(static_cast<u32>(expr(a) - b)));
+    EXPECT((static_cast<i32>(expr(a) - b)) == -2);
+  }
+}
+
+void TestAllocationSize() {
+  constexpr size_t kStride = 5128;
+  constexpr size_t kHeader = 16;
+  auto total = [](size_t count) -> size_t {
+    return expr(count) * constant<kStride> + constant<kHeader>;
+  };
+  EXPECT(total(0) == kHeader);
+  EXPECT(total(1000) == 1000 * kStride + kHeader);
+  const size_t limit = (u64_max - kHeader) / kStride;
+  EXPECT(total(limit) == limit * kStride + kHeader);
+  EXPECT_DEATH((void)total(limit + 1));
+  EXPECT_DEATH((void)total(u64_max));
+}
+
+void TestFallback() {
+  // No type can hold every possible product of two `u64`s, so these check
+  // each operation.
+  {
+    const u64 a = u32_max;
+    const u64 b = u32_max;
+    EXPECT((static_cast<u64>(expr(a) * b)) == u64{u32_max} * u32_max);
+  }
+  {
+    const u64 a = u64_max;
+    const u64 b = u64_max;
+    EXPECT_DEATH((void)(static_cast<u64>(expr(a) * b)));
+    EXPECT_DEATH((void)(static_cast<u64>(expr(a) * b * a * 0)));
+    // The product fits in 128 bits, so it is exact.
+    EXPECT((static_cast<u64>(expr(a) * b * 0)) == 0);
+  }
+  {
+    const i64 a = i64_min;
+    EXPECT((static_cast<i64>(expr(a) * i64{-1} - 1)) == i64_max);
+  }
+#ifdef __SIZEOF_INT128__
+  {
+    // Operands and results beyond `int128_t`’s range are exact, too.
+    constexpr uint128_t kTop = uint128_t{1} << 127;
+    EXPECT(((expr(kTop | 1) - constant<uint128_t{1}>).value<uint128_t>()) ==
+           kTop);
+    EXPECT((static_cast<uint128_t>(expr(kTop) - 1 + kTop)) == ~uint128_t{0});
+    EXPECT((static_cast<int128_t>(expr(kTop) * i8{-1})) ==
+           numeric_limits<int128_t>::min());
+    EXPECT((static_cast<int128_t>(expr(i8{-1}) - kTop + kTop)) == -1);
+    EXPECT_DEATH((void)(static_cast<int128_t>(expr(kTop) + 0)));
+    EXPECT_DEATH((void)(static_cast<uint128_t>(expr(kTop) + kTop)));
+  }
+#endif
+}
+
+void TestTrapping() {
+  const trapping<size_t> count = size_t{10};
+  const trapping<size_t> stride = size_t{48};
+  trapping<size_t> total = expr(count) * expr(stride) + constant<size_t{16}>;
+  EXPECT(total == 496U);
+}
+
+void TestRanged() {
+  const ranged<i32, 0, 100> percent = 75;
+  EXPECT((static_cast<i32>(expr(percent) * 1000)) == 75000);
+  EXPECT((static_cast<i8>(expr(percent) - constant<i32{100}>)) == -25);
+}
+
+}  // namespace
+
+int main() {
+  TestFinalCheck();
+  TestAllocationSize();
+  TestFallback();
+  TestTrapping();
+  TestRanged();
+}
@@ -0,0 +1,283 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <limits>
+#include <vector>
+
+#include "fixed.h"
+#include "test_support.h"
+
+using namespace integers;
+using namespace std;
+
+namespace {
+
+// `std::fixed` is an iostream manipulator.
+using integers::fixed;
+
+using i8 = int8_t;
+using u8 = uint8_t;
+using i16 = int16_t;
+using i32 = int32_t;
+using u32 = uint32_t;
+using i64 = int64_t;
+
+using q7 = fixed<i8, 7>;
+using q7_sat = fixed<i8, 7, saturate_policy>;
+using q15 = fixed<i16, 15, saturate_policy>;
+using q16_16 = fixed<i32, 16>;
+using uq4_4 = fixed<u8, 4>;
+using uq4_4_sat = fixed<u8, 4, saturate_policy>;
+
+// Literals and arithmetic are `constexpr`.
+static_assert(q15{0.5} * q15{0.75} == q15{0.375});
+static_assert(q16_16{3.25}.raw() == 0x34000);
+static_assert(q16_16{-1.5}.raw() == -0x18000);
+static_assert(q16_16{2} / q16_16{8} == q16_16{0.25});
+static_assert(q15{2.0} == q15::from_raw(numeric_limits<i16>::max()));
+static_assert(q16_16{1}.raw() == 0x10000);
+
+static_assert(is_trivial_v<q16_16>);
+static_assert(sizeof(q7) == sizeof(i8));
+static_assert(sizeof(fixed<i64, 32>) == sizeof(i64));
+
+void TestConstructor() {
+  EXPECT(q16_16{7}.raw() == 7 << 16);
+  EXPECT(q16_16{-7}.to_integer() == -7);
+  EXPECT(uq4_4{15}.raw() == 0xf0);
+  EXPECT_DEATH((void)uq4_4{16});
+  EXPECT_DEATH((void)uq4_4{-1});
+  EXPECT(uq4_4_sat{16}.raw() == 0xff);
+  EXPECT(uq4_4_sat{-1}.raw() == 0);
+  // Q7 and Q15 cannot represent 1.
+  EXPECT(q7{-1}.raw() == -128);
+  EXPECT_DEATH((void)q7{1});
+  EXPECT(q15{1} == q15::from_raw(numeric_limits<i16>::max()));
+
+  // Doubles round to nearest, ties away from 0.
+  EXPECT(q7{0.5}.raw() == 64);
+  EXPECT(q7{1.0 / 256}.raw() == 1);
+  EXPECT(q7{-1.0 / 256}.raw() == -1);
+  EXPECT(q7{1.0 / 512}.raw() == 0);
+  EXPECT(q7{-1.0}.raw() == -128);
+  EXPECT(q7{-1.0 - 1.0 / 256 + 1.0 / 1024}.raw() == -128);
+  EXPECT_DEATH((void)q7{-1.0 - 1.0 / 256});
+  EXPECT(q7{1.0 - 1.0 / 128}.raw() == 127);
+  EXPECT_DEATH((void)q7{1.0 - 1.0 / 256});
+  EXPECT(q7_sat{5.0}.raw() == 127);
+  EXPECT(q7_sat{-5.0}.raw() == -128);
+  EXPECT(q7_sat{1e300}.raw() == 127);
+  EXPECT(uq4_4_sat{-0.01}.raw() == 0);
+  EXPECT(uq4_4_sat{-5.0}.raw() == 0);
+  EXPECT_DEATH((void)q7_sat{numeric_limits<double>::quiet_NaN()});
+
+  // At the ends of a 64-bit type, where min - 1 and max are not doubles.
+  using q63_0 = fixed<i64, 0>;
+  EXPECT(q63_0{-9223372036854775808.0}.raw() == numeric_limits<i64>::min());
+  EXPECT_DEATH((void)q63_0{9223372036854775808.0});
+  EXPECT((fixed<i64, 0, saturate_policy>{1e19}.raw() ==
+          numeric_limits<i64>::max()));
+}
+
+void TestAddSub() {
+  EXPECT(q16_16{1.5} + q16_16{2.25} == q16_16{3.75});
+  EXPECT(q16_16{1.5} - q16_16{2.25} == q16_16{-0.75});
+  EXPECT(-q16_16{1.5} == q16_16{-1.5});
+  EXPECT_DEATH((void)(q7{0.75} + q7{0.5}));
+  EXPECT(q15{0.75} + q15{0.5} == q15::from_raw(numeric_limits<i16>::max()));
+  EXPECT(-q15{-1.0} == q15::from_raw(numeric_limits<i16>::max()));
+  EXPECT_DEATH((void)-q7{-1.0});
+  EXPECT_DEATH((void)(uq4_4{1} - uq4_4{2}));
+}
+
+// The product, rounded to nearest with ties toward positive infinity.
+template <int FracBits>
+i64 ReferenceProduct(i64 x, i64 y) {
+  const i64 p = x * y;
+  const i64 floor = p >= 0 ? p >> FracBits : -((-p - 1) >> FracBits) - 1;
+  const i64 remainder = p - floor * (i64{1} << FracBits);
+  return remainder * 2 >= (i64{1} << FracBits) ? floor + 1 : floor;
+}
+
+template <typename F, int FracBits>
+void GenericTestExhaustiveMul() {
+  using T = decltype(F{}.raw());
+  constexpr i64 min = numeric_limits<T>::min();
+  constexpr i64 max = numeric_limits<T>::max();
+  using Sat = fixed<T, FracBits, saturate_policy>;
+  using Wrap = fixed<T, FracBits, wrap_policy>;
+  for (i64 a = min; a <= max; a++) {
+    for (i64 b = min; b <= max; b++) {
+      const T x = static_cast<T>(a);
+      const T y = static_cast<T>(b);
+      const i64 expected = ReferenceProduct<FracBits>(a, b);
+      const i64 clamped =
+          expected < min ? min : expected > max ? max : expected;
+      EXPECT((Sat::from_raw(x) * Sat::from_raw(y)).raw() == clamped);
+      EXPECT((Wrap::from_raw(x) * Wrap::from_raw(y)).raw() ==
+             static_cast<T>(expected));
+      if (expected == clamped) {
+        EXPECT((F::from_raw(x) * F::from_raw(y)).raw() == expected);
+      }
+    }
+  }
+}
+
+void TestMul() {
+  EXPECT(q16_16{1.5} * q16_16{-2.25} == q16_16{-3.375});
+  EXPECT(q16_16{1.5} * 3 == q16_16{4.5});
+  EXPECT(3 * q16_16{1.5} == q16_16{4.5});
+  // Ties round toward positive infinity.
+  EXPECT((q7::from_raw(1) * q7{0.5}).raw() == 1);
+  EXPECT((q7::from_raw(-1) * q7{0.5}).raw() == 0);
+  EXPECT((q7::from_raw(3) * q7{0.5}).raw() == 2);
+  EXPECT_DEATH((void)(q7{-1.0} * q7{-1.0}));
+  EXPECT(q15{-1.0} * q15{-1.0} == q15::from_raw(numeric_limits<i16>::max()));
+  EXPECT_DEATH((void)(q16_16{30000} * q16_16{2}));
+  EXPECT_DEATH((void)(q16_16{30000} * 2));
+
+  using q32_32 = fixed<i64, 32>;
+  EXPECT(q32_32{-1.25} * q32_32{1e5} == q32_32{-1.25e5});
+  EXPECT_DEATH((void)(q32_32{1e5} * q32_32{1e5}));
+
+  GenericTestExhaustiveMul<q7, 7>();
+  GenericTestExhaustiveMul<fixed<i8, 3>, 3>();
+  GenericTestExhaustiveMul<fixed<i8, 0>, 0>();
+  GenericTestExhaustiveMul<uq4_4, 4>();
+  GenericTestExhaustiveMul<fixed<u8, 7>, 7>();
+}
+
+void TestDiv() {
+  EXPECT(q16_16{3} / q16_16{4} == q16_16{0.75});
+  EXPECT(q16_16{-3} / q16_16{4} == q16_16{-0.75});
+  EXPECT(q16_16{3} / 4 == q16_16{0.75});
+  // Truncates toward 0.
+  EXPECT((q16_16::from_raw(1) / q16_16{2}).raw() == 0);
+  EXPECT((q16_16::from_raw(-1) / q16_16{2}).raw() == 0);
+  EXPECT_DEATH((void)(q16_16{1} / q16_16{0}));
+  EXPECT_DEATH((void)(q16_16{1} / 0));
+  EXPECT_DEATH((void)(q7{0.5} / q7{0.25}));
+  EXPECT(q15{0.5} / q15{0.25} == q15::from_raw(numeric_limits<i16>::max()));
+  EXPECT(q15{-0.5} / q15{0.25} == q15{-1.0});
+  EXPECT(q15{-1.0} / -1 == q15::from_raw(numeric_limits<i16>::max()));
+}
+
+void TestComparison() {
+  EXPECT(q16_16{1.5} < q16_16{2});
+  EXPECT(q16_16{-1.5} <= q16_16{-1.5});
+  EXPECT(q16_16{2} > q16_16{-2});
+  EXPECT(q16_16{2} >= q16_16{2});
+  EXPECT(q16_16{2} != q16_16{2.5});
+  EXPECT(q16_16{2}.to_integer() == 2);
+  EXPECT(q16_16{-2.5}.to_double() < -2.4999);
+  EXPECT(q16_16{-2.5}.to_double() > -2.5001);
+  EXPECT(q16_16{-2.5}.to_integer() == -3);
+}
+
+template <typename F>
+vector<F> FromRaw(const vector<i64>& raw) {
+  vector<F> result;
+  for (const i64 r : raw) {
+    result.push_back(F::from_raw(static_cast<decltype(F{}.raw())>(r)));
+  }
+  return result;
+}
+
+void TestBatch() {
+  // More than a block, so that both the block loop and the remainder run.
+  constexpr size_t kCount = 1000;
+  vector<i64> raw_x(kCount);
+  vector<i64> raw_y(kCount);
+  for (size_t i = 0; i < kCount; i++) {
+    raw_x[i] = static_cast<i16>(i * 2654435761U);
+    raw_y[i] = static_cast<i16>(i * 40503U);
+  }
+
+  {
+    const vector<q15> x = FromRaw<q15>(raw_x);
+    const vector<q15> y = FromRaw<q15>(raw_y);
+    vector<q15> r(kCount);
+    fixed_mul_n(x.data(), y.data(), r.data(), kCount);
+    vector<q15> acc = y;
+    fixed_mac_n(x.data(), y.data(), acc.data(), kCount);
+    bool all_equal = true;
+    for (size_t i = 0; i < kCount; i++) {
+      all_equal = all_equal && r[i] == x[i] * y[i];
+      // 1 rounding, and 1 clamp at the end.
+      const i64 sum = raw_y[i] + ReferenceProduct<15>(raw_x[i], raw_y[i]);
+      const i64 clamped = sum < -32768 ? -32768 : sum > 32767 ? 32767 : sum;
+      all_equal = all_equal && acc[i].raw() == clamped;
+    }
+    EXPECT(all_equal);
+  }
+
+  {
+    using F = fixed<i32, 20>;
+    vector<F> x(kCount, F{1.5});
+    vector<F> y(kCount, F{-2.25});
+    vector<F> acc(kCount, F{10});
+    fixed_mac_n(x.data(), y.data(), acc.data(), kCount);
+    EXPECT(acc[0] == F{6.625} && acc[kCount - 1] == F{6.625});
+    fixed_mul_n(x.data(), y.data(), x.data(), kCount);
+    EXPECT(x[0] == F{-3.375} && x[kCount - 1] == F{-3.375});
+    y[kCount - 1] = F{1000};
+    EXPECT_DEATH(fixed_mul_n(y.data(), y.data(), x.data(), kCount));
+    EXPECT_DEATH(fixed_mac_n(y.data(), y.data(), acc.data(), kCount));
+  }
+
+  {
+    using F = fixed<u32, 16, wrap_policy>;
+    vector<F> x(3, F{0x8000});
+    vector<F> r(3);
+    fixed_mul_n(x.data(), x.data(), r.data(), 3);
+    EXPECT(r[2].raw() == 0);
+  }
+
+#ifdef __cpp_lib_span
+  {
+    const vector<q15> x(17, q15{0.5});
+    vector<q15> acc(17, q15{0.25});
+    fixed_mac_n(span<const q15>(x), span<const q15>(x), span<q15>(acc));
+    EXPECT(acc[16] == q15{0.5});
+    vector<q15> r(16);
+    EXPECT_DEATH(
+        fixed_mul_n(span<const q15>(x), span<const q15>(x), span<q15>(r)));
+
+    // Containers, and spans of non-`const` elements, convert too.
+    vector<q15> y(16, q15{0.5});
+    fixed_mul_n(y, y, r);
+    EXPECT(r[15] == q15{0.25});
+    fixed_mac_n(span(y), y, span(r));
+    EXPECT(r[15] == q15{0.5});
+    q15 products[16];
+    fixed_mul_n(r, y, products);
+    EXPECT(products[15] == q15{0.25});
+    EXPECT_DEATH(fixed_mac_n(x, y, r));
+  }
+#endif
+}
+
+}  // namespace
+
+int main() {
+  TestConstructor();
+  TestAddSub();
+  TestMul();
+  TestDiv();
+  TestComparison();
+  TestBatch();
+}
@@ -0,0 +1,244 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FORMAT_H_
+#define FORMAT_H_
+
+#include <stdint.h>
+
+#include <charconv>
+#include <system_error>
+#include <type_traits>
+
+#if __has_include(<version>)
+#include <version>
+#endif
+#if defined(__cpp_lib_format)
+#include <format>
+#endif
+
+#include "is_integral.h"
+
+namespace integers {
+
+template <typename T>
+class trapping;
+template <typename T>
+class wrapping;
+template <typename T>
+class clamping;
+template <typename T, T Min, T Max>
+class ranged;
+template <typename T, typename Policy>
+class integer;
+
+}  // namespace integers
+
+namespace internal {
+
+// `formattable<C>` describes how to get the value of an object of 1 of the
+// class templates in this library, for formatting: `value_type` is the
+// integral type it holds, and `get` returns the value.
+template <typename C>
+struct formattable {
+  static constexpr bool value = false;
+};
+
+template <typename T>
+struct formattable<integers::trapping<T>> {
+  static constexpr bool value = true;
+  using value_type = T;
+  static constexpr T get(integers::trapping<T> x) { return static_cast<T>(x); }
+};
+
+template <typename T>
+struct formattable<integers::wrapping<T>> {
+  static constexpr bool value = true;
+  using value_type = T;
+  static constexpr T get(integers::wrapping<T> x) { return static_cast<T>(x); }
+};
+
+template <typename T>
+struct formattable<integers::clamping<T>> {
+  static constexpr bool value = true;
+  using value_type = T;
+  static constexpr T get(integers::clamping<T> x) { return static_cast<T>(x); }
+};
+
+template <typename T, T Min, T Max>
+struct formattable<integers::ranged<T, Min, Max>> {
+  static constexpr bool value = true;
+  using value_type = T;
+  static constexpr T get(integers::ranged<T, Min, Max> x) {
+    return static_cast<T>(x);
+  }
+};
+
+template <typename T, typename Policy>
+struct formattable<integers::integer<T, Policy>> {
+  static constexpr bool value = true;
+  using value_type = T;
+  // `value` `trap`s if a sticky overflow flag is set.
+  static constexpr T get(integers::integer<T, Policy> x) { return x.value(); }
+};
+
+#if defined(INTEGERS_HAVE_INT128)
+// Writes `value` in `base`, as `std::to_chars` would if it accepted 128-bit
+// integers (which it does not, in strict standard modes). Splits `value` into
+// chunks that fit in 64 bits, and converts those with `std::to_chars`.
+inline std::to_chars_result to_chars_128(char* first,
+                                         char* last,
+                                         integers::uint128_t value,
+                                         int base) {
+  if (value <= UINT64_MAX) {
+    return std::to_chars(first, last, static_cast<uint64_t>(value), base);
+  }
+
+  // `chunk` is the largest power of `base` that fits in 64 bits, and the low
+  // chunk of `value` has `digits` digits in `base`, with leading zeros.
+  const uint64_t b = static_cast<uint64_t>(base);
+  uint64_t chunk = b;
+  int digits = 1;
+  while (chunk <= UINT64_MAX / b) {
+    chunk *= b;
+    ++digits;
+  }
+  const std::to_chars_result high =
+      to_chars_128(first, last, value / chunk, base);
+  if (high.ec != std::errc{}) {
+    return high;
+  }
+  if (last - high.ptr < digits) {
+    return {last, std::errc::value_too_large};
+  }
+  char low[64];
+  const std::to_chars_result r =
+      std::to_chars(low, low + sizeof(low),
+                    static_cast<uint64_t>(value % chunk), base);
+  const ptrdiff_t length = r.ptr - low;
+  char* p = high.ptr;
+  for (ptrdiff_t i = length; i < digits; ++i) {
+    *p++ = '0';
+  }
+  for (ptrdiff_t i = 0; i < length; ++i) {
+    *p++ = low[i];
+  }
+  return {p, std::errc{}};
+}
+#endif
+
+// Like `std::to_chars`, but also for 128-bit integers.
+template <typename T>
+std::to_chars_result to_chars(char* first, char* last, T value, int base) {
+  assert_is_integral(T);
+  if constexpr (sizeof(T) <= sizeof(uint64_t)) {
+    return std::to_chars(first, last, value, base);
+  } else {
+#if defined(INTEGERS_HAVE_INT128)
+    auto magnitude = static_cast<integers::uint128_t>(value);
+    if constexpr (is_signed_v<T>) {
+      if (value < 0) {
+        if (first == last) {
+          return {last, std::errc::value_too_large};
+        }
+        *first++ = '-';
+        magnitude = 0 - magnitude;
+      }
+    }
+    return to_chars_128(first, last, magnitude, base);
+#endif
+  }
+}
+
+}  // namespace internal
+
+namespace integers {
+
+/// ## Formatting
+///
+/// ### `to_chars`
+///
+/// Writes the value of a `trapping<T>`, `wrapping<T>`, `clamping<T>`,
+/// `ranged<T, Min, Max>`, or `integer<T, Policy>` into [`first`, `last`), in
+/// `base`, like `std::to_chars` (which this calls). It does not allocate,
+/// use the locale, or throw. Returns a pointer to the end of the characters
+/// written, or, if they don’t fit, `last` and `std::errc::value_too_large`.
+///
+/// Unlike `std::to_chars`, this also works with 128-bit integers.
+///
+///   char buffer[32];
+///   const auto [end, error] = to_chars(buffer, buffer + 32, count);
+///
+/// ### `std::formatter`
+///
+/// If the standard library has `std::format` (C++20), these types are also
+/// formattable, with the same format specifications as `T`:
+///
+///   std::format("{} bytes, {:#x}", size, flags);
+///
+/// To write them to `std::ostream`s, include ostream.h. (None of the class
+/// headers include `<ostream>`.)
+template <typename C,
+          std::enable_if_t<internal::formattable<C>::value, int> = 0>
+std::to_chars_result to_chars(char* first,
+                              char* last,
+                              C value,
+                              int base = 10) {
+  return internal::to_chars(first, last, internal::formattable<C>::get(value),
+                            base);
+}
+
+}  // namespace integers
+
+#if defined(__cpp_lib_format)
+namespace internal {
+
+template <typename C, typename CharT>
+struct formatter
+    : std::formatter<typename formattable<C>::value_type, CharT> {
+  template <typename FormatContext>
+  auto format(C value, FormatContext& context) const {
+    return std::formatter<typename formattable<C>::value_type,
+                          CharT>::format(formattable<C>::get(value), context);
+  }
+};
+
+}  // namespace internal
+
+namespace std {
+
+template <typename T, typename CharT>
+struct formatter<integers::trapping<T>, CharT>
+    : internal::formatter<integers::trapping<T>, CharT> {};
+
+template <typename T, typename CharT>
+struct formatter<integers::wrapping<T>, CharT>
+    : internal::formatter<integers::wrapping<T>, CharT> {};
+
+template <typename T, typename CharT>
+struct formatter<integers::clamping<T>, CharT>
+    : internal::formatter<integers::clamping<T>, CharT> {};
+
+template <typename T, T Min, T Max, typename CharT>
+struct formatter<integers::ranged<T, Min, Max>, CharT>
+    : internal::formatter<integers::ranged<T, Min, Max>, CharT> {};
+
+template <typename T, typename Policy, typename CharT>
+struct formatter<integers::integer<T, Policy>, CharT>
+    : internal::formatter<integers::integer<T, Policy>, CharT> {};
+
+}  // namespace std
+#endif
+
+#endif  // FORMAT_H_
@@ -0,0 +1,189 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include "clamping.h"
+#include "format.h"
+#include "integer.h"
+#include "ostream.h"
+#include "ranged.h"
+#include "test_support.h"
+#include "trapping.h"
+#include "wrapping.h"
+
+using namespace integers;
+using namespace std;
+
+namespace {
+
+using i8 = int8_t;
+using u8 = uint8_t;
+using i16 = int16_t;
+using u16 = uint16_t;
+using i32 = int32_t;
+using u32 = uint32_t;
+using i64 = int64_t;
+using u64 = uint64_t;
+
+// Returns the result of `to_chars`, or "error" if it failed.
+template <typename C>
+string ToChars(C value, int base = 10, size_t size = 160) {
+  char buffer[160];
+  const to_chars_result r = integers::to_chars(buffer, buffer + size, value,
+                                               base);
+  if (r.ec != errc{}) {
+    return r.ptr == buffer + size ? "error" : "bad pointer";
+  }
+  return string(buffer, r.ptr);
+}
+
+template <typename C>
+string Stream(C value) {
+  ostringstream os;
+  os << value;
+  return os.str();
+}
+
+template <typename T>
+void GenericTestToChars() {
+  constexpr T max = numeric_limits<T>::max();
+  constexpr T min = numeric_limits<T>::min();
+  EXPECT(ToChars(trapping<T>{max}) == to_string(max));
+  EXPECT(ToChars(trapping<T>{min}) == to_string(min));
+  EXPECT(ToChars(wrapping<T>{max} + T{1}) == to_string(min));
+  EXPECT(ToChars(clamping<T>{max} + T{1}) == to_string(max));
+  EXPECT(ToChars(integer<T, trap_policy>{T{42}}) == "42");
+  EXPECT(ToChars(ranged<T, T{0}, T{100}>{T{99}}) == "99");
+  EXPECT(ToChars(trapping<T>{T{0}}) == "0");
+  EXPECT(ToChars(trapping<T>{T{0x7b}}, 16) == "7b");
+  EXPECT(ToChars(trapping<T>{T{5}}, 2) == "101");
+  // Too small a buffer.
+  EXPECT(ToChars(trapping<T>{T{100}}, 10, 2) == "error");
+}
+
+template <class... T>
+void CallGenericTestToChars() {
+  (GenericTestToChars<T>(), ...);
+}
+
+void TestToChars() {
+  CallGenericTestToChars<i8, u8, i16, u16, i32, u32, i64, u64>();
+  // Any unqualified call finds the right overload, even with `std::to_chars`
+  // visible.
+  char buffer[8];
+  const auto [end, error] = to_chars(buffer, buffer + 8, trapping<int>{-12});
+  EXPECT(error == errc{});
+  EXPECT(string(buffer, end) == "-12");
+}
+
+void TestOstream() {
+  EXPECT(Stream(trapping<i32>{-7}) == "-7");
+  EXPECT(Stream(wrapping<u16>{u16{65535}} + 1) == "0");
+  EXPECT(Stream(clamping<i64>{numeric_limits<i64>::max()} * 2) ==
+         "9223372036854775807");
+  EXPECT(Stream(ranged<int, 0, 256>{42}) == "42");
+  EXPECT(Stream(integer<u32, wrap_policy>{0U} - 1U) == "4294967295");
+  // Exactly as for a plain `T`, including stream flags and 8-bit types.
+  EXPECT(Stream(trapping<u8>{u8{'A'}}) == "A");
+  ostringstream os;
+  os << hex << trapping<u32>{255U};
+  EXPECT(os.str() == "ff");
+  using sticky_u8 = integer<u8, sticky_policy>;
+  EXPECT_DEATH(cout << sticky_u8{u8{255}} + 1);
+}
+
+#if defined(INTEGERS_HAVE_INT128)
+void TestInt128() {
+  constexpr uint128_t u128_max = numeric_limits<uint128_t>::max();
+  constexpr int128_t i128_max = numeric_limits<int128_t>::max();
+  constexpr int128_t i128_min = numeric_limits<int128_t>::min();
+  EXPECT(ToChars(trapping<uint128_t>{u128_max}) ==
+         "340282366920938463463374607431768211455");
+  EXPECT(ToChars(trapping<int128_t>{i128_max}) ==
+         "170141183460469231731687303715884105727");
+  EXPECT(ToChars(trapping<int128_t>{i128_min}) ==
+         "-170141183460469231731687303715884105728");
+  EXPECT(ToChars(trapping<uint128_t>{u128_max}, 16) ==
+         "ffffffffffffffffffffffffffffffff");
+  EXPECT(ToChars(trapping<uint128_t>{uint128_t{1} << 64}, 16) ==
+         "10000000000000000");
+  EXPECT(ToChars(trapping<uint128_t>{uint128_t{1} << 64}) ==
+         "18446744073709551616");
+  // Leading zeros in the low chunks.
+  EXPECT(ToChars(trapping<uint128_t>{uint128_t{10000000000000000000ULL} *
+                                     10000000000000000000ULL}) ==
+         "100000000000000000000000000000000000000");
+  EXPECT(ToChars(trapping<uint128_t>{u128_max}, 2) == string(128, '1'));
+  EXPECT(ToChars(trapping<int128_t>{int128_t{-1}}, 36) == "-1");
+  EXPECT(ToChars(trapping<uint128_t>{u128_max}, 10, 38) == "error");
+  EXPECT(ToChars(trapping<uint128_t>{u128_max}, 10, 39) ==
+         "340282366920938463463374607431768211455");
+  EXPECT(ToChars(trapping<int128_t>{i128_min}, 10, 0) == "error");
+  EXPECT(Stream(clamping<int128_t>{i128_min} - 1) ==
+         "-170141183460469231731687303715884105728");
+  EXPECT(Stream(wrapping<uint128_t>{u128_max} + 1) == "0");
+  // The stream’s flags apply, as for narrower types.
+  {
+    ostringstream os;
+    os << hex << trapping<uint128_t>{u128_max} << ' '
+       << trapping<int128_t>{-1} << ' ' << showbase << uppercase
+       << trapping<uint128_t>{uint128_t{0xabc} << 64} << ' '
+       << trapping<uint128_t>{0U};
+    EXPECT(os.str() ==
+           "ffffffffffffffffffffffffffffffff ffffffffffffffffffffffffffffffff "
+           "0XABC0000000000000000 0");
+  }
+  {
+    ostringstream os;
+    os << oct << showbase << wrapping<uint128_t>{u128_max} << ' '
+       << clamping<int128_t>{8};
+    EXPECT(os.str() == "03777777777777777777777777777777777777777777 010");
+  }
+  {
+    ostringstream os;
+    os << showpos << trapping<int128_t>{5} << ' ' << trapping<uint128_t>{5U}
+       << ' ' << setw(6) << setfill('*') << trapping<int128_t>{-42} << ' '
+       << left << setw(4) << trapping<int128_t>{0} << '|';
+    EXPECT(os.str() == "+5 5 ***-42 +0**|");
+  }
+}
+#endif
+
+#if defined(__cpp_lib_format)
+void TestFormat() {
+  EXPECT(format("{}", trapping<int>{-3}) == "-3");
+  EXPECT(format("{:#x}", wrapping<u32>{255U}) == "0xff");
+  EXPECT(format("{:>5}", clamping<u8>{u8{200}} + 100) == "  255");
+  EXPECT(format("{}", ranged<int, 0, 10>{7}) == "7");
+  EXPECT(format("{:+}", integer<i16, saturate_policy>{i16{5}}) == "+5");
+}
+#endif
+
+}  // namespace
+
+int main() {
+  TestToChars();
+  TestOstream();
+#if defined(INTEGERS_HAVE_INT128)
+  TestInt128();
+#endif
+#if defined(__cpp_lib_format)
+  TestFormat();
+#endif
+}
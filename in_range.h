@@ -17,15 +17,20 @@
 
 #include <limits>
 #include <type_traits>
+#if __has_include(<version>)
+#include <version>
+#endif
+#ifdef __cpp_lib_integer_comparison_functions
+#include <utility>
+#endif
 
 #include "is_integral.h"
 
-namespace integers {
+namespace internal {
 
-#ifdef __cpp_lib_integer_comparison_functions
-using std::in_range;
-#else
-// Polyfill of C++20 `std::in_range` to C++17.
+// Like C++20 `std::in_range`, but also accepts 128-bit integers (which
+// `std::in_range` rejects). The classes and functions in this library use
+// this version.
 template <typename R, typename T>
 constexpr bool in_range(T value) noexcept {
   assert_is_integral(T);
@@ -34,14 +39,65 @@ constexpr bool in_range(T value) noexcept {
   constexpr R kMin = std::numeric_limits<R>::min();
   constexpr R kMax = std::numeric_limits<R>::max();
 
-  if constexpr (std::is_signed_v<T> == std::is_signed_v<R>) {
+  if constexpr (is_signed_v<T> == is_signed_v<R>) {
     return kMin <= value && value <= kMax;
-  } else if constexpr (std::is_signed_v<T>) {
-    return 0 <= value && std::make_unsigned_t<T>(value) <= kMax;
+  } else if constexpr (is_signed_v<T>) {
+    return 0 <= value && make_unsigned_t<T>(value) <= kMax;
   } else {
-    return value <= std::make_unsigned_t<R>(kMax);
+    return value <= make_unsigned_t<R>(kMax);
   }
 }
+
+/// Returns true if `x` < 0, without a type-limits warning for unsigned `T`.
+template <typename T>
+constexpr bool is_negative(T x) {
+  if constexpr (is_signed_v<T>) {
+    return x < 0;
+  } else {
+    return false;
+  }
+}
+
+/// True if the usual arithmetic conversions for `T` and `U` convert a signed
+/// operand to unsigned, so that e.g. `-7 / 2U` is not -3. The library’s
+/// division functions divide the operands’ magnitudes instead, in that type.
+template <typename T, typename U>
+inline constexpr bool kDivisionConvertsSign =
+    !is_signed_v<decltype(T{} / U{})> && (is_signed_v<T> || is_signed_v<U>);
+
+/// Returns |`x`| as an unsigned `M`, which must be at least as wide as `T`.
+template <typename M, typename T>
+constexpr M unsigned_abs(T x) {
+  return is_negative(x) ? static_cast<M>(M{0} - static_cast<M>(x))
+                        : static_cast<M>(x);
+}
+
+// Like C++20 `std::cmp_less`, but also accepts 128-bit integers: returns
+// true if the mathematical value of `x` is less than that of `y`, whatever
+// their signedness.
+template <typename T, typename U>
+constexpr bool less(T x, U y) noexcept {
+  assert_is_integral(T);
+  assert_is_integral(U);
+
+  if constexpr (is_signed_v<T> == is_signed_v<U>) {
+    return x < y;
+  } else if constexpr (is_signed_v<T>) {
+    return x < 0 || make_unsigned_t<T>(x) < y;
+  } else {
+    return 0 <= y && x < make_unsigned_t<U>(y);
+  }
+}
+
+}  // namespace internal
+
+namespace integers {
+
+#ifdef __cpp_lib_integer_comparison_functions
+using std::in_range;
+#else
+// Polyfill of C++20 `std::in_range` to C++17.
+using ::internal::in_range;
 #endif
 
 }  // namespace integers
@@ -0,0 +1,1108 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INTEGER_H_
+#define INTEGER_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <limits>
+#include <type_traits>
+
+#include "assume.h"
+#include "checked.h"
+#include "clamping.h"
+#include "in_range.h"
+#include "is_integral.h"
+#include "trap.h"
+#include "trapping.h"
+#include "wrapping.h"
+
+namespace integers {
+
+/// ## Overflow Policies
+///
+/// An overflow policy is a class with `static constexpr` functions `cast<R>`,
+/// `add<R>`, `sub<R>`, `mul<R>`, `div<R>`, `mod<R>`, `shl<R>`, and `shr<R>`,
+/// with the same signatures as the `checked_*` functions in checked.h. That
+/// is, each one returns a `result<R>`. Each policy also has a `static
+/// constexpr bool kSticky`, which tells `integer<T, Policy>` whether it must
+/// store the `overflowed` flag.
+///
+/// Since every function is a `constexpr` template that `integer<T, Policy>`
+/// calls directly, the policy is resolved entirely at compile time. For all
+/// policies but `sticky_policy`, `overflowed` is the constant `false`, so
+/// `integer<T, Policy>` compiles to exactly the same code as the
+/// corresponding helper function (`trapping_add`, `wrapping_add`, et c.).
+///
+/// ### `trap_policy`
+///
+/// `trap`s on overflow, division by 0, lossy conversions, and shifting too
+/// far, like `trapping<T>`.
+struct trap_policy {
+  static constexpr bool kSticky = false;
+
+  template <typename R, typename T>
+  static constexpr result<R> cast(T value) {
+    return {trapping_cast<R>(value), false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> add(T x, U y) {
+    return {trapping_add<R>(x, y), false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> sub(T x, U y) {
+    return {trapping_sub<R>(x, y), false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> mul(T x, U y) {
+    return {trapping_mul<R>(x, y), false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> div(T dividend, U divisor) {
+    return {trapping_div<R>(dividend, divisor), false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> mod(T dividend, U divisor) {
+    return {trapping_mod<R>(dividend, divisor), false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> shl(T value, U amount) {
+    return {trapping_shl<R>(value, amount), false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> shr(T value, U amount) {
+    return {trapping_shr<R>(value, amount), false};
+  }
+};
+
+/// ### `wrap_policy`
+///
+/// Wraps around on overflow and on lossy conversions, and masks shift amounts,
+/// like `wrapping<T>`. (Division by 0 still `trap`s.)
+struct wrap_policy {
+  static constexpr bool kSticky = false;
+
+  template <typename R, typename T>
+  static constexpr result<R> cast(T value) {
+    return {wrapping_cast<R>(value), false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> add(T x, U y) {
+    return {wrapping_add<R>(x, y), false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> sub(T x, U y) {
+    return {wrapping_sub<R>(x, y), false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> mul(T x, U y) {
+    return {wrapping_mul<R>(x, y), false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> div(T dividend, U divisor) {
+    return {wrapping_div<R>(dividend, divisor), false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> mod(T dividend, U divisor) {
+    return {wrapping_mod<R>(dividend, divisor), false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> shl(T value, U amount) {
+    wrapping<R> r{wrapping_cast<R>(value)};
+    r <<= amount;
+    return {static_cast<R>(r), false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> shr(T value, U amount) {
+    wrapping<R> r{wrapping_cast<R>(value)};
+    r >>= amount;
+    return {static_cast<R>(r), false};
+  }
+};
+
+/// ### `saturate_policy`
+///
+/// Clamps to the minimum or maximum value on overflow, on lossy conversions,
+/// and on shifting too far, like `clamping<T>`. (Division by 0 and negative
+/// shift amounts still `trap`.)
+struct saturate_policy {
+  static constexpr bool kSticky = false;
+
+  template <typename R, typename T>
+  static constexpr result<R> cast(T value) {
+    return {clamping_cast<R>(value), false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> add(T x, U y) {
+    return {clamping_add<R>(x, y), false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> sub(T x, U y) {
+    return {clamping_sub<R>(x, y), false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> mul(T x, U y) {
+    return {clamping_mul<R>(x, y), false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> div(T dividend, U divisor) {
+    return {clamping_div<R>(dividend, divisor), false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> mod(T dividend, U divisor) {
+    return {clamping_mod<R>(dividend, divisor), false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> shl(T value, U amount) {
+    clamping<R> r{clamping_cast<R>(value)};
+    r <<= amount;
+    return {static_cast<R>(r), false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> shr(T value, U amount) {
+    clamping<R> r{clamping_cast<R>(value)};
+    r >>= amount;
+    return {static_cast<R>(r), false};
+  }
+};
+
+/// ### `sticky_policy`
+///
+/// Records overflow, division by 0, lossy conversions, and shifting too far in
+/// a sticky flag, like `checked<T>`, and `trap`s only when you ask for the
+/// value.
+struct sticky_policy {
+  static constexpr bool kSticky = true;
+
+  template <typename R, typename T>
+  static constexpr result<R> cast(T value) {
+    return checked_cast<R>(value);
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> add(T x, U y) {
+    return checked_add<R>(x, y);
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> sub(T x, U y) {
+    return checked_sub<R>(x, y);
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> mul(T x, U y) {
+    return checked_mul<R>(x, y);
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> div(T dividend, U divisor) {
+    return checked_div<R>(dividend, divisor);
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> mod(T dividend, U divisor) {
+    return checked_mod<R>(dividend, divisor);
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> shl(T value, U amount) {
+    return checked_shl<R>(value, amount);
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> shr(T value, U amount) {
+    return checked_shr<R>(value, amount);
+  }
+};
+
+/// ### `assume_policy`
+///
+/// Does not check at all: it tells the compiler to assume that no operation
+/// overflows, divides by 0, or converts lossily (see `INTEGERS_ASSUME`). If
+/// one does, the behavior is undefined, just as for the built-in signed
+/// types. (In a constant expression, it fails to compile.)
+///
+/// This policy is only for code whose ranges have been validated some other
+/// way (e.g. by running the same code with `trap_policy` under test and
+/// fuzzing), and which a benchmark shows is too slow with checks. See
+/// `unchecked_release_policy`.
+struct assume_policy {
+  static constexpr bool kSticky = false;
+
+  template <typename R, typename T>
+  static constexpr result<R> cast(T value) {
+    R r = 0;
+    const bool overflowed = cast_truncate(value, &r);
+    INTEGERS_ASSUME(!overflowed);
+    return {r, false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> add(T x, U y) {
+    R r = 0;
+    const bool overflowed = add_overflow(x, y, &r);
+    INTEGERS_ASSUME(!overflowed);
+    return {r, false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> sub(T x, U y) {
+    R r = 0;
+    const bool overflowed = sub_overflow(x, y, &r);
+    INTEGERS_ASSUME(!overflowed);
+    return {r, false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> mul(T x, U y) {
+    R r = 0;
+    const bool overflowed = mul_overflow(x, y, &r);
+    INTEGERS_ASSUME(!overflowed);
+    return {r, false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> div(T dividend, U divisor) {
+    R r = 0;
+    const bool overflowed = div_overflow(dividend, divisor, &r);
+    INTEGERS_ASSUME(!overflowed);
+    return {r, false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> mod(T dividend, U divisor) {
+    R r = 0;
+    const bool overflowed = mod_overflow(dividend, divisor, &r);
+    INTEGERS_ASSUME(!overflowed);
+    return {r, false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> shl(T value, U amount) {
+    R r = 0;
+    const bool overflowed = shl_overflow(value, amount, &r);
+    INTEGERS_ASSUME(!overflowed);
+    return {r, false};
+  }
+
+  template <typename R, typename T, typename U>
+  static constexpr result<R> shr(T value, U amount) {
+    R r = 0;
+    const bool overflowed = shr_overflow(value, amount, &r);
+    INTEGERS_ASSUME(!overflowed);
+    return {r, false};
+  }
+};
+
+/// ### `unchecked_release_policy`
+///
+/// `trap_policy`, unless you define both `NDEBUG` and
+/// `INTEGERS_UNCHECKED_RELEASE` and are not building with AddressSanitizer,
+/// in which case it is `assume_policy`. This lets a hot module run fully
+/// checked in debug, test, and sanitizer builds, and unchecked in a
+/// benchmark-validated release build, without changing any code:
+///
+///   template <typename T>
+///   using hot_int = integer<T, unchecked_release_policy>;
+#if defined(__SANITIZE_ADDRESS__)
+#define INTEGERS_ASAN_ENABLED
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define INTEGERS_ASAN_ENABLED
+#endif
+#endif
+
+#if defined(NDEBUG) && defined(INTEGERS_UNCHECKED_RELEASE) && \
+    !defined(INTEGERS_ASAN_ENABLED)
+using unchecked_release_policy = assume_policy;
+#else
+using unchecked_release_policy = trap_policy;
+#endif
+
+/// ### `INTEGERS_DEFAULT_POLICY`
+///
+/// The policy of `default_integer<T>`. Defaults to `trap_policy`; define it
+/// (e.g. `-DINTEGERS_DEFAULT_POLICY=::integers::saturate_policy`) to change
+/// the policy of every `default_integer` in the build.
+#if !defined(INTEGERS_DEFAULT_POLICY)
+#define INTEGERS_DEFAULT_POLICY ::integers::trap_policy
+#endif
+
+}  // namespace integers
+
+namespace internal {
+
+/// Stores the sticky overflow flag of an `integer<T, Policy>` for which
+/// `Policy::kSticky` is true. Otherwise, this is an empty base class, and the
+/// flag is the constant `false`.
+template <bool Sticky>
+class overflow_flag {
+ public:
+  constexpr bool overflowed() const { return false; }
+
+ protected:
+  constexpr void record(bool) {}
+};
+
+template <>
+class overflow_flag<true> {
+ public:
+  constexpr bool overflowed() const { return overflowed_; }
+
+ protected:
+  constexpr void record(bool overflowed) { overflowed_ |= overflowed; }
+
+ private:
+  bool overflowed_ = false;
+};
+
+struct from_result_t {};
+
+}  // namespace internal
+
+namespace integers {
+
+/// ## `integer<T, Policy>`
+///
+/// This template class implements integer types whose behavior on overflow,
+/// division by 0, and narrowing conversions is chosen by `Policy` (see
+/// Overflow Policies, above). `integer<T, trap_policy>` behaves like
+/// `trapping<T>`, `integer<T, wrap_policy>` like `wrapping<T>`,
+/// `integer<T, saturate_policy>` like `clamping<T>`, and
+/// `integer<T, sticky_policy>` like `checked<T>`.
+///
+/// Using one template means code can switch policies with only a type alias
+/// (or `INTEGERS_DEFAULT_POLICY`), and that `integer<T, P>` has the same
+/// operators, with the same rules, whatever `P` is. Mixed-type operands
+/// follow `checked<T>`: in `x + y` and `x += y`, `y` need not fit in `T`, as
+/// long as the result does. Bitwise operands are first converted to `T`
+/// according to the policy.
+///
+/// Except with `sticky_policy`, `integer<T, Policy>` is trivial and has the
+/// same size as `T`, and all operations are `constexpr`. To format values,
+/// see format.h and ostream.h.
+template <typename T, typename Policy>
+class integer : public internal::overflow_flag<Policy::kSticky> {
+  assert_is_integral(T);
+
+  using Self = integer<T, Policy>;
+
+ public:
+  /// ### `integer`
+  ///
+  /// The default constructor. As with `trapping<T>`, the value is undefined
+  /// (but with `sticky_policy`, the overflow flag starts out cleared).
+  integer() = default;
+
+  /// ### `integer`
+  ///
+  /// Constructs and initializes.
+  template <typename U, std::enable_if_t<std::is_same_v<T, U>, int> = 0>
+  constexpr integer(U value) : value_(value) {}
+
+  /// ### `integer`
+  ///
+  /// Constructs and initializes, converting `value` according to the policy.
+  template <typename U, std::enable_if_t<!std::is_same_v<T, U>, int> = 0>
+  constexpr explicit integer(U value)
+      : integer(internal::from_result_t{},
+                Policy::template cast<T>(value)) {}
+
+  /// ### `value`
+  ///
+  /// Returns the plain `T` value. `trap`s if the policy is `sticky_policy`
+  /// and any operation that contributed to this value overflowed.
+  constexpr T value() const {
+    if (this->overflowed()) {
+      trap();
+    }
+    return value_;
+  }
+
+  /// ### `operator U`
+  ///
+  /// Returns the plain `T` value as a `U`, converted according to the policy.
+  /// With `sticky_policy`, this `trap`s if the value overflowed or does not
+  /// fit in a `U`, since there is no flag to record that in.
+  template <typename U,
+            std::enable_if_t<internal::is_integral_v<U>, int> = 0>
+  constexpr operator U() const {
+    const result<U> r = Policy::template cast<U>(value());
+    if (r.overflowed) {
+      trap();
+    }
+    return r.value;
+  }
+
+  /// ### `operator+=`
+  ///
+  /// Increments by `x`.
+  constexpr Self& operator+=(Self x) {
+    this->record(x.overflowed());
+    return assign(Policy::template add<T>(value_, x.value_));
+  }
+
+  /// ### `operator+=`
+  ///
+  /// Increments by `x`. `x` need not fit in `T`; only the result must.
+  template <typename U, std::enable_if_t<!std::is_same_v<Self, U>, int> = 0>
+  constexpr Self& operator+=(U x) {
+    assert_is_integral(U);
+    return assign(Policy::template add<T>(value_, x));
+  }
+
+  /// ### `operator+`
+  ///
+  /// Adds `rhs` to `lhs`, and returns the result.
+  friend constexpr Self operator+(Self lhs, Self rhs) {
+    lhs += rhs;
+    return lhs;
+  }
+
+  /// ### `operator+`
+  ///
+  /// Adds `rhs` to `lhs`, and returns the result.
+  template <typename U>
+  friend constexpr Self operator+(Self lhs, U rhs) {
+    lhs += rhs;
+    return lhs;
+  }
+
+  /// ### `operator+`
+  ///
+  /// Adds `rhs` to `lhs`, and returns the result.
+  template <typename U>
+  friend constexpr Self operator+(U lhs, Self rhs) {
+    rhs += lhs;
+    return rhs;
+  }
+
+  /// ### `operator+`
+  ///
+  /// Does nothing. (But it’s explicit about it!)
+  constexpr Self operator+() const { return *this; }
+
+  /// ### `operator-=`
+  ///
+  /// Subtracts `x`.
+  constexpr Self& operator-=(Self x) {
+    this->record(x.overflowed());
+    return assign(Policy::template sub<T>(value_, x.value_));
+  }
+
+  /// ### `operator-=`
+  ///
+  /// Subtracts `x`. `x` need not fit in `T`; only the result must.
+  template <typename U, std::enable_if_t<!std::is_same_v<Self, U>, int> = 0>
+  constexpr Self& operator-=(U x) {
+    assert_is_integral(U);
+    return assign(Policy::template sub<T>(value_, x));
+  }
+
+  /// ### `operator-`
+  ///
+  /// Subtracts `rhs` from `lhs`, and returns the result.
+  friend constexpr Self operator-(Self lhs, Self rhs) {
+    lhs -= rhs;
+    return lhs;
+  }
+
+  /// ### `operator-`
+  ///
+  /// Subtracts `rhs` from `lhs`, and returns the result.
+  template <typename U>
+  friend constexpr Self operator-(Self lhs, U rhs) {
+    lhs -= rhs;
+    return lhs;
+  }
+
+  /// ### `operator-`
+  ///
+  /// Subtracts `rhs` from `lhs`, and returns the result.
+  template <typename U>
+  friend constexpr Self operator-(U lhs, Self rhs) {
+    assert_is_integral(U);
+    Self result{internal::from_result_t{},
+                Policy::template sub<T>(lhs, rhs.value_)};
+    result.record(rhs.overflowed());
+    return result;
+  }
+
+  /// ### `operator-`
+  ///
+  /// Returns the value with its sign reversed. If `T` is the minimum value,
+  /// the policy determines the result.
+  constexpr Self operator-() const {
+    static_assert(internal::is_signed_v<T>, "Cannot negate an unsigned value");
+    Self result{internal::from_result_t{},
+                Policy::template sub<T>(T{0}, value_)};
+    result.record(this->overflowed());
+    return result;
+  }
+
+  /// ### `operator*=`
+  ///
+  /// Multiplies by `x`.
+  constexpr Self& operator*=(Self x) {
+    this->record(x.overflowed());
+    return assign(Policy::template mul<T>(value_, x.value_));
+  }
+
+  /// ### `operator*=`
+  ///
+  /// Multiplies by `x`. `x` need not fit in `T`; only the result must.
+  template <typename U, std::enable_if_t<!std::is_same_v<Self, U>, int> = 0>
+  constexpr Self& operator*=(U x) {
+    assert_is_integral(U);
+    return assign(Policy::template mul<T>(value_, x));
+  }
+
+  /// ### `operator*`
+  ///
+  /// Multiplies `lhs` by `rhs`, and returns the result.
+  friend constexpr Self operator*(Self lhs, Self rhs) {
+    lhs *= rhs;
+    return lhs;
+  }
+
+  /// ### `operator*`
+  ///
+  /// Multiplies `lhs` by `rhs`, and returns the result.
+  template <typename U>
+  friend constexpr Self operator*(Self lhs, U rhs) {
+    lhs *= rhs;
+    return lhs;
+  }
+
+  /// ### `operator*`
+  ///
+  /// Multiplies `lhs` by `rhs`, and returns the result.
+  template <typename U>
+  friend constexpr Self operator*(U lhs, Self rhs) {
+    rhs *= lhs;
+    return rhs;
+  }
+
+  /// ### `operator/=`
+  ///
+  /// Divides by `divisor`, storing the quotient in `*this`.
+  constexpr Self& operator/=(Self divisor) {
+    this->record(divisor.overflowed());
+    return assign(Policy::template div<T>(value_, divisor.value_));
+  }
+
+  /// ### `operator/=`
+  ///
+  /// Divides by `divisor`, storing the quotient in `*this`. `divisor` need
+  /// not fit in `T`; only the quotient must.
+  template <typename U, std::enable_if_t<!std::is_same_v<Self, U>, int> = 0>
+  constexpr Self& operator/=(U divisor) {
+    assert_is_integral(U);
+    return assign(Policy::template div<T>(value_, divisor));
+  }
+
+  /// ### `operator/`
+  ///
+  /// Divides `dividend` by `divisor`, and returns the quotient.
+  friend constexpr Self operator/(Self dividend, Self divisor) {
+    dividend /= divisor;
+    return dividend;
+  }
+
+  /// ### `operator/`
+  ///
+  /// Divides `dividend` by `divisor`, and returns the quotient.
+  template <typename U>
+  friend constexpr Self operator/(Self dividend, U divisor) {
+    dividend /= divisor;
+    return dividend;
+  }
+
+  /// ### `operator/`
+  ///
+  /// Divides `dividend` by `divisor`, and returns the quotient.
+  template <typename U>
+  friend constexpr Self operator/(U dividend, Self divisor) {
+    assert_is_integral(U);
+    Self result{internal::from_result_t{},
+                Policy::template div<T>(dividend, divisor.value_)};
+    result.record(divisor.overflowed());
+    return result;
+  }
+
+  /// ### `operator%=`
+  ///
+  /// Divides by `divisor`, storing the remainder in `*this`.
+  constexpr Self& operator%=(Self divisor) {
+    this->record(divisor.overflowed());
+    return assign(Policy::template mod<T>(value_, divisor.value_));
+  }
+
+  /// ### `operator%=`
+  ///
+  /// Divides by `divisor`, storing the remainder in `*this`. `divisor` need
+  /// not fit in `T`.
+  template <typename U, std::enable_if_t<!std::is_same_v<Self, U>, int> = 0>
+  constexpr Self& operator%=(U divisor) {
+    assert_is_integral(U);
+    return assign(Policy::template mod<T>(value_, divisor));
+  }
+
+  /// ### `operator%`
+  ///
+  /// Divides `dividend` by `divisor`, and returns the remainder.
+  friend constexpr Self operator%(Self dividend, Self divisor) {
+    dividend %= divisor;
+    return dividend;
+  }
+
+  /// ### `operator%`
+  ///
+  /// Divides `dividend` by `divisor`, and returns the remainder.
+  template <typename U>
+  friend constexpr Self operator%(Self dividend, U divisor) {
+    dividend %= divisor;
+    return dividend;
+  }
+
+  /// ### `operator%`
+  ///
+  /// Divides `dividend` by `divisor`, and returns the remainder.
+  template <typename U>
+  friend constexpr Self operator%(U dividend, Self divisor) {
+    assert_is_integral(U);
+    Self result{internal::from_result_t{},
+                Policy::template mod<T>(dividend, divisor.value_)};
+    result.record(divisor.overflowed());
+    return result;
+  }
+
+  /// ### `operator|=`
+  ///
+  /// Takes the bitwise `|` of the value and `x`, and assigns it to the value.
+  constexpr Self& operator|=(Self x) {
+    this->record(x.overflowed());
+    value_ |= x.value_;
+    return *this;
+  }
+
+  /// ### `operator|`
+  ///
+  /// Takes the bitwise `|` of `lhs` and `rhs`, and returns it. If either
+  /// operand is not a `Self`, it is first converted according to the policy.
+  friend constexpr Self operator|(Self lhs, Self rhs) {
+    lhs |= rhs;
+    return lhs;
+  }
+
+  /// ### `operator|`
+  ///
+  /// Takes the bitwise `|` of `lhs` and `rhs`, and returns it. If either
+  /// operand is not a `Self`, it is first converted according to the policy.
+  template <typename U>
+  friend constexpr Self operator|(Self lhs, U rhs) {
+    lhs |= Self{rhs};
+    return lhs;
+  }
+
+  /// ### `operator|`
+  ///
+  /// Takes the bitwise `|` of `lhs` and `rhs`, and returns it. If either
+  /// operand is not a `Self`, it is first converted according to the policy.
+  template <typename U>
+  friend constexpr Self operator|(U lhs, Self rhs) {
+    rhs |= Self{lhs};
+    return rhs;
+  }
+
+  /// ### `operator&=`
+  ///
+  /// Takes the bitwise `&` of the value and `x`, and assigns it to the value.
+  constexpr Self& operator&=(Self x) {
+    this->record(x.overflowed());
+    value_ &= x.value_;
+    return *this;
+  }
+
+  /// ### `operator&`
+  ///
+  /// Takes the bitwise `&` of `lhs` and `rhs`, and returns it. If either
+  /// operand is not a `Self`, it is first converted according to the policy.
+  friend constexpr Self operator&(Self lhs, Self rhs) {
+    lhs &= rhs;
+    return lhs;
+  }
+
+  /// ### `operator&`
+  ///
+  /// Takes the bitwise `&` of `lhs` and `rhs`, and returns it. If either
+  /// operand is not a `Self`, it is first converted according to the policy.
+  template <typename U>
+  friend constexpr Self operator&(Self lhs, U rhs) {
+    lhs &= Self{rhs};
+    return lhs;
+  }
+
+  /// ### `operator&`
+  ///
+  /// Takes the bitwise `&` of `lhs` and `rhs`, and returns it. If either
+  /// operand is not a `Self`, it is first converted according to the policy.
+  template <typename U>
+  friend constexpr Self operator&(U lhs, Self rhs) {
+    rhs &= Self{lhs};
+    return rhs;
+  }
+
+  /// ### `operator^=`
+  ///
+  /// Takes the bitwise `^` of the value and `x`, and assigns it to the value.
+  constexpr Self& operator^=(Self x) {
+    this->record(x.overflowed());
+    value_ ^= x.value_;
+    return *this;
+  }
+
+  /// ### `operator^`
+  ///
+  /// Takes the bitwise `^` of `lhs` and `rhs`, and returns it. If either
+  /// operand is not a `Self`, it is first converted according to the policy.
+  friend constexpr Self operator^(Self lhs, Self rhs) {
+    lhs ^= rhs;
+    return lhs;
+  }
+
+  /// ### `operator^`
+  ///
+  /// Takes the bitwise `^` of `lhs` and `rhs`, and returns it. If either
+  /// operand is not a `Self`, it is first converted according to the policy.
+  template <typename U>
+  friend constexpr Self operator^(Self lhs, U rhs) {
+    lhs ^= Self{rhs};
+    return lhs;
+  }
+
+  /// ### `operator^`
+  ///
+  /// Takes the bitwise `^` of `lhs` and `rhs`, and returns it. If either
+  /// operand is not a `Self`, it is first converted according to the policy.
+  template <typename U>
+  friend constexpr Self operator^(U lhs, Self rhs) {
+    rhs ^= Self{lhs};
+    return rhs;
+  }
+
+  /// ### `operator~`
+  ///
+  /// Returns the bitwise complement of the value.
+  constexpr Self operator~() const {
+    Self result = *this;
+    result.value_ = static_cast<T>(~value_);
+    return result;
+  }
+
+  /// ### `operator<<=`
+  ///
+  /// Shifts the value left by `amount` bits.
+  template <typename U>
+  constexpr Self& operator<<=(U amount) {
+    assert_is_integral(U);
+    return assign(Policy::template shl<T>(value_, amount));
+  }
+
+  /// ### `operator<<=`
+  ///
+  /// Shifts the value left by `amount` bits.
+  constexpr Self& operator<<=(Self amount) {
+    this->record(amount.overflowed());
+    return *this <<= amount.value_;
+  }
+
+  /// ### `operator<<`
+  ///
+  /// Shifts `lhs` left by `amount` bits, and returns the result.
+  template <typename U>
+  friend constexpr Self operator<<(Self lhs, U amount) {
+    lhs <<= amount;
+    return lhs;
+  }
+
+  /// ### `operator>>=`
+  ///
+  /// Shifts the value right by `amount` bits.
+  template <typename U>
+  constexpr Self& operator>>=(U amount) {
+    assert_is_integral(U);
+    return assign(Policy::template shr<T>(value_, amount));
+  }
+
+  /// ### `operator>>=`
+  ///
+  /// Shifts the value right by `amount` bits.
+  constexpr Self& operator>>=(Self amount) {
+    this->record(amount.overflowed());
+    return *this >>= amount.value_;
+  }
+
+  /// ### `operator>>`
+  ///
+  /// Shifts `lhs` right by `amount` bits, and returns the result.
+  template <typename U>
+  friend constexpr Self operator>>(Self lhs, U amount) {
+    lhs >>= amount;
+    return lhs;
+  }
+
+  /// ### `operator<`
+  ///
+  /// Returns true if `lhs` is less than `rhs`. (With `sticky_policy`, all
+  /// comparisons `trap` if either operand overflowed.)
+  friend constexpr bool operator<(Self lhs, Self rhs) {
+    return lhs.value() < rhs.value();
+  }
+
+  /// ### `operator<`
+  ///
+  /// Returns true if `lhs` is mathematically less than `rhs`. (Like
+  /// `operator==`, this never converts either operand.)
+  template <typename U>
+  friend constexpr bool operator<(Self lhs, U rhs) {
+    return internal::less(lhs.value(), rhs);
+  }
+
+  /// ### `operator<`
+  ///
+  /// Returns true if `lhs` is mathematically less than `rhs`.
+  template <typename U>
+  friend constexpr bool operator<(U lhs, Self rhs) {
+    return internal::less(lhs, rhs.value());
+  }
+
+  /// ### `operator>`
+  ///
+  /// Returns true if `lhs` is greater than `rhs`.
+  friend constexpr bool operator>(Self lhs, Self rhs) { return rhs < lhs; }
+
+  /// ### `operator>`
+  ///
+  /// Returns true if `lhs` is mathematically greater than `rhs`.
+  template <typename U>
+  friend constexpr bool operator>(Self lhs, U rhs) {
+    return rhs < lhs;
+  }
+
+  /// ### `operator>`
+  ///
+  /// Returns true if `lhs` is mathematically greater than `rhs`.
+  template <typename U>
+  friend constexpr bool operator>(U lhs, Self rhs) {
+    return rhs < lhs;
+  }
+
+  /// ### `operator<=`
+  ///
+  /// Returns true if `lhs` is less than or equal to `rhs`.
+  friend constexpr bool operator<=(Self lhs, Self rhs) { return !(lhs > rhs); }
+
+  /// ### `operator<=`
+  ///
+  /// Returns true if `lhs` is mathematically less than or equal to `rhs`.
+  template <typename U>
+  friend constexpr bool operator<=(Self lhs, U rhs) {
+    return !(lhs > rhs);
+  }
+
+  /// ### `operator<=`
+  ///
+  /// Returns true if `lhs` is mathematically less than or equal to `rhs`.
+  template <typename U>
+  friend constexpr bool operator<=(U lhs, Self rhs) {
+    return !(lhs > rhs);
+  }
+
+  /// ### `operator>=`
+  ///
+  /// Returns true if `lhs` is greater than or equal to `rhs`.
+  friend constexpr bool operator>=(Self lhs, Self rhs) { return !(rhs > lhs); }
+
+  /// ### `operator>=`
+  ///
+  /// Returns true if `lhs` is mathematically greater than or equal to `rhs`.
+  template <typename U>
+  friend constexpr bool operator>=(Self lhs, U rhs) {
+    return !(rhs > lhs);
+  }
+
+  /// ### `operator>=`
+  ///
+  /// Returns true if `lhs` is mathematically greater than or equal to `rhs`.
+  template <typename U>
+  friend constexpr bool operator>=(U lhs, Self rhs) {
+    return !(rhs > lhs);
+  }
+
+  /// ### `operator==`
+  ///
+  /// Returns true if `lhs` is equal to `rhs`.
+  friend constexpr bool operator==(Self lhs, Self rhs) {
+    return lhs.value() == rhs.value();
+  }
+
+  /// ### `operator==`
+  ///
+  /// Returns true if `lhs` is mathematically equal to `rhs`. (Unlike the
+  /// built-in `==`, this never converts either operand.)
+  template <typename U>
+  friend constexpr bool operator==(Self lhs, U rhs) {
+    assert_is_integral(U);
+    return internal::in_range<T>(rhs) && lhs.value() == static_cast<T>(rhs);
+  }
+
+  /// ### `operator==`
+  ///
+  /// Returns true if `lhs` is mathematically equal to `rhs`.
+  template <typename U>
+  friend constexpr bool operator==(U lhs, Self rhs) {
+    return rhs == lhs;
+  }
+
+  /// ### `operator!=`
+  ///
+  /// Returns true if `lhs` is not equal to `rhs`.
+  friend constexpr bool operator!=(Self lhs, Self rhs) { return !(lhs == rhs); }
+
+  /// ### `operator!=`
+  ///
+  /// Returns true if `lhs` is not equal to `rhs`.
+  template <typename U>
+  friend constexpr bool operator!=(Self lhs, U rhs) {
+    return !(lhs == rhs);
+  }
+
+  /// ### `operator!=`
+  ///
+  /// Returns true if `lhs` is not equal to `rhs`.
+  template <typename U>
+  friend constexpr bool operator!=(U lhs, Self rhs) {
+    return !(lhs == rhs);
+  }
+
+  /// ### `operator++`
+  ///
+  /// Prefix increment. Increments the value and returns `*this` with the new
+  /// value.
+  constexpr Self& operator++() {
+    *this += T{1};
+    return *this;
+  }
+
+  /// ### `operator++`
+  ///
+  /// Postfix increment. Increments the value and returns an object containing
+  /// the previous value.
+  constexpr Self operator++(int) {
+    Self previous = *this;
+    *this += T{1};
+    return previous;
+  }
+
+  /// ### `operator--`
+  ///
+  /// Prefix decrement. Decrements the value and returns `*this` with the new
+  /// value.
+  constexpr Self& operator--() {
+    *this -= T{1};
+    return *this;
+  }
+
+  /// ### `operator--`
+  ///
+  /// Postfix decrement. Decrements the value and returns an object containing
+  /// the previous value.
+  constexpr Self operator--(int) {
+    Self previous = *this;
+    *this -= T{1};
+    return previous;
+  }
+
+  /// ### `abs`
+  ///
+  /// Returns the absolute value of `x`. If `x` is the minimum value, the
+  /// policy determines the result.
+  friend constexpr Self abs(Self x) {
+    if constexpr (internal::is_unsigned_v<T>) {
+      return x;
+    } else {
+      return x.value_ < 0 ? -x : x;
+    }
+  }
+
+ private:
+  constexpr integer(internal::from_result_t, result<T> r) : value_(r.value) {
+    this->record(r.overflowed);
+  }
+
+  constexpr Self& assign(result<T> r) {
+    value_ = r.value;
+    this->record(r.overflowed);
+    return *this;
+  }
+
+  T value_;
+};
+
+/// ### `default_integer<T>`
+///
+/// `integer<T, INTEGERS_DEFAULT_POLICY>`.
+template <typename T>
+using default_integer = integer<T, INTEGERS_DEFAULT_POLICY>;
+
+static_assert(std::is_trivial_v<integer<int, trap_policy>>,
+              "`integer<T, trap_policy>` must be trivial");
+static_assert(sizeof(integer<int8_t, trap_policy>) == sizeof(int8_t),
+              "sizeof(integer<int8_t, trap_policy>) must == sizeof(int8_t)");
+static_assert(sizeof(integer<int64_t, assume_policy>) == sizeof(int64_t),
+              "sizeof(integer<int64_t, assume_policy>) must == "
+              "sizeof(int64_t)");
+static_assert(alignof(integer<int64_t, wrap_policy>) == alignof(int64_t),
+              "alignof(integer<int64_t, wrap_policy>) must == "
+              "alignof(int64_t)");
+static_assert(std::is_standard_layout_v<integer<int, saturate_policy>>,
+              "`integer<T, saturate_policy>` must be standard-layout");
+
+}  // namespace integers
+
+#endif  // INTEGER_H_
@@ -0,0 +1,319 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#include "integer.h"
+#include "ostream.h"
+#include "test_support.h"
+
+using namespace integers;
+using namespace std;
+
+namespace {
+
+using i8 = int8_t;
+using u8 = uint8_t;
+using i16 = int16_t;
+using u16 = uint16_t;
+using i32 = int32_t;
+using u32 = uint32_t;
+using i64 = int64_t;
+using u64 = uint64_t;
+
+template <typename T>
+using trap_int = integer<T, trap_policy>;
+template <typename T>
+using wrap_int = integer<T, wrap_policy>;
+template <typename T>
+using saturate_int = integer<T, saturate_policy>;
+template <typename T>
+using sticky_int = integer<T, sticky_policy>;
+template <typename T>
+using assume_int = integer<T, assume_policy>;
+
+// Policies resolve at compile time, so the operators work in constant
+// expressions.
+static_assert((trap_int<u16>{u16{1000}} * 60).value() == 60000);
+static_assert((wrap_int<u8>{u8{200}} + 100).value() == 44);
+static_assert((saturate_int<i8>{i8{100}} * 2).value() == 127);
+static_assert((assume_int<i32>{1 << 20} * (1 << 10)).value() == 1 << 30);
+static_assert(sticky_int<u8>{u8{255}}.operator+=(1).overflowed());
+
+static_assert(is_trivial_v<wrap_int<u64>>);
+static_assert(is_trivial_v<saturate_int<i16>>);
+static_assert(sizeof(saturate_int<i16>) == sizeof(i16));
+static_assert(sizeof(sticky_int<i32>) > sizeof(i32));
+static_assert(is_same_v<default_integer<int>, trap_int<int>>);
+static_assert(is_same_v<unchecked_release_policy, trap_policy>);
+
+void TestConstructor() {
+  EXPECT(trap_int<i8>{i8{-5}}.value() == -5);
+  EXPECT(trap_int<i16>{1000}.value() == 1000);
+  EXPECT_DEATH(trap_int<u8>{-1});
+  EXPECT(wrap_int<u8>{0x1234}.value() == 0x34);
+  EXPECT(saturate_int<u8>{-1}.value() == 0);
+  EXPECT(saturate_int<i8>{1000}.value() == 127);
+  {
+    sticky_int<u8> x{256};
+    EXPECT(x.overflowed());
+    EXPECT_DEATH((void)x.value());
+  }
+  {
+    sticky_int<i32> x;
+    EXPECT(!x.overflowed());
+  }
+}
+
+// Checks that every policy agrees with the corresponding helper functions,
+// for every pair of `T`s.
+template <typename T>
+void GenericTestMatchesHelpers() {
+  constexpr T min = numeric_limits<T>::min();
+  constexpr T max = numeric_limits<T>::max();
+  for (int i = min; i <= max; ++i) {
+    for (int j = min; j <= max; ++j) {
+      const T x = static_cast<T>(i);
+      const T y = static_cast<T>(j);
+      EXPECT((wrap_int<T>{x} + y).value() == wrapping_add<T>(x, y));
+      EXPECT((wrap_int<T>{x} - wrap_int<T>{y}).value() ==
+             wrapping_sub<T>(x, y));
+      EXPECT((wrap_int<T>{x} * y).value() == wrapping_mul<T>(x, y));
+      EXPECT((saturate_int<T>{x} + y).value() == clamping_add<T>(x, y));
+      EXPECT((saturate_int<T>{x} - saturate_int<T>{y}).value() ==
+             clamping_sub<T>(x, y));
+      EXPECT((saturate_int<T>{x} * y).value() == clamping_mul<T>(x, y));
+
+      T sum = 0;
+      EXPECT((sticky_int<T>{x} + y).overflowed() == add_overflow(x, y, &sum));
+      T product = 0;
+      EXPECT((sticky_int<T>{x} * y).overflowed() ==
+             mul_overflow(x, y, &product));
+      if (y != 0 && !(is_signed_v<T> && x == min && y == T(-1))) {
+        EXPECT((wrap_int<T>{x} / y).value() == x / y);
+        EXPECT((saturate_int<T>{x} % y).value() == x % y);
+        EXPECT((trap_int<T>{x} / y).value() == x / y);
+        EXPECT(!(sticky_int<T>{x} % y).overflowed());
+      }
+    }
+  }
+}
+
+void TestMatchesHelpers() {
+  GenericTestMatchesHelpers<i8>();
+  GenericTestMatchesHelpers<u8>();
+}
+
+template <typename T>
+void GenericTestOverflow() {
+  constexpr T min = numeric_limits<T>::min();
+  constexpr T max = numeric_limits<T>::max();
+  {
+    trap_int<T> x = max;
+    EXPECT_DEATH(x += T{1});
+    EXPECT_DEATH(x *= T{2});
+    EXPECT_DEATH(x /= T{0});
+    EXPECT_DEATH(x++);
+    trap_int<T> y = min;
+    EXPECT_DEATH(y -= T{1});
+    EXPECT_DEATH(--y);
+  }
+  {
+    wrap_int<T> x = max;
+    EXPECT(++x == min);
+    EXPECT(x-- == min);
+    EXPECT(x == max);
+    EXPECT_DEATH(x %= T{0});
+  }
+  {
+    saturate_int<T> x = max;
+    x += T{1};
+    EXPECT(x == max);
+    x = min;
+    x -= T{1};
+    EXPECT(x == min);
+    EXPECT_DEATH(x /= T{0});
+  }
+  {
+    sticky_int<T> x = max;
+    x += T{1};
+    EXPECT(x.overflowed());
+    // Once set, the flag stays set, and propagates to results.
+    x -= T{1};
+    EXPECT(x.overflowed());
+    EXPECT((sticky_int<T>{T{1}} + x).overflowed());
+    EXPECT((T{1} - x).overflowed());
+    EXPECT((sticky_int<T>{T{1}} & x).overflowed());
+    EXPECT_DEATH((void)(x == T{0}));
+  }
+  {
+    sticky_int<T> x = max;
+    x /= T{0};
+    EXPECT(x.overflowed());
+  }
+  if constexpr (is_signed_v<T>) {
+    EXPECT_DEATH(-trap_int<T>{min});
+    EXPECT_DEATH(abs(trap_int<T>{min}));
+    EXPECT((-wrap_int<T>{min}) == min);
+    EXPECT((-saturate_int<T>{min}) == max);
+    EXPECT(abs(saturate_int<T>{min}) == max);
+    EXPECT((-sticky_int<T>{min}).overflowed());
+    EXPECT(abs(trap_int<T>{T{-3}}) == T{3});
+    EXPECT(abs(wrap_int<T>{min}) == min);
+  }
+}
+
+template <class... T>
+void CallGenericTestOverflow() {
+  (GenericTestOverflow<T>(), ...);
+}
+
+void TestOverflow() {
+  CallGenericTestOverflow<i8, u8, i16, u16, i32, u32, i64, u64>();
+}
+
+void TestMixedTypes() {
+  {
+    // The right-hand side need not fit in `T`, as long as the result does.
+    trap_int<u32> x = 5U;
+    x += i64{-3};
+    EXPECT(x == 2U);
+    EXPECT_DEATH(x += i64{-3});
+  }
+  {
+    sticky_int<u16> x = u16{3};
+    EXPECT((x * 30000).overflowed());
+    EXPECT((30000 * x).overflowed());
+    EXPECT((x * 20).value() == 60);
+  }
+  {
+    EXPECT((wrap_int<u8>{u8{10}} - 11) == 255);
+    EXPECT((11 - wrap_int<u8>{u8{10}}) == 1);
+    EXPECT((saturate_int<u8>{u8{10}} - 11) == 0);
+    EXPECT((1000 / saturate_int<u8>{u8{2}}) == 255);
+  }
+}
+
+void TestBitwise() {
+  EXPECT((trap_int<u8>{u8{0xF0}} | 0x0F) == 0xFF);
+  EXPECT_DEATH((void)(trap_int<u8>{u8{0xF0}} | 0x100));
+  EXPECT((wrap_int<u8>{u8{0xF0}} | 0x10F) == 0xFF);
+  EXPECT((saturate_int<u8>{u8{0x0F}} & 0x1FF) == 0x0F);
+  EXPECT((0x3C ^ saturate_int<u8>{u8{0xFF}}) == 0xC3);
+  EXPECT((~wrap_int<u16>{u16{0}}) == 0xFFFF);
+  EXPECT((sticky_int<u8>{u8{1}} | 0x100).overflowed());
+}
+
+void TestShift() {
+  EXPECT((trap_int<u64>{u64{1}} << 40) == u64{1} << 40);
+  EXPECT_DEATH((void)(trap_int<i32>{1} << 31));
+  EXPECT_DEATH((void)(trap_int<u32>{1} >> 32));
+  EXPECT((wrap_int<u8>{u8{0x81}} << 1) == 0x02);
+  EXPECT((wrap_int<u8>{u8{0x81}} << 9) == 0x02);
+  EXPECT((saturate_int<i16>{i16{-300}} << 8) == numeric_limits<i16>::min());
+  EXPECT((saturate_int<u8>{u8{0x80}} >> 8) == 0);
+  EXPECT((sticky_int<u16>{u16{0x100}} << 8).overflowed());
+  EXPECT(!(sticky_int<u16>{u16{0x100}} >> 8).overflowed());
+  EXPECT((sticky_int<u16>{u16{1}} >> sticky_int<u16>{u16{16}}).overflowed());
+  EXPECT((assume_int<u32>{0xabU} << 24) == 0xab000000U);
+
+  trap_int<i64> x = i64{-1};
+  x <<= trap_int<i64>{i64{63}};
+  EXPECT(x == numeric_limits<i64>::min());
+  x >>= 62;
+  EXPECT(x == -2);
+}
+
+void TestComparison() {
+  const trap_int<i32> a = -1;
+  const trap_int<i32> b = 1;
+  EXPECT(a < b);
+  EXPECT(b > a);
+  EXPECT(a <= a);
+  EXPECT(b >= 1);
+  EXPECT(a != b);
+  // Mixed-type `==` compares mathematical values.
+  EXPECT(a != numeric_limits<u32>::max());
+  EXPECT(wrap_int<u8>{u8{255}} != -1);
+  EXPECT(wrap_int<u8>{u8{255}} == 255LL);
+  // So do the mixed-type relational operators.
+  EXPECT(trap_int<u8>{u8{255}} < 256);
+  EXPECT(256 > trap_int<u8>{u8{255}});
+  EXPECT(!(trap_int<u8>{u8{255}} >= 256));
+  EXPECT(a < numeric_limits<u32>::max());
+  EXPECT(a <= 0U);
+  EXPECT(!(a > 0U));
+  EXPECT(1U >= a);
+  EXPECT(wrap_int<u32>{0U} > -1);
+  EXPECT(-1 < wrap_int<u32>{0U});
+  EXPECT(saturate_int<i8>{i8{-128}} < u64{0});
+  EXPECT(sticky_int<i16>{i16{-1}} < numeric_limits<u64>::max());
+}
+
+void TestOperatorU() {
+  {
+    const trap_int<i64> x = i64{300};
+    EXPECT(static_cast<i16>(x) == 300);
+    i8 y = 0;
+    EXPECT_DEATH(y = x);
+    (void)y;
+  }
+  {
+    const wrap_int<i64> x = i64{300};
+    EXPECT(static_cast<u8>(x) == 44);
+    const saturate_int<i64> z = i64{300};
+    EXPECT(static_cast<u8>(z) == 255);
+  }
+  {
+    const sticky_int<i64> x = i64{300};
+    EXPECT(static_cast<i16>(x) == 300);
+    u8 y = 0;
+    EXPECT_DEATH(y = x);
+    (void)y;
+  }
+}
+
+void TestPrint() {
+  ostringstream out;
+  out << wrap_int<i16>{i16{-42}} << " " << default_integer<u16>{u16{7}};
+  EXPECT(out.str() == "-42 7");
+}
+
+void TestAssume() {
+  // `assume_policy` does not check, so only valid operations are tested.
+  assume_int<size_t> total = size_t{1000};
+  total *= 48;
+  total += 16;
+  total /= 2;
+  EXPECT(total.value() == 24008);
+  EXPECT((total % 10) == 8);
+  EXPECT(static_cast<u16>(total) == 24008);
+}
+
+}  // namespace
+
+int main() {
+  TestConstructor();
+  TestMatchesHelpers();
+  TestOverflow();
+  TestMixedTypes();
+  TestBitwise();
+  TestShift();
+  TestComparison();
+  TestOperatorU();
+  TestPrint();
+  TestAssume();
+}
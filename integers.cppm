@@ -0,0 +1,80 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// The `integers` module: `import integers;` instead of including the headers.
+//
+// Build it with `make module`. Macros are not exported from modules, so to use
+// `trap()` or `INTEGERS_ASSUME` directly, include trap.h or assume.h as well.
+// The configuration macros (`INTEGERS_COLD_TRAP`, `INTEGERS_TELEMETRY`, et c.)
+// take effect when the module is built, not when it is imported.
+// (GCC 12 fails to build the module with `INTEGERS_TELEMETRY`, with an internal
+// compiler error.)
+
+module;
+
+// The global module fragment includes every standard header that the library
+// uses, so that their include guards keep them out of the module itself.
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if __has_include(<version>)
+#include <version>
+#endif
+#if defined(__cpp_lib_format)
+#include <format>
+#endif
+#if __has_include(<span>)
+#include <span>
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#if defined(INTEGERS_TRAP_HANDLER_HEADER)
+#include INTEGERS_TRAP_HANDLER_HEADER
+#endif
+
+export module integers;
+
+// This exports the `internal` namespace too, but only `integers` is the API.
+export extern "C++" {
+#include "integers.h"
+}
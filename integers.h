@@ -0,0 +1,57 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INTEGERS_H_
+#define INTEGERS_H_
+
+/// ## integers.h
+///
+/// Includes all of the library’s headers, for use as a precompiled header
+/// (`make pch`) and in the `integers` module (integers.cppm; `make module`).
+///
+/// Without either of those, prefer to include only the headers you use: e.g.
+/// trapping.h alone includes only `<limits>`, `<type_traits>`, and the C
+/// headers `<stdint.h>` and `<stdlib.h>` (and, in C++20, `<utility>`, for
+/// `std::in_range`), while this header also includes `<atomic>`, `<charconv>`,
+/// `<ostream>`, `<thread>`, `<vector>`, et c.
+
+#include "alloc.h"
+#include "assume.h"
+#include "atomic.h"
+#include "batch.h"
+#include "bounded_span.h"
+#include "checked.h"
+#include "clamping.h"
+#include "divider.h"
+#include "expression.h"
+#include "fixed.h"
+#include "format.h"
+#include "in_range.h"
+#include "integer.h"
+#include "iota.h"
+#include "is_integral.h"
+#include "layout.h"
+#include "ostream.h"
+#include "packed.h"
+#include "parse.h"
+#include "ranged.h"
+#include "reduce.h"
+#include "serial.h"
+#include "telemetry.h"
+#include "trap.h"
+#include "trapping.h"
+#include "wide.h"
+#include "wrapping.h"
+
+#endif  // INTEGERS_H_
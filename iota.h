@@ -0,0 +1,186 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IOTA_H_
+#define IOTA_H_
+
+#include <limits>
+#include <type_traits>
+
+#include "is_integral.h"
+#include "trap.h"
+#include "trapping.h"
+
+namespace internal {
+
+// Returns the number of values in [`begin`, `end`) (or, if `stride` is
+// negative, in (`end`, `begin`]) that are `begin` plus a multiple of
+// `stride`. `stride` must not be 0.
+template <typename T, typename S>
+constexpr make_unsigned_t<T> iota_count(T begin, T end, S stride) {
+  using U = make_unsigned_t<T>;
+  using M = std::conditional_t<(sizeof(S) > sizeof(T)), make_unsigned_t<S>, U>;
+  const bool up = !is_negative(stride);
+  if (up ? !(begin < end) : !(end < begin)) {
+    return 0;
+  }
+  const U distance = up ? static_cast<U>(static_cast<U>(end) -
+                                         static_cast<U>(begin))
+                        : static_cast<U>(static_cast<U>(begin) -
+                                         static_cast<U>(end));
+  return static_cast<U>(
+      static_cast<M>(static_cast<M>(distance) - 1) / unsigned_abs<M>(stride) +
+      1);
+}
+
+}  // namespace internal
+
+namespace integers {
+
+/// ## `iota_range<T>`
+///
+/// The range of `T`s returned by `checked_iota`. Its iterators yield plain
+/// `T`s.
+///
+/// `checked_iota` checks, once, that the value after the last one (`begin +
+/// size() * stride`) fits in `T`, if there are at least 2 values. So the
+/// iterators add the stride in plain `T` arithmetic, with no checks, and the
+/// compiler can see that they do not overflow.
+template <typename T>
+class iota_range {
+  assert_is_integral(T);
+
+  using U = internal::make_unsigned_t<T>;
+
+ public:
+  class iterator {
+   public:
+    constexpr T operator*() const { return value_; }
+
+    constexpr iterator& operator++() {
+      value_ = static_cast<T>(value_ + step_);
+      return *this;
+    }
+
+    friend constexpr bool operator==(iterator lhs, iterator rhs) {
+      return lhs.value_ == rhs.value_;
+    }
+
+    friend constexpr bool operator!=(iterator lhs, iterator rhs) {
+      return lhs.value_ != rhs.value_;
+    }
+
+   private:
+    friend class iota_range;
+    constexpr iterator(T value, T step) : value_(value), step_(step) {}
+
+    T value_;
+    T step_;
+  };
+
+  constexpr iterator begin() const { return iterator(first_, step_); }
+  constexpr iterator end() const { return iterator(end_, step_); }
+
+  /// ### `size`
+  ///
+  /// Returns the number of values in the range.
+  constexpr U size() const { return size_; }
+
+  constexpr bool empty() const { return size_ == 0; }
+
+ private:
+  template <typename R, typename S>
+  friend constexpr iota_range<R> checked_iota(R begin, R end, S stride);
+
+  constexpr iota_range(T first, T end, T step, U size)
+      : first_(first), end_(end), step_(step), size_(size) {}
+
+  T first_;
+  T end_;
+  T step_;
+  U size_;
+};
+
+/// ### `checked_iota`
+///
+/// Returns the range of `T`s `begin`, `begin + stride`, `begin + 2 * stride`,
+/// and so on, that are less than `end` (or, if `stride` is negative, greater
+/// than `end`). For example,
+///
+///   for (const uint8_t x : checked_iota<uint8_t>(0, 255, 5)) {
+///     // 0, 5, 10, ..., 250
+///   }
+///   for (const size_t i : checked_iota<size_t>(count, 0, -1)) {
+///     // count, count - 1, ..., 1
+///   }
+///
+/// `trap`s if `stride` is 0, or if there are 2 or more values and the value
+/// after the last one does not fit in `T` (as with
+/// `checked_iota<uint8_t>(0, 255, 4)`, which would end at 256). `stride` can be
+/// of any integer type (e.g. negative, for an unsigned `T`).
+///
+/// Unlike a loop with a `trapping<T>` counter, which checks for overflow on
+/// every increment, this checks once, up front, so that the loop body has no
+/// checks, and the compiler can unroll and vectorize it.
+template <typename T, typename S>
+constexpr iota_range<T> checked_iota(T begin, T end, S stride) {
+  assert_is_integral(T);
+  assert_is_integral(S);
+  using U = internal::make_unsigned_t<T>;
+  using M = std::conditional_t<(sizeof(S) > sizeof(T)),
+                               internal::make_unsigned_t<S>, U>;
+  if (stride == 0) {
+    trap();
+  }
+  const bool up = !internal::is_negative(stride);
+  const U size = internal::iota_count(begin, end, stride);
+  if (size <= 1) {
+    // The stride need not fit in `T`; any step past `begin` will do.
+    const T step = static_cast<T>(up ? 1 : -1);
+    return iota_range<T>(begin, static_cast<T>(begin + (size == 1 ? step : 0)),
+                         step, size);
+  }
+  // The distance from `begin` to the end of `T`, in the direction of
+  // `stride`.
+  const U headroom =
+      up ? static_cast<U>(static_cast<U>(std::numeric_limits<T>::max()) -
+                          static_cast<U>(begin))
+         : static_cast<U>(static_cast<U>(begin) -
+                          static_cast<U>(std::numeric_limits<T>::min()));
+  M offset = 0;
+  if (mul_overflow(static_cast<M>(size), internal::unsigned_abs<M>(stride),
+                   &offset) ||
+      offset > headroom) {
+    trap();
+  }
+  // With 2 or more values, the stride fits in `T` (or, for a negative stride
+  // and unsigned `T`, wraps around to the same effect).
+  const T step = static_cast<T>(stride);
+  const U offset_bits = static_cast<U>(up ? offset : M{0} - offset);
+  return iota_range<T>(begin,
+                       static_cast<T>(static_cast<U>(begin) + offset_bits),
+                       step, size);
+}
+
+/// ### `checked_iota`
+///
+/// Returns the range of `T`s from `begin` up to, but not including, `end`.
+template <typename T>
+constexpr iota_range<T> checked_iota(T begin, T end) {
+  return checked_iota(begin, end, 1);
+}
+
+}  // namespace integers
+
+#endif  // IOTA_H_
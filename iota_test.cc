@@ -0,0 +1,140 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdint.h>
+
+#include <limits>
+#include <vector>
+
+#include "iota.h"
+#include "test_support.h"
+
+using namespace integers;
+using namespace std;
+
+namespace {
+
+using i8 = int8_t;
+using u8 = uint8_t;
+using i32 = int32_t;
+using u32 = uint32_t;
+using i64 = int64_t;
+using u64 = uint64_t;
+
+template <typename R>
+vector<i64> Values(const R& range) {
+  vector<i64> values;
+  for (const auto x : range) {
+    values.push_back(static_cast<i64>(x));
+  }
+  return values;
+}
+
+void TestIota() {
+  EXPECT((Values(checked_iota(0, 4)) == vector<i64>{0, 1, 2, 3}));
+  EXPECT((Values(checked_iota(-2, 1)) == vector<i64>{-2, -1, 0}));
+  EXPECT(Values(checked_iota(3, 3)).empty());
+  EXPECT(Values(checked_iota(4, 3)).empty());
+  EXPECT(checked_iota(4, 3).empty());
+  EXPECT(checked_iota<u64>(10, 20).size() == 10);
+  EXPECT(checked_iota<u8>(0, 255).size() == 255);
+  EXPECT((is_same_v<decltype(*checked_iota<u8>(0, 1).begin()), u8>));
+}
+
+void TestStride() {
+  EXPECT((Values(checked_iota(0, 10, 3)) == vector<i64>{0, 3, 6, 9}));
+  EXPECT((Values(checked_iota(0, 9, 3)) == vector<i64>{0, 3, 6}));
+  EXPECT((Values(checked_iota(5, 0, -2)) == vector<i64>{5, 3, 1}));
+  EXPECT((Values(checked_iota<size_t>(3, 0, -1)) == vector<i64>{3, 2, 1}));
+  EXPECT((Values(checked_iota<u8>(250, 10, i64{-80})) ==
+          vector<i64>{250, 170, 90}));
+  EXPECT_DEATH(checked_iota<u8>(250, 0, i64{-100}));
+  EXPECT(Values(checked_iota(0, 10, -1)).empty());
+  EXPECT(Values(checked_iota(10, 0, 1)).empty());
+  // A stride that does not fit in `T` is fine, if there is only 1 value.
+  EXPECT((Values(checked_iota<i8>(0, 100, 1000)) == vector<i64>{0}));
+  EXPECT((Values(checked_iota<u8>(7, 0, i64{-1000})) == vector<i64>{7}));
+  EXPECT_DEATH(checked_iota(0, 10, 0));
+  EXPECT_DEATH(checked_iota(0, 0, 0));
+}
+
+void TestEdges() {
+  constexpr i32 max = numeric_limits<i32>::max();
+  constexpr i32 min = numeric_limits<i32>::min();
+  EXPECT((Values(checked_iota(max - 2, max)) == vector<i64>{max - 2, max - 1}));
+  EXPECT((Values(checked_iota(min + 2, min, -1)) ==
+          vector<i64>{min + 2, min + 1}));
+  EXPECT(checked_iota(min, max).size() == numeric_limits<u32>::max());
+  // The value after the last, max - 1 + 2, does not fit.
+  EXPECT_DEATH(checked_iota(max - 3, max, 2));
+  EXPECT_DEATH(checked_iota(min + 3, min, -2));
+  EXPECT_DEATH(checked_iota<u8>(0, 255, 4));
+  EXPECT(checked_iota<u8>(0, 255, 5).size() == 51);
+  EXPECT(checked_iota<u8>(0, 251, 5).size() == 51);
+  EXPECT_DEATH(checked_iota<u64>(0, numeric_limits<u64>::max(), 2));
+  EXPECT(checked_iota<u64>(0, numeric_limits<u64>::max(), 3).size() ==
+         numeric_limits<u64>::max() / 3);
+}
+
+template <typename T>
+void GenericTestExhaustive() {
+  constexpr int min = numeric_limits<T>::min();
+  constexpr int max = numeric_limits<T>::max();
+  for (const int stride : {1, 3, -1, -7, 100}) {
+    for (int begin = min; begin <= max; ++begin) {
+      for (int end = min; end <= max; ++end) {
+        vector<i64> expected;
+        int next = begin;
+        for (; stride > 0 ? next < end : next > end; next += stride) {
+          expected.push_back(next);
+        }
+        const auto range = [=] {
+          return checked_iota(static_cast<T>(begin), static_cast<T>(end),
+                              stride);
+        };
+        if (expected.size() >= 2 && (next < min || next > max)) {
+          EXPECT_DEATH(range());
+        } else {
+          EXPECT(range().size() == expected.size());
+          EXPECT(Values(range()) == expected);
+        }
+      }
+    }
+  }
+}
+
+void TestExhaustive() {
+#if defined(INTEGERS_TRAP_THROWS)
+  GenericTestExhaustive<i8>();
+  GenericTestExhaustive<u8>();
+#endif
+}
+
+constexpr int SumOfOdds(int n) {
+  int sum = 0;
+  for (const int x : checked_iota(1, 2 * n, 2)) {
+    sum += x;
+  }
+  return sum;
+}
+static_assert(SumOfOdds(10) == 100);
+
+}  // namespace
+
+int main() {
+  TestIota();
+  TestStride();
+  TestEdges();
+  TestExhaustive();
+}
@@ -15,8 +15,100 @@
 #ifndef IS_INTEGRAL_H_
 #define IS_INTEGRAL_H_
 
-#define assert_is_integral(T)                                      \
-  static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool>, \
+#include <stdint.h>
+
+#include <type_traits>
+
+/// ## 128-Bit Integers
+///
+/// ### `int128_t`, `uint128_t`
+///
+/// If the compiler supports `__int128` (as GCC and Clang do on 64-bit
+/// targets), these are the signed and unsigned 128-bit types, and
+/// `INTEGERS_HAVE_INT128` is defined. All the classes and functions in this
+/// library accept them, like any other integral type: e.g.
+/// `trapping<int128_t>`.
+///
+/// The standard type traits (`std::is_integral`, `std::is_signed`,
+/// `std::make_unsigned`) reject `__int128` in strict standard modes (e.g.
+/// `-std=c++17`, as opposed to `-std=gnu++17`), so this library uses its own,
+/// in `internal`, which accept it in every mode. (Note that C++20
+/// `std::in_range`, which is what `integers::in_range` refers to in C++20,
+/// rejects it in every mode. Use `internal::in_range`.)
+#if defined(__SIZEOF_INT128__)
+#define INTEGERS_HAVE_INT128
+namespace integers {
+__extension__ typedef __int128 int128_t;
+__extension__ typedef unsigned __int128 uint128_t;
+}  // namespace integers
+#endif
+
+namespace internal {
+
+template <typename T>
+inline constexpr bool is_integral_v = std::is_integral_v<T>;
+
+template <typename T>
+inline constexpr bool is_signed_v = std::is_signed_v<T>;
+
+template <typename T>
+struct make_unsigned {
+  using type = std::make_unsigned_t<T>;
+};
+
+template <typename T>
+struct make_signed {
+  using type = std::make_signed_t<T>;
+};
+
+#if defined(INTEGERS_HAVE_INT128)
+template <>
+inline constexpr bool is_integral_v<integers::int128_t> = true;
+template <>
+inline constexpr bool is_integral_v<integers::uint128_t> = true;
+template <>
+inline constexpr bool is_signed_v<integers::int128_t> = true;
+template <>
+inline constexpr bool is_signed_v<integers::uint128_t> = false;
+
+template <>
+struct make_unsigned<integers::int128_t> {
+  using type = integers::uint128_t;
+};
+template <>
+struct make_unsigned<integers::uint128_t> {
+  using type = integers::uint128_t;
+};
+template <>
+struct make_signed<integers::int128_t> {
+  using type = integers::int128_t;
+};
+template <>
+struct make_signed<integers::uint128_t> {
+  using type = integers::int128_t;
+};
+#endif
+
+template <typename T>
+inline constexpr bool is_unsigned_v = is_integral_v<T> && !is_signed_v<T>;
+
+template <typename T>
+using make_unsigned_t = typename make_unsigned<T>::type;
+
+template <typename T>
+using make_signed_t = typename make_signed<T>::type;
+
+/// The widest unsigned integral type; every integral value’s magnitude fits.
+#if defined(INTEGERS_HAVE_INT128)
+using uwidest_t = integers::uint128_t;
+#else
+using uwidest_t = uintmax_t;
+#endif
+
+}  // namespace internal
+
+#define assert_is_integral(T)                                             \
+  static_assert(::internal::is_integral_v<T> && !std::is_same_v<T, bool>, \
                 "Must be an integral type")
 
 #endif  // IS_INTEGRAL_H_
@@ -0,0 +1,212 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LAYOUT_H_
+#define LAYOUT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <type_traits>
+
+#if __has_include(<span>)
+#include <span>
+#endif
+
+#include "bounded_span.h"
+#include "clamping.h"
+#include "in_range.h"
+#include "integer.h"
+#include "ranged.h"
+#include "trap.h"
+#include "trapping.h"
+#include "wrapping.h"
+
+namespace internal {
+
+// `layout_traits<C>::raw_type` is the integral type that `C` holds, and that
+// `as_raw` views an array of `C`s as. It is `const` for `ranged`, since
+// storing an arbitrary value would break its invariant.
+template <typename C>
+struct layout_traits;
+
+template <typename T>
+struct layout_traits<integers::trapping<T>> {
+  using raw_type = T;
+};
+
+template <typename T>
+struct layout_traits<integers::wrapping<T>> {
+  using raw_type = T;
+};
+
+template <typename T>
+struct layout_traits<integers::clamping<T>> {
+  using raw_type = T;
+};
+
+template <typename T, T Min, T Max>
+struct layout_traits<integers::ranged<T, Min, Max>> {
+  using raw_type = const T;
+};
+
+template <typename T, typename Policy>
+struct layout_traits<integers::integer<T, Policy>> {
+  using raw_type = T;
+};
+
+// True if a `C` has exactly the size, alignment, and representation of a `T`,
+// so that an array of 1 can be viewed as an array of the other.
+template <typename C, typename T>
+inline constexpr bool is_layout_compatible_v =
+    sizeof(C) == sizeof(T) && alignof(C) == alignof(T) &&
+    std::is_standard_layout_v<C> && std::is_trivially_copyable_v<C>;
+
+// `To`, with `From`’s `const`.
+template <typename From, typename To>
+using copy_const_t = std::conditional_t<std::is_const_v<From>, const To, To>;
+
+template <typename C, typename T>
+C* layout_cast(T* data) {
+  static_assert(is_layout_compatible_v<std::remove_const_t<C>,
+                                       std::remove_const_t<T>>,
+                "C must have the layout of T (e.g. not sticky_policy)");
+  return reinterpret_cast<C*>(data);
+}
+
+template <typename C, typename T>
+integers::bounded_span<C> view_as(integers::bounded_span<T> s) {
+  return {layout_cast<C>(s.data()), s.size()};
+}
+
+#ifdef __cpp_lib_span
+template <typename C, typename T, size_t N>
+std::span<C, N> view_as(std::span<T, N> s) {
+  return std::span<C, N>(layout_cast<C>(s.data()), s.size());
+}
+#endif
+
+}  // namespace internal
+
+namespace integers {
+
+/// ## Layout
+///
+/// `trapping<T>`, `wrapping<T>`, `clamping<T>`, `ranged<T, Min, Max>`, and
+/// `integer<T, Policy>` (for every policy but `sticky_policy`, whose flag
+/// takes space) have exactly the size, alignment, and representation of `T`:
+/// each is a standard-layout, trivially copyable class whose only member is a
+/// `T`. Each class header `static_assert`s this, and layout_test.cc checks it
+/// for every type.
+///
+/// So an existing array of `T`s (e.g. a large buffer from a file, or from a C
+/// API) can be used as an array of `trapping<T>`s, and back, without copying.
+/// The functions below do that for `bounded_span`s and (in C++20)
+/// `std::span`s, keeping `const` and (for `std::span`) a static extent:
+///
+///   std::vector<uint32_t> counts = ReadCounts(file);
+///   for (trapping<uint32_t>& count : as_trapping(bounded_span(counts))) {
+///     count *= 3;  // `trap`s on overflow.
+///   }
+///
+/// Both views refer to the same elements, so a write through one is visible
+/// through the other. (C++ before C++23’s `std::start_lifetime_as_array` has
+/// no way to say that a `T` array also holds `trapping<T>` objects. These
+/// views rely on the layout guarantees above, and on GCC and Clang treating
+/// an access to a class’s only member as an access to its type, which they
+/// do for type-based alias analysis.)
+///
+/// ### `as_trapping`
+///
+/// Returns a view of the `T`s in `s` as `trapping<T>`s.
+template <typename Span>
+auto as_trapping(Span s) {
+  using T = typename Span::element_type;
+  return internal::view_as<
+      internal::copy_const_t<T, trapping<std::remove_const_t<T>>>>(s);
+}
+
+/// ### `as_wrapping`
+///
+/// Returns a view of the `T`s in `s` as `wrapping<T>`s.
+template <typename Span>
+auto as_wrapping(Span s) {
+  using T = typename Span::element_type;
+  return internal::view_as<
+      internal::copy_const_t<T, wrapping<std::remove_const_t<T>>>>(s);
+}
+
+/// ### `as_clamping`
+///
+/// Returns a view of the `T`s in `s` as `clamping<T>`s.
+template <typename Span>
+auto as_clamping(Span s) {
+  using T = typename Span::element_type;
+  return internal::view_as<
+      internal::copy_const_t<T, clamping<std::remove_const_t<T>>>>(s);
+}
+
+/// ### `as_integer`
+///
+/// Returns a view of the `T`s in `s` as `integer<T, Policy>`s. `Policy` may
+/// not be `sticky_policy`.
+template <typename Policy, typename Span>
+auto as_integer(Span s) {
+  using T = typename Span::element_type;
+  return internal::view_as<
+      internal::copy_const_t<T, integer<std::remove_const_t<T>, Policy>>>(s);
+}
+
+/// ### `as_ranged`
+///
+/// Returns a view of the `T`s in `s` as `ranged<T, Min, Max>`s, after
+/// checking (in 1 pass, with 1 branch) that every element is in range.
+/// `trap`s if any is not. The check covers only the elements as they are
+/// now; do not store out-of-range values through `s` while using the view.
+template <auto Min, auto Max, typename Span>
+auto as_ranged(Span s) {
+  using T = std::remove_const_t<typename Span::element_type>;
+  static_assert(internal::in_range<T>(Min) && internal::in_range<T>(Max),
+                "Min and Max must be in the range of T");
+  constexpr T min = static_cast<T>(Min);
+  constexpr T max = static_cast<T>(Max);
+  // A byte, not a `bool`, so that compilers vectorize the loop.
+  uint8_t out_of_range = 0;
+  for (const T x : s) {
+    out_of_range |=
+        static_cast<uint8_t>(static_cast<uint8_t>(x < min) | (x > max));
+  }
+  if (out_of_range != 0) {
+    trap();
+  }
+  return internal::view_as<
+      internal::copy_const_t<typename Span::element_type,
+                             ranged<T, min, max>>>(s);
+}
+
+/// ### `as_raw`
+///
+/// Returns a view of the elements of `s` (`trapping<T>`s, `ranged`s, et c.)
+/// as the `T`s they hold. The view is `const` for `ranged`s.
+template <typename Span>
+auto as_raw(Span s) {
+  using C = typename Span::element_type;
+  using Raw =
+      typename internal::layout_traits<std::remove_const_t<C>>::raw_type;
+  return internal::view_as<internal::copy_const_t<C, Raw>>(s);
+}
+
+}  // namespace integers
+
+#endif  // LAYOUT_H_
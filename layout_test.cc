@@ -0,0 +1,176 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <type_traits>
+#include <vector>
+
+#include "layout.h"
+#include "test_support.h"
+
+using namespace integers;
+using namespace std;
+
+namespace {
+
+using i8 = int8_t;
+using u8 = uint8_t;
+using i16 = int16_t;
+using u16 = uint16_t;
+using i32 = int32_t;
+using u32 = uint32_t;
+using i64 = int64_t;
+using u64 = uint64_t;
+
+template <typename T>
+constexpr bool LayoutCompatible() {
+  return internal::is_layout_compatible_v<trapping<T>, T> &&
+         internal::is_layout_compatible_v<wrapping<T>, T> &&
+         internal::is_layout_compatible_v<clamping<T>, T> &&
+         internal::is_layout_compatible_v<ranged<T, 0, 1>, T> &&
+         internal::is_layout_compatible_v<integer<T, trap_policy>, T> &&
+         internal::is_layout_compatible_v<integer<T, wrap_policy>, T> &&
+         internal::is_layout_compatible_v<integer<T, saturate_policy>, T> &&
+         internal::is_layout_compatible_v<integer<T, assume_policy>, T> &&
+         internal::is_layout_compatible_v<integer<T, unchecked_release_policy>,
+                                          T>;
+}
+
+static_assert(LayoutCompatible<i8>() && LayoutCompatible<u8>() &&
+              LayoutCompatible<i16>() && LayoutCompatible<u16>() &&
+              LayoutCompatible<i32>() && LayoutCompatible<u32>() &&
+              LayoutCompatible<i64>() && LayoutCompatible<u64>());
+#if defined(INTEGERS_HAVE_INT128)
+static_assert(LayoutCompatible<int128_t>() && LayoutCompatible<uint128_t>());
+#endif
+// The sticky flag takes space.
+static_assert(!internal::is_layout_compatible_v<integer<i32, sticky_policy>,
+                                                i32>);
+
+static_assert(is_same_v<decltype(as_trapping(declval<bounded_span<u32>>())),
+                        bounded_span<trapping<u32>>>);
+static_assert(
+    is_same_v<decltype(as_trapping(declval<bounded_span<const u32>>())),
+              bounded_span<const trapping<u32>>>);
+static_assert(is_same_v<decltype(as_raw(declval<bounded_span<wrapping<i8>>>())),
+                        bounded_span<i8>>);
+static_assert(
+    is_same_v<decltype(as_raw(declval<bounded_span<ranged<u8, 1, 4>>>())),
+              bounded_span<const u8>>);
+
+void TestTrapping() {
+  vector<u32> counts = {1, 2, 3, 0x7fffffff};
+  const bounded_span<trapping<u32>> checked = as_trapping(bounded_span(counts));
+  EXPECT(checked.size() == 4);
+  EXPECT(static_cast<const void*>(checked.data()) == counts.data());
+  for (trapping<u32>& count : checked) {
+    count *= 2U;
+  }
+  EXPECT(counts[0] == 2 && counts[3] == 0xfffffffe);
+  EXPECT_DEATH(checked.at(3) += 2U);
+  EXPECT(counts[3] == 0xfffffffe);
+
+  counts[1] = 40;
+  EXPECT(checked.at(1) == 40U);
+
+  const bounded_span<u32> raw = as_raw(checked);
+  EXPECT(raw.data() == counts.data() && raw.size() == 4);
+  raw.at(0) = 7;
+  EXPECT(checked.at(0) == 7U);
+
+  const vector<u32>& readonly = counts;
+  const bounded_span<const trapping<u32>> view =
+      as_trapping(bounded_span(readonly));
+  EXPECT(view.at(2) + 1U == 7U);
+}
+
+void TestWrappingAndClamping() {
+  array<i8, 3> samples = {100, -100, 5};
+  for (wrapping<i8>& x : as_wrapping(bounded_span(samples))) {
+    x += i8{100};
+  }
+  EXPECT(samples[0] == -56 && samples[1] == 0 && samples[2] == 105);
+
+  for (clamping<i8>& x : as_clamping(bounded_span(samples))) {
+    x += i8{100};
+  }
+  EXPECT(samples[0] == 44 && samples[1] == 100 && samples[2] == 127);
+
+  const bounded_span<integer<i8, saturate_policy>> saturating =
+      as_integer<saturate_policy>(bounded_span(samples));
+  saturating.at(1) *= 3;
+  EXPECT(samples[1] == 127);
+}
+
+void TestRanged() {
+  vector<u8> kinds = {1, 4, 2, 3};
+  const bounded_span<ranged<u8, 1, 4>> checked =
+      as_ranged<1, 4>(bounded_span(kinds));
+  EXPECT(checked.size() == 4);
+  EXPECT(checked.at(1) == 4);
+  checked.at(0) = ranged<u8, 1, 4>(u8{2});
+  EXPECT(kinds[0] == 2);
+
+  const bounded_span<const u8> raw = as_raw(checked);
+  EXPECT(raw.at(3) == 3);
+
+  kinds[2] = 5;
+  EXPECT_DEATH(((void)as_ranged<1, 4>(bounded_span(kinds))));
+  kinds[2] = 0;
+  EXPECT_DEATH(((void)as_ranged<1, 4>(bounded_span(kinds))));
+
+  const vector<i32> deltas = {-3, 0, 3};
+  const bounded_span<const ranged<i32, -3, 3>> view =
+      as_ranged<-3, 3>(bounded_span(deltas));
+  EXPECT(view.at(0) == -3);
+  EXPECT_DEATH(((void)as_ranged<-2, 3>(bounded_span(deltas))));
+
+  // Empty spans are in any range.
+  EXPECT((as_ranged<1, 4>(bounded_span<u8>()).empty()));
+}
+
+#ifdef __cpp_lib_span
+void TestSpan() {
+  array<u16, 4> x = {1, 2, 3, 4};
+  const span<trapping<u16>, 4> checked = as_trapping(span(x));
+  checked[3] *= 2U;
+  EXPECT(x[3] == 8);
+  EXPECT_DEATH(checked[0] -= 2U);
+
+  const span<u16, 4> raw = as_raw(checked);
+  EXPECT(raw.data() == x.data());
+
+  const vector<u16> y = {10, 20};
+  const span<const clamping<u16>> view = as_clamping(span(y));
+  EXPECT(view[0] - 20U == 0U);
+
+  const span<const ranged<u16, 10, 20>> ranged_view =
+      as_ranged<10, 20>(span(y));
+  EXPECT(ranged_view.size() == 2);
+}
+#endif
+
+}  // namespace
+
+int main() {
+  TestTrapping();
+  TestWrappingAndClamping();
+  TestRanged();
+#ifdef __cpp_lib_span
+  TestSpan();
+#endif
+}
@@ -0,0 +1,103 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OSTREAM_H_
+#define OSTREAM_H_
+
+#include <stdint.h>
+
+#include <ostream>
+#include <string_view>
+
+#include "format.h"
+
+#if defined(INTEGERS_HAVE_INT128)
+namespace internal {
+
+// Writes a 128-bit `value` as `os` would write a 64-bit one: in the base
+// that `os`’s flags select, with `showbase`, `uppercase`, and `showpos`, and
+// padded to `os.width()`. As for narrower types, negative values are written
+// in 2’s complement in hexadecimal and octal.
+template <typename T>
+void write_128(std::ostream& os, T value) {
+  const std::ios_base::fmtflags flags = os.flags();
+  const std::ios_base::fmtflags base = flags & std::ios_base::basefield;
+  // 43 octal digits and a prefix, or 39 decimal digits and a sign.
+  char buffer[48];
+  char* p = buffer;
+  std::to_chars_result r;
+  if (base == std::ios_base::hex || base == std::ios_base::oct) {
+    const auto bits = static_cast<integers::uint128_t>(value);
+    const bool upper = (flags & std::ios_base::uppercase) != 0;
+    if ((flags & std::ios_base::showbase) != 0 && bits != 0) {
+      *p++ = '0';
+      if (base == std::ios_base::hex) {
+        *p++ = upper ? 'X' : 'x';
+      }
+    }
+    r = to_chars(p, buffer + sizeof(buffer), bits,
+                 base == std::ios_base::hex ? 16 : 8);
+    for (char* digit = p; upper && digit != r.ptr; ++digit) {
+      if (*digit >= 'a' && *digit <= 'f') {
+        *digit = static_cast<char>(*digit - 'a' + 'A');
+      }
+    }
+  } else {
+    if constexpr (is_signed_v<T>) {
+      if ((flags & std::ios_base::showpos) != 0 && value >= 0) {
+        *p++ = '+';
+      }
+    }
+    r = to_chars(p, buffer + sizeof(buffer), value, 10);
+  }
+  os << std::string_view(buffer, static_cast<size_t>(r.ptr - buffer));
+}
+
+}  // namespace internal
+#endif
+
+namespace integers {
+
+/// ## `ostream` Output
+///
+/// ### `operator<<`
+///
+/// Writes the value of a `trapping<T>`, `wrapping<T>`, `clamping<T>`,
+/// `ranged<T, Min, Max>`, or `integer<T, Policy>` to `os`, exactly as `os`
+/// would write a plain `T`. (So, an 8-bit value is written as a character.)
+/// `std::ostream` does not support 128-bit values, so this writes those
+/// itself, honoring the base (`std::hex`, `std::oct`), `std::showbase`,
+/// `std::uppercase`, `std::showpos`, and the field width and fill. (It
+/// ignores the locale’s digit grouping, and `std::internal` adjustment.)
+///
+/// This is in a separate header so that the class headers need not include
+/// `<ostream>`. Include it where you use iostreams; elsewhere, consider
+/// `to_chars` or `std::format`. (See format.h.)
+template <typename C,
+          std::enable_if_t<internal::formattable<C>::value, int> = 0>
+std::ostream& operator<<(std::ostream& os, C value) {
+  using T = typename internal::formattable<C>::value_type;
+  if constexpr (sizeof(T) > sizeof(uint64_t)) {
+#if defined(INTEGERS_HAVE_INT128)
+    internal::write_128(os, internal::formattable<C>::get(value));
+#endif
+  } else {
+    os << internal::formattable<C>::get(value);
+  }
+  return os;
+}
+
+}  // namespace integers
+
+#endif  // OSTREAM_H_
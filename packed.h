@@ -0,0 +1,332 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PACKED_H_
+#define PACKED_H_
+
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <type_traits>
+
+#include "bounded_span.h"
+#include "is_integral.h"
+#include "trap.h"
+#include "trapping.h"
+
+namespace integers {
+
+template <typename T>
+class wrapping;
+template <typename T>
+class clamping;
+template <typename T, T Min, T Max>
+class ranged;
+template <typename T, typename Policy>
+class integer;
+template <typename T, int FracBits, typename Policy>
+class fixed;
+
+}  // namespace integers
+
+namespace internal {
+
+// `packed_traits<C>` describes how to store a `C` in a packed field: `raw_type`
+// is the integral type of its representation, `from_raw` makes a `C` from one,
+// and `to_raw` gets one from a `C`. `from_raw` applies `C`’s own rules: e.g.
+// a `ranged` `trap`s if the value is out of its range.
+template <typename C, typename = void>
+struct packed_traits;
+
+template <typename T>
+struct packed_traits<T, std::enable_if_t<is_integral_v<T>>> {
+  using raw_type = T;
+  static constexpr T from_raw(T raw) { return raw; }
+  static constexpr T to_raw(T value) { return value; }
+};
+
+template <typename C, typename T>
+struct packed_class_traits {
+  using raw_type = T;
+  static constexpr C from_raw(T raw) { return C(raw); }
+  static constexpr T to_raw(C value) { return static_cast<T>(value); }
+};
+
+template <typename T>
+struct packed_traits<integers::trapping<T>>
+    : packed_class_traits<integers::trapping<T>, T> {};
+
+template <typename T>
+struct packed_traits<integers::wrapping<T>>
+    : packed_class_traits<integers::wrapping<T>, T> {};
+
+template <typename T>
+struct packed_traits<integers::clamping<T>>
+    : packed_class_traits<integers::clamping<T>, T> {};
+
+template <typename T, T Min, T Max>
+struct packed_traits<integers::ranged<T, Min, Max>>
+    : packed_class_traits<integers::ranged<T, Min, Max>, T> {};
+
+template <typename T, typename Policy>
+struct packed_traits<integers::integer<T, Policy>>
+    : packed_class_traits<integers::integer<T, Policy>, T> {
+  // A field holds only the `T`, so it would drop the overflow flag.
+  static_assert(!Policy::kSticky,
+                "be<C> and le<C> do not support sticky_policy");
+};
+
+template <typename T, int FracBits, typename Policy>
+struct packed_traits<integers::fixed<T, FracBits, Policy>> {
+  using raw_type = T;
+  using C = integers::fixed<T, FracBits, Policy>;
+  static constexpr C from_raw(T raw) { return C::from_raw(raw); }
+  static constexpr T to_raw(C value) { return value.raw(); }
+};
+
+// Byte-swapping `memcpy` loads and stores compile to 1 `movbe` (x86-64, where
+// the target has it) or `ldr` and `rev` (AArch64), or a load and `bswap`.
+// Where the compiler does not tell us the byte order, the portable fallback
+// assembles the value a byte at a time, which GCC and Clang also fold into a
+// single load.
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__)
+inline constexpr bool kHostBigEndian = __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__;
+#define INTEGERS_HAVE_BYTE_ORDER
+#endif
+
+#if defined(INTEGERS_HAVE_BYTE_ORDER)
+template <typename U>
+U byte_swap(U x) {
+  if constexpr (sizeof(U) == 1) {
+    return x;
+  } else if constexpr (sizeof(U) == 2) {
+    return __builtin_bswap16(x);
+  } else if constexpr (sizeof(U) == 4) {
+    return __builtin_bswap32(x);
+  } else if constexpr (sizeof(U) == 8) {
+    return __builtin_bswap64(x);
+  } else {
+    static_assert(sizeof(U) == 16);
+    return static_cast<U>(
+        U{__builtin_bswap64(static_cast<uint64_t>(x))} << 64 |
+        U{__builtin_bswap64(static_cast<uint64_t>(x >> 64))});
+  }
+}
+#endif
+
+// Returns the unsigned `U` stored at `p`, most significant byte first if
+// `BigEndian`, or least significant first otherwise.
+template <typename U, bool BigEndian>
+U load_bytes(const unsigned char* p) {
+#if defined(INTEGERS_HAVE_BYTE_ORDER)
+  U x;
+  memcpy(&x, p, sizeof(x));
+  return BigEndian == kHostBigEndian ? x : byte_swap(x);
+#else
+  U x = 0;
+  for (size_t i = 0; i < sizeof(U); i++) {
+    const size_t shift = CHAR_BIT * (BigEndian ? sizeof(U) - 1 - i : i);
+    x = static_cast<U>(x | static_cast<U>(U{p[i]} << shift));
+  }
+  return x;
+#endif
+}
+
+// Stores the unsigned `x` at `p`, in the byte order of `load_bytes`.
+template <typename U, bool BigEndian>
+void store_bytes(unsigned char* p, U x) {
+#if defined(INTEGERS_HAVE_BYTE_ORDER)
+  if (BigEndian != kHostBigEndian) {
+    x = byte_swap(x);
+  }
+  memcpy(p, &x, sizeof(x));
+#else
+  for (size_t i = 0; i < sizeof(U); i++) {
+    const size_t shift = CHAR_BIT * (BigEndian ? sizeof(U) - 1 - i : i);
+    p[i] = static_cast<unsigned char>(x >> shift);
+  }
+#endif
+}
+
+#undef INTEGERS_HAVE_BYTE_ORDER
+
+// The storage of `be<C>` and `le<C>`.
+template <typename C, bool BigEndian>
+class packed_field {
+  using Traits = packed_traits<C>;
+  using Raw = typename Traits::raw_type;
+  using U = make_unsigned_t<Raw>;
+
+ public:
+  /// ### `load`
+  ///
+  /// Returns the value, converted from the field’s byte order.
+  C load() const {
+    return Traits::from_raw(
+        static_cast<Raw>(load_bytes<U, BigEndian>(bytes_)));
+  }
+
+  /// ### `store`
+  ///
+  /// Stores `value` in the field’s byte order.
+  void store(C value) {
+    store_bytes<U, BigEndian>(bytes_, static_cast<U>(Traits::to_raw(value)));
+  }
+
+ private:
+  unsigned char bytes_[sizeof(Raw)];
+};
+
+}  // namespace internal
+
+namespace integers {
+
+/// ## Packed Fields
+///
+/// `be<C>` and `le<C>` are big- and little-endian integer fields, with no
+/// alignment and no padding, for structs that describe the layout of file
+/// formats, network packets, and so on. `C` is an integral type, or 1 of the
+/// class templates in this library (e.g. `be<trapping<uint32_t>>`), including
+/// `fixed`, but not `integer<T, sticky_policy>`, whose overflow flag a field
+/// has no room for. `load` returns a `C` directly, with a single
+/// (byte-swapping) load: there is no need to `memcpy` into a native integer,
+/// swap it, and then wrap it. Constructing the `C` applies its rules, so e.g.
+/// loading a `be<ranged<uint8_t, 1, 4>>` `trap`s if the byte is out of range.
+/// (Fields do not convert to `C` implicitly, since that would make mixed
+/// operators like `trapping<T> == U` ambiguous.)
+///
+///   struct Header {
+///     be<trapping<uint32_t>> magic;
+///     be<trapping<uint16_t>> version;
+///     be<trapping<uint32_t>> table_offset;  // Unaligned: at offset 6.
+///     be<trapping<uint32_t>> table_count;
+///   };
+///
+///   const Header* h = packed_view<Header>(file, file_size);
+///   const trapping<uint32_t> table_end =  // `trap`s on overflow.
+///       h->table_offset.load() + h->table_count.load() * 8U;
+///
+/// `be<C>` and `le<C>` have size `sizeof(C)` and alignment 1, and are
+/// trivially copyable and standard-layout, so a struct of them has exactly
+/// the layout of the format, and `packed_view` can overlay it on a buffer
+/// (e.g. from `mmap`) without copying.
+///
+/// ### `be<C>`
+///
+/// A big-endian (network byte order) field.
+template <typename C>
+class be : public internal::packed_field<C, true> {
+ public:
+  be() = default;
+
+  /// ### `operator=`
+  ///
+  /// Stores `value`, as `store` does.
+  be& operator=(C value) {
+    this->store(value);
+    return *this;
+  }
+};
+
+/// ### `le<C>`
+///
+/// A little-endian field.
+template <typename C>
+class le : public internal::packed_field<C, false> {
+ public:
+  le() = default;
+
+  /// ### `operator=`
+  ///
+  /// Stores `value`, as `store` does.
+  le& operator=(C value) {
+    this->store(value);
+    return *this;
+  }
+};
+
+static_assert(sizeof(be<uint32_t>) == 4 && alignof(be<uint32_t>) == 1,
+              "be<T> must have the size of T, and no alignment");
+static_assert(std::is_trivially_copyable_v<le<uint64_t>> &&
+                  std::is_standard_layout_v<le<uint64_t>>,
+              "le<T> must be trivially copyable and standard-layout");
+
+/// ## Packed Views
+///
+/// These functions return a pointer to (or span of) a struct of packed fields
+/// at `offset` in the `size` bytes at `data`, without copying. They `trap` if
+/// it does not fit entirely within those bytes (computing the end with
+/// overflow checks). `S` must have alignment 1 (i.e. consist of `be`, `le`, and
+/// byte fields) and be trivially copyable and standard-layout, so that any
+/// offset is valid and the layout is exactly the declared one.
+///
+/// ### `packed_view`
+///
+/// Returns a pointer to the `S` at `offset` in `data`.
+template <typename S>
+const S* packed_view(const void* data, size_t size, size_t offset = 0) {
+  static_assert(alignof(S) == 1, "packed_view needs a packed struct");
+  static_assert(
+      std::is_trivially_copyable_v<S> && std::is_standard_layout_v<S>,
+      "packed_view needs a trivially copyable, standard-layout struct");
+  if (trapping_add<size_t>(offset, sizeof(S)) > size) {
+    trap();
+  }
+  return reinterpret_cast<const S*>(static_cast<const unsigned char*>(data) +
+                                    offset);
+}
+
+template <typename S>
+S* packed_view(void* data, size_t size, size_t offset = 0) {
+  return const_cast<S*>(
+      packed_view<S>(static_cast<const void*>(data), size, offset));
+}
+
+/// ### `packed_array_view`
+///
+/// Returns a `bounded_span` of the `count` consecutive `S`s at `offset` in
+/// `data` (e.g. a table of records).
+template <typename S>
+bounded_span<const S> packed_array_view(const void* data,
+                                        size_t size,
+                                        size_t offset,
+                                        size_t count) {
+  static_assert(alignof(S) == 1, "packed_array_view needs a packed struct");
+  static_assert(
+      std::is_trivially_copyable_v<S> && std::is_standard_layout_v<S>,
+      "packed_array_view needs a trivially copyable, standard-layout struct");
+  if (trapping_add<size_t>(offset, trapping_mul<size_t>(count, sizeof(S))) >
+      size) {
+    trap();
+  }
+  return {reinterpret_cast<const S*>(static_cast<const unsigned char*>(data) +
+                                     offset),
+          count};
+}
+
+template <typename S>
+bounded_span<S> packed_array_view(void* data,
+                                  size_t size,
+                                  size_t offset,
+                                  size_t count) {
+  const bounded_span<const S> view =
+      packed_array_view<S>(static_cast<const void*>(data), size, offset, count);
+  return {const_cast<S*>(view.data()), view.size()};
+}
+
+}  // namespace integers
+
+#endif  // PACKED_H_
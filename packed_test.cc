@@ -0,0 +1,206 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <type_traits>
+#include <vector>
+
+#include "clamping.h"
+#include "fixed.h"
+#include "integer.h"
+#include "packed.h"
+#include "ranged.h"
+#include "test_support.h"
+#include "trapping.h"
+#include "wrapping.h"
+
+using namespace integers;
+using namespace std;
+
+namespace {
+
+// `std::fixed` is an iostream manipulator.
+using integers::fixed;
+
+using i16 = int16_t;
+using u8 = uint8_t;
+using u16 = uint16_t;
+using i32 = int32_t;
+using u32 = uint32_t;
+using i64 = int64_t;
+using u64 = uint64_t;
+
+struct Header {
+  be<trapping<u32>> magic;
+  be<trapping<u16>> version;
+  be<trapping<u32>> table_offset;
+  be<trapping<u32>> table_count;
+  be<ranged<u8, 1, 4>> kind;
+};
+
+struct Record {
+  le<u16> id;
+  le<i32> delta;
+};
+
+static_assert(sizeof(Header) == 15);
+static_assert(alignof(Header) == 1);
+static_assert(offsetof(Header, table_offset) == 6);
+static_assert(sizeof(Record) == 6);
+static_assert(is_trivially_copyable_v<Header>);
+static_assert(is_standard_layout_v<Header>);
+static_assert(is_same_v<decltype(declval<Header>().magic.load()),
+                        trapping<u32>>);
+
+// Bytes are most significant first for `be`, and least significant first for
+// `le`.
+template <typename Field>
+u64 FieldValue(const vector<u8>& bytes) {
+  Field field;
+  memcpy(&field, bytes.data(), sizeof(field));
+  return static_cast<u64>(field.load());
+}
+
+void TestLoad() {
+  EXPECT(FieldValue<be<u8>>({0xab}) == 0xab);
+  EXPECT(FieldValue<be<u16>>({0x12, 0x34}) == 0x1234);
+  EXPECT(FieldValue<le<u16>>({0x12, 0x34}) == 0x3412);
+  EXPECT(FieldValue<be<u32>>({0x12, 0x34, 0x56, 0x78}) == 0x12345678);
+  EXPECT(FieldValue<le<u32>>({0x12, 0x34, 0x56, 0x78}) == 0x78563412);
+  EXPECT(FieldValue<be<u64>>({1, 2, 3, 4, 5, 6, 7, 8}) == 0x0102030405060708);
+  EXPECT(FieldValue<le<u64>>({1, 2, 3, 4, 5, 6, 7, 8}) == 0x0807060504030201);
+  {
+    be<i16> x;
+    memcpy(&x, "\xff\xfe", 2);
+    EXPECT(x.load() == -2);
+  }
+  {
+    le<i64> x;
+    memcpy(&x, "\xfe\xff\xff\xff\xff\xff\xff\xff", 8);
+    EXPECT(x.load() == -2);
+  }
+#if defined(INTEGERS_HAVE_INT128)
+  {
+    be<uint128_t> x;
+    const u8 bytes[16] = {1, 2,  3,  4,  5,  6,  7,  8,
+                          9, 10, 11, 12, 13, 14, 15, 16};
+    memcpy(&x, bytes, 16);
+    EXPECT(static_cast<u64>(x.load() >> 64) == 0x0102030405060708);
+    EXPECT(static_cast<u64>(x.load()) == 0x090a0b0c0d0e0f10);
+  }
+#endif
+}
+
+template <typename F, typename C>
+void GenericTestRoundTrip(C value) {
+  F field;
+  field = value;
+  EXPECT(field.load() == value);
+  F copy;
+  memcpy(&copy, &field, sizeof(field));
+  EXPECT(copy.load() == value);
+}
+
+void TestStore() {
+  GenericTestRoundTrip<be<u16>>(u16{0xbeef});
+  GenericTestRoundTrip<le<i32>>(i32{-123456});
+  GenericTestRoundTrip<be<i64>>(i64{-1234567890123});
+  GenericTestRoundTrip<le<trapping<u64>>>(trapping<u64>{0x1122334455667788});
+  GenericTestRoundTrip<be<wrapping<i16>>>(wrapping<i16>{i16{-5}});
+  GenericTestRoundTrip<le<clamping<u32>>>(clamping<u32>{7U});
+  GenericTestRoundTrip<be<integer<i32, saturate_policy>>>(
+      integer<i32, saturate_policy>{-9});
+  GenericTestRoundTrip<be<fixed<i32, 16>>>(fixed<i32, 16>{-2.5});
+
+  be<u32> x;
+  x = 0x01020304;
+  u8 bytes[4];
+  memcpy(bytes, &x, 4);
+  EXPECT(bytes[0] == 1 && bytes[3] == 4);
+  le<u32> y;
+  y = 0x01020304;
+  memcpy(bytes, &y, 4);
+  EXPECT(bytes[0] == 4 && bytes[3] == 1);
+}
+
+vector<u8> MakeFile() {
+  vector<u8> file = {
+      0,    0,    0,    0,                 // Padding, to misalign.
+      0xca, 0xfe, 0xba, 0xbe,              // magic
+      0,    2,                             // version
+      0,    0,    0,    15,                // table_offset
+      0,    0,    0,    2,                 // table_count
+      3,                                   // kind
+      1,    0,    0xfe, 0xff, 0xff, 0xff,  // Record 0
+      2,    0,    0x10, 0,    0,    0,     // Record 1
+  };
+  return file;
+}
+
+void TestView() {
+  const vector<u8> file = MakeFile();
+  const Header* h = packed_view<Header>(file.data(), file.size(), 4);
+  EXPECT(h->magic.load() == 0xcafebabe);
+  EXPECT(h->version.load() == 2);
+  EXPECT(h->kind.load() == 3);
+  // Arithmetic on the fields is `trapping<u32>` arithmetic.
+  const trapping<u32> table_end =
+      h->table_offset.load() + h->table_count.load() * sizeof(Record);
+  EXPECT(table_end == 27U);
+  EXPECT_DEATH((void)(h->magic.load() * 2U));
+
+  const bounded_span<const Record> records = packed_array_view<Record>(
+      file.data(), file.size(), 4 + h->table_offset.load(),
+      h->table_count.load());
+  EXPECT(records.size() == 2);
+  EXPECT(records.at(0).id.load() == 1 && records.at(0).delta.load() == -2);
+  EXPECT(records.at(1).id.load() == 2 && records.at(1).delta.load() == 16);
+
+  EXPECT_DEATH((void)packed_view<Header>(file.data(), file.size(), 20));
+  EXPECT_DEATH((void)packed_view<Header>(file.data(), 18, 4));
+  EXPECT_DEATH((void)packed_view<Header>(file.data(), file.size(), SIZE_MAX));
+  EXPECT_DEATH(
+      (void)packed_array_view<Record>(file.data(), file.size(), 19, 3));
+  EXPECT_DEATH((void)packed_array_view<Record>(file.data(), file.size(), 0,
+                                               SIZE_MAX / 2));
+
+  // An out-of-range `ranged` field `trap`s when it is read.
+  vector<u8> bad = file;
+  bad[4 + 14] = 5;
+  const Header* b = packed_view<Header>(bad.data(), bad.size(), 4);
+  EXPECT_DEATH((void)b->kind.load());
+}
+
+void TestWrite() {
+  vector<u8> file = MakeFile();
+  Header* h = packed_view<Header>(file.data(), file.size(), 4);
+  h->version = u16{3};
+  EXPECT(file[9] == 3);
+  const bounded_span<Record> records =
+      packed_array_view<Record>(file.data(), file.size(), 19, 2);
+  records.at(1).delta = -1;
+  EXPECT(file[27] == 0xff && file[30] == 0xff);
+}
+
+}  // namespace
+
+int main() {
+  TestLoad();
+  TestStore();
+  TestView();
+  TestWrite();
+}
@@ -0,0 +1,243 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PARSE_H_
+#define PARSE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <limits>
+#include <string_view>
+#include <type_traits>
+
+#include "checked.h"
+#include "is_integral.h"
+#include "telemetry.h"
+#include "trap.h"
+#include "trapping.h"
+
+namespace internal {
+
+// Returns the value of the digit `c` in bases up to 36 (0–9, then a–z or
+// A–Z), or 36 (which is not a digit in any base) if `c` is not a digit.
+constexpr unsigned digit_value(char c) {
+  if ('0' <= c && c <= '9') {
+    return static_cast<unsigned>(c - '0');
+  }
+  const char lower = static_cast<char>(c | 0x20);
+  if ('a' <= lower && lower <= 'z') {
+    return static_cast<unsigned>(lower - 'a' + 10);
+  }
+  return 36;
+}
+
+// Returns the 8 `char`s at `p` as an integer, with `p[0]` in the least
+// significant byte. Compilers fold this into a single load on little-endian
+// targets.
+constexpr uint64_t load_8_chars(const char* p) {
+  const auto byte = [p](int i) {
+    return uint64_t{static_cast<unsigned char>(p[i])} << (8 * i);
+  };
+  return byte(0) | byte(1) | byte(2) | byte(3) | byte(4) | byte(5) | byte(6) |
+         byte(7);
+}
+
+// Returns true if all 8 bytes of `chunk` are ASCII decimal digits: each must
+// be 0x3_, and still be 0x3_ after adding 6. (A carry out of 1 byte can only
+// come from a byte >= 0xfa, which fails anyway.)
+constexpr bool are_8_digits(uint64_t chunk) {
+  constexpr uint64_t kHighNibbles = 0xf0f0f0f0f0f0f0f0;
+  return ((chunk & kHighNibbles) |
+          (((chunk + 0x0606060606060606) & kHighNibbles) >> 4)) ==
+         0x3333333333333333;
+}
+
+// Returns the value of the 8 decimal digits in `chunk` (from `load_8_chars`),
+// with 3 multiplications: 8 digits → 4 2-digit numbers → 2 4-digit numbers
+// → 1 8-digit number.
+constexpr uint32_t parse_8_digits(uint64_t chunk) {
+  chunk -= 0x3030303030303030;
+  chunk = chunk * 10 + (chunk >> 8);
+  chunk = (((chunk & 0x000000ff000000ff) * (100 + (1000000ULL << 32))) +
+           (((chunk >> 16) & 0x000000ff000000ff) * (1 + (10000ULL << 32)))) >>
+          32;
+  return static_cast<uint32_t>(chunk);
+}
+
+// Parses the decimal digits in [`p`, `end`) into `*value`. Returns true if
+// there is a non-digit, or the value overflows `A`.
+//
+// Any number with at most `digits10` digits fits in `A`, so the first that
+// many digits need no overflow checks: they go 8 at a time (with
+// `parse_8_digits`) and then 1 at a time. Only the digits after those need a
+// checked multiply and add each.
+template <typename A>
+constexpr bool parse_decimal(const char* p, const char* end, A* value) {
+  constexpr ptrdiff_t kSafeDigits = std::numeric_limits<A>::digits10;
+  const char* safe_end = end - p > kSafeDigits ? p + kSafeDigits : end;
+  A v = 0;
+  for (; safe_end - p >= 8; p += 8) {
+    const uint64_t chunk = load_8_chars(p);
+    if (!are_8_digits(chunk)) {
+      return true;
+    }
+    v = static_cast<A>(v * 100000000 + parse_8_digits(chunk));
+  }
+  for (; p != safe_end; ++p) {
+    const unsigned digit = digit_value(*p);
+    if (digit >= 10) {
+      return true;
+    }
+    v = static_cast<A>(v * 10 + digit);
+  }
+  for (; p != end; ++p) {
+    const unsigned digit = digit_value(*p);
+    if (digit >= 10 || integers::mul_overflow(v, 10, &v) ||
+        integers::add_overflow(v, digit, &v)) {
+      return true;
+    }
+  }
+  *value = v;
+  return false;
+}
+
+// Parses the digits in [`p`, `end`) in `base` into `*value`. Returns true if
+// there is a non-digit, or the value overflows `A`.
+template <typename A>
+constexpr bool parse_digits(const char* p,
+                            const char* end,
+                            unsigned base,
+                            A* value) {
+  A v = 0;
+  for (; p != end; ++p) {
+    const unsigned digit = digit_value(*p);
+    if (digit >= base || integers::mul_overflow(v, base, &v) ||
+        integers::add_overflow(v, digit, &v)) {
+      return true;
+    }
+  }
+  *value = v;
+  return false;
+}
+
+}  // namespace internal
+
+namespace integers {
+
+/// ## Parsing
+///
+/// These functions parse integers from text, detecting overflow as they go.
+/// They are locale-independent, do not allocate or throw, and do not use
+/// `strtol` et c. or iostreams.
+///
+/// The whole of `text` must be the number: an optional `-` (only if `R` is
+/// signed), then 1 or more digits in `base`. There is no leading whitespace,
+/// `+`, or `0x` prefix. `base` can be 2 through 36; digits after 9 are `a`
+/// through `z` (or `A` through `Z`).
+///
+/// Decimal parsing, the common case, is fastest: runs of 8 digits are
+/// checked and converted at once, with SWAR (SIMD within a register)
+/// arithmetic on a 64-bit word, and only the digits that could overflow are
+/// checked individually. E.g. for `int64_t`, a 19-digit number takes 2 SWAR
+/// steps and 3 single-digit steps, and none of them check for overflow until
+/// the end.
+///
+/// ### `parse_overflow`
+///
+/// Parses `text` and stores the value in `result`. Returns true if `text` is
+/// not a valid number, or if the value does not fit in `R` (in which case
+/// `result` is unchanged).
+template <typename R>
+[[nodiscard]] constexpr bool parse_overflow(std::string_view text,
+                                            R* result,
+                                            int base = 10) {
+  assert_is_integral(R);
+  // Accumulate in the widest type that is fast, and narrow at the end.
+  using A = std::conditional_t<(sizeof(R) > sizeof(uint64_t)),
+                               internal::uwidest_t, uint64_t>;
+
+  const char* p = text.data();
+  const char* const end = p + text.size();
+  bool negative = false;
+  if constexpr (internal::is_signed_v<R>) {
+    if (p != end && *p == '-') {
+      negative = true;
+      ++p;
+    }
+  }
+  if (p == end || base < 2 || base > 36) {
+    return true;
+  }
+
+  A magnitude = 0;
+  const bool bad =
+      base == 10 ? internal::parse_decimal(p, end, &magnitude)
+                 : internal::parse_digits(p, end, static_cast<unsigned>(base),
+                                          &magnitude);
+  if (bad) {
+    return true;
+  }
+
+  constexpr A kMax = static_cast<A>(std::numeric_limits<R>::max());
+  if (negative) {
+    // |min| is `max + 1`.
+    if (magnitude > kMax + 1) {
+      return true;
+    }
+    *result = magnitude == 0
+                  ? R{0}
+                  : static_cast<R>(-static_cast<R>(magnitude - 1) - 1);
+  } else {
+    if (magnitude > kMax) {
+      return true;
+    }
+    *result = static_cast<R>(magnitude);
+  }
+  return false;
+}
+
+/// ### `checked_parse`
+///
+/// Parses `text`, and reports whether it was not a valid number or the value
+/// did not fit in `R`. (See `result<R>` in checked.h.)
+template <typename R>
+constexpr result<R> checked_parse(std::string_view text, int base = 10) {
+  result<R> r{0, false};
+  r.overflowed = parse_overflow(text, &r.value, base);
+  return r;
+}
+
+/// ### `trapping_parse`
+///
+/// Parses `text` and returns the value, which you can assign to a
+/// `trapping<R>`. If `text` is not a valid number, or the value does not fit
+/// in `R`, this function will `trap`.
+template <typename R>
+constexpr R trapping_parse(std::string_view text,
+                           int base = 10 INTEGERS_CALL_SITE) {
+  assert_is_integral(R);
+
+  R result = 0;
+  const bool overflowed = parse_overflow(text, &result, base);
+  INTEGERS_RECORD_CHECK("trapping_parse", overflowed, result);
+  if (overflowed) {
+    trap();
+  }
+  return result;
+}
+
+}  // namespace integers
+
+#endif  // PARSE_H_
@@ -0,0 +1,216 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <limits>
+#include <string>
+
+#include "parse.h"
+#include "test_support.h"
+
+using namespace integers;
+using namespace std;
+
+namespace {
+
+using i8 = int8_t;
+using u8 = uint8_t;
+using i16 = int16_t;
+using u16 = uint16_t;
+using i32 = int32_t;
+using u32 = uint32_t;
+using i64 = int64_t;
+using u64 = uint64_t;
+
+template <typename T>
+void GenericTestExhaustive() {
+  for (int i = numeric_limits<T>::min() - 1; i <= numeric_limits<T>::max() + 1;
+       ++i) {
+    const string text = to_string(i);
+    const result<T> r = checked_parse<T>(text);
+    EXPECT(r.overflowed == !in_range<T>(i));
+    if (!r.overflowed) {
+      EXPECT(r.value == i);
+    }
+  }
+}
+
+void TestExhaustive() {
+  GenericTestExhaustive<i8>();
+  GenericTestExhaustive<u8>();
+  GenericTestExhaustive<i16>();
+  GenericTestExhaustive<u16>();
+}
+
+template <typename T>
+void GenericTestLimits() {
+  constexpr T max = numeric_limits<T>::max();
+  constexpr T min = numeric_limits<T>::min();
+  EXPECT(checked_parse<T>(to_string(max)).value == max);
+  EXPECT(checked_parse<T>(to_string(min)).value == min);
+  EXPECT(checked_parse<T>(to_string(u64{max} + 1)).overflowed);
+  EXPECT(checked_parse<T>(to_string(u64{max}) + "0").overflowed);
+  if constexpr (is_signed_v<T>) {
+    if constexpr (sizeof(T) < sizeof(i64)) {
+      EXPECT(checked_parse<T>(to_string(i64{min} - 1)).overflowed);
+    }
+    EXPECT(checked_parse<T>(to_string(min) + "0").overflowed);
+  } else {
+    EXPECT(checked_parse<T>("-1").overflowed);
+  }
+  EXPECT(trapping_parse<T>("0") == 0);
+  EXPECT_DEATH((void)trapping_parse<T>(to_string(max) + "9"));
+  EXPECT_DEATH((void)trapping_parse<T>(""));
+}
+
+template <class... T>
+void CallGenericTestLimits() {
+  (GenericTestLimits<T>(), ...);
+}
+
+void TestLimits() {
+  // `u64` is separate, since `max + 1` does not fit in a `u64`; and `i64`
+  // has `min - 1` tested below.
+  CallGenericTestLimits<i8, u8, i16, u16, i32, u32, i64>();
+  EXPECT(checked_parse<u64>("18446744073709551615").value ==
+         numeric_limits<u64>::max());
+  EXPECT(checked_parse<u64>("18446744073709551616").overflowed);
+  EXPECT(checked_parse<u64>("99999999999999999999").overflowed);
+  EXPECT(checked_parse<u64>("184467440737095516150").overflowed);
+  EXPECT(checked_parse<i64>("-9223372036854775808").value ==
+         numeric_limits<i64>::min());
+  EXPECT(checked_parse<i64>("9223372036854775808").overflowed);
+  EXPECT(checked_parse<i64>("-9223372036854775809").overflowed);
+}
+
+void TestSyntax() {
+  const char* const bad[] = {"",    "-",   "+1",  " 1",        "1 ",
+                             "1-",  "--1", "0x1", "12a",        "1.0",
+                             "1e3", "١",   "12345678901234x", "/"};
+  for (const char* text : bad) {
+    EXPECT(checked_parse<i32>(text).overflowed);
+    EXPECT(checked_parse<u64>(text).overflowed);
+  }
+  EXPECT(checked_parse<i32>("-0").value == 0);
+  EXPECT(checked_parse<u32>("-0").overflowed);
+  EXPECT(checked_parse<u8>(string(100, '0') + "255").value == 255);
+  EXPECT(checked_parse<u8>(string(100, '0') + "256").overflowed);
+  EXPECT(checked_parse<i64>("-" + string(30, '0') + "1").value == -1);
+
+  // `parse_overflow` leaves `result` alone on failure. The input need not be
+  // NUL-terminated.
+  i16 x = 7;
+  EXPECT(parse_overflow<i16>("40000", &x));
+  EXPECT(x == 7);
+  EXPECT(!parse_overflow<i16>(string_view("-1234567", 5), &x));
+  EXPECT(x == -1234);
+}
+
+void TestSwar() {
+  // Every byte value in every position of an 8-digit chunk.
+  for (int position = 0; position < 8; ++position) {
+    for (int c = 0; c < 256; ++c) {
+      string text = "12345678";
+      text[static_cast<size_t>(position)] = static_cast<char>(c);
+      const uint64_t chunk = internal::load_8_chars(text.data());
+      EXPECT(internal::are_8_digits(chunk) == ('0' <= c && c <= '9'));
+    }
+  }
+  static_assert(internal::parse_8_digits(internal::load_8_chars("12345678")) ==
+                12345678);
+  static_assert(internal::parse_8_digits(internal::load_8_chars("99999999")) ==
+                99999999);
+  static_assert(internal::parse_8_digits(internal::load_8_chars("00000000")) ==
+                0);
+
+  // Numbers of every length, and a bad character at every position.
+  u64 value = 0;
+  for (int length = 1; length <= 20; ++length) {
+    value = value * 10 + static_cast<u64>(length % 10);
+    const string text = to_string(value);
+    EXPECT(checked_parse<u64>(text).value == value);
+    for (size_t i = 0; i < text.size(); ++i) {
+      string broken = text;
+      broken[i] = ':';
+      EXPECT(checked_parse<u64>(broken).overflowed);
+      broken[i] = '/';
+      EXPECT(checked_parse<u64>(broken).overflowed);
+    }
+  }
+  static_assert(checked_parse<i64>("-1234567890123456789").value ==
+                -1234567890123456789);
+}
+
+void TestBases() {
+  EXPECT(checked_parse<u8>("ff", 16).value == 255);
+  EXPECT(checked_parse<u8>("FF", 16).value == 255);
+  EXPECT(checked_parse<u8>("100", 16).overflowed);
+  EXPECT(checked_parse<u8>("fg", 16).overflowed);
+  EXPECT(checked_parse<i8>("-80", 16).value == -128);
+  EXPECT(checked_parse<i8>("80", 16).overflowed);
+  EXPECT(checked_parse<u64>("ffffffffffffffff", 16).value ==
+         numeric_limits<u64>::max());
+  EXPECT(checked_parse<u64>("10000000000000000", 16).overflowed);
+  EXPECT(checked_parse<i64>("7fffffffffffffff", 16).value ==
+         numeric_limits<i64>::max());
+  EXPECT(checked_parse<i64>("8000000000000000", 16).overflowed);
+  EXPECT(checked_parse<u32>("101", 2).value == 5);
+  EXPECT(checked_parse<u32>("102", 2).overflowed);
+  EXPECT(checked_parse<u32>("777", 8).value == 511);
+  EXPECT(checked_parse<u32>("zZ", 36).value == 1295);
+  EXPECT(checked_parse<u32>("1", 1).overflowed);
+  EXPECT(checked_parse<u32>("1", 37).overflowed);
+  EXPECT(checked_parse<u32>("1", -10).overflowed);
+  EXPECT(trapping_parse<u16>("beef", 16) == 0xbeef);
+}
+
+void TestTrapping() {
+  trapping<u32> count = trapping_parse<u32>("4000000000");
+  EXPECT_DEATH(count *= 2U);
+  EXPECT_DEATH((void)trapping_parse<u32>("4294967296"));
+  EXPECT_DEATH((void)trapping_parse<u32>("12 "));
+  static_assert(trapping_parse<i32>("-2147483648") ==
+                numeric_limits<i32>::min());
+}
+
+#if defined(INTEGERS_HAVE_INT128)
+void TestParse128() {
+  EXPECT(checked_parse<uint128_t>("340282366920938463463374607431768211455")
+             .value == numeric_limits<uint128_t>::max());
+  EXPECT(checked_parse<uint128_t>("340282366920938463463374607431768211456")
+             .overflowed);
+  EXPECT(checked_parse<int128_t>("-170141183460469231731687303715884105728")
+             .value == numeric_limits<int128_t>::min());
+  EXPECT(checked_parse<int128_t>("170141183460469231731687303715884105728")
+             .overflowed);
+  EXPECT(checked_parse<uint128_t>("ffffffffffffffffffffffffffffffff", 16)
+             .value == numeric_limits<uint128_t>::max());
+  EXPECT(checked_parse<int128_t>("18446744073709551616").value ==
+         int128_t{1} << 64);
+}
+#endif
+
+}  // namespace
+
+int main() {
+  TestExhaustive();
+  TestLimits();
+  TestSyntax();
+  TestSwar();
+  TestBases();
+  TestTrapping();
+#if defined(INTEGERS_HAVE_INT128)
+  TestParse128();
+#endif
+}
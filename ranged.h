@@ -18,17 +18,81 @@
 #include <stdint.h>
 #include <stdlib.h>
 
-#include <algorithm>
 #include <limits>
 #include <type_traits>
 
+#include "assume.h"
+#include "clamping.h"
 #include "is_integral.h"
 #include "trap.h"
+#include "trapping.h"
+
+namespace internal {
+
+/// The range of values an operation on two `ranged` values can produce,
+/// clamped to the range of `T`. `exact` is true if the whole unclamped range
+/// fits in `T`, so that the operation can never overflow and need not be
+/// checked at run time.
+template <typename T>
+struct bounds {
+  T min;
+  T max;
+  bool exact;
+};
+
+template <typename T>
+constexpr bounds<T> add_bounds(T a_min, T a_max, T b_min, T b_max) {
+  T unused = 0;
+  return {integers::clamping_add<T>(a_min, b_min),
+          integers::clamping_add<T>(a_max, b_max),
+          !integers::add_overflow(a_min, b_min, &unused) &&
+              !integers::add_overflow(a_max, b_max, &unused)};
+}
+
+template <typename T>
+constexpr bounds<T> sub_bounds(T a_min, T a_max, T b_min, T b_max) {
+  T unused = 0;
+  return {integers::clamping_sub<T>(a_min, b_max),
+          integers::clamping_sub<T>(a_max, b_min),
+          !integers::sub_overflow(a_min, b_max, &unused) &&
+              !integers::sub_overflow(a_max, b_min, &unused)};
+}
+
+template <typename T>
+constexpr bounds<T> mul_bounds(T a_min, T a_max, T b_min, T b_max) {
+  // The extremes of a product of two intervals are among the products of
+  // their endpoints. Clamping is monotonic, so the extremes of the clamped
+  // products are the clamped extremes.
+  const T corners[] = {
+      integers::clamping_mul<T>(a_min, b_min),
+      integers::clamping_mul<T>(a_min, b_max),
+      integers::clamping_mul<T>(a_max, b_min),
+      integers::clamping_mul<T>(a_max, b_max),
+  };
+  bounds<T> result{corners[0], corners[0], true};
+  for (T corner : corners) {
+    result.min = corner < result.min ? corner : result.min;
+    result.max = corner > result.max ? corner : result.max;
+  }
+  T unused = 0;
+  result.exact = !integers::mul_overflow(a_min, b_min, &unused) &&
+                 !integers::mul_overflow(a_min, b_max, &unused) &&
+                 !integers::mul_overflow(a_max, b_min, &unused) &&
+                 !integers::mul_overflow(a_max, b_max, &unused);
+  return result;
+}
+
+/// A tag for the `ranged` constructor that skips the range check, for values
+/// that are in range by construction.
+struct unchecked_t {};
+inline constexpr unchecked_t unchecked;
+
+}  // namespace internal
 
 namespace integers {
 
 template <typename T, T Min, T Max>
-void assert_in_range(const T& value) {
+constexpr void assert_in_range(const T& value) {
   if (value < Min || value > Max) {
     trap();
   }
@@ -36,7 +100,33 @@ void assert_in_range(const T& value) {
 
 /// ## `ranged<T>`
 ///
-/// TODO: Documentation.
+/// This template class implements integer types whose values are constrained
+/// to [`Min`, `Max`]. Constructing a `ranged` from a value outside the range
+/// `trap`s.
+///
+/// Arithmetic on `ranged` values (`+`, `-`, `*`, and unary `-`) returns a
+/// `ranged` whose bounds are computed at compile time from the operands’
+/// bounds. For example,
+///
+///   ranged<int, 0, 100> a = ...;
+///   ranged<int, 0, 100> b = ...;
+///   auto c = a + b;  // ranged<int, 0, 200>
+///   auto d = a - b;  // ranged<int, -100, 100>
+///
+/// If the result’s bounds fit in `T`, the operation cannot overflow, and
+/// there is no run-time check at all. Otherwise, the bounds are clamped to the
+/// range of `T`, and the operation `trap`s at run time if it overflows (like
+/// `trapping<T>`).
+///
+/// A `ranged<T, Min, Max>` converts implicitly, and without a check, to any
+/// `ranged<T, A, B>` with a range that contains [`Min`, `Max`]. Converting to
+/// a narrower range must be explicit, and is checked.
+///
+/// Reading the value (with `operator T`) also tells the compiler that it is
+/// in range (with `__builtin_assume`, or `__builtin_unreachable` if that is
+/// not available), so that it can remove redundant checks in your code, too.
+///
+/// All operations are `constexpr`.
 template <typename T, T Min, T Max>
 class ranged {
   assert_is_integral(T);
@@ -44,19 +134,128 @@ class ranged {
 
   using Self = ranged<T, Min, Max>;
 
+  template <typename U, U OtherMin, U OtherMax>
+  friend class ranged;
+
  public:
-  ranged() : value_(0) { assert_in_range<T, Min, Max>(value_); }
+  /// ### `ranged`
+  ///
+  /// The default constructor. Initializes the value to 0, and `trap`s if 0 is
+  /// not in range.
+  constexpr ranged() : value_(0) { assert_in_range<T, Min, Max>(value_); }
 
-  ranged(const T& value) : value_(value) {
+  /// ### `ranged`
+  ///
+  /// Constructs and initializes. `trap`s if `value` is not in range.
+  constexpr ranged(const T& value) : value_(value) {
     assert_in_range<T, Min, Max>(value_);
   }
 
-  operator T() const { return value_; }
+  /// ### `ranged`
+  ///
+  /// Converts from a `ranged` with a range that is contained in this one,
+  /// without a check.
+  template <T OtherMin,
+            T OtherMax,
+            std::enable_if_t<(Min <= OtherMin && OtherMax <= Max), int> = 0>
+  constexpr ranged(ranged<T, OtherMin, OtherMax> other)
+      : value_(other.value_) {}
+
+  /// ### `ranged`
+  ///
+  /// Converts from a `ranged` with a range that is not contained in this one.
+  /// `trap`s if `other` is not in range.
+  template <T OtherMin,
+            T OtherMax,
+            std::enable_if_t<!(Min <= OtherMin && OtherMax <= Max), int> = 0>
+  constexpr explicit ranged(ranged<T, OtherMin, OtherMax> other)
+      : ranged(other.value_) {}
+
+  /// ### `operator T`
+  ///
+  /// Returns the value, and tells the compiler that it is in range.
+  constexpr operator T() const {
+    INTEGERS_ASSUME(!(value_ < Min) && !(value_ > Max));
+    return value_;
+  }
+
+  /// ### `operator+`
+  ///
+  /// Adds `rhs` to the value, and returns the sum as a `ranged` with the bounds
+  /// of all possible sums. Checks for overflow only if the sum of the bounds
+  /// does not fit in `T`.
+  template <T OtherMin, T OtherMax>
+  constexpr auto operator+(ranged<T, OtherMin, OtherMax> rhs) const {
+    constexpr auto b = internal::add_bounds<T>(Min, Max, OtherMin, OtherMax);
+    using R = ranged<T, b.min, b.max>;
+    if constexpr (b.exact) {
+      return R(internal::unchecked, static_cast<T>(value_ + rhs.value_));
+    } else {
+      return R(internal::unchecked, trapping_add<T>(value_, rhs.value_));
+    }
+  }
+
+  /// ### `operator-`
+  ///
+  /// Subtracts `rhs` from the value, and returns the difference as a `ranged`
+  /// with the bounds of all possible differences. Checks for overflow only if
+  /// the difference of the bounds does not fit in `T`.
+  template <T OtherMin, T OtherMax>
+  constexpr auto operator-(ranged<T, OtherMin, OtherMax> rhs) const {
+    constexpr auto b = internal::sub_bounds<T>(Min, Max, OtherMin, OtherMax);
+    using R = ranged<T, b.min, b.max>;
+    if constexpr (b.exact) {
+      return R(internal::unchecked, static_cast<T>(value_ - rhs.value_));
+    } else {
+      return R(internal::unchecked, trapping_sub<T>(value_, rhs.value_));
+    }
+  }
+
+  /// ### `operator*`
+  ///
+  /// Multiplies the value by `rhs`, and returns the product as a `ranged` with
+  /// the bounds of all possible products. Checks for overflow only if the
+  /// product of the bounds does not fit in `T`.
+  template <T OtherMin, T OtherMax>
+  constexpr auto operator*(ranged<T, OtherMin, OtherMax> rhs) const {
+    constexpr auto b = internal::mul_bounds<T>(Min, Max, OtherMin, OtherMax);
+    using R = ranged<T, b.min, b.max>;
+    if constexpr (b.exact) {
+      return R(internal::unchecked, static_cast<T>(value_ * rhs.value_));
+    } else {
+      return R(internal::unchecked, trapping_mul<T>(value_, rhs.value_));
+    }
+  }
+
+  /// ### `operator-`
+  ///
+  /// Returns the value with its sign reversed, as a `ranged<T, -Max, -Min>`.
+  /// Checks for overflow only if `Min` is the minimum value of `T`.
+  constexpr auto operator-() const {
+    static_assert(internal::is_signed_v<T>, "Cannot negate an unsigned value");
+    constexpr auto b = internal::sub_bounds<T>(T{0}, T{0}, Min, Max);
+    using R = ranged<T, b.min, b.max>;
+    if constexpr (b.exact) {
+      return R(internal::unchecked, static_cast<T>(-value_));
+    } else {
+      return R(internal::unchecked, trapping_sub<T>(T{0}, value_));
+    }
+  }
 
  private:
+  constexpr ranged(internal::unchecked_t, T value) : value_(value) {}
+
   T value_;
 };
 
+static_assert(std::is_trivially_copyable_v<ranged<int, 0, 9>>,
+              "`ranged<T>` must be trivially copyable");
+static_assert(std::is_standard_layout_v<ranged<int, 0, 9>>,
+              "`ranged<T>` must be standard-layout");
+static_assert(sizeof(ranged<int64_t, 0, 9>) == sizeof(int64_t) &&
+                  alignof(ranged<int64_t, 0, 9>) == alignof(int64_t),
+              "ranged<int64_t> must have the size and alignment of int64_t");
+
 }  // namespace integers
 
 #endif  // RANGED_H_
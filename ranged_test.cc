@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include <iostream>
+#include <limits>
+#include <type_traits>
 
 #include "ranged.h"
 #include "test_support.h"
@@ -20,7 +22,32 @@
 using namespace std;
 using namespace integers;
 
-int main() {
+namespace {
+
+using Percent = ranged<int, 0, 100>;
+
+// The result bounds are computed at compile time.
+static_assert(is_same_v<decltype(Percent{} + Percent{}), ranged<int, 0, 200>>);
+static_assert(
+    is_same_v<decltype(Percent{} - Percent{}), ranged<int, -100, 100>>);
+static_assert(
+    is_same_v<decltype(Percent{} * Percent{}), ranged<int, 0, 10000>>);
+static_assert(is_same_v<decltype(-Percent{}), ranged<int, -100, 0>>);
+static_assert(is_same_v<decltype(ranged<int, -3, 2>{} * ranged<int, -5, 7>{}),
+                        ranged<int, -21, 15>>);
+
+// When the bounds do not fit in `T`, they are clamped to it.
+static_assert(
+    is_same_v<decltype(ranged<int8_t, 0, 100>{} + ranged<int8_t, 0, 100>{}),
+              ranged<int8_t, 0, 127>>);
+static_assert(
+    is_same_v<decltype(ranged<uint8_t, 0, 10>{} - ranged<uint8_t, 0, 10>{}),
+              ranged<uint8_t, 0, 10>>);
+
+// And everything is `constexpr`.
+static_assert(int{Percent{60} + Percent{70}} == 130);
+
+void TestConstructor() {
   {
     ranged<int, 0, 256> goat{42};
     EXPECT(42 == goat);
@@ -28,6 +55,66 @@ int main() {
   }
   {
     ranged<int, 0, 256> goat;
-    // EXPECT_DEATH(goat{512});
+    EXPECT(0 == goat);
+    EXPECT_DEATH((ranged<int, 0, 256>{512}));
+    EXPECT_DEATH((ranged<int, 0, 256>{-1}));
+    EXPECT_DEATH((ranged<int, 1, 256>{}));
   }
 }
+
+void TestConversion() {
+  const Percent p = 42;
+  // Widening is implicit and unchecked.
+  const ranged<int, -1000, 1000> wide = p;
+  EXPECT(wide == 42);
+  // Narrowing is explicit and checked.
+  EXPECT((ranged<int, 0, 50>{p}) == 42);
+  EXPECT_DEATH((ranged<int, 0, 10>{p}));
+}
+
+void TestArithmetic() {
+  const Percent a = 60;
+  const Percent b = 70;
+  EXPECT(a + b == 130);
+  EXPECT(a - b == -10);
+  EXPECT(a * b == 4200);
+  EXPECT(-a == -60);
+
+  // The result is itself `ranged`, so the bounds keep propagating.
+  const auto c = (a + b) * (a - b);
+  static_assert(is_same_v<decltype(c), const ranged<int, -20000, 20000>>);
+  EXPECT(c == -1300);
+}
+
+void TestChecked() {
+  {
+    const ranged<int8_t, 0, 100> a = int8_t{100};
+    const ranged<int8_t, 0, 100> b = int8_t{27};
+    EXPECT(a + b == 127);
+    const ranged<int8_t, 0, 100> c = int8_t{28};
+    EXPECT_DEATH((void)(a + c));
+  }
+  {
+    const ranged<uint8_t, 0, 10> a = uint8_t{3};
+    const ranged<uint8_t, 0, 10> b = uint8_t{4};
+    EXPECT(b - a == 1);
+    EXPECT_DEATH((void)(a - b));
+  }
+  {
+    constexpr int kMin = numeric_limits<int>::min();
+    const ranged<int, kMin, 0> a = kMin;
+    static_assert(
+        is_same_v<decltype(-a), ranged<int, 0, numeric_limits<int>::max()>>);
+    EXPECT_DEATH((void)(-a));
+    EXPECT((-ranged<int, kMin, 0>{-5}) == 5);
+  }
+}
+
+}  // namespace
+
+int main() {
+  TestConstructor();
+  TestConversion();
+  TestArithmetic();
+  TestChecked();
+}
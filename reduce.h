@@ -0,0 +1,544 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef REDUCE_H_
+#define REDUCE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if __has_include(<span>)
+#include <span>
+#endif
+
+#include "checked.h"
+#include "is_integral.h"
+#include "trap.h"
+#include "trapping.h"
+#include "wide.h"
+
+namespace integers {
+
+/// ## Reductions
+///
+/// ### `parallel`
+///
+/// Pass a `parallel` as the first argument of a reduction function to split
+/// the array into `threads` chunks (by default, 1 per hardware thread),
+/// reduce each chunk on its own thread (1 of which is the calling thread), and
+/// then merge the partial results, with a check per chunk. Each thread gets at
+/// least `min_chunk` elements, so small arrays use fewer threads, or just the
+/// calling thread.
+///
+/// (The reduction functions do not take `std::execution` policies, since
+/// with libstdc++, using those requires linking with TBB.)
+struct parallel {
+  unsigned threads = 0;
+  size_t min_chunk = size_t{1} << 16;
+};
+
+}  // namespace integers
+
+namespace internal {
+
+// Products check for overflow, to stop early, once per this many elements.
+inline constexpr size_t kReduceBlockSize = 256;
+
+// The reduction functions accept arrays of integers, or of `trapping<T>`.
+template <typename E>
+struct element {
+  using type = E;
+  static constexpr E get(E x) { return x; }
+};
+
+template <typename T>
+struct element<integers::trapping<T>> {
+  using type = T;
+  static constexpr T get(integers::trapping<T> x) { return static_cast<T>(x); }
+};
+
+template <typename E>
+using element_t = typename element<E>::type;
+
+// Returns the largest magnitude of any `T`.
+template <typename T>
+constexpr uwidest_t max_magnitude() {
+  return static_cast<uwidest_t>(std::numeric_limits<T>::max()) +
+         (is_signed_v<T> ? 1 : 0);
+}
+
+// The type in which to add up items of magnitude at most `Magnitude`: 64 bits,
+// if that holds the sum of at least 2^16 items; else 128 bits, if available.
+template <bool Signed, uwidest_t Magnitude>
+struct accumulator {
+  using A64 = std::conditional_t<Signed, int64_t, uint64_t>;
+#if defined(INTEGERS_HAVE_INT128)
+  using A128 =
+      std::conditional_t<Signed, integers::int128_t, integers::uint128_t>;
+#else
+  using A128 = A64;
+#endif
+  using type = std::conditional_t<
+      (static_cast<uwidest_t>(std::numeric_limits<A64>::max()) / Magnitude >=
+       (1 << 16)),
+      A64,
+      A128>;
+};
+
+// Returns the sum of `item(i)` for `i` in [`begin`, `end`), where every item
+// is an `A` of magnitude at most `Magnitude`.
+//
+// Any `max(A) / Magnitude` such items add up to at most `max(A)` (and at
+// least `min(A)`), so they are summed with plain, unchecked (and
+// vectorizable) adds, in blocks of that many items; only the sum of the
+// blocks is checked. If fewer than 2 items fit, each add is checked.
+template <typename A, uwidest_t Magnitude, typename Item>
+integers::result<A> sum_items(size_t begin, size_t end, Item item) {
+  constexpr uwidest_t kBlock =
+      static_cast<uwidest_t>(std::numeric_limits<A>::max()) / Magnitude;
+  integers::result<A> total{0, false};
+  if constexpr (kBlock < 2) {
+    for (size_t i = begin; i != end; ++i) {
+      total.overflowed |= integers::add_overflow(total.value, item(i),
+                                                 &total.value);
+    }
+  } else {
+    while (begin != end) {
+      const size_t n =
+          end - begin < kBlock ? end - begin : static_cast<size_t>(kBlock);
+      A block = 0;
+      for (size_t i = begin; i != begin + n; ++i) {
+        block = static_cast<A>(block + item(i));
+      }
+      total.overflowed |= integers::add_overflow(total.value, block,
+                                                 &total.value);
+      begin += n;
+    }
+  }
+  return total;
+}
+
+template <typename E>
+using sum_accumulator_t =
+    typename accumulator<is_signed_v<element_t<E>>,
+                         max_magnitude<element_t<E>>()>::type;
+
+template <typename E>
+integers::result<sum_accumulator_t<E>> sum_chunk(const E* x,
+                                                  size_t begin,
+                                                  size_t end) {
+  using A = sum_accumulator_t<E>;
+  return sum_items<A, max_magnitude<element_t<E>>()>(
+      begin, end,
+      [x](size_t i) { return static_cast<A>(element<E>::get(x[i])); });
+}
+
+// Dot products of `T`s are exact in `P`, if there is such a type, and then
+// summed in `A`. Otherwise, they are computed and summed, with checks, in `R`.
+template <typename T>
+using product_t = double_width_t<T>;
+
+template <typename E>
+using dot_accumulator_t = typename accumulator<
+    is_signed_v<element_t<E>>,
+    max_magnitude<element_t<E>>() * max_magnitude<element_t<E>>()>::type;
+
+template <typename R, typename E>
+auto dot_chunk(const E* x, const E* y, size_t begin, size_t end) {
+  using T = element_t<E>;
+  if constexpr (std::is_void_v<product_t<T>>) {
+    integers::result<R> total{0, false};
+    for (size_t i = begin; i != end; ++i) {
+      R product;
+      total.overflowed |= integers::mul_overflow(element<E>::get(x[i]),
+                                                 element<E>::get(y[i]),
+                                                 &product) |
+                          integers::add_overflow(total.value, product,
+                                                 &total.value);
+    }
+    return total;
+  } else {
+    using P = product_t<T>;
+    using A = dot_accumulator_t<E>;
+    return sum_items<A, max_magnitude<T>() * max_magnitude<T>()>(
+        begin, end, [x, y](size_t i) {
+          return static_cast<A>(static_cast<P>(element<E>::get(x[i])) *
+                                static_cast<P>(element<E>::get(y[i])));
+        });
+  }
+}
+
+// A product, as a sign and a magnitude, so that it does not overflow unless
+// the magnitude does not fit in `uwidest_t`. Only the final product is checked
+// against `R`. (Checking each partial product against `R` would report e.g.
+// the `int8_t`s -128 × -1 × -1 as overflowing `int8_t`.)
+struct signed_magnitude {
+  uwidest_t magnitude;
+  bool negative;
+  bool overflowed;
+};
+
+// Returns the product of `x[begin]` through `x[end - 1]`. The overflow flag is
+// sticky, so the loop does not branch on it, except once per block to stop
+// early. If the product overflowed, but 1 of the factors is 0, the product is
+// 0 after all.
+template <typename E>
+signed_magnitude product_chunk(const E* x, size_t begin, size_t end) {
+  using T = element_t<E>;
+  signed_magnitude product{1, false, false};
+  for (size_t block = begin; block < end && !product.overflowed;
+       block += kReduceBlockSize) {
+    const size_t block_end = std::min(end, block + kReduceBlockSize);
+    for (size_t i = block; i != block_end; ++i) {
+      const T factor = element<E>::get(x[i]);
+      product.negative ^= is_negative(factor);
+      product.overflowed |= integers::mul_overflow(
+          product.magnitude, unsigned_abs<uwidest_t>(factor),
+          &product.magnitude);
+    }
+  }
+  if (product.overflowed) {
+    for (size_t i = begin; i != end; ++i) {
+      if (element<E>::get(x[i]) == 0) {
+        return {0, false, false};
+      }
+    }
+  }
+  return product;
+}
+
+// Returns `product` as an `R` (truncated, if it does not fit), and whether it
+// does not fit.
+template <typename R>
+integers::result<R> product_cast(signed_magnitude product) {
+  integers::result<R> r{
+      static_cast<R>(product.negative ? uwidest_t{0} - product.magnitude
+                                      : product.magnitude),
+      product.overflowed};
+  r.overflowed |=
+      cast_magnitude(product.magnitude, product.negative, &r.value);
+  return r;
+}
+
+// Calls `reduce(begin, end)` for `count` elements split into chunks, each on
+// its own thread, and returns the partial results.
+template <typename Partial, typename Reduce>
+std::vector<Partial> fan_out(const integers::parallel& policy,
+                             size_t count,
+                             Reduce reduce) {
+  size_t threads = policy.threads != 0
+                       ? policy.threads
+                       : std::max(1U, std::thread::hardware_concurrency());
+  threads = std::min(threads,
+                     std::max<size_t>(1, count / std::max<size_t>(
+                                                     1, policy.min_chunk)));
+  // Chunk `c` is [`first(c)`, `first(c + 1)`).
+  const auto first = [count, threads](size_t c) {
+    return c * (count / threads) + std::min(c, count % threads);
+  };
+  std::vector<Partial> partials(threads);
+  std::vector<std::thread> workers;
+  workers.reserve(threads - 1);
+  for (size_t c = 1; c < threads; ++c) {
+    workers.emplace_back(
+        [&partials, &reduce, &first, c] {
+          partials[c] = reduce(first(c), first(c + 1));
+        });
+  }
+  partials[0] = reduce(0, first(1));
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+  return partials;
+}
+
+// Returns the sum of `partials`.
+template <typename A>
+integers::result<A> merge_sums(
+    const std::vector<integers::result<A>>& partials) {
+  integers::result<A> total{0, false};
+  for (const integers::result<A>& partial : partials) {
+    total.overflowed |=
+        partial.overflowed |
+        integers::add_overflow(total.value, partial.value, &total.value);
+  }
+  return total;
+}
+
+}  // namespace internal
+
+namespace integers {
+
+/// These functions compute the sum, product, or dot product of arrays of
+/// integers (or of `trapping<T>`s), exactly, and report or `trap` if the
+/// result does not fit in `R`.
+///
+/// Checking each operation (as `std::accumulate` over `trapping<T>` would)
+/// costs a branch per element and prevents vectorization. Instead, the sums
+/// accumulate in a type at least twice as wide as the elements, where a block
+/// of N elements provably cannot overflow: e.g. any 2<sup>32</sup> `int32_t`s
+/// add up to at most 2<sup>63</sup> in magnitude, so `int64_t` holds their
+/// sum. The elements of a block are added without checks, and only the sum of
+/// the blocks (and then the conversion to `R`) is checked. For the 8- and
+/// 16-bit types, the block is longer than any array that fits in memory, so
+/// there is 1 check, at the end; for the 32-bit types, there is 1 check per
+/// 2<sup>32</sup> elements. `int64_t` elements accumulate in `int128_t`, where
+/// available; otherwise, and for 128-bit elements, each add is checked.
+///
+/// Dot products work the same way, with the exact products as the elements
+/// (e.g. `int32_t` products are exact in `int64_t`, and their sums accumulate
+/// in `int128_t`).
+///
+/// Products overflow after a few elements, so there is no such proof: the
+/// product’s magnitude is computed in the widest unsigned type, with a
+/// separate sign and a sticky overflow flag that is checked once per block, to
+/// stop early. Only the final product is checked against `R`, so e.g. the
+/// `int16_t`s -2 × -1 fit in `uint8_t`.
+///
+/// Each function also takes a `parallel` (as the first argument), and a
+/// `std::span` instead of a pointer and count (in C++20).
+///
+/// ### `sum_overflow`
+///
+/// Stores the sum of `x[0]` through `x[count - 1]` in `result`, and returns
+/// true if it does not fit in `R`.
+template <typename R, typename E>
+[[nodiscard]] bool sum_overflow(const E* x, size_t count, R* result) {
+  assert_is_integral(R);
+  const auto sum = internal::sum_chunk(x, 0, count).template cast<R>();
+  *result = sum.value;
+  return sum.overflowed;
+}
+
+template <typename R, typename E>
+[[nodiscard]] bool sum_overflow(const parallel& policy,
+                                const E* x,
+                                size_t count,
+                                R* result) {
+  assert_is_integral(R);
+  using A = internal::sum_accumulator_t<E>;
+  const auto partials = internal::fan_out<integers::result<A>>(
+      policy, count,
+      [x](size_t begin, size_t end) {
+        return internal::sum_chunk(x, begin, end);
+      });
+  const auto sum = internal::merge_sums(partials).template cast<R>();
+  *result = sum.value;
+  return sum.overflowed;
+}
+
+/// ### `product_overflow`
+///
+/// Stores the product of `x[0]` through `x[count - 1]` (or 1, if `count` is
+/// 0) in `result`, and returns true if it does not fit in `R`.
+template <typename R, typename E>
+[[nodiscard]] bool product_overflow(const E* x, size_t count, R* result) {
+  assert_is_integral(R);
+  const auto product =
+      internal::product_cast<R>(internal::product_chunk(x, 0, count));
+  *result = product.value;
+  return product.overflowed;
+}
+
+template <typename R, typename E>
+[[nodiscard]] bool product_overflow(const parallel& policy,
+                                    const E* x,
+                                    size_t count,
+                                    R* result) {
+  assert_is_integral(R);
+  const auto partials = internal::fan_out<internal::signed_magnitude>(
+      policy, count, [x](size_t begin, size_t end) {
+        return internal::product_chunk(x, begin, end);
+      });
+  // A partial product of 0 means a factor of 0.
+  internal::signed_magnitude total{1, false, false};
+  for (const internal::signed_magnitude& partial : partials) {
+    if (!partial.overflowed && partial.magnitude == 0) {
+      *result = 0;
+      return false;
+    }
+    total.negative ^= partial.negative;
+    total.overflowed |=
+        partial.overflowed | integers::mul_overflow(total.magnitude,
+                                                    partial.magnitude,
+                                                    &total.magnitude);
+  }
+  const auto product = internal::product_cast<R>(total);
+  *result = product.value;
+  return product.overflowed;
+}
+
+/// ### `dot_overflow`
+///
+/// Stores the sum of `x[i] * y[i]`, for `i` in [0, `count`), in `result`,
+/// and returns true if it does not fit in `R`.
+template <typename R, typename E>
+[[nodiscard]] bool dot_overflow(const E* x,
+                                const E* y,
+                                size_t count,
+                                R* result) {
+  assert_is_integral(R);
+  const auto dot = internal::dot_chunk<R>(x, y, 0, count).template cast<R>();
+  *result = dot.value;
+  return dot.overflowed;
+}
+
+template <typename R, typename E>
+[[nodiscard]] bool dot_overflow(const parallel& policy,
+                                const E* x,
+                                const E* y,
+                                size_t count,
+                                R* result) {
+  assert_is_integral(R);
+  using Partial = decltype(internal::dot_chunk<R>(x, y, 0, 0));
+  const auto partials = internal::fan_out<Partial>(
+      policy, count, [x, y](size_t begin, size_t end) {
+        return internal::dot_chunk<R>(x, y, begin, end);
+      });
+  const auto dot = internal::merge_sums(partials).template cast<R>();
+  *result = dot.value;
+  return dot.overflowed;
+}
+
+/// ### `trapping_sum`, `trapping_product`, `trapping_dot`
+///
+/// Return the sum, product, or dot product. If it does not fit in `R`, these
+/// functions will `trap`.
+template <typename R, typename E>
+R trapping_sum(const E* x, size_t count) {
+  R result;
+  if (sum_overflow(x, count, &result)) {
+    trap();
+  }
+  return result;
+}
+
+template <typename R, typename E>
+R trapping_sum(const parallel& policy, const E* x, size_t count) {
+  R result;
+  if (sum_overflow(policy, x, count, &result)) {
+    trap();
+  }
+  return result;
+}
+
+template <typename R, typename E>
+R trapping_product(const E* x, size_t count) {
+  R result;
+  if (product_overflow(x, count, &result)) {
+    trap();
+  }
+  return result;
+}
+
+template <typename R, typename E>
+R trapping_product(const parallel& policy, const E* x, size_t count) {
+  R result;
+  if (product_overflow(policy, x, count, &result)) {
+    trap();
+  }
+  return result;
+}
+
+template <typename R, typename E>
+R trapping_dot(const E* x, const E* y, size_t count) {
+  R result;
+  if (dot_overflow(x, y, count, &result)) {
+    trap();
+  }
+  return result;
+}
+
+template <typename R, typename E>
+R trapping_dot(const parallel& policy, const E* x, const E* y, size_t count) {
+  R result;
+  if (dot_overflow(policy, x, y, count, &result)) {
+    trap();
+  }
+  return result;
+}
+
+#ifdef __cpp_lib_span
+/// ### Range overloads
+///
+/// Each function also takes any contiguous range that converts to a
+/// `std::span` (e.g. a `std::vector`, `std::array`, or `std::span`) instead of
+/// a pointer and count, e.g. `trapping_sum<int64_t>(values)`. For
+/// `trapping_dot`, `x` and `y` must be the same size; if not, it will `trap`.
+template <typename R, typename X>
+  requires requires(const X& x) { std::span(x); }
+R trapping_sum(const X& x) {
+  const std::span s(x);
+  return trapping_sum<R>(s.data(), s.size());
+}
+
+template <typename R, typename X>
+  requires requires(const X& x) { std::span(x); }
+R trapping_sum(const parallel& policy, const X& x) {
+  const std::span s(x);
+  return trapping_sum<R>(policy, s.data(), s.size());
+}
+
+template <typename R, typename X>
+  requires requires(const X& x) { std::span(x); }
+R trapping_product(const X& x) {
+  const std::span s(x);
+  return trapping_product<R>(s.data(), s.size());
+}
+
+template <typename R, typename X>
+  requires requires(const X& x) { std::span(x); }
+R trapping_product(const parallel& policy, const X& x) {
+  const std::span s(x);
+  return trapping_product<R>(policy, s.data(), s.size());
+}
+
+template <typename R, typename X, typename Y>
+  requires requires(const X& x, const Y& y) {
+    std::span(x);
+    std::span(y);
+  }
+R trapping_dot(const X& x, const Y& y) {
+  const std::span sx(x);
+  const std::span sy(y);
+  if (sx.size() != sy.size()) {
+    trap();
+  }
+  return trapping_dot<R>(sx.data(), sy.data(), sx.size());
+}
+
+template <typename R, typename X, typename Y>
+  requires requires(const X& x, const Y& y) {
+    std::span(x);
+    std::span(y);
+  }
+R trapping_dot(const parallel& policy, const X& x, const Y& y) {
+  const std::span sx(x);
+  const std::span sy(y);
+  if (sx.size() != sy.size()) {
+    trap();
+  }
+  return trapping_dot<R>(policy, sx.data(), sy.data(), sx.size());
+}
+#endif
+
+}  // namespace integers
+
+#endif  // REDUCE_H_
@@ -0,0 +1,284 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stddef.h>
+
+#include <array>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "reduce.h"
+#include "test_support.h"
+
+using namespace integers;
+using namespace std;
+
+namespace {
+
+using i8 = int8_t;
+using u8 = uint8_t;
+using i16 = int16_t;
+using u16 = uint16_t;
+using i32 = int32_t;
+using u32 = uint32_t;
+using i64 = int64_t;
+using u64 = uint64_t;
+
+// Splits even small arrays across several threads.
+constexpr parallel kSmallChunks{4, 3};
+
+template <typename T>
+void GenericTestSum() {
+  constexpr T max = numeric_limits<T>::max();
+  constexpr T min = numeric_limits<T>::min();
+  {
+    const T x[] = {max, max, max, T{1}};
+    if constexpr (sizeof(T) < 8) {
+      // The partial sums overflow `T`, but the accumulator holds them.
+      EXPECT(trapping_sum<i64>(x, 3) == 3 * i64{max});
+    }
+    EXPECT_DEATH((void)trapping_sum<T>(x, 2));
+    T sum;
+    EXPECT(sum_overflow(x, 4, &sum));
+    EXPECT(!sum_overflow(x, 1, &sum));
+    EXPECT(sum == max);
+    EXPECT(!sum_overflow(x, 0, &sum));
+    EXPECT(sum == 0);
+  }
+  if constexpr (is_signed_v<T>) {
+    // The sum fits, even though intermediate sums do not.
+    const T x[] = {max, max, min, min, T{1}, T{1}, T{-1}};
+    EXPECT(trapping_sum<T>(x, 7) == T{-1});
+    EXPECT(trapping_sum<T>(kSmallChunks, x, 7) == T{-1});
+    EXPECT_DEATH((void)trapping_sum<T>(x, 2));
+  }
+}
+
+template <typename T>
+void GenericTestSumLong() {
+  vector<T> x(100000);
+  for (size_t i = 0; i < x.size(); ++i) {
+    x[i] = static_cast<T>(i * 37 % 101);
+  }
+  i64 expected = 0;
+  for (T v : x) {
+    expected += static_cast<i64>(v);
+  }
+  EXPECT(trapping_sum<i64>(x.data(), x.size()) == expected);
+  EXPECT(trapping_sum<i64>(kSmallChunks, x.data(), x.size()) == expected);
+  EXPECT(trapping_sum<i64>(parallel{}, x.data(), x.size()) == expected);
+  EXPECT(trapping_sum<i64>(parallel{7, 1}, x.data(), x.size()) == expected);
+  EXPECT(trapping_sum<i64>(parallel{1000000, 1}, x.data(), 5) ==
+         trapping_sum<i64>(x.data(), 5));
+  if constexpr (sizeof(T) <= 2) {
+    EXPECT_DEATH((void)trapping_sum<T>(x.data(), x.size()));
+    EXPECT_DEATH((void)trapping_sum<T>(kSmallChunks, x.data(), x.size()));
+  }
+}
+
+template <typename T>
+void GenericTestProduct() {
+  constexpr T max = numeric_limits<T>::max();
+  {
+    const T x[] = {T{2}, T{3}, T{7}};
+    EXPECT(trapping_product<T>(x, 3) == T{42});
+    EXPECT(trapping_product<T>(kSmallChunks, x, 3) == T{42});
+    EXPECT(trapping_product<T>(x, 0) == T{1});
+  }
+  {
+    const T x[] = {max, T{2}, T{1}};
+    EXPECT_DEATH((void)trapping_product<T>(x, 3));
+    EXPECT_DEATH((void)trapping_product<T>(kSmallChunks, x, 3));
+    T product;
+    EXPECT(product_overflow(x, 3, &product));
+    EXPECT(!product_overflow(x + 1, 2, &product));
+    EXPECT(product == T{2});
+  }
+  {
+    // Any 0 factor, even after the product overflowed, makes it exact.
+    vector<T> x(1000, T{2});
+    x.back() = 0;
+    EXPECT(trapping_product<T>(x.data(), x.size()) == 0);
+    EXPECT(trapping_product<T>(kSmallChunks, x.data(), x.size()) == 0);
+    x.front() = 0;
+    x.back() = 2;
+    EXPECT(trapping_product<T>(kSmallChunks, x.data(), x.size()) == 0);
+  }
+  if constexpr (is_signed_v<T>) {
+    const T x[] = {T{-1}, numeric_limits<T>::min()};
+    EXPECT_DEATH((void)trapping_product<T>(x, 2));
+    EXPECT(trapping_product<T>(x + 1, 1) == numeric_limits<T>::min());
+
+    // Partial products that do not fit in `R` are fine, if the product does.
+    const T y[] = {numeric_limits<T>::min(), T{-1}, T{-1}};
+    EXPECT(trapping_product<T>(y, 3) == numeric_limits<T>::min());
+    EXPECT(trapping_product<T>(kSmallChunks, y, 3) ==
+           numeric_limits<T>::min());
+    const T z[] = {T{-2}, T{-1}};
+    EXPECT(trapping_product<u8>(z, 2) == 2);
+    EXPECT(trapping_product<u8>(kSmallChunks, z, 2) == 2);
+    EXPECT_DEATH((void)trapping_product<u8>(z + 1, 1));
+    T product;
+    EXPECT(product_overflow(y, 2, &product));
+  }
+}
+
+template <typename T>
+void GenericTestDot() {
+  constexpr T max = numeric_limits<T>::max();
+  constexpr T min = numeric_limits<T>::min();
+  {
+    const T x[] = {T{1}, T{2}, T{3}};
+    const T y[] = {T{4}, T{5}, T{6}};
+    EXPECT(trapping_dot<T>(x, y, 3) == T{32});
+    EXPECT(trapping_dot<T>(kSmallChunks, x, y, 3) == T{32});
+    EXPECT(trapping_dot<T>(x, y, 0) == T{0});
+  }
+  {
+    const T x[] = {max, max};
+    const T y[] = {max, T{1}};
+    EXPECT_DEATH((void)trapping_dot<T>(x, y, 2));
+    EXPECT(trapping_dot<T>(x + 1, y + 1, 1) == max);
+    T dot;
+    EXPECT(dot_overflow(x, y, 1, &dot));
+  }
+  if constexpr (is_signed_v<T>) {
+    // The products overflow `T`, but their sum fits.
+    const T x[] = {max, max};
+    const T y[] = {max, static_cast<T>(-max)};
+    EXPECT(trapping_dot<T>(x, y, 2) == 0);
+    EXPECT(trapping_dot<T>(kSmallChunks, x, y, 2) == 0);
+    const T z[] = {min, min};
+    EXPECT_DEATH((void)trapping_dot<T>(z, z, 2));
+  }
+}
+
+template <typename T>
+void GenericTestDotLong() {
+  vector<T> x(10000);
+  vector<T> y(x.size());
+  for (size_t i = 0; i < x.size(); ++i) {
+    x[i] = static_cast<T>(i % 13);
+    y[i] = static_cast<T>(i % 7);
+  }
+  i64 expected = 0;
+  for (size_t i = 0; i < x.size(); ++i) {
+    expected += static_cast<i64>(x[i]) * static_cast<i64>(y[i]);
+  }
+  EXPECT(trapping_dot<i64>(x.data(), y.data(), x.size()) == expected);
+  EXPECT(trapping_dot<i64>(kSmallChunks, x.data(), y.data(), x.size()) ==
+         expected);
+}
+
+template <class... T>
+void CallGenericTests() {
+  (GenericTestSum<T>(), ...);
+  (GenericTestSumLong<T>(), ...);
+  (GenericTestProduct<T>(), ...);
+  (GenericTestDot<T>(), ...);
+  (GenericTestDotLong<T>(), ...);
+}
+
+void TestAllTypes() {
+  CallGenericTests<i8, u8, i16, u16, i32, u32, i64, u64>();
+}
+
+void TestExhaustivePairs() {
+  // Every sum of 2 `int8_t`s, and every dot product of 2 pairs with the same
+  // second element, in every result type.
+  for (int a = -128; a <= 127; ++a) {
+    for (int b = -128; b <= 127; ++b) {
+      const i8 x[] = {static_cast<i8>(a), static_cast<i8>(b)};
+      i8 sum;
+      EXPECT(sum_overflow(x, 2, &sum) == !in_range<i8>(a + b));
+      u8 usum;
+      EXPECT(sum_overflow(x, 2, &usum) == !in_range<u8>(a + b));
+      i8 dot;
+      EXPECT(dot_overflow(x, x, 2, &dot) == !in_range<i8>(a * a + b * b));
+      i16 product;
+      EXPECT(!product_overflow(x, 2, &product));
+      EXPECT(product == a * b);
+      i8 narrow;
+      EXPECT(product_overflow(x, 2, &narrow) == !in_range<i8>(a * b));
+      u8 unsigned_product;
+      EXPECT(product_overflow(x, 2, &unsigned_product) ==
+             !in_range<u8>(a * b));
+      const i8 y[] = {static_cast<i8>(a), static_cast<i8>(b), i8{-1}};
+      EXPECT(product_overflow(y, 3, &narrow) == !in_range<i8>(-a * b));
+    }
+  }
+}
+
+#if defined(INTEGERS_HAVE_INT128)
+void TestInt128() {
+  constexpr i64 max = numeric_limits<i64>::max();
+  const i64 x[] = {max, max, max, max};
+  EXPECT(trapping_sum<int128_t>(x, 4) == int128_t{max} * 4);
+  EXPECT(trapping_dot<int128_t>(x, x, 2) == int128_t{max} * max * 2);
+  EXPECT_DEATH((void)trapping_dot<int128_t>(x, x, 4));
+  EXPECT_DEATH((void)trapping_sum<i64>(x, 4));
+  const int128_t y[] = {int128_t{max} * max, int128_t{max} * max};
+  EXPECT(trapping_sum<int128_t>(y, 2) == int128_t{max} * max * 2);
+  EXPECT_DEATH((void)trapping_dot<int128_t>(y, y, 2));
+}
+#endif
+
+void TestTrappingElements() {
+  const trapping<u8> x[] = {u8{200}, u8{100}, u8{3}};
+  EXPECT(trapping_sum<u16>(x, 3) == 303);
+  EXPECT(trapping_product<u32>(x, 3) == 60000);
+  EXPECT(trapping_product<u32>(kSmallChunks, x, 3) == 60000);
+  EXPECT(trapping_dot<u32>(x, x, 3) == 50009);
+  EXPECT_DEATH((void)trapping_sum<u8>(x, 3));
+}
+
+void TestSpan() {
+#ifdef __cpp_lib_span
+  const vector<i32> x = {1, 2, 3, 4};
+  const vector<i32> y = {5, 6, 7};
+  EXPECT(trapping_sum<i32>(span<const i32>(x)) == 10);
+  EXPECT(trapping_sum<i32>(kSmallChunks, span<const i32>(x)) == 10);
+  EXPECT(trapping_product<i32>(span<const i32>(x)) == 24);
+  EXPECT(trapping_product<i32>(kSmallChunks, span<const i32>(x)) == 24);
+  EXPECT(trapping_dot<i32>(span<const i32>(x).first(3), span<const i32>(y)) ==
+         38);
+  EXPECT(trapping_dot<i32>(kSmallChunks, span<const i32>(x).first(3),
+                           span<const i32>(y)) == 38);
+  EXPECT_DEATH((void)trapping_dot<i32>(span<const i32>(x), span<const i32>(y)));
+
+  // Containers, and spans of non-`const` elements, convert too.
+  vector<i32> z = {100000, 100000};
+  EXPECT(trapping_sum<i64>(z) == 200000);
+  EXPECT(trapping_sum<i64>(vector<i32>{1, 2}) == 3);
+  EXPECT(trapping_product<i64>(span<i32>(z)) == 10000000000);
+  EXPECT(trapping_dot<i64>(kSmallChunks, z, span<i32>(z)) == 20000000000);
+  const array<u8, 2> w = {200, 100};
+  EXPECT(trapping_sum<u16>(w) == 300);
+  EXPECT_DEATH((void)trapping_dot<i64>(x, z));
+#endif
+}
+
+}  // namespace
+
+int main() {
+  TestAllTypes();
+  TestExhaustivePairs();
+#if defined(INTEGERS_HAVE_INT128)
+  TestInt128();
+#endif
+  TestTrappingElements();
+  TestSpan();
+}
@@ -0,0 +1,237 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SERIAL_H_
+#define SERIAL_H_
+
+#include <stddef.h>
+
+#include <atomic>
+#include <type_traits>
+
+#include "is_integral.h"
+#include "trap.h"
+#include "wrapping.h"
+
+namespace internal {
+
+/// The size of a cache line, for padding to avoid false sharing. (C++17’s
+/// `std::hardware_destructive_interference_size` is not available everywhere,
+/// and GCC warns that its value can change between compiler versions.)
+#if defined(__APPLE__) && defined(__aarch64__)
+inline constexpr size_t kCacheLineSize = 128;
+#else
+inline constexpr size_t kCacheLineSize = 64;
+#endif
+
+}  // namespace internal
+
+namespace integers {
+
+/// ## Serial Number Arithmetic
+///
+/// These functions compare sequence numbers that wrap around, such as TCP
+/// sequence numbers or queue counters, as in [RFC
+/// 1982](https://www.rfc-editor.org/rfc/rfc1982). `a` is less than `b` if
+/// going forward from `a` to `b` is shorter than going backward: e.g. for
+/// `uint8_t`s, 250 is less than 3.
+///
+/// They work on the unsigned counterpart of `T`, in wrapping arithmetic, and
+/// are branch-free: each is a subtraction and a sign test. All are
+/// `constexpr`, and accept integral `T`s or `wrapping<T>`s.
+///
+/// When `a` and `b` are exactly half the range apart, RFC 1982 leaves their
+/// order undefined. Here, neither is less than the other, and they are not
+/// equal.
+///
+/// ### `seq_distance`
+///
+/// Returns the signed distance from `from` to `to`: how far forward (if
+/// positive) or backward (if negative) `to` is from `from`. If they are
+/// exactly half the range apart, returns the minimum value of the signed type.
+template <typename T, std::enable_if_t<internal::is_integral_v<T>, int> = 0>
+constexpr internal::make_signed_t<T> seq_distance(T from, T to) {
+  using U = internal::make_unsigned_t<T>;
+  return wrapping_cast<internal::make_signed_t<T>>(
+      wrapping_sub<U>(wrapping_cast<U>(to), wrapping_cast<U>(from)));
+}
+
+/// ### `seq_lt`
+///
+/// Returns true if `a` is before `b`.
+template <typename T, std::enable_if_t<internal::is_integral_v<T>, int> = 0>
+constexpr bool seq_lt(T a, T b) {
+  return seq_distance(a, b) > 0;
+}
+
+/// ### `seq_gt`
+///
+/// Returns true if `a` is after `b`.
+template <typename T, std::enable_if_t<internal::is_integral_v<T>, int> = 0>
+constexpr bool seq_gt(T a, T b) {
+  return seq_lt(b, a);
+}
+
+/// ### `seq_le`
+///
+/// Returns true if `a` is before or equal to `b`.
+template <typename T, std::enable_if_t<internal::is_integral_v<T>, int> = 0>
+constexpr bool seq_le(T a, T b) {
+  return a == b || seq_lt(a, b);
+}
+
+/// ### `seq_ge`
+///
+/// Returns true if `a` is after or equal to `b`.
+template <typename T, std::enable_if_t<internal::is_integral_v<T>, int> = 0>
+constexpr bool seq_ge(T a, T b) {
+  return seq_le(b, a);
+}
+
+template <typename T>
+constexpr internal::make_signed_t<T> seq_distance(wrapping<T> from,
+                                                  wrapping<T> to) {
+  return seq_distance(static_cast<T>(from), static_cast<T>(to));
+}
+
+template <typename T>
+constexpr bool seq_lt(wrapping<T> a, wrapping<T> b) {
+  return seq_lt(static_cast<T>(a), static_cast<T>(b));
+}
+
+template <typename T>
+constexpr bool seq_gt(wrapping<T> a, wrapping<T> b) {
+  return seq_gt(static_cast<T>(a), static_cast<T>(b));
+}
+
+template <typename T>
+constexpr bool seq_le(wrapping<T> a, wrapping<T> b) {
+  return seq_le(static_cast<T>(a), static_cast<T>(b));
+}
+
+template <typename T>
+constexpr bool seq_ge(wrapping<T> a, wrapping<T> b) {
+  return seq_ge(static_cast<T>(a), static_cast<T>(b));
+}
+
+/// ## `ring_indices<T>`
+///
+/// Index arithmetic for a ring buffer whose capacity is a power of 2, with
+/// free-running `head` and `tail` counters of unsigned type `T`. The
+/// producer writes slot `slot(tail)` and then increments `tail`; the consumer
+/// reads slot `slot(head)` and then increments `head`. The counters wrap
+/// around (use `wrapping<T>`, or unsigned `T`s), but `size`, `full`, and
+/// `empty` are still correct, since `tail - head` is never more than the
+/// capacity. Unlike indices that wrap at the capacity, this needs no
+/// wasted slot to tell a full ring from an empty one, and no branches.
+///
+/// For a single-producer, single-consumer queue, keep the counters in
+/// `padded_atomic<T>`s, so that the producer and consumer do not contend for
+/// 1 cache line:
+///
+///   const ring_indices<uint32_t> ring(trapping_cast<uint32_t>(items.size()));
+///   padded_atomic<uint32_t> head{0};
+///   padded_atomic<uint32_t> tail{0};
+///
+///   bool Push(Item item) {  // Producer thread.
+///     const uint32_t t = tail.load(std::memory_order_relaxed);
+///     if (ring.full(head.load(std::memory_order_acquire), t)) {
+///       return false;
+///     }
+///     items[ring.slot(t)] = item;
+///     tail.store(t + 1, std::memory_order_release);
+///     return true;
+///   }
+///
+/// `Pop` is symmetric. For several producers (or consumers), claim a counter
+/// value with `compare_exchange_weak` on `tail` (or `head`), and compare
+/// per-slot sequence numbers using `seq_lt` et c.
+template <typename T>
+class ring_indices {
+  assert_is_integral(T);
+  static_assert(!internal::is_signed_v<T>,
+                "Ring counters must be unsigned, so that they can wrap");
+
+ public:
+  /// ### `ring_indices`
+  ///
+  /// `trap`s if `capacity` is not a power of 2.
+  constexpr explicit ring_indices(T capacity)
+      : mask_(static_cast<T>(capacity - 1)) {
+    if (capacity == 0 || (capacity & mask_) != 0) {
+      trap();
+    }
+  }
+
+  /// ### `capacity`
+  constexpr T capacity() const { return static_cast<T>(mask_ + 1); }
+
+  /// ### `slot`
+  ///
+  /// Returns the index in the buffer of the element that `counter` refers to.
+  constexpr T slot(T counter) const { return static_cast<T>(counter & mask_); }
+  constexpr T slot(wrapping<T> counter) const {
+    return slot(static_cast<T>(counter));
+  }
+
+  /// ### `size`
+  ///
+  /// Returns the number of elements between `head` and `tail`.
+  constexpr T size(T head, T tail) const { return wrapping_sub<T>(tail, head); }
+  constexpr T size(wrapping<T> head, wrapping<T> tail) const {
+    return size(static_cast<T>(head), static_cast<T>(tail));
+  }
+
+  /// ### `available`
+  ///
+  /// Returns the number of free slots: how many elements can be pushed.
+  constexpr T available(T head, T tail) const {
+    return static_cast<T>(capacity() - size(head, tail));
+  }
+  constexpr T available(wrapping<T> head, wrapping<T> tail) const {
+    return available(static_cast<T>(head), static_cast<T>(tail));
+  }
+
+  /// ### `empty`
+  constexpr bool empty(T head, T tail) const { return head == tail; }
+  constexpr bool empty(wrapping<T> head, wrapping<T> tail) const {
+    return empty(static_cast<T>(head), static_cast<T>(tail));
+  }
+
+  /// ### `full`
+  constexpr bool full(T head, T tail) const {
+    return size(head, tail) == capacity();
+  }
+  constexpr bool full(wrapping<T> head, wrapping<T> tail) const {
+    return full(static_cast<T>(head), static_cast<T>(tail));
+  }
+
+ private:
+  T mask_;
+};
+
+/// ## `padded_atomic<T>`
+///
+/// A `std::atomic<T>` that is aligned to, and fills, a whole cache line, so
+/// that e.g. a queue’s head and tail counters, which different threads
+/// update, do not share a cache line (‘false sharing’).
+template <typename T>
+struct alignas(internal::kCacheLineSize) padded_atomic : std::atomic<T> {
+  using std::atomic<T>::atomic;
+  using std::atomic<T>::operator=;
+};
+
+}  // namespace integers
+
+#endif  // SERIAL_H_
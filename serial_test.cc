@@ -0,0 +1,184 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include "serial.h"
+#include "test_support.h"
+
+using namespace integers;
+using namespace std;
+
+namespace {
+
+using i8 = int8_t;
+using u8 = uint8_t;
+using u16 = uint16_t;
+using u32 = uint32_t;
+using i64 = int64_t;
+
+void TestSeqDistance() {
+  EXPECT(seq_distance<u8>(250, 3) == 9);
+  EXPECT(seq_distance<u8>(3, 250) == -9);
+  EXPECT(seq_distance<u8>(0, 128) == -128);
+  EXPECT(seq_distance<u8>(128, 0) == -128);
+  EXPECT(seq_distance<u8>(7, 7) == 0);
+  EXPECT(seq_distance<i8>(127, -128) == 1);
+  EXPECT(seq_distance<u32>(0xfffffff0, 0x10) == 0x20);
+  EXPECT((is_same_v<decltype(seq_distance<u16>(1, 2)), int16_t>));
+  const wrapping<u32> a{0xffffffffU};
+  EXPECT(seq_distance(a, a + 1U) == 1);
+  static_assert(seq_distance<u8>(255, 0) == 1);
+}
+
+template <typename T>
+void GenericTestExhaustiveSeq() {
+  constexpr T min = numeric_limits<T>::min();
+  constexpr T max = numeric_limits<T>::max();
+  for (T a = min;; ++a) {
+    for (T b = min;; ++b) {
+      // The reference: the distance forward from `a` to `b`, modulo 256.
+      const i64 forward = (i64{b} - i64{a} + 256) % 256;
+      const bool lt = forward != 0 && forward < 128;
+      const bool gt = forward > 128;
+      EXPECT(seq_distance(a, b) ==
+             (forward < 128 ? forward : forward - 256));
+      EXPECT(seq_lt(a, b) == lt);
+      EXPECT(seq_gt(a, b) == gt);
+      EXPECT(seq_le(a, b) == (lt || a == b));
+      EXPECT(seq_ge(a, b) == (gt || a == b));
+      EXPECT(seq_lt(wrapping<T>{a}, wrapping<T>{b}) == lt);
+      EXPECT(seq_ge(wrapping<T>{a}, wrapping<T>{b}) == (gt || a == b));
+      if (b == max) {
+        break;
+      }
+    }
+    if (a == max) {
+      break;
+    }
+  }
+}
+
+void TestSeqComparison() {
+  EXPECT(seq_lt<u8>(250, 3));
+  EXPECT(!seq_lt<u8>(3, 250));
+  EXPECT(seq_gt<u8>(3, 250));
+  EXPECT(!seq_lt<u8>(5, 5));
+  EXPECT(seq_le<u8>(5, 5));
+  EXPECT(seq_ge<u8>(5, 5));
+  // Exactly half the range apart: neither is before the other.
+  EXPECT(!seq_lt<u8>(0, 128));
+  EXPECT(!seq_gt<u8>(0, 128));
+  EXPECT(!seq_le<u8>(0, 128));
+  EXPECT(!seq_ge<u8>(0, 128));
+  static_assert(seq_lt<u32>(0xffffffff, 0));
+  GenericTestExhaustiveSeq<u8>();
+  GenericTestExhaustiveSeq<i8>();
+}
+
+void TestRingIndices() {
+  {
+    constexpr ring_indices<u8> ring(16);
+    static_assert(ring.capacity() == 16);
+    static_assert(ring.slot(u8{33}) == 1);
+    static_assert(ring.size(250, 4) == 10);
+    static_assert(ring.available(250, 4) == 6);
+    static_assert(ring.empty(9, 9));
+    static_assert(ring.full(250, 10));
+    static_assert(!ring.full(250, 9));
+  }
+  {
+    const ring_indices<u32> ring(1U << 31);
+    EXPECT(ring.capacity() == 1U << 31);
+    EXPECT(ring.slot(0xffffffffU) == (1U << 31) - 1);
+    EXPECT(ring.full(0x80000001U, 1U));
+    const wrapping<u32> head{0xfffffffeU};
+    EXPECT(ring.size(head, head + 3U) == 3);
+    EXPECT(ring.slot(head + 3U) == 1);
+  }
+  {
+    const ring_indices<u8> ring(1);
+    EXPECT(ring.slot(u8{200}) == 0);
+    EXPECT(ring.full(200, 201));
+  }
+  EXPECT_DEATH((void)ring_indices<u32>(0));
+  EXPECT_DEATH((void)ring_indices<u32>(3));
+  EXPECT_DEATH((void)ring_indices<u32>(0x80000001U));
+}
+
+void TestPaddedAtomic() {
+  static_assert(alignof(padded_atomic<u32>) == internal::kCacheLineSize);
+  static_assert(sizeof(padded_atomic<u32>) == internal::kCacheLineSize);
+  struct Counters {
+    padded_atomic<u32> head{0};
+    padded_atomic<u32> tail{0};
+  };
+  static_assert(offsetof(Counters, tail) == internal::kCacheLineSize);
+  padded_atomic<u32> x{7};
+  x = 8;
+  EXPECT(x.fetch_add(1) == 8);
+  EXPECT(x.load() == 9);
+}
+
+void TestSpscQueue() {
+  // 8-bit counters wrap around many times over the run.
+  constexpr size_t kCount = 100000;
+  const ring_indices<u8> ring(16);
+  array<size_t, 16> items{};
+  padded_atomic<u8> head{0};
+  padded_atomic<u8> tail{0};
+
+  thread producer([&] {
+    for (size_t i = 0; i < kCount;) {
+      const u8 t = tail.load(memory_order_relaxed);
+      if (ring.full(head.load(memory_order_acquire), t)) {
+        this_thread::yield();
+        continue;
+      }
+      items[ring.slot(t)] = i++;
+      tail.store(static_cast<u8>(t + 1), memory_order_release);
+    }
+  });
+
+  bool in_order = true;
+  for (size_t i = 0; i < kCount;) {
+    const u8 h = head.load(memory_order_relaxed);
+    if (ring.empty(h, tail.load(memory_order_acquire))) {
+      this_thread::yield();
+      continue;
+    }
+    in_order = in_order && items[ring.slot(h)] == i++;
+    head.store(static_cast<u8>(h + 1), memory_order_release);
+  }
+  producer.join();
+  EXPECT(in_order);
+  EXPECT(ring.empty(head.load(), tail.load()));
+}
+
+}  // namespace
+
+int main() {
+  TestSeqDistance();
+  TestSeqComparison();
+  TestRingIndices();
+  TestPaddedAtomic();
+  TestSpscQueue();
+}
@@ -0,0 +1,373 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+/// ## Telemetry
+///
+/// If you define `INTEGERS_TELEMETRY`, every call to a trapping helper
+/// function (`trapping_cast`, `trapping_add`, `trapping_sub`, `trapping_mul`,
+/// `trapping_div`, `trapping_mod`, `trapping_shl`, `trapping_shr`, and
+/// `trapping_parse`) records, for its call site:
+///
+/// * how many checks it executed;
+/// * how many of them failed (i.e. were about to `trap`); and
+/// * a histogram of the log<sub>2</sub> headroom of the results: bucket `h`
+///   counts results that could have been multiplied by 2<sup>`h`</sup> (but
+///   not 2<sup>`h + 1`</sup>) without overflowing. Bucket 0 is results within
+///   a factor of 2 of overflow.
+///
+/// Use the data to find the hot checks, and the checks that never come close
+/// to overflowing, so you can decide where to use `checked<T>`, expression.h,
+/// or `assume_policy` instead.
+///
+/// The call site is the caller’s `__builtin_FILE()` and `__builtin_LINE()`,
+/// passed as default arguments. (Operators cannot take extra arguments, so
+/// the `trapping<T>` operators are all attributed to their lines in
+/// trapping.h, one site per operation. Call the helper functions directly for
+/// per-site data.) Checks evaluated at compile time are not recorded; note
+/// that this includes initializers of `const` variables whose operands are
+/// all constants.
+///
+/// Counters are thread-local, so recording takes no locks and no atomic
+/// read-modify-write instructions. `telemetry_snapshot` and `telemetry_dump`
+/// merge the counters of all live threads and of threads that have exited.
+///
+/// If you do not define `INTEGERS_TELEMETRY`, none of this is compiled, and
+/// the helpers have exactly the same signatures and code as without it.
+///
+/// ### `telemetry_snapshot`
+///
+/// Returns the counters of every call site recorded so far, sorted by file,
+/// line, and operation.
+///
+/// ### `telemetry_dump`
+///
+/// Writes the result of `telemetry_snapshot` to `os`, 1 line per site:
+///
+///   demo.cc:42 trapping_mul checks=1000 traps=0 headroom=20:1000
+///
+/// ### `telemetry_reset`
+///
+/// Clears all the counters (of all threads).
+#if defined(INTEGERS_TELEMETRY)
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "is_integral.h"
+
+namespace internal {
+
+/// 1 headroom bucket for each bit of the widest integer type, plus bucket 0.
+inline constexpr size_t kHeadroomBuckets =
+    static_cast<size_t>(std::numeric_limits<uwidest_t>::digits) + 1;
+
+}  // namespace internal
+
+namespace integers {
+
+struct telemetry_site {
+  const char* file;
+  unsigned line;
+  const char* operation;
+  uint64_t checks;
+  uint64_t traps;
+  std::array<uint64_t, internal::kHeadroomBuckets> headroom;
+};
+
+}  // namespace integers
+
+namespace internal {
+
+/// Returns log2 of how far `value` is from overflowing `T`: the number of
+/// times it could be doubled without overflowing.
+template <typename T>
+unsigned headroom(T value) {
+  using U = internal::make_unsigned_t<T>;
+  constexpr unsigned kBits = std::numeric_limits<U>::digits;
+  U magnitude = static_cast<U>(value);
+  if constexpr (internal::is_signed_v<T>) {
+    magnitude =
+        static_cast<U>(magnitude ^ static_cast<U>(value >> (kBits - 1)));
+  }
+  unsigned used = 0;
+  if constexpr (kBits > 64) {
+    if ((magnitude >> 64) != 0) {
+      used = 64;
+      magnitude = static_cast<U>(magnitude >> 64);
+    }
+  }
+  if (magnitude != 0) {
+    used += 64U - static_cast<unsigned>(__builtin_clzll(
+                      static_cast<unsigned long long>(magnitude)));
+  }
+  return static_cast<unsigned>(std::numeric_limits<T>::digits) - used;
+}
+
+/// The counters for 1 call site, in 1 thread. Only the owning thread writes
+/// them, so it can increment with a plain load and store; they are atomic
+/// only so that other threads can read them while it does.
+struct site_counters {
+  const char* file;
+  unsigned line;
+  const char* operation;
+  std::atomic<uint64_t> checks{0};
+  std::atomic<uint64_t> traps{0};
+  std::array<std::atomic<uint64_t>, kHeadroomBuckets> headroom{};
+
+  static void increment(std::atomic<uint64_t>& counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1,
+                  std::memory_order_relaxed);
+  }
+};
+
+struct site_key {
+  const char* file;
+  unsigned line;
+  const char* operation;
+
+  bool operator==(const site_key& other) const {
+    return file == other.file && line == other.line &&
+           operation == other.operation;
+  }
+};
+
+struct site_key_hash {
+  size_t operator()(const site_key& key) const {
+    return std::hash<const void*>()(key.file) ^
+           (std::hash<const void*>()(key.operation) << 1) ^
+           (static_cast<size_t>(key.line) * 0x9e3779b97f4a7c15ULL);
+  }
+};
+
+class thread_telemetry;
+
+/// All threads’ tables, plus the merged counters of exited threads.
+struct telemetry_registry {
+  std::mutex mutex;
+  std::vector<thread_telemetry*> threads;
+  std::vector<integers::telemetry_site> exited;
+  uint64_t generation = 0;
+};
+
+inline telemetry_registry& registry() {
+  // Leaked, so that it outlives every thread’s `thread_telemetry`.
+  static telemetry_registry* const instance = new telemetry_registry;
+  return *instance;
+}
+
+class thread_telemetry {
+ public:
+  thread_telemetry() {
+    telemetry_registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.threads.push_back(this);
+  }
+
+  ~thread_telemetry() {
+    telemetry_registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    CopyTo(&r.exited);
+    r.threads.erase(std::find(r.threads.begin(), r.threads.end(), this));
+  }
+
+  thread_telemetry(const thread_telemetry&) = delete;
+  thread_telemetry& operator=(const thread_telemetry&) = delete;
+
+  site_counters& Find(const char* file, unsigned line, const char* operation) {
+    // Consecutive checks usually come from the same site (e.g. in a loop), so
+    // try the last one first.
+    if (last_ != nullptr && last_->line == line && last_->file == file &&
+        last_->operation == operation) {
+      return *last_;
+    }
+    const site_key key{file, line, operation};
+    auto found = sites_.find(key);
+    if (found == sites_.end()) {
+      auto counters = std::make_unique<site_counters>();
+      counters->file = file;
+      counters->line = line;
+      counters->operation = operation;
+      std::lock_guard<std::mutex> lock(mutex_);
+      found = sites_.emplace(key, std::move(counters)).first;
+    }
+    last_ = found->second.get();
+    return *last_;
+  }
+
+  /// Appends this thread’s counters to `sites`. Holds this thread’s lock, so
+  /// that the owning thread does not add a site meanwhile.
+  void CopyTo(std::vector<integers::telemetry_site>* sites) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& entry : sites_) {
+      const site_counters& c = *entry.second;
+      integers::telemetry_site site{c.file, c.line, c.operation, 0, 0, {}};
+      site.checks = c.checks.load(std::memory_order_relaxed);
+      site.traps = c.traps.load(std::memory_order_relaxed);
+      for (size_t i = 0; i < site.headroom.size(); ++i) {
+        site.headroom[i] = c.headroom[i].load(std::memory_order_relaxed);
+      }
+      sites->push_back(site);
+    }
+  }
+
+  /// Clears this thread’s counters. (Another thread may call this; the
+  /// owner’s concurrent increments may be lost, which is fine for counters.)
+  void Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : sites_) {
+      site_counters& c = *entry.second;
+      c.checks.store(0, std::memory_order_relaxed);
+      c.traps.store(0, std::memory_order_relaxed);
+      for (auto& bucket : c.headroom) {
+        bucket.store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<site_key, std::unique_ptr<site_counters>, site_key_hash>
+      sites_;
+  site_counters* last_ = nullptr;
+};
+
+inline thread_telemetry& this_thread_telemetry() {
+  thread_local thread_telemetry instance;
+  return instance;
+}
+
+/// Records 1 check at a call site. `result` is ignored if `failed`.
+template <typename R>
+void record_check(const char* file,
+                  unsigned line,
+                  const char* operation,
+                  bool failed,
+                  R result) {
+  site_counters& c = this_thread_telemetry().Find(file, line, operation);
+  site_counters::increment(c.checks);
+  if (failed) {
+    site_counters::increment(c.traps);
+  } else {
+    site_counters::increment(c.headroom[headroom(result)]);
+  }
+}
+
+}  // namespace internal
+
+namespace integers {
+
+inline std::vector<telemetry_site> telemetry_snapshot() {
+  std::vector<telemetry_site> sites;
+  {
+    internal::telemetry_registry& r = internal::registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    sites = r.exited;
+    for (internal::thread_telemetry* thread : r.threads) {
+      thread->CopyTo(&sites);
+    }
+  }
+
+  // Merge the same site from different threads (and, since string literals
+  // need not be unique, from different copies of the same file name).
+  const auto before = [](const telemetry_site& a, const telemetry_site& b) {
+    const int file = strcmp(a.file, b.file);
+    if (file != 0) {
+      return file < 0;
+    }
+    if (a.line != b.line) {
+      return a.line < b.line;
+    }
+    return strcmp(a.operation, b.operation) < 0;
+  };
+  std::sort(sites.begin(), sites.end(), before);
+  std::vector<telemetry_site> merged;
+  for (const telemetry_site& site : sites) {
+    if (!merged.empty() && !before(merged.back(), site)) {
+      telemetry_site& m = merged.back();
+      m.checks += site.checks;
+      m.traps += site.traps;
+      for (size_t i = 0; i < m.headroom.size(); ++i) {
+        m.headroom[i] += site.headroom[i];
+      }
+    } else {
+      merged.push_back(site);
+    }
+  }
+  return merged;
+}
+
+inline void telemetry_dump(std::ostream& os) {
+  for (const telemetry_site& site : telemetry_snapshot()) {
+    os << site.file << ":" << site.line << " " << site.operation
+       << " checks=" << site.checks << " traps=" << site.traps << " headroom=";
+    const char* separator = "";
+    for (size_t i = 0; i < site.headroom.size(); ++i) {
+      if (site.headroom[i] != 0) {
+        os << separator << i << ":" << site.headroom[i];
+        separator = ",";
+      }
+    }
+    os << "\n";
+  }
+}
+
+inline void telemetry_reset() {
+  internal::telemetry_registry& r = internal::registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  r.exited.clear();
+  for (internal::thread_telemetry* thread : r.threads) {
+    thread->Reset();
+  }
+}
+
+}  // namespace integers
+
+/// The trailing parameters that give a trapping helper its caller’s location.
+#define INTEGERS_CALL_SITE                        \
+  , const char* integers_file = __builtin_FILE(), \
+                unsigned integers_line = __builtin_LINE()
+
+/// Records a check made by `operation` (at run time only).
+#define INTEGERS_RECORD_CHECK(operation, failed, result)                \
+  do {                                                                  \
+    if (!__builtin_is_constant_evaluated()) {                           \
+      ::internal::record_check(integers_file, integers_line, operation, \
+                               failed, result);                         \
+    }                                                                   \
+  } while (false)
+
+#else
+
+#define INTEGERS_CALL_SITE
+#define INTEGERS_RECORD_CHECK(operation, failed, result) \
+  do {                                                   \
+  } while (false)
+
+#endif  // INTEGERS_TELEMETRY
+
+#endif  // TELEMETRY_H_
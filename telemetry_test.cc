@@ -0,0 +1,177 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// This test must be built with `INTEGERS_TELEMETRY` defined.
+
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_support.h"
+#include "trapping.h"
+
+using namespace integers;
+using namespace std;
+
+namespace {
+
+using i8 = int8_t;
+using u8 = uint8_t;
+using i32 = int32_t;
+using u32 = uint32_t;
+using u64 = uint64_t;
+
+static_assert(trapping_add<int>(1, 2) == 3,
+              "Checks at compile time still work, and are not recorded");
+
+const telemetry_site* FindSite(const vector<telemetry_site>& sites,
+                               unsigned line,
+                               const string& operation) {
+  for (const telemetry_site& site : sites) {
+    if (site.line == line && operation == site.operation &&
+        string(site.file).find("telemetry_test.cc") != string::npos) {
+      return &site;
+    }
+  }
+  return nullptr;
+}
+
+void TestHeadroom() {
+  EXPECT(internal::headroom(u8{0}) == 8);
+  EXPECT(internal::headroom(u8{1}) == 7);
+  EXPECT(internal::headroom(u8{0x80}) == 0);
+  EXPECT(internal::headroom(i8{0}) == 7);
+  EXPECT(internal::headroom(i8{64}) == 0);
+  EXPECT(internal::headroom(i8{-64}) == 1);
+  EXPECT(internal::headroom(i8{-128}) == 0);
+  EXPECT(internal::headroom(numeric_limits<u64>::max()) == 0);
+  EXPECT(internal::headroom(u64{1}) == 63);
+#if defined(INTEGERS_HAVE_INT128)
+  EXPECT(internal::headroom(uint128_t{1}) == 127);
+  EXPECT(internal::headroom(uint128_t{1} << 64) == 63);
+  EXPECT(internal::headroom(numeric_limits<int128_t>::max()) == 0);
+  EXPECT(internal::headroom(int128_t{-1}) == 127);
+#endif
+}
+
+void TestPerSiteCounts() {
+  telemetry_reset();
+  u32 total = 0;
+  for (u32 i = 0; i < 10; ++i) {
+    total = trapping_add<u32>(total, i);
+  }
+  const unsigned add_line = __LINE__ - 2;
+  // (Not `const`, which would make these constant expressions, evaluated and
+  // not recorded at compile time.)
+  i32 product = trapping_mul<i32>(1 << 20, 1 << 9);
+  const unsigned mul_line = __LINE__ - 1;
+  u8 narrow = trapping_cast<u8>(product >> 22);
+  const unsigned cast_line = __LINE__ - 1;
+  EXPECT(total == 45 && narrow == 128);
+
+  const vector<telemetry_site> sites = telemetry_snapshot();
+  const telemetry_site* add = FindSite(sites, add_line, "trapping_add");
+  EXPECT(add != nullptr);
+  EXPECT(add->checks == 10);
+  EXPECT(add->traps == 0);
+  // The sums are 0, 1, 3, 6, 10, ..., 36, 45: 0 has 32 bits of headroom, and
+  // 36 and 45 have 26.
+  EXPECT(add->headroom[32] == 1);
+  EXPECT(add->headroom[31] == 1);
+  EXPECT(add->headroom[26] == 2);
+
+  const telemetry_site* mul = FindSite(sites, mul_line, "trapping_mul");
+  EXPECT(mul != nullptr);
+  EXPECT(mul->checks == 1);
+  EXPECT(mul->headroom[1] == 1);
+
+  const telemetry_site* cast = FindSite(sites, cast_line, "trapping_cast");
+  EXPECT(cast != nullptr);
+  EXPECT(cast->headroom[0] == 1);
+}
+
+void TestOperatorsAreAttributedToTrappingH() {
+  telemetry_reset();
+  trapping<u32> x = 1U;
+  x *= 3U;
+  x *= 3U;
+  bool found = false;
+  for (const telemetry_site& site : telemetry_snapshot()) {
+    if (string(site.file).find("trapping.h") != string::npos &&
+        string(site.operation) == "trapping_mul") {
+      EXPECT(site.checks == 2);
+      found = true;
+    }
+  }
+  EXPECT(found);
+}
+
+void TestThreads() {
+  telemetry_reset();
+  const auto work = [] {
+    u64 sum = 0;
+    for (u64 i = 0; i < 1000; ++i) {
+      sum = trapping_add<u64>(sum, i);
+    }
+    EXPECT(sum == 499500);
+  };
+  const unsigned line = __LINE__ - 4;
+  vector<thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back(work);
+  }
+  for (thread& t : threads) {
+    t.join();
+  }
+  // The threads have exited, but their counts are kept and merged.
+  work();
+  const vector<telemetry_site> sites = telemetry_snapshot();
+  const telemetry_site* add = FindSite(sites, line, "trapping_add");
+  EXPECT(add != nullptr);
+  EXPECT(add->checks == 5000);
+}
+
+void TestDump() {
+  telemetry_reset();
+  EXPECT(trapping_sub<u8>(200, 72) == 128);
+  const unsigned line = __LINE__ - 1;
+  ostringstream out;
+  telemetry_dump(out);
+  const string expected = ":" + to_string(line) +
+                          " trapping_sub checks=1 traps=0 headroom=0:1\n";
+  EXPECT(out.str().find(expected) != string::npos);
+  EXPECT(out.str().find("telemetry_test.cc") != string::npos);
+}
+
+void TestReset() {
+  EXPECT(trapping_add<int>(1, 1) == 2);
+  telemetry_reset();
+  for (const telemetry_site& site : telemetry_snapshot()) {
+    EXPECT(site.checks == 0);
+  }
+}
+
+}  // namespace
+
+int main() {
+  TestHeadroom();
+  TestPerSiteCounts();
+  TestOperatorsAreAttributedToTrappingH();
+  TestThreads();
+  TestDump();
+  TestReset();
+}
@@ -15,8 +15,10 @@
 #ifndef EXPECTATIONS_H_
 #define EXPECTATIONS_H_
 
+#include <assert.h>
 #include <err.h>
 #include <execinfo.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
 #include <iostream>
@@ -50,6 +52,28 @@ void PrintBacktrace();
 // This is less janky than trying to install the Google Test framework using
 // CMake, which doesn't build (CMakeLists.txt syntax errors). It was literally
 // easier and faster to write this. Sorry.
+//
+// If `trap` throws (with `INTEGERS_TRAP_THROWS`, as the Makefile builds the
+// tests by default), `EXPECT_DEATH` checks for the exception in-process.
+// Otherwise, it runs `statement` in a child process, and checks that the
+// child dies of a signal.
+#if defined(INTEGERS_TRAP_THROWS)
+#define EXPECT_DEATH(statement)                                       \
+  {                                                                   \
+    bool trapped = false;                                             \
+    try {                                                             \
+      statement;                                                      \
+    } catch (const ::integers::trap_exception&) {                     \
+      trapped = true;                                                 \
+    }                                                                 \
+    if (!trapped) {                                                   \
+      std::cerr << "FAILURE: Did not trap. Boo!! " << __FILE__ << ":" \
+                << __LINE__ << "\n";                                  \
+      ::integers::PrintBacktrace();                                   \
+      _exit(1);                                                       \
+    }                                                                 \
+  }
+#else
 #define EXPECT_DEATH(statement)                                           \
   {                                                                       \
     pid_t pid = fork();                                                   \
@@ -75,6 +99,7 @@ void PrintBacktrace();
       }                                                                   \
     }                                                                     \
   }
+#endif
 
 }  // namespace integers
 
@@ -35,10 +35,108 @@
 /// since it is surprising, you might enjoy [“Crash-Only Software” by Candea
 /// and
 /// Fox](https://www.usenix.org/legacy/events/hotos03/tech/full_papers/candea/candea.pdf).
-#if __has_builtin(__builtin_trap) && defined(NDEBUG)
-#define trap() __builtin_trap();
+///
+/// ### `INTEGERS_TRAP_HANDLER`, `INTEGERS_TRAP_THROWS`
+///
+/// You can choose what `trap` does at compile time, so the default still
+/// costs no more than the trap instruction or `abort` call, with no indirect
+/// call through a function pointer.
+///
+/// If you define `INTEGERS_TRAP_HANDLER` to the name of a function (e.g.
+/// `-DINTEGERS_TRAP_HANDLER=my_trap`), `trap` calls it directly. It should be
+/// `[[noreturn]]`: e.g. it might count or log the failure and then `abort`,
+/// or `longjmp` out of the current request. (If it does return, `trap` calls
+/// `abort`.) If the handler is not declared by a standard header, also define
+/// `INTEGERS_TRAP_HANDLER_HEADER` to a header on the include path that
+/// declares it (e.g. `-DINTEGERS_TRAP_HANDLER_HEADER='"my_trap.h"'`), and
+/// trap.h will include it. `-DINTEGERS_TRAP_HANDLER=abort` and
+/// `-DINTEGERS_TRAP_HANDLER=__builtin_trap` select those regardless of
+/// `NDEBUG`.
+///
+/// If you define `INTEGERS_TRAP_THROWS`, `trap` throws an
+/// `integers::trap_exception`, which unwinds like any other exception. The
+/// tests use this to check that operations trap without forking a process for
+/// each check (see test_support.h).
+///
+/// Define at most 1 of these. Either works with `INTEGERS_COLD_TRAP`.
+#if defined(INTEGERS_TRAP_HANDLER) && defined(INTEGERS_TRAP_THROWS)
+#error Define at most 1 of INTEGERS_TRAP_HANDLER and INTEGERS_TRAP_THROWS.
+#endif
+
+#include <stdlib.h>
+
+#if defined(INTEGERS_TRAP_HANDLER)
+
+#if defined(INTEGERS_TRAP_HANDLER_HEADER)
+#include INTEGERS_TRAP_HANDLER_HEADER
+#endif
+
+#define INTEGERS_TRAP_ACTION() \
+  INTEGERS_TRAP_HANDLER();     \
+  abort();
+
+#elif defined(INTEGERS_TRAP_THROWS)
+
+#include <exception>
+
+namespace integers {
+
+/// ### `trap_exception`
+///
+/// Thrown by `trap` if you define `INTEGERS_TRAP_THROWS`.
+struct trap_exception : std::exception {
+  const char* what() const noexcept override { return "integers: trap"; }
+};
+
+}  // namespace integers
+
+#define INTEGERS_TRAP_ACTION() throw ::integers::trap_exception();
+
+#elif __has_builtin(__builtin_trap) && defined(NDEBUG)
+#define INTEGERS_TRAP_ACTION() __builtin_trap();
+#else
+#define INTEGERS_TRAP_ACTION() abort();
+#endif
+
+/// ### `INTEGERS_COLD_TRAP`
+///
+/// By default, `trap` expands inline to the trap instruction or `abort` call
+/// at every checking site. If you define `INTEGERS_COLD_TRAP`, every site
+/// instead calls a single shared handler, `internal::cold_trap`, which is
+/// marked `cold`, `noinline`, and `noreturn` (so compilers place it in
+/// `.text.unlikely`, away from hot code). The compiler then treats every
+/// failing branch as unlikely, laying out the checked code as straight-line
+/// fall-through and moving the failure paths out of the hot functions.
+///
+/// Since the handler is never inlined, its return address identifies the
+/// call site exactly, at no cost to the site. The handler stores it in
+/// `internal::trap_site` (for debuggers and core dumps) and, unless `NDEBUG`
+/// is defined, prints it to `stderr`, and then does what `trap` otherwise
+/// would. Use e.g. `addr2line` to map it back to a source line (subtracting
+/// the load address, for position-independent executables).
+#if defined(INTEGERS_COLD_TRAP)
+
+#include <stdio.h>
+
+namespace internal {
+
+/// The return address of the most recent call to `cold_trap`.
+inline const void* volatile trap_site = nullptr;
+
+[[noreturn]] __attribute__((cold, noinline)) inline void cold_trap() {
+  trap_site = __builtin_return_address(0);
+#if !defined(NDEBUG)
+  fprintf(stderr, "integers: trap called from %p\n", trap_site);
+#endif
+  INTEGERS_TRAP_ACTION()
+}
+
+}  // namespace internal
+
+#define trap() ::internal::cold_trap();
+
 #else
-#define trap() abort();
+#define trap() INTEGERS_TRAP_ACTION()
 #endif
 
 #endif  // TRAP_H_
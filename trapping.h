@@ -16,29 +16,27 @@
 #define TRAPPING_H_
 
 #include <stdint.h>
-#include <stdlib.h>
 
-#include <algorithm>
 #include <limits>
-#include <ostream>
 #include <type_traits>
-#include <utility>
 
 #include "in_range.h"
 #include "is_integral.h"
+#include "telemetry.h"
 #include "trap.h"
 
 namespace internal {
 
-/// Returns true if `divisor` is 0. Returns true if `divisor` is signed, is -1,
-/// and if `dividend` is the minimum value for its type. Such division is UB, so
-/// must be avoided. This function is used in `div_overflow` and `mod_overflow`.
+/// Returns true if `divisor` is 0. Returns true if both operands are signed,
+/// `divisor` is -1, and `dividend` is the minimum value for its type. Such
+/// division is UB, so must be avoided. This function is used in
+/// `div_overflow` and `mod_overflow`.
 //
 // Adapted from
 // https://stackoverflow.com/questions/30394086/integer-division-overflows.
 // Thanks, chux!
 template <typename T, typename U>
-[[nodiscard]] bool check_bad_division(T dividend, U divisor) {
+[[nodiscard]] constexpr bool check_bad_division(T dividend, U divisor) {
   assert_is_integral(T);
   assert_is_integral(U);
 
@@ -51,8 +49,35 @@ template <typename T, typename U>
   //
   // As of C++17, we can assume 2’s complement. (See section 6.8.1 of
   // https://isocpp.org/files/papers/N4860.pdf.)
-  return std::is_signed_v<U> && dividend == std::numeric_limits<T>::min() &&
-         divisor == -1;
+  if constexpr (internal::is_signed_v<T> && internal::is_signed_v<U>) {
+    return dividend == std::numeric_limits<T>::min() && divisor == -1;
+  } else {
+    return false;
+  }
+}
+
+/// Stores `magnitude`, negated if `negative`, in `result`. Returns true if it
+/// does not fit.
+template <typename M, typename R>
+constexpr bool cast_magnitude(M magnitude, bool negative, R* result) {
+  if (!negative || magnitude == 0) {
+    if (!in_range<R>(magnitude)) {
+      return true;
+    }
+    *result = static_cast<R>(magnitude);
+    return false;
+  }
+  if constexpr (internal::is_signed_v<R>) {
+    // -(`magnitude` - 1) - 1, so as not to overflow when the result is `R`’s
+    // minimum.
+    if (!in_range<R>(magnitude - 1)) {
+      return true;
+    }
+    *result = static_cast<R>(-static_cast<R>(magnitude - 1) - 1);
+    return false;
+  } else {
+    return true;
+  }
 }
 
 }  // namespace internal
@@ -75,38 +100,30 @@ namespace integers {
 /// < 0 and `R` is unsigned.)
 template <typename R, typename T>
 constexpr bool cast_truncate(T value, R* result) {
-  if (in_range<R>(value)) {
+  if (internal::in_range<R>(value)) {
     *result = static_cast<R>(value);
     return false;
   }
   return true;
 }
 
-// NOTE: For `*_overflow`, `Result<R> { R, bool }` instead of returning `bool`
-// and writing to an `R*` out-parameter might be more readable and/or may result
-// in better object code. Preliminary testing shows that at -O0, the `Result`
-// version produces much worse code; at -O1, `Result` is marginally better; and
-// at -O2 and higher, both get inlined into oblivion. So, we should decide on
-// the basis of readability, since for builders who care about optimization it
-// seems essentially not to matter.
+// NOTE: For callers that prefer a returned `{value, overflowed}` pair to an
+// out-parameter (e.g. to keep the value in registers at low optimization
+// levels, or to chain several operations with 1 check at the end), see
+// `result<R>` and the `checked_*` functions in checked.h. At -O2 and higher,
+// both forms get inlined into oblivion.
 //
 // Note that `std::optional` would seem to be the right type to use here, but
-// since it introduces new UB — the opposite of what we are trying to achieve
-// with this library — it is not fit for our purposes. We could use Abseil's
-// `optional` and enable Abseil's hardening mode (which defines the UB to
-// crash), but we want for this library to be a simple, stand-alone dependency
-// that introduces no further dependencies. We could also write our own
-// `optional`, but that could be a significant undertaking. For now, we just
-// need to get the basic integer functionality implemented and tested, and this
-// out-parameter implementation works just fine and produces good enough object
-// code.
+// since it introduces new UB — the opposite of what we are trying to achieve
+// with this library — it is not fit for our purposes. `result<R>` always has
+// a value, and never has UB.
 
 /// ### `add_overflow`
 ///
 /// Adds `x` to `y` and stores the result in `result` (which can be a pointer to
 /// `x`, `y`, or another object). Returns true if the operation overflowed.
 template <typename T, typename U, typename R>
-[[nodiscard]] bool add_overflow(T x, U y, R* result) {
+[[nodiscard]] constexpr bool add_overflow(T x, U y, R* result) {
   assert_is_integral(T);
   assert_is_integral(U);
   assert_is_integral(R);
@@ -125,7 +142,7 @@ template <typename T, typename U, typename R>
 ///
 /// Note: Subtracting 0 does **not** return true. (See `cast_truncate`.)
 template <typename T, typename U, typename R>
-[[nodiscard]] bool sub_overflow(T x, U y, R* result) {
+[[nodiscard]] constexpr bool sub_overflow(T x, U y, R* result) {
   assert_is_integral(T);
   assert_is_integral(U);
   assert_is_integral(R);
@@ -142,7 +159,7 @@ template <typename T, typename U, typename R>
 /// pointer to `x`, `y`, or another object). Returns true if the operation
 /// overflowed.
 template <typename T, typename U, typename R>
-[[nodiscard]] bool mul_overflow(T x, U y, R* result) {
+[[nodiscard]] constexpr bool mul_overflow(T x, U y, R* result) {
   assert_is_integral(T);
   assert_is_integral(U);
   assert_is_integral(R);
@@ -158,15 +175,31 @@ template <typename T, typename U, typename R>
 /// Divides `dividend` by `divisor` and stores the quotient in `result` (which
 /// can be a pointer to `dividend`, `divisor`, or another object). Returns true
 /// if the operation overflowed.
+///
+/// Like `add_overflow` et c., this computes the mathematical result even when
+/// the usual arithmetic conversions would not: the quotient of `-7` and `2U`
+/// is -3, not 2147483644.
 template <typename T, typename U, typename R>
-[[nodiscard]] bool div_overflow(T dividend, U divisor, R* result) {
+[[nodiscard]] constexpr bool div_overflow(T dividend, U divisor, R* result) {
   assert_is_integral(T);
   assert_is_integral(U);
   assert_is_integral(R);
-  if (internal::check_bad_division<T, U>(dividend, divisor)) {
-    return true;
+  if constexpr (internal::kDivisionConvertsSign<T, U>) {
+    using M = decltype(dividend / divisor);
+    if (divisor == 0) {
+      return true;
+    }
+    return internal::cast_magnitude(
+        static_cast<M>(internal::unsigned_abs<M>(dividend) /
+                       internal::unsigned_abs<M>(divisor)),
+        internal::is_negative(dividend) != internal::is_negative(divisor),
+        result);
+  } else {
+    if (internal::check_bad_division<T, U>(dividend, divisor)) {
+      return true;
+    }
+    return cast_truncate(dividend / divisor, result);
   }
-  return cast_truncate(dividend / divisor, result);
 }
 
 /// ### `mod_overflow`
@@ -174,28 +207,110 @@ template <typename T, typename U, typename R>
 /// Divides `dividend` by `divisor` and stores the remainder in `result` (which
 /// can be a pointer to `dividend`, `divisor`, or another object). Returns true
 /// if the operation overflowed.
+///
+/// As with `div_overflow`, the operands may differ in signedness; the
+/// remainder has the sign of `dividend`.
+template <typename T, typename U, typename R>
+[[nodiscard]] constexpr bool mod_overflow(T dividend, U divisor, R* result) {
+  assert_is_integral(T);
+  assert_is_integral(U);
+  assert_is_integral(R);
+  if constexpr (internal::kDivisionConvertsSign<T, U>) {
+    using M = decltype(dividend % divisor);
+    if (divisor == 0) {
+      return true;
+    }
+    return internal::cast_magnitude(
+        static_cast<M>(internal::unsigned_abs<M>(dividend) %
+                       internal::unsigned_abs<M>(divisor)),
+        internal::is_negative(dividend), result);
+  } else {
+    if (internal::check_bad_division<T, U>(dividend, divisor)) {
+      return true;
+    }
+    return cast_truncate(dividend % divisor, result);
+  }
+}
+
+/// ### `shl_overflow`
+///
+/// Shifts `value` left by `amount` bits, as an `R`, and stores the result in
+/// `result` (which can be a pointer to `value` or another object). Returns
+/// true if `amount` is negative or not less than the number of bits in `R`,
+/// or if the mathematical result (`value` × 2<sup>`amount`</sup>) does not
+/// fit in `R`. In particular, a signed shift overflows if it would change the
+/// sign bit.
+///
+/// The range check on `amount` and the overflow check on the value each take a
+/// single comparison: bits fall off the top exactly when the value (or, if it
+/// is negative, its complement) is greater than `R`’s maximum shifted right
+/// by `amount`.
 template <typename T, typename U, typename R>
-[[nodiscard]] bool mod_overflow(T dividend, U divisor, R* result) {
+[[nodiscard]] constexpr bool shl_overflow(T value, U amount, R* result) {
   assert_is_integral(T);
   assert_is_integral(U);
   assert_is_integral(R);
-  if (internal::check_bad_division<T, U>(dividend, divisor)) {
+  using UR = internal::make_unsigned_t<R>;
+  constexpr auto kBits = std::numeric_limits<UR>::digits;
+  if (static_cast<internal::make_unsigned_t<U>>(amount) >=
+      static_cast<unsigned>(kBits)) {
     return true;
   }
-  return cast_truncate(dividend % divisor, result);
+  R r = 0;
+  if (cast_truncate(value, &r)) {
+    return true;
+  }
+  const UR bits = static_cast<UR>(r);
+  UR magnitude = bits;
+  if constexpr (internal::is_signed_v<R>) {
+    magnitude = static_cast<UR>(magnitude ^ static_cast<UR>(r >> (kBits - 1)));
+  }
+  if (magnitude > static_cast<UR>(std::numeric_limits<R>::max() >> amount)) {
+    return true;
+  }
+  *result = static_cast<R>(static_cast<UR>(bits << amount));
+  return false;
+}
+
+/// ### `shr_overflow`
+///
+/// Shifts `value` right by `amount` bits, and stores the result in `result`
+/// (which can be a pointer to `value` or another object). Signed values are
+/// sign-extended. Returns true if `amount` is negative or not less than the
+/// number of bits in `T`, or if the result does not fit in `R`.
+template <typename T, typename U, typename R>
+[[nodiscard]] constexpr bool shr_overflow(T value, U amount, R* result) {
+  assert_is_integral(T);
+  assert_is_integral(U);
+  assert_is_integral(R);
+  constexpr auto kBits =
+      std::numeric_limits<internal::make_unsigned_t<T>>::digits;
+  if (static_cast<internal::make_unsigned_t<U>>(amount) >=
+      static_cast<unsigned>(kBits)) {
+    return true;
+  }
+  return cast_truncate(static_cast<T>(value >> amount), result);
 }
 
 /// ## Trapping Operations
 ///
+/// These functions, like the primitive checking operations above and all of
+/// `trapping<T>`’s operators, are `constexpr`. If an operation would `trap`
+/// during constant evaluation, that is a compile-time error. So, you can
+/// compute constants (such as table sizes) with them, and pay nothing at run
+/// time.
+///
 /// ### `trapping_cast`
 ///
 /// Converts `T`s to `R`s, and traps if `R` cannot hold the full `value`. (This
 /// can happen on some narrowing conversions, and if `value` is signed and < 0
 /// and `R` is unsigned.)
 template <typename R, typename T>
-R trapping_cast(T value) {
+constexpr R trapping_cast(T value INTEGERS_CALL_SITE) {
   R result = 0;
-  if (cast_truncate(value, &result)) {
+  const bool overflowed = cast_truncate(value, &result);
+  INTEGERS_RECORD_CHECK("trapping_cast", overflowed, result);
+  if (overflowed) {
     trap();
   }
   return result;
@@ -206,13 +321,15 @@ R trapping_cast(T value) {
 /// Adds `x` and `y` and returns the result. If the operation overflows, or
 /// cannot fit into type `R`, this function will `trap`.
 template <typename R, typename T, typename U>
-R trapping_add(T x, U y) {
+constexpr R trapping_add(T x, U y INTEGERS_CALL_SITE) {
   assert_is_integral(R);
   assert_is_integral(T);
   assert_is_integral(U);
 
   R result = 0;
-  if (add_overflow(x, y, &result)) {
+  const bool overflowed = add_overflow(x, y, &result);
+  INTEGERS_RECORD_CHECK("trapping_add", overflowed, result);
+  if (overflowed) {
     trap();
   }
   return result;
@@ -223,13 +340,15 @@ R trapping_add(T x, U y) {
 /// Multiplies `x` and `y` and returns the result. If the operation
 /// overflows, or cannot fit into type `R`, this function will `trap`.
 template <typename R, typename T, typename U>
-R trapping_mul(T x, U y) {
+constexpr R trapping_mul(T x, U y INTEGERS_CALL_SITE) {
   assert_is_integral(R);
   assert_is_integral(T);
   assert_is_integral(U);
 
   R result = 0;
-  if (mul_overflow(x, y, &result)) {
+  const bool overflowed = mul_overflow(x, y, &result);
+  INTEGERS_RECORD_CHECK("trapping_mul", overflowed, result);
+  if (overflowed) {
     trap();
   }
 
@@ -241,13 +360,15 @@ R trapping_mul(T x, U y) {
 /// Subtracts `y` from `x` and returns the result. If the operation
 /// overflows, or cannot fit into type `R`, this function will `trap`.
 template <typename R, typename T, typename U>
-R trapping_sub(T x, U y) {
+constexpr R trapping_sub(T x, U y INTEGERS_CALL_SITE) {
   assert_is_integral(R);
   assert_is_integral(T);
   assert_is_integral(U);
 
   R result = 0;
-  if (sub_overflow(x, y, &result)) {
+  const bool overflowed = sub_overflow(x, y, &result);
+  INTEGERS_RECORD_CHECK("trapping_sub", overflowed, result);
+  if (overflowed) {
     trap();
   }
 
@@ -259,13 +380,15 @@ R trapping_sub(T x, U y) {
 /// Divides `dividend` by `divisor` and returns the quotient. If the operation
 /// overflows, or cannot fit into type `R`, this function will `trap`.
 template <typename R, typename T, typename U>
-R trapping_div(T dividend, U divisor) {
+constexpr R trapping_div(T dividend, U divisor INTEGERS_CALL_SITE) {
   assert_is_integral(R);
   assert_is_integral(T);
   assert_is_integral(U);
 
   R result = 0;
-  if (div_overflow(dividend, divisor, &result)) {
+  const bool overflowed = div_overflow(dividend, divisor, &result);
+  INTEGERS_RECORD_CHECK("trapping_div", overflowed, result);
+  if (overflowed) {
     trap();
   }
   return result;
@@ -276,13 +399,57 @@ R trapping_div(T dividend, U divisor) {
 /// Divides `dividend` by `divisor` and returns the remainder. If the operation
 /// overflows, or cannot fit into type `R`, this function will `trap`.
 template <typename R, typename T, typename U>
-R trapping_mod(T dividend, U divisor) {
+constexpr R trapping_mod(T dividend, U divisor INTEGERS_CALL_SITE) {
+  assert_is_integral(R);
+  assert_is_integral(T);
+  assert_is_integral(U);
+
+  R result = 0;
+  const bool overflowed = mod_overflow(dividend, divisor, &result);
+  INTEGERS_RECORD_CHECK("trapping_mod", overflowed, result);
+  if (overflowed) {
+    trap();
+  }
+
+  return result;
+}
+
+/// ### `trapping_shl`
+///
+/// Shifts `value` left by `amount` bits, as an `R`, and returns the result.
+/// `trap`s if `amount` is negative or too large, or if bits would fall off
+/// the left side (see `shl_overflow`).
+template <typename R, typename T, typename U>
+constexpr R trapping_shl(T value, U amount INTEGERS_CALL_SITE) {
+  assert_is_integral(R);
+  assert_is_integral(T);
+  assert_is_integral(U);
+
+  R result = 0;
+  const bool overflowed = shl_overflow(value, amount, &result);
+  INTEGERS_RECORD_CHECK("trapping_shl", overflowed, result);
+  if (overflowed) {
+    trap();
+  }
+
+  return result;
+}
+
+/// ### `trapping_shr`
+///
+/// Shifts `value` right by `amount` bits, and returns the result as an `R`.
+/// `trap`s if `amount` is negative or too large, or if the result does not
+/// fit in `R`.
+template <typename R, typename T, typename U>
+constexpr R trapping_shr(T value, U amount INTEGERS_CALL_SITE) {
   assert_is_integral(R);
   assert_is_integral(T);
   assert_is_integral(U);
 
   R result = 0;
-  if (mod_overflow(dividend, divisor, &result)) {
+  const bool overflowed = shr_overflow(value, amount, &result);
+  INTEGERS_RECORD_CHECK("trapping_shr", overflowed, result);
+  if (overflowed) {
     trap();
   }
 
@@ -298,6 +465,15 @@ R trapping_mod(T dividend, U divisor) {
 /// For guaranteed wrapping behavior, see the companion template class
 /// `wrapping<T>`.
 ///
+/// All operations are `constexpr`. For example,
+///
+///   constexpr size_t kTableSize = trapping<size_t>(kCount) * sizeof(Header);
+///
+/// is computed at compile time, and fails to compile if it overflows.
+///
+/// To format values, see format.h (`to_chars` and `std::format`) and
+/// ostream.h.
+///
 /// Implementation guided by the fine advice at
 /// https://en.cppreference.com/w/cpp/language/operators.
 template <typename T>
@@ -318,7 +494,7 @@ class trapping {
   ///
   /// Constructs and initializes.
   template <typename U, std::enable_if_t<std::is_same_v<T, U>, int> = 0>
-  trapping(U value) : value_(value) {}
+  constexpr trapping(U value) : value_(value) {}
 
   /// ### `trapping`
   ///
@@ -332,12 +508,12 @@ class trapping {
   /// will build and run just 'fine'. Thanks to Steve Checkoway for pointing
   /// this out.
   template <typename U, std::enable_if_t<!std::is_same_v<T, U>, int> = 0>
-  explicit trapping(U value) : value_(trapping_cast<T>(value)) {}
+  constexpr explicit trapping(U value) : value_(trapping_cast<T>(value)) {}
 
   /// ### `operator+=`
   ///
   /// Increments by `x`, `trap`ping on overflow.
-  Self& operator+=(T x) {
+  constexpr Self& operator+=(T x) {
     value_ = trapping_add<T, T, T>(value_, x);
     return *this;
   }
@@ -346,7 +522,7 @@ class trapping {
   ///
   /// Adds `rhs` to `lhs`, assigns the result to `lhs`, and returns it.
   /// `trap`s on overflow.
-  friend Self operator+(Self lhs, Self rhs) {
+  friend constexpr Self operator+(Self lhs, Self rhs) {
     lhs += rhs;
     return lhs;
   }
@@ -355,9 +531,12 @@ class trapping {
   ///
   /// Adds `rhs` to `lhs`, assigns the result to `lhs`, and returns it.
   /// `trap`s on overflow.
+  ///
+  /// This is a single checked operation in `T`, so the other operand need not
+  /// fit in `T`, as long as the result does.
   template <typename U>
-  friend Self operator+(Self lhs, U rhs) {
-    lhs += Self{rhs};
+  friend constexpr Self operator+(Self lhs, U rhs) {
+    lhs.value_ = trapping_add<T>(lhs.value_, rhs);
     return lhs;
   }
 
@@ -365,22 +544,24 @@ class trapping {
   ///
   /// Adds `rhs` to `lhs`, assigns the result to `lhs`, and returns it.
   /// `trap`s on overflow.
+  ///
+  /// This is a single checked operation in `T`, so the other operand need not
+  /// fit in `T`, as long as the result does.
   template <typename U>
-  friend Self operator+(U lhs, Self rhs) {
-    Self result{lhs};
-    result += rhs;
-    return result;
+  friend constexpr Self operator+(U lhs, Self rhs) {
+    rhs.value_ = trapping_add<T>(lhs, rhs.value_);
+    return rhs;
   }
 
   /// ### `operator+`
   ///
   /// Does nothing. (But it’s explicit about it!)
-  Self& operator+() { return *this; }
+  constexpr Self& operator+() { return *this; }
 
   /// ### `operator-=`
   ///
   /// Subtracts `x`, `trap`ping on overflow.
-  Self& operator-=(T x) {
+  constexpr Self& operator-=(T x) {
     value_ = trapping_sub<T, T, T>(value_, x);
     return *this;
   }
@@ -389,7 +570,7 @@ class trapping {
   ///
   /// Subtracts `rhs` from `lhs`, assigns the result to `lhs`, and returns
   /// it. `trap`s on overflow.
-  friend Self operator-(Self lhs, Self rhs) {
+  friend constexpr Self operator-(Self lhs, Self rhs) {
     lhs -= rhs;
     return lhs;
   }
@@ -398,9 +579,12 @@ class trapping {
   ///
   /// Subtracts `rhs` from `lhs`, assigns the result to `lhs`, and returns
   /// it. `trap`s on overflow.
+  ///
+  /// This is a single checked operation in `T`, so the other operand need not
+  /// fit in `T`, as long as the result does.
   template <typename U>
-  friend Self operator-(Self lhs, U rhs) {
-    lhs -= Self{rhs};
+  friend constexpr Self operator-(Self lhs, U rhs) {
+    lhs.value_ = trapping_sub<T>(lhs.value_, rhs);
     return lhs;
   }
 
@@ -408,11 +592,13 @@ class trapping {
   ///
   /// Subtracts `rhs` from `lhs`, assigns the result to `lhs`, and returns
   /// it. `trap`s on overflow.
+  ///
+  /// This is a single checked operation in `T`, so the other operand need not
+  /// fit in `T`, as long as the result does.
   template <typename U>
-  friend Self operator-(U lhs, Self rhs) {
-    Self result{lhs};
-    result -= rhs;
-    return result;
+  friend constexpr Self operator-(U lhs, Self rhs) {
+    rhs.value_ = trapping_sub<T>(lhs, rhs.value_);
+    return rhs;
   }
 
   /// ### `operator-`
@@ -421,9 +607,9 @@ class trapping {
   /// if `T` were signed.) However, if `T` is signed and is the minimum
   /// value, which cannot be represented in the positive range of `T`, this
   /// function will `trap`.
-  Self& operator-() {
-    static_assert(std::is_signed_v<T>, "Cannot negate an unsigned value");
-    if (std::is_signed_v<T> && value_ == std::numeric_limits<T>::min()) {
+  constexpr Self& operator-() {
+    static_assert(internal::is_signed_v<T>, "Cannot negate an unsigned value");
+    if (internal::is_signed_v<T> && value_ == std::numeric_limits<T>::min()) {
       trap();
     }
     value_ = -value_;
@@ -433,7 +619,7 @@ class trapping {
   /// ### `operator*=`
   ///
   /// Multiplies by `x`, `trap`ping on overflow.
-  Self& operator*=(T x) {
+  constexpr Self& operator*=(T x) {
     value_ = trapping_mul<T, T, T>(value_, x);
     return *this;
   }
@@ -442,7 +628,7 @@ class trapping {
   ///
   /// Multiplies `lhs` by `rhs`, assigns the result to `lhs`, and returns
   /// it. `trap`s on overflow.
-  friend Self operator*(Self lhs, Self rhs) {
+  friend constexpr Self operator*(Self lhs, Self rhs) {
     lhs *= rhs;
     return lhs;
   }
@@ -451,9 +637,12 @@ class trapping {
   ///
   /// Multiplies `lhs` by `rhs`, assigns the result to `lhs`, and returns
   /// it. `trap`s on overflow.
+  ///
+  /// This is a single checked operation in `T`, so the other operand need not
+  /// fit in `T`, as long as the result does.
   template <typename U>
-  friend Self operator*(Self lhs, U rhs) {
-    lhs *= Self{rhs};
+  friend constexpr Self operator*(Self lhs, U rhs) {
+    lhs.value_ = trapping_mul<T>(lhs.value_, rhs);
     return lhs;
   }
 
@@ -461,18 +650,20 @@ class trapping {
   ///
   /// Multiplies `lhs` by `rhs`, assigns the result to `lhs`, and returns
   /// it. `trap`s on overflow.
+  ///
+  /// This is a single checked operation in `T`, so the other operand need not
+  /// fit in `T`, as long as the result does.
   template <typename U>
-  friend Self operator*(U lhs, Self rhs) {
-    Self result{lhs};
-    result *= rhs;
-    return result;
+  friend constexpr Self operator*(U lhs, Self rhs) {
+    rhs.value_ = trapping_mul<T>(lhs, rhs.value_);
+    return rhs;
   }
 
   /// ### `operator/=`
   ///
   /// Divides by `divisor`, storing the quotient in `*this`, and `trap`ping
   /// on overflow or if `divisor` is 0.
-  Self& operator/=(T divisor) {
+  constexpr Self& operator/=(T divisor) {
     value_ = trapping_div<T, T, T>(value_, divisor);
     return *this;
   }
@@ -481,7 +672,7 @@ class trapping {
   ///
   /// Divides `dividend` by `divisor`, storing the quotient in `dividend`, and
   /// returns `dividend`. `trap`s on overflow or if `divisor` is 0.
-  friend Self operator/(Self dividend, Self divisor) {
+  friend constexpr Self operator/(Self dividend, Self divisor) {
     dividend /= divisor;
     return dividend;
   }
@@ -490,9 +681,12 @@ class trapping {
   ///
   /// Divides `dividend` by `divisor`, storing the quotient in `dividend`, and
   /// returns `dividend`. `trap`s on overflow or if `divisor` is 0.
+  ///
+  /// This is a single checked operation in `T`, so the other operand need not
+  /// fit in `T`, as long as the result does.
   template <typename U>
-  friend Self operator/(Self dividend, U divisor) {
-    dividend /= Self{divisor};
+  friend constexpr Self operator/(Self dividend, U divisor) {
+    dividend.value_ = trapping_div<T>(dividend.value_, divisor);
     return dividend;
   }
 
@@ -500,18 +694,20 @@ class trapping {
   ///
   /// Divides `dividend` by `divisor`, storing the quotient in `dividend`, and
   /// returns `dividend`. `trap`s on overflow or if `divisor` is 0.
+  ///
+  /// This is a single checked operation in `T`, so the other operand need not
+  /// fit in `T`, as long as the result does.
   template <typename U>
-  friend Self operator/(U dividend, Self divisor) {
-    Self result{dividend};
-    result /= Self{divisor};
-    return result;
+  friend constexpr Self operator/(U dividend, Self divisor) {
+    divisor.value_ = trapping_div<T>(dividend, divisor.value_);
+    return divisor;
   }
 
   /// ### `operator%=`
   ///
   /// Divides by `divisor`, storing the remainder in `*this`, and `trap`ping on
   /// overflow or if `divisor` is 0.
-  Self& operator%=(T divisor) {
+  constexpr Self& operator%=(T divisor) {
     value_ = trapping_mod<T, T, T>(value_, divisor);
     return *this;
   }
@@ -520,7 +716,7 @@ class trapping {
   ///
   /// Divides `dividend` by `divisor`, storing the remainder in `dividend`, and
   /// returns `dividend`. `trap`s on overflow or if `divisor` is 0.
-  friend Self operator%(Self dividend, Self divisor) {
+  friend constexpr Self operator%(Self dividend, Self divisor) {
     dividend %= divisor;
     return dividend;
   }
@@ -529,9 +725,12 @@ class trapping {
   ///
   /// Divides `dividend` by `divisor`, storing the remainder in `dividend`, and
   /// returns `dividend`. `trap`s on overflow or if `divisor` is 0.
+  ///
+  /// This is a single checked operation in `T`, so the other operand need not
+  /// fit in `T`, as long as the result does.
   template <typename U>
-  friend Self operator%(Self dividend, U divisor) {
-    dividend %= Self{divisor};
+  friend constexpr Self operator%(Self dividend, U divisor) {
+    dividend.value_ = trapping_mod<T>(dividend.value_, divisor);
     return dividend;
   }
 
@@ -539,18 +738,20 @@ class trapping {
   ///
   /// Divides `dividend` by `divisor`, storing the remainder in `dividend`, and
   /// returns `dividend`. `trap`s on overflow or if `divisor` is 0.
+  ///
+  /// This is a single checked operation in `T`, so the other operand need not
+  /// fit in `T`, as long as the result does.
   template <typename U>
-  friend Self operator%(U dividend, Self divisor) {
-    Self result{dividend};
-    result %= Self{divisor};
-    return result;
+  friend constexpr Self operator%(U dividend, Self divisor) {
+    divisor.value_ = trapping_mod<T>(dividend, divisor.value_);
+    return divisor;
   }
 
   /// ### `operator|=`
   ///
   /// Takes the bitwise `|` of the value and `x`, and assigns it to `value_`.
   /// Returns `*this`.
-  Self& operator|=(Self x) {
+  constexpr Self& operator|=(Self x) {
     value_ |= x.value_;
     return *this;
   }
@@ -559,7 +760,7 @@ class trapping {
   ///
   /// Takes the bitwise `|` of `lhs` and `rhs`, assigns it to `lhs`, and returns
   /// it.
-  friend Self operator|(Self lhs, Self rhs) {
+  friend constexpr Self operator|(Self lhs, Self rhs) {
     lhs |= rhs;
     return lhs;
   }
@@ -569,9 +770,9 @@ class trapping {
   /// Takes the bitwise `|` of `lhs` and `rhs`, assigns it to `lhs`, and returns
   /// it.
   template <typename U>
-  friend Self operator|(Self lhs, U rhs) {
+  friend constexpr Self operator|(Self lhs, U rhs) {
     assert_is_integral(U);
-    if (!in_range<T>(rhs)) {
+    if (!internal::in_range<T>(rhs)) {
       trap();
     }
     lhs |= Self{rhs};
@@ -583,9 +784,9 @@ class trapping {
   /// Takes the bitwise `|` of `lhs` and `rhs`, assigns it to `lhs`, and returns
   /// it.
   template <typename U>
-  friend Self operator|(U lhs, Self rhs) {
+  friend constexpr Self operator|(U lhs, Self rhs) {
     assert_is_integral(U);
-    if (!in_range<T>(lhs)) {
+    if (!internal::in_range<T>(lhs)) {
       trap();
     }
     Self result{lhs};
@@ -597,7 +798,7 @@ class trapping {
   ///
   /// Takes the bitwise `&` of the value and `x`, and assigns it to `value_`.
   /// Returns `*this`.
-  Self& operator&=(Self x) {
+  constexpr Self& operator&=(Self x) {
     value_ &= x.value_;
     return *this;
   }
@@ -606,7 +807,7 @@ class trapping {
   ///
   /// Takes the bitwise `&` of `lhs` and `rhs`, assigns it to `lhs`, and returns
   /// it.
-  friend Self operator&(Self lhs, Self rhs) {
+  friend constexpr Self operator&(Self lhs, Self rhs) {
     lhs &= rhs;
     return lhs;
   }
@@ -616,9 +817,9 @@ class trapping {
   /// Takes the bitwise `&` of `lhs` and `rhs`, assigns it to `lhs`, and returns
   /// it.
   template <typename U>
-  friend Self operator&(Self lhs, U rhs) {
+  friend constexpr Self operator&(Self lhs, U rhs) {
     assert_is_integral(U);
-    if (!in_range<T>(rhs)) {
+    if (!internal::in_range<T>(rhs)) {
       trap();
     }
     lhs &= rhs;
@@ -630,9 +831,9 @@ class trapping {
   /// Takes the bitwise `&` of `lhs` and `rhs`, assigns it to `lhs`, and returns
   /// it.
   template <typename U>
-  friend Self operator&(U lhs, Self rhs) {
+  friend constexpr Self operator&(U lhs, Self rhs) {
     assert_is_integral(U);
-    if (!in_range<T>(lhs)) {
+    if (!internal::in_range<T>(lhs)) {
       trap();
     }
     Self result{lhs};
@@ -644,7 +845,7 @@ class trapping {
   ///
   /// Takes the bitwise `^` of the value and `x`, and assigns it to `value_`.
   /// Returns `*this`.
-  Self& operator^=(Self x) {
+  constexpr Self& operator^=(Self x) {
     value_ ^= x.value_;
     return *this;
   }
@@ -653,7 +854,7 @@ class trapping {
   ///
   /// Takes the bitwise `&` of `lhs` and `rhs`, assigns it to `lhs`, and returns
   /// it.
-  friend Self operator^(Self lhs, Self rhs) {
+  friend constexpr Self operator^(Self lhs, Self rhs) {
     lhs ^= rhs;
     return lhs;
   }
@@ -663,9 +864,9 @@ class trapping {
   /// Takes the bitwise `&` of `lhs` and `rhs`, assigns it to `lhs`, and returns
   /// it.
   template <typename U>
-  friend Self operator^(Self lhs, U rhs) {
+  friend constexpr Self operator^(Self lhs, U rhs) {
     assert_is_integral(U);
-    if (!in_range<T>(rhs)) {
+    if (!internal::in_range<T>(rhs)) {
       trap();
     }
     lhs ^= rhs;
@@ -677,9 +878,9 @@ class trapping {
   /// Takes the bitwise `&` of `lhs` and `rhs`, assigns it to `lhs`, and returns
   /// it.
   template <typename U>
-  friend Self operator^(U lhs, Self rhs) {
+  friend constexpr Self operator^(U lhs, Self rhs) {
     assert_is_integral(U);
-    if (!in_range<T>(lhs)) {
+    if (!internal::in_range<T>(lhs)) {
       trap();
     }
     Self result{lhs};
@@ -690,20 +891,19 @@ class trapping {
   /// ### `operator>>=`
   ///
   /// Shifts the value right by `x` bits, and assigns the result to `value_`.
-  /// Returns `*this`. `trap`s if `x` is more than there are bits in the value.
-  Self& operator>>=(T x) {
-    if (x < 1 || static_cast<size_t>(x) > (CHAR_BIT * sizeof(T) - 1U)) {
-      trap();
-    }
-    value_ = value_ >> x;
+  /// Returns `*this`. `trap`s if `x` is negative or not less than the number
+  /// of bits in the value.
+  constexpr Self& operator>>=(T x) {
+    value_ = trapping_shr<T>(value_, x);
     return *this;
   }
 
   /// ### `operator>>`
   ///
   /// Shifts `lhs` right by `x` bits, assigns the result to `lhs`, and returns
-  /// it.. `trap`s if `x` is more than there are bits in the value.
-  friend Self operator>>(Self lhs, Self rhs) {
+  /// it. `trap`s if `x` is negative or not less than the number of bits in the
+  /// value.
+  friend constexpr Self operator>>(Self lhs, Self rhs) {
     lhs >>= rhs;
     return lhs;
   }
@@ -711,42 +911,21 @@ class trapping {
   /// ### `operator<<=`
   ///
   /// Shifts the value left by `x` bits, and assigns the result to `value_`.
-  /// Returns `*this`. `trap`s if `x` is more than there are bits in the value
-  /// or if bits ‘fall off’ the left side (i.e. the shift overflows).
-  Self& operator<<=(T x) {
-    if (x < 1 || static_cast<size_t>(x) > (CHAR_BIT * sizeof(T) - 1U)) {
-      trap();
-    }
-
-    // Check that we aren’t about to shift left by more than we have room left
-    // for — i.e. check for overflow.
-    using U = typename std::make_unsigned<T>::type;
-    U unsigned_x = static_cast<U>(x);
-    const int leading_zeros = __builtin_clz(unsigned_x);
-    if (x >= leading_zeros) {
-      trap();
-    }
-
-    const T y = value_ << x;
-
-    // E.g. (1 << 31UL) results in "warning: signed shift result (0x80000000)
-    // sets the sign bit of the shift expression's type ('int') and becomes
-    // negative [-Wshift-sign-overflow]". So, check for this condition: change
-    // in sign if `T` `is_signed`.
-    if (std::is_signed_v<T> && ((x < 0 && y >= 0) || (x >= 0 && y < 0))) {
-      trap();
-    }
-
-    value_ = y;
+  /// Returns `*this`. `trap`s if `x` is negative or not less than the number
+  /// of bits in the value, or if bits ‘fall off’ the left side (i.e. the shift
+  /// overflows, including into the sign bit).
+  constexpr Self& operator<<=(T x) {
+    value_ = trapping_shl<T>(value_, x);
     return *this;
   }
 
   /// ### `operator<<`
   ///
   /// Shifts `lhs` left by `x` bits, and assigns the result to `lhs`, and
-  /// returns it.. `trap`s if `x` is more than there are bits in the value or if
-  /// bits ‘fall off’ the left side (i.e. the shift overflows).
-  friend Self operator<<(Self lhs, Self rhs) {
+  /// returns it. `trap`s if `x` is negative or not less than the number of
+  /// bits in the value, or if bits ‘fall off’ the left side (i.e. the shift
+  /// overflows, including into the sign bit).
+  friend constexpr Self operator<<(Self lhs, Self rhs) {
     lhs <<= rhs;
     return lhs;
   }
@@ -754,67 +933,69 @@ class trapping {
   /// ### `operator<`
   ///
   /// Returns true if `lhs` is less than `rhs`.
-  friend bool operator<(Self lhs, Self rhs) { return lhs.value_ < rhs.value_; }
+  friend constexpr bool operator<(Self lhs, Self rhs) {
+    return lhs.value_ < rhs.value_;
+  }
 
   /// ### `operator<`
   ///
   /// Returns true if `lhs` is less than `rhs`.
-  friend bool operator<(Self lhs, T rhs) { return lhs.value_ < rhs; }
+  friend constexpr bool operator<(Self lhs, T rhs) { return lhs.value_ < rhs; }
 
   /// ### `operator<`
   ///
   /// Returns true if `lhs` is less than `rhs`.
-  friend bool operator<(T lhs, Self rhs) { return lhs < rhs.value_; }
+  friend constexpr bool operator<(T lhs, Self rhs) { return lhs < rhs.value_; }
 
   /// ### `operator>`
   ///
   /// Returns true if `lhs` is greater than `rhs`.
-  friend bool operator>(Self lhs, Self rhs) { return rhs < lhs; }
+  friend constexpr bool operator>(Self lhs, Self rhs) { return rhs < lhs; }
 
   /// ### `operator>`
   ///
   /// Returns true if `lhs` is greater than `rhs`.
-  friend bool operator>(Self lhs, T rhs) { return rhs < lhs; }
+  friend constexpr bool operator>(Self lhs, T rhs) { return rhs < lhs; }
 
   /// ### `operator>`
   ///
   /// Returns true if `lhs` is greater than `rhs`.
-  friend bool operator>(T lhs, Self rhs) { return rhs < lhs; }
+  friend constexpr bool operator>(T lhs, Self rhs) { return rhs < lhs; }
 
   /// ### `operator<=`
   ///
   /// Returns true if `lhs` is less than or equal to `rhs`.
-  friend bool operator<=(Self lhs, Self rhs) { return !(lhs > rhs); }
+  friend constexpr bool operator<=(Self lhs, Self rhs) { return !(lhs > rhs); }
 
   /// ### `operator<=`
   ///
   /// Returns true if `lhs` is less than or equal to `rhs`.
-  friend bool operator<=(Self lhs, T rhs) { return !(lhs > rhs); }
+  friend constexpr bool operator<=(Self lhs, T rhs) { return !(lhs > rhs); }
 
   /// ### `operator<=`
   ///
   /// Returns true if `lhs` is less than or equal to `rhs`.
-  friend bool operator<=(T lhs, Self rhs) { return !(lhs > rhs); }
+  friend constexpr bool operator<=(T lhs, Self rhs) { return !(lhs > rhs); }
 
   /// ### `operator>=`
   ///
   /// Returns true if `lhs` is greater than or equal to `rhs`.
-  friend bool operator>=(Self lhs, Self rhs) { return !(rhs > lhs); }
+  friend constexpr bool operator>=(Self lhs, Self rhs) { return !(rhs > lhs); }
 
   /// ### `operator>=`
   ///
   /// Returns true if `lhs` is greater than or equal to `rhs`.
-  friend bool operator>=(Self lhs, T rhs) { return !(rhs > lhs); }
+  friend constexpr bool operator>=(Self lhs, T rhs) { return !(rhs > lhs); }
 
   /// ### `operator>=`
   ///
   /// Returns true if `lhs` is greater than or equal to `rhs`.
-  friend bool operator>=(T lhs, Self rhs) { return !(rhs > lhs); }
+  friend constexpr bool operator>=(T lhs, Self rhs) { return !(rhs > lhs); }
 
   /// ### `operator==`
   ///
   /// Returns true if `lhs` is equal to `rhs`.
-  friend bool operator==(Self lhs, Self rhs) {
+  friend constexpr bool operator==(Self lhs, Self rhs) {
     return lhs.value_ == rhs.value_;
   }
 
@@ -822,9 +1003,9 @@ class trapping {
   ///
   /// Returns true if `lhs` is equal to `rhs`.
   template <typename U>
-  friend bool operator==(Self lhs, U rhs) {
+  friend constexpr bool operator==(Self lhs, U rhs) {
     assert_is_integral(U);
-    if (!in_range<T>(rhs) || !in_range<U>(lhs.value_)) {
+    if (!internal::in_range<T>(rhs) || !internal::in_range<U>(lhs.value_)) {
       trap();
     }
     return lhs.value_ == rhs;
@@ -834,20 +1015,20 @@ class trapping {
   ///
   /// Returns true if `lhs` is equal to `rhs`.
   template <typename U>
-  friend bool operator==(U lhs, Self rhs) {
+  friend constexpr bool operator==(U lhs, Self rhs) {
     return rhs == lhs;
   }
 
   /// ### `operator!=`
   ///
   /// Returns true if `lhs` is not equal to `rhs`.
-  friend bool operator!=(Self lhs, Self rhs) { return !(lhs == rhs); }
+  friend constexpr bool operator!=(Self lhs, Self rhs) { return !(lhs == rhs); }
 
   /// ### `operator!=`
   ///
   /// Returns true if `lhs` is not equal to `rhs`.
   template <typename U>
-  friend bool operator!=(Self lhs, U rhs) {
+  friend constexpr bool operator!=(Self lhs, U rhs) {
     return !(lhs == rhs);
   }
 
@@ -855,7 +1036,7 @@ class trapping {
   ///
   /// Returns true if `lhs` is not equal to `rhs`.
   template <typename U>
-  friend bool operator!=(U lhs, Self rhs) {
+  friend constexpr bool operator!=(U lhs, Self rhs) {
     return !(lhs == rhs);
   }
 
@@ -863,7 +1044,7 @@ class trapping {
   ///
   /// Prefix increment. Increments the value and returns `*this` with the new
   /// value.
-  Self& operator++() {
+  constexpr Self& operator++() {
     *this += 1;
     return *this;
   }
@@ -872,7 +1053,7 @@ class trapping {
   ///
   /// Postfix increment. Increments the value and returns an object containing
   /// the previous value.
-  Self operator++(int) {
+  constexpr Self operator++(int) {
     Self previous = *this;
     *this += 1;
     return previous;
@@ -882,7 +1063,7 @@ class trapping {
   ///
   /// Prefix decrement. Decrements the value and returns `*this` with the new
   /// value.
-  Self& operator--() {
+  constexpr Self& operator--() {
     *this -= 1;
     return *this;
   }
@@ -891,7 +1072,7 @@ class trapping {
   ///
   /// Postfix decrement. Decrements the value and returns an object containing
   /// the previous value.
-  Self operator--(int) {
+  constexpr Self operator--(int) {
     Self previous = *this;
     *this -= 1;
     return previous;
@@ -902,24 +1083,16 @@ class trapping {
   /// Returns the plain `T` value as a `U`. Traps if the value cannot be
   /// represented as a `U`.
   template <typename U>
-  operator U() const {
+  constexpr operator U() const {
     return trapping_cast<U>(value_);
   }
 
-  /// ### `operator<<`
-  ///
-  /// Writes `self`'s value to the `ostream`, and returns the `ostream`.
-  friend std::ostream& operator<<(std::ostream& os, Self self) {
-    os << self.value_;
-    return os;
-  }
-
   /// ### `abs`
   ///
   /// Returns the absolute value of `x`. Traps if the absolute value cannot be
   /// represented.
-  friend Self abs(Self x) {
-    if constexpr (std::is_unsigned_v<T>) {
+  friend constexpr Self abs(Self x) {
+    if constexpr (internal::is_unsigned_v<T>) {
       return x;
     } else {
       if (x < T{0}) {
@@ -946,6 +1119,10 @@ static_assert(sizeof(trapping<int32_t>) == sizeof(int32_t),
               "sizeof(trapping<int32_t>) must == sizeof(int32_t)");
 static_assert(sizeof(trapping<int64_t>) == sizeof(int64_t),
               "sizeof(trapping<int64_t>) must == sizeof(int64_t)");
+static_assert(alignof(trapping<int64_t>) == alignof(int64_t),
+              "alignof(trapping<int64_t>) must == alignof(int64_t)");
+static_assert(std::is_standard_layout_v<trapping<int>>,
+              "`trapping<T>` must be standard-layout");
 
 }  // namespace integers
 
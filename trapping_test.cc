@@ -15,6 +15,7 @@
 #include <iostream>
 #include <limits>
 
+#include "ostream.h"
 #include "test_support.h"
 #include "trapping.h"
 
@@ -398,6 +399,94 @@ void TestModOverflow() {
   }
 }
 
+// Checks `shl_overflow` and `shr_overflow` against the mathematical result,
+// for every `T` value and every shift amount from -1 through the width of `T`.
+template <typename T>
+void GenericTestShiftOverflow() {
+  constexpr int bits = numeric_limits<make_unsigned_t<T>>::digits;
+  for (int v = numeric_limits<T>::min(); v <= numeric_limits<T>::max(); ++v) {
+    const T value = static_cast<T>(v);
+    for (int amount = -1; amount <= bits; ++amount) {
+      const bool bad_amount = amount < 0 || amount >= bits;
+      T result = 0;
+      const bool overflowed = shl_overflow(value, amount, &result);
+      if (bad_amount) {
+        EXPECT(overflowed);
+        EXPECT(shr_overflow(value, amount, &result));
+        continue;
+      }
+      const i64 expected = i64{v} * (i64{1} << amount);
+      EXPECT(overflowed == !in_range<T>(expected));
+      if (!overflowed) {
+        EXPECT(result == expected);
+      }
+      EXPECT(!shr_overflow(value, amount, &result));
+      EXPECT(result == (v >> amount));
+    }
+  }
+}
+
+void TestShlOverflow() {
+  GenericTestShiftOverflow<i8>();
+  GenericTestShiftOverflow<u8>();
+  GenericTestShiftOverflow<i16>();
+  GenericTestShiftOverflow<u16>();
+
+  {
+    i64 result;
+    EXPECT(!shl_overflow(i64{1}, 62, &result));
+    EXPECT(result == i64{1} << 62);
+    EXPECT(shl_overflow(i64{1}, 63, &result));
+    EXPECT(!shl_overflow(i64{-1}, 63, &result));
+    EXPECT(result == i64_min);
+    EXPECT(shl_overflow(i64{-2}, 63, &result));
+    EXPECT(shl_overflow(i64{1}, 64, &result));
+  }
+  {
+    u64 result;
+    EXPECT(!shl_overflow(u64{1}, 63, &result));
+    EXPECT(result == u64{1} << 63);
+    EXPECT(shl_overflow(u64{3}, 63, &result));
+    EXPECT(!shl_overflow(u64_max, 0, &result));
+    EXPECT(shl_overflow(u64_max, 1, &result));
+    EXPECT(shl_overflow(u64{1}, -1, &result));
+  }
+  {
+    // The shift happens in `R`, so widening first is not an overflow.
+    u32 result;
+    EXPECT(!shl_overflow(u8{0xff}, 24, &result));
+    EXPECT(result == 0xff000000);
+    EXPECT(shl_overflow(i8{-1}, 1, &result));
+  }
+}
+
+void TestShrOverflow() {
+  {
+    i64 result;
+    EXPECT(!shr_overflow(i64_min, 63, &result));
+    EXPECT(result == -1);
+    EXPECT(shr_overflow(i64_min, 64, &result));
+    EXPECT(shr_overflow(i64_min, -1, &result));
+  }
+  {
+    u8 result;
+    EXPECT(!shr_overflow(u32_max, 24, &result));
+    EXPECT(result == u8_max);
+    EXPECT(shr_overflow(u32_max, 23, &result));
+    EXPECT(shr_overflow(i32{-1}, 24, &result));
+  }
+}
+
+void TestShift() {
+  EXPECT((trapping_shl<u64>(u64{1}, 40) == u64{1} << 40));
+  EXPECT((trapping_shr<u16>(u64{1} << 40, 30) == 1024));
+  EXPECT_DEATH((void)trapping_shl<i32>(1, 31));
+  EXPECT_DEATH((void)trapping_shl<u32>(1, 32));
+  EXPECT_DEATH((void)trapping_shr<i32>(1, -1));
+  EXPECT_DEATH((void)trapping_shr<u8>(0x1ff, 0));
+  static_assert(trapping_shl<i16>(-1, 15) == numeric_limits<i16>::min());
+}
+
 void TestMul() {
   EXPECT_DEATH((trapping_mul<i32, i32, i32>(i32_max, 2)));
   EXPECT_DEATH((trapping_mul<i16, i32, i32>(i32_max, 1)));
@@ -839,6 +928,28 @@ void TestOperatorLeftShift() {
     trapping<i32> x = 1;
     EXPECT_DEATH(x <<= 31);
   }
+  {
+    trapping<i32> x = 1;
+    x <<= 0;
+    EXPECT(x == 1);
+    EXPECT_DEATH(x <<= -1);
+    EXPECT_DEATH(x <<= 32);
+  }
+  {
+    trapping<i64> x = i64{1};
+    x <<= 40;
+    EXPECT(x == i64{1} << 40);
+    x = i64{-3};
+    x <<= 61;
+    EXPECT(x == i64{-3} * (i64{1} << 61));
+    EXPECT_DEATH(x <<= 1);
+  }
+  {
+    trapping<u64> x = u64{3};
+    x <<= 62;
+    EXPECT(x == u64{3} << 62);
+    EXPECT_DEATH(x <<= 1);
+  }
 }
 
 void TestOperatorRightShift() {
@@ -851,6 +962,14 @@ void TestOperatorRightShift() {
     trapping<i32> x = 1;
     EXPECT_DEATH(x >>= 33);
   }
+  {
+    trapping<u64> x = u64_max;
+    x >>= 0;
+    EXPECT(x == u64_max);
+    x >>= 63;
+    EXPECT(x == 1U);
+    EXPECT_DEATH(x >>= 64);
+  }
 
   // Expect sign-extension:
   {
@@ -1128,6 +1247,93 @@ void TestMultiOperatorOverflow() {
   CallGenericTestMultiOperatorOverflow<i8, i16, i32, i64>();
 }
 
+void TestMixedTypeOperators() {
+  {
+    // The other operand need not fit in `T`, as long as the result does.
+    const trapping<u32> x{5U};
+    EXPECT(static_cast<u32>(x + i64{-3}) == 2);
+    EXPECT(static_cast<u32>(i64{-3} + x) == 2);
+    EXPECT(static_cast<u32>(x - i64{-4294967290}) == u32_max);
+    EXPECT(static_cast<u32>(x * i64{858993459}) == u32_max);
+    EXPECT_DEATH((void)(x + i64{-6}));
+    EXPECT_DEATH((void)(x - i64{-4294967291}));
+  }
+  {
+    const trapping<i8> x{i8{-100}};
+    EXPECT(static_cast<i8>(x - u64{28}) == -128);
+    EXPECT(static_cast<i8>(u64{200} + x) == 100);
+    EXPECT_DEATH((void)(x - u64{29}));
+    EXPECT_DEATH((void)(x * u64{2}));
+  }
+  {
+    // Division is exact even where the usual arithmetic conversions would
+    // make the signed operand unsigned.
+    const trapping<i32> x{-7};
+    EXPECT(static_cast<i32>(x / 2U) == -3);
+    EXPECT(static_cast<i32>(x % 2U) == -1);
+    EXPECT(static_cast<i32>(7U / trapping<i32>{-2}) == -3);
+    EXPECT(static_cast<i32>(7U % trapping<i32>{-2}) == 1);
+    EXPECT(static_cast<i32>(trapping<i32>{i32_min} / u64{1}) == i32_min);
+    EXPECT(static_cast<i32>(x / u64{0x100000000}) == 0);
+    EXPECT_DEATH((void)(x / 0U));
+    EXPECT_DEATH((void)(x % 0U));
+    EXPECT_DEATH((void)(u64{0x100000000} / trapping<i32>{1}));
+  }
+  {
+    const trapping<u32> x{7U};
+    EXPECT(static_cast<u32>(x / i64{7}) == 1);
+    EXPECT(static_cast<u32>(trapping<u32>{0U} / -1) == 0);
+    EXPECT(static_cast<u32>(x % -2) == 1);
+    EXPECT_DEATH((void)(x / -1));
+  }
+  {
+    i32 r = 0;
+    EXPECT(!div_overflow(-7, 2U, &r) && r == -3);
+    EXPECT(!mod_overflow(-7, 2U, &r) && r == -1);
+    EXPECT(!div_overflow(i64_min, u64{1} << 63, &r) && r == -1);
+    EXPECT(div_overflow(i64_min, u64{1}, &r));
+    u64 u = 0;
+    EXPECT(!div_overflow(u64_max, i64{1}, &u) && u == u64_max);
+    EXPECT(div_overflow(u64_max, i64{-1}, &u));
+  }
+}
+
+template <typename T, typename U>
+void GenericTestExhaustiveMixedTraps() {
+  const auto check = [](int expected, auto compute) {
+    if (expected >= numeric_limits<T>::min() &&
+        expected <= numeric_limits<T>::max()) {
+      EXPECT(static_cast<T>(compute()) == expected);
+    } else {
+      EXPECT_DEATH((void)compute());
+    }
+  };
+  for (int i = numeric_limits<T>::min(); i <= numeric_limits<T>::max(); ++i) {
+    const trapping<T> x{static_cast<T>(i)};
+    for (int j = numeric_limits<U>::min(); j <= numeric_limits<U>::max(); ++j) {
+      const U y = static_cast<U>(j);
+      check(i + j, [x, y] { return x + y; });
+      check(j + i, [x, y] { return y + x; });
+      check(i - j, [x, y] { return x - y; });
+      check(j - i, [x, y] { return y - x; });
+      check(i * j, [x, y] { return x * y; });
+      if (j == 0) {
+        EXPECT_DEATH((void)(x / y));
+        EXPECT_DEATH((void)(x % y));
+      } else {
+        check(i / j, [x, y] { return x / y; });
+        check(i % j, [x, y] { return x % y; });
+      }
+      if (i == 0) {
+        EXPECT_DEATH((void)(y / x));
+      } else {
+        check(j / i, [x, y] { return y / x; });
+        check(j % i, [x, y] { return y % x; });
+      }
+    }
+  }
+}
+
 void TestOstream() {
   auto x = trapping<i32>(42);
   std::cout << "Testing `operator<<`: " << x << "\n";
@@ -1160,6 +1366,99 @@ void TestAbs() {
   CallGenericTestAbs<i8, u8, i16, u16, i32, u32, i64, u64>();
 }
 
+// Checks every pair of 8-bit operands, for every operator, against the
+// mathematical result: the operator must return it if it fits, and `trap` if
+// not. That is about 300,000 death tests, so it runs only when they are
+// in-process (see test_support.h).
+template <typename T>
+void GenericTestExhaustiveTraps() {
+  constexpr int min = numeric_limits<T>::min();
+  constexpr int max = numeric_limits<T>::max();
+  const auto check = [](int expected, auto compute) {
+    if (expected >= min && expected <= max) {
+      EXPECT(static_cast<T>(compute()) == expected);
+    } else {
+      EXPECT_DEATH((void)compute());
+    }
+  };
+  for (int i = min; i <= max; ++i) {
+    const trapping<T> x{static_cast<T>(i)};
+    for (int j = min; j <= max; ++j) {
+      const trapping<T> y{static_cast<T>(j)};
+      check(i + j, [x, y] { return x + y; });
+      check(i - j, [x, y] { return x - y; });
+      check(i * j, [x, y] { return x * y; });
+      if (j == 0) {
+        EXPECT_DEATH((void)(x / y));
+        EXPECT_DEATH((void)(x % y));
+      } else {
+        check(i / j, [x, y] { return x / y; });
+        // The remainder always fits, except for `min % -1`, which is UB for
+        // the built-in `%`.
+        check(i / j >= min && i / j <= max ? i % j : max + 1,
+              [x, y] { return x % y; });
+      }
+    }
+  }
+}
+
+void TestExhaustiveTraps() {
+#if defined(INTEGERS_TRAP_THROWS)
+  GenericTestExhaustiveTraps<i8>();
+  GenericTestExhaustiveTraps<u8>();
+  GenericTestExhaustiveMixedTraps<i8, u8>();
+  GenericTestExhaustiveMixedTraps<u8, i8>();
+#endif
+}
+
+struct Header {
+  u32 magic;
+  u32 count;
+  u64 offset;
+};
+
+// These are all evaluated at compile time. (If any of them overflowed, this
+// file would not compile.)
+constexpr size_t kHeaderCount = 1000;
+constexpr size_t kTableSize = trapping<size_t>(kHeaderCount) * sizeof(Header);
+static_assert(kTableSize == kHeaderCount * sizeof(Header));
+
+constexpr trapping<i32> kSum = trapping<i32>(i32_max - 1) + 1;
+static_assert(kSum == i32_max);
+static_assert(trapping_add<i64>(i32_max, i32_max) == i64{i32_max} * 2);
+static_assert(trapping_sub<u8>(u8{1}, u8{1}) == 0);
+static_assert(trapping_mul<u16>(u8_max, u8_max) == 65025);
+static_assert(trapping_div<i8>(i8_min, i8{1}) == i8_min);
+static_assert(trapping_mod<i8>(i8_max, i8{2}) == 1);
+static_assert(trapping_cast<u8>(i64{255}) == u8_max);
+
+constexpr bool CheckAll() {
+  i16 result = 0;
+  return add_overflow(i16_max, 1, &result) &&
+         sub_overflow(i16_min, 1, &result) &&
+         mul_overflow(i16_max, 2, &result) &&
+         div_overflow(i16_min, -1, &result) &&
+         mod_overflow(i16_max, 0, &result) &&
+         !add_overflow(i16_max - 1, 1, &result) && result == i16_max;
+}
+static_assert(CheckAll());
+
+constexpr trapping<i32> Compute() {
+  trapping<i32> x = 10;
+  x *= 3;
+  x -= 5;
+  x /= 5;
+  x %= 3;
+  x <<= 2;
+  x |= trapping<i32>(1);
+  ++x;
+  x--;
+  return -abs(x);
+}
+static_assert(Compute() == -9);
+static_assert(Compute() < 0 && Compute() != 0 && Compute() >= -9);
+static_assert(static_cast<i8>(Compute()) == -9);
+
 }  // namespace
 
 int main() {
@@ -1172,6 +1471,8 @@ int main() {
   TestMulOverflow();
   TestDivOverflow();
   TestModOverflow();
+  TestShlOverflow();
+  TestShrOverflow();
 
   TestCast();
 
@@ -1180,6 +1481,7 @@ int main() {
   TestMul();
   TestDiv();
   TestMod();
+  TestShift();
 
   TestConstructorDefault();
   TestConstructorT();
@@ -1211,7 +1513,10 @@ int main() {
   TestOperatorU();
 
   TestMultiOperatorOverflow();
+  TestMixedTypeOperators();
 
   TestOstream();
   TestAbs();
+
+  TestExhaustiveTraps();
 }
@@ -0,0 +1,170 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef WIDE_H_
+#define WIDE_H_
+
+#include <stdint.h>
+
+#include <limits>
+#include <type_traits>
+
+#include "is_integral.h"
+
+namespace internal {
+
+/// The integral type with twice as many bits as `T`, and the same signedness,
+/// or `void` if there is none.
+template <typename T, typename = void>
+struct double_width {
+  using type = void;
+};
+
+template <typename T>
+struct double_width<T, std::enable_if_t<(sizeof(T) <= 4)>> {
+  using type = std::conditional_t<is_signed_v<T>, int64_t, uint64_t>;
+};
+
+#if defined(INTEGERS_HAVE_INT128)
+template <typename T>
+struct double_width<T, std::enable_if_t<(sizeof(T) == 8)>> {
+  using type = std::conditional_t<is_signed_v<T>,
+                                  integers::int128_t,
+                                  integers::uint128_t>;
+};
+#endif
+
+template <typename T>
+using double_width_t = typename double_width<T>::type;
+
+}  // namespace internal
+
+namespace integers {
+
+/// ## Double-Width Arithmetic
+///
+/// ### `wide<T>`
+///
+/// A value with twice as many bits as `T`, as a pair of halves: the value is
+/// `hi` × 2<sup>N</sup> + `lo`, where N is the number of bits in `T`. `hi` has
+/// the signedness of `T`, and `lo` is always unsigned.
+///
+/// `fits` returns true if the value is representable in `T` (i.e. `hi` is
+/// just the sign extension of `lo`), and then `narrow` returns it as a `T`.
+template <typename T>
+struct wide {
+  assert_is_integral(T);
+
+  T hi;
+  internal::make_unsigned_t<T> lo;
+
+  constexpr bool fits() const {
+    if constexpr (internal::is_signed_v<T>) {
+      return hi == (static_cast<T>(lo) < 0 ? T{-1} : T{0});
+    } else {
+      return hi == 0;
+    }
+  }
+
+  constexpr T narrow() const { return static_cast<T>(lo); }
+
+  friend constexpr bool operator==(wide a, wide b) {
+    return a.hi == b.hi && a.lo == b.lo;
+  }
+
+  friend constexpr bool operator!=(wide a, wide b) { return !(a == b); }
+};
+
+/// ### `mul_wide`
+///
+/// Returns the full, double-width product of `x` and `y`, which never
+/// overflows.
+///
+/// For 8- through 32-bit types, and for 64-bit types when `int128_t` is
+/// available, this multiplies in the double-width type, which compilers lower
+/// to a single widening multiply (e.g. x86-64 `mul`/`imul` with a 2-register
+/// result, or AArch64 `mul` and `umulh`/`smulh`). Otherwise (for 128-bit
+/// types, and 64-bit types without `int128_t`), it multiplies the half-width
+/// halves, schoolbook style.
+template <typename T>
+constexpr wide<T> mul_wide(T x, T y) {
+  assert_is_integral(T);
+  using U = internal::make_unsigned_t<T>;
+  using D = internal::double_width_t<T>;
+  constexpr int kBits = std::numeric_limits<U>::digits;
+
+  if constexpr (!std::is_void_v<D>) {
+    const D product = static_cast<D>(static_cast<D>(x) * static_cast<D>(y));
+    return {static_cast<T>(product >> kBits), static_cast<U>(product)};
+  } else {
+    constexpr int kHalf = kBits / 2;
+    constexpr U kMask = static_cast<U>((U{1} << kHalf) - 1);
+    const U ux = static_cast<U>(x);
+    const U uy = static_cast<U>(y);
+    const U x0 = ux & kMask;
+    const U x1 = ux >> kHalf;
+    const U y0 = uy & kMask;
+    const U y1 = uy >> kHalf;
+
+    const U p00 = x0 * y0;
+    const U p01 = x0 * y1;
+    const U p10 = x1 * y0;
+    const U p11 = x1 * y1;
+    // Each term is less than 2^kHalf, so the sum cannot overflow.
+    const U middle = (p00 >> kHalf) + (p01 & kMask) + (p10 & kMask);
+
+    const U lo = static_cast<U>(middle << kHalf) | (p00 & kMask);
+    U hi = p11 + (p01 >> kHalf) + (p10 >> kHalf) + (middle >> kHalf);
+    if constexpr (internal::is_signed_v<T>) {
+      // The unsigned product of the 2’s complement bit patterns is too big
+      // by 2^kBits × (y if x < 0, plus x if y < 0).
+      if (x < 0) {
+        hi -= uy;
+      }
+      if (y < 0) {
+        hi -= ux;
+      }
+    }
+    return {static_cast<T>(hi), lo};
+  }
+}
+
+/// ### `add_wide`
+///
+/// Returns the full, double-width sum of `x` and `y`, which never overflows:
+/// `lo` is the wrapped sum, and `hi` is the carry (0 or 1) for unsigned types,
+/// or the sign extension (-1 or 0) for signed types.
+template <typename T>
+constexpr wide<T> add_wide(T x, T y) {
+  assert_is_integral(T);
+  using U = internal::make_unsigned_t<T>;
+  const U ux = static_cast<U>(x);
+  const U uy = static_cast<U>(y);
+  const U lo = static_cast<U>(ux + uy);
+  U hi = lo < ux ? U{1} : U{0};
+  if constexpr (internal::is_signed_v<T>) {
+    // Sign-extend each operand into the high half.
+    if (x < 0) {
+      hi = static_cast<U>(hi - 1U);
+    }
+    if (y < 0) {
+      hi = static_cast<U>(hi - 1U);
+    }
+  }
+  return {static_cast<T>(hi), lo};
+}
+
+}  // namespace integers
+
+#endif  // WIDE_H_
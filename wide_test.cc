@@ -0,0 +1,249 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <limits>
+
+#include "checked.h"
+#include "clamping.h"
+#include "test_support.h"
+#include "trapping.h"
+#include "wide.h"
+#include "wrapping.h"
+
+using namespace integers;
+using namespace std;
+
+namespace {
+
+using i8 = int8_t;
+using u8 = uint8_t;
+using i16 = int16_t;
+using u16 = uint16_t;
+using i32 = int32_t;
+using u32 = uint32_t;
+using i64 = int64_t;
+using u64 = uint64_t;
+
+// Returns the value of `w` as an `i64`. Only for types of up to 16 bits.
+template <typename T>
+i64 Join(wide<T> w) {
+  return i64{w.hi} * (i64{1} << numeric_limits<decltype(w.lo)>::digits) +
+         i64{w.lo};
+}
+
+template <typename T>
+void GenericTestWideExhaustive() {
+  for (int x = numeric_limits<T>::min(); x <= numeric_limits<T>::max(); ++x) {
+    for (int y = numeric_limits<T>::min(); y <= numeric_limits<T>::max();
+         ++y) {
+      const T tx = static_cast<T>(x);
+      const T ty = static_cast<T>(y);
+      EXPECT(Join(mul_wide(tx, ty)) == i64{x} * y);
+      EXPECT(Join(add_wide(tx, ty)) == i64{x} + y);
+      EXPECT(mul_wide(tx, ty).fits() == in_range<T>(x * y));
+      EXPECT(add_wide(tx, ty).fits() == in_range<T>(x + y));
+    }
+  }
+}
+
+void TestWideExhaustive() {
+  GenericTestWideExhaustive<i8>();
+  GenericTestWideExhaustive<u8>();
+}
+
+void TestWide32() {
+  const i64 values[] = {0,          1,          -1,         2,
+                        -2,         0x7fff,     0x10000,    -0x10000,
+                        0x7fffffff, -0x7fffffff - 1, 0x12345678, -0x12345678};
+  for (i64 x : values) {
+    for (i64 y : values) {
+      const wide<i32> p = mul_wide(static_cast<i32>(x), static_cast<i32>(y));
+      EXPECT((i64{p.hi} * (i64{1} << 32) + i64{p.lo}) == x * y);
+      const wide<u32> q = mul_wide(static_cast<u32>(x), static_cast<u32>(y));
+      EXPECT((u64{q.hi} << 32 | q.lo) ==
+             u64{static_cast<u32>(x)} * static_cast<u32>(y));
+      const wide<i32> s = add_wide(static_cast<i32>(x), static_cast<i32>(y));
+      EXPECT((i64{s.hi} * (i64{1} << 32) + i64{s.lo}) == x + y);
+    }
+  }
+}
+
+void TestWide64() {
+  constexpr u64 u64_max = numeric_limits<u64>::max();
+  constexpr i64 i64_max = numeric_limits<i64>::max();
+  constexpr i64 i64_min = numeric_limits<i64>::min();
+  static_assert(mul_wide<u64>(u64_max, u64_max) == wide<u64>{u64_max - 1, 1});
+  static_assert(mul_wide<u64>(u64_max, 2) == wide<u64>{1, u64_max - 1});
+  static_assert(mul_wide<u64>(1ULL << 32, 1ULL << 32) == wide<u64>{1, 0});
+  static_assert(mul_wide<i64>(i64_min, i64_min) == wide<i64>{1LL << 62, 0});
+  static_assert(mul_wide<i64>(i64_min, i64_max) ==
+                wide<i64>{-(1LL << 62), 1ULL << 63});
+  static_assert(mul_wide<i64>(-1, 1) == wide<i64>{-1, u64_max});
+  static_assert(mul_wide<i64>(-1, -1) == wide<i64>{0, 1});
+  static_assert(mul_wide<i64>(i64_max, 1).fits());
+  static_assert(!mul_wide<i64>(i64_max, 2).fits());
+  static_assert(mul_wide<i64>(i64_min, 1).fits());
+  static_assert(mul_wide<i64>(i64_min, 1).narrow() == i64_min);
+  static_assert(!mul_wide<i64>(i64_min, -1).fits());
+  static_assert(add_wide<u64>(u64_max, u64_max) == wide<u64>{1, u64_max - 1});
+  static_assert(add_wide<i64>(i64_min, i64_min) == wide<i64>{-1, 0});
+  static_assert(add_wide<i64>(i64_max, i64_max) ==
+                wide<i64>{0, u64_max - 1});
+  static_assert(add_wide<i64>(-1, 1) == wide<i64>{0, 0});
+  static_assert(add_wide<i64>(-1, -1) == wide<i64>{-1, u64_max - 1});
+
+  // The `fits` check agrees with `__builtin_mul_overflow`.
+  const i64 values[] = {0,         1,          -1,           3,       -3,
+                        1LL << 31, 1LL << 32,  -(1LL << 32), i64_max, i64_min,
+                        i64_max / 3, 0x123456789LL};
+  for (i64 x : values) {
+    for (i64 y : values) {
+      i64 product;
+      const bool overflowed = __builtin_mul_overflow(x, y, &product);
+      const wide<i64> w = mul_wide(x, y);
+      EXPECT(w.fits() == !overflowed);
+      EXPECT(w.narrow() == static_cast<i64>(static_cast<u64>(x) *
+                                            static_cast<u64>(y)));
+    }
+  }
+}
+
+#if defined(INTEGERS_HAVE_INT128)
+using i128 = int128_t;
+using u128 = uint128_t;
+
+constexpr u128 u128_max = numeric_limits<u128>::max();
+constexpr i128 i128_max = numeric_limits<i128>::max();
+constexpr i128 i128_min = numeric_limits<i128>::min();
+
+void TestTraits() {
+  static_assert(numeric_limits<u128>::digits == 128);
+  static_assert(internal::is_integral_v<i128>);
+  static_assert(internal::is_signed_v<i128>);
+  static_assert(internal::is_unsigned_v<u128>);
+  static_assert(is_same_v<internal::make_unsigned_t<i128>, u128>);
+  static_assert(is_same_v<internal::make_signed_t<u128>, i128>);
+  static_assert(internal::in_range<i128>(numeric_limits<u64>::max()));
+  static_assert(!internal::in_range<i64>(i128{1} << 64));
+  static_assert(!internal::in_range<u128>(i128{-1}));
+  static_assert(!internal::in_range<i128>(u128_max));
+  static_assert(internal::in_range<u128>(i128_max));
+}
+
+void TestWide128() {
+  // The schoolbook path, checked against products that fit in 128 bits.
+  static_assert(mul_wide<u128>(u128_max, u128_max) ==
+                wide<u128>{u128_max - 1, 1});
+  static_assert(mul_wide<u128>(u128{1} << 64, u128{1} << 64) ==
+                wide<u128>{1, 0});
+  static_assert(mul_wide<i128>(i128_min, i128_min) ==
+                wide<i128>{i128{1} << 126, 0});
+  static_assert(mul_wide<i128>(-1, 1) == wide<i128>{-1, u128_max});
+  static_assert(mul_wide<i128>(-1, -1) == wide<i128>{0, 1});
+  static_assert(mul_wide<i128>(i128_max, -1).fits());
+  static_assert(!mul_wide<i128>(i128_min, -1).fits());
+  static_assert(add_wide<u128>(u128_max, 1) == wide<u128>{1, 0});
+  static_assert(add_wide<i128>(i128_min, -1) == wide<i128>{-1, u128_max / 2});
+
+  const i64 values[] = {0, 1, -1, 7, -7, 1LL << 40, -(1LL << 40),
+                        0x123456789abcdefLL, numeric_limits<i64>::max(),
+                        numeric_limits<i64>::min()};
+  for (i64 x : values) {
+    for (i64 y : values) {
+      const wide<i128> w = mul_wide(i128{x}, i128{y});
+      EXPECT(w.fits());
+      EXPECT(w.narrow() == i128{x} * i128{y});
+      const wide<i128> shifted = mul_wide(i128{x} * (i128{1} << 64), i128{y});
+      EXPECT(shifted == mul_wide(i128{x}, i128{y} * (i128{1} << 64)));
+    }
+  }
+}
+
+void TestTrapping128() {
+  trapping<i128> x = i128{1} << 100;
+  x *= 4;
+  EXPECT(x == i128{1} << 102);
+  EXPECT_DEATH(x *= (1 << 30));
+  trapping<i128> y = i128_max;
+  EXPECT_DEATH(y += 1);
+  y -= i128_max;
+  EXPECT(y == 0);
+  EXPECT_DEATH(y /= 0);
+  EXPECT_DEATH((void)trapping_cast<i64>(i128{1} << 64));
+  EXPECT(trapping_cast<i64>(-(i128{1} << 63)) == numeric_limits<i64>::min());
+  EXPECT(trapping_shl<u128>(u128{1}, 127) == u128{1} << 127);
+  EXPECT_DEATH((void)trapping_shl<i128>(i128{1}, 127));
+  EXPECT(trapping_mul<i128>(numeric_limits<i64>::max(),
+                            numeric_limits<i64>::max()) ==
+         i128{numeric_limits<i64>::max()} * numeric_limits<i64>::max());
+
+  // A 128-bit accumulator for 64-bit products.
+  trapping<u128> sum = u128{0};
+  for (int i = 0; i < 4; ++i) {
+    sum += trapping_mul<u128>(numeric_limits<u64>::max(), u64{1} << 61);
+  }
+  EXPECT(sum == u128{numeric_limits<u64>::max()} << 63);
+  EXPECT_DEATH(sum += trapping_mul<u128>(numeric_limits<u64>::max(),
+                                         numeric_limits<u64>::max()));
+}
+
+void TestWrapping128() {
+  wrapping<u128> x = u128_max;
+  x += 2;
+  EXPECT(x == 1);
+  wrapping<i128> y = i128_min;
+  y -= 1;
+  EXPECT(y == i128_max);
+  EXPECT(wrapping_mul<i128>(i128_max, 2) == -2);
+}
+
+void TestClamping128() {
+  clamping<u128> x = u128{3};
+  x -= 5;
+  EXPECT(x == 0);
+  clamping<i128> y = i128_max;
+  y += 1;
+  EXPECT(y == i128_max);
+  y = i128_min;
+  y *= 2;
+  EXPECT(y == i128_min);
+  EXPECT(clamping_cast<i64>(i128{1} << 80) == numeric_limits<i64>::max());
+}
+
+void TestChecked128() {
+  EXPECT(checked_mul<i128>(i128{1} << 63, i128{1} << 63).value ==
+         i128{1} << 126);
+  EXPECT(checked_mul<i128>(i128{1} << 63, i128{1} << 64).overflowed);
+  checked<u128> total = u128_max / 2;
+  total *= 3;
+  EXPECT(total.overflowed());
+}
+#endif
+
+}  // namespace
+
+int main() {
+  TestWideExhaustive();
+  TestWide32();
+  TestWide64();
+#if defined(INTEGERS_HAVE_INT128)
+  TestTraits();
+  TestWide128();
+  TestTrapping128();
+  TestWrapping128();
+  TestClamping128();
+  TestChecked128();
+#endif
+}
@@ -15,77 +15,165 @@
 #ifndef WRAPPING_H_
 #define WRAPPING_H_
 
+#include <limits.h>
 #include <stdint.h>
 #include <stdlib.h>
 
-#include <algorithm>
 #include <limits>
 #include <type_traits>
 
+#include "in_range.h"
 #include "is_integral.h"
+#include "trap.h"
+
+namespace internal {
+
+/// The unsigned type in which wrapping arithmetic producing an `R` is done:
+/// `R`’s unsigned counterpart, or `unsigned int` if that is narrower. (Integer
+/// promotion would otherwise turn e.g. `uint16_t * uint16_t` back into signed
+/// `int` arithmetic, which can overflow.)
+template <typename R>
+using wrapping_t =
+    std::common_type_t<internal::make_unsigned_t<R>, unsigned int>;
+
+/// Reduces `value` modulo 2ⁿ, where n is the number of bits in `R`, and
+/// returns it as an `R`.
+template <typename R, typename T>
+constexpr R wrap_to(T value) {
+  return static_cast<R>(static_cast<internal::make_unsigned_t<R>>(value));
+}
+
+}  // namespace internal
 
 namespace integers {
 
 /// ## Wrapping Operations
 ///
+/// These functions compute the result in the unsigned counterpart of `R`,
+/// where the C++ standard defines arithmetic to be modulo 2ⁿ, and convert it
+/// back to `R`. They compile to exactly the same instructions as the built-in
+/// operators on unsigned types, with no branches (so loops using them
+/// vectorize as well as plain unsigned loops do). All are `constexpr`.
+///
+/// ### `wrapping_cast`
+///
+/// Converts `T`s to `R`s, keeping only the low bits of `value` that fit in
+/// `R`.
+template <typename R, typename T>
+constexpr R wrapping_cast(T value) {
+  assert_is_integral(R);
+  assert_is_integral(T);
+  return internal::wrap_to<R>(value);
+}
+
 /// ### `wrapping_add`
 ///
 /// Adds `x` and `y` and returns the result. If the operation overflows, or
 /// cannot fit into type `R`, this function will wrap.
-template <typename T, typename U, typename R>
-R wrapping_add(const T& x, const U& y) {
-  // TODO
-  (void)x;
-  (void)y;
-  return 0;
+template <typename R, typename T, typename U>
+constexpr R wrapping_add(T x, U y) {
+  assert_is_integral(R);
+  assert_is_integral(T);
+  assert_is_integral(U);
+  using W = internal::wrapping_t<R>;
+  return internal::wrap_to<R>(static_cast<W>(static_cast<W>(x) +
+                                             static_cast<W>(y)));
 }
 
 /// ### `wrapping_mul`
 ///
 /// Multiplies `x` and `y` and returns the result. If the operation overflows,
 /// or cannot fit into type `R`, this function will wrap.
-template <typename T, typename U, typename R>
-R wrapping_mul(const T& x, const U& y) {
-  // TODO
-  (void)x;
-  (void)y;
-  return 0;
+template <typename R, typename T, typename U>
+constexpr R wrapping_mul(T x, U y) {
+  assert_is_integral(R);
+  assert_is_integral(T);
+  assert_is_integral(U);
+  using W = internal::wrapping_t<R>;
+  return internal::wrap_to<R>(static_cast<W>(static_cast<W>(x) *
+                                             static_cast<W>(y)));
 }
 
 /// ### `wrapping_sub`
 ///
 /// Subtracts `y` from `x` and returns the result. If the operation overflows,
 /// or cannot fit into type `R`, this function will wrap.
-template <typename T, typename U, typename R>
-R wrapping_sub(const T& x, const U& y) {
-  // TODO
-  (void)x;
-  (void)y;
-  return 0;
+template <typename R, typename T, typename U>
+constexpr R wrapping_sub(T x, U y) {
+  assert_is_integral(R);
+  assert_is_integral(T);
+  assert_is_integral(U);
+  using W = internal::wrapping_t<R>;
+  return internal::wrap_to<R>(static_cast<W>(static_cast<W>(x) -
+                                             static_cast<W>(y)));
 }
 
 /// ### `wrapping_div`
 ///
 /// Divides `dividend` by `divisor` and returns the quotient. If the operation
-/// overflows, or cannot fit into type `R`, this function will wrap.
-template <typename T, typename U, typename R>
-R wrapping_div(const T& dividend, const U& divisor) {
-  // TODO
-  (void)dividend;
-  (void)divisor;
-  return 0;
+/// overflows, or cannot fit into type `R`, this function will wrap. The
+/// quotient is the mathematical one, rounded toward 0, even when the usual
+/// arithmetic conversions would make a negative operand unsigned (so
+/// `wrapping_div<int>(-7, 2U)` is -3, not 2147483644, as with `trapping_div`).
+/// The minimum value divided by -1 wraps back to itself instead of being UB.
+///
+/// There is no sensible wrapped value for division by 0, so if `divisor` is 0,
+/// this function will `trap`.
+template <typename R, typename T, typename U>
+constexpr R wrapping_div(T dividend, U divisor) {
+  assert_is_integral(R);
+  assert_is_integral(T);
+  assert_is_integral(U);
+  if (divisor == 0) {
+    trap();
+  }
+  using C = decltype(dividend / divisor);
+  if constexpr (internal::kDivisionConvertsSign<T, U>) {
+    const C quotient = internal::unsigned_abs<C>(dividend) /
+                       internal::unsigned_abs<C>(divisor);
+    return internal::is_negative(dividend) != internal::is_negative(divisor)
+               ? wrapping_sub<R>(C{0}, quotient)
+               : internal::wrap_to<R>(quotient);
+  } else {
+    if constexpr (internal::is_signed_v<C>) {
+      if (static_cast<C>(divisor) == C{-1}) {
+        return wrapping_sub<R>(C{0}, static_cast<C>(dividend));
+      }
+    }
+    return internal::wrap_to<R>(dividend / divisor);
+  }
 }
 
 /// ### `wrapping_mod`
 ///
-/// Divides `dividend` by `divisor` and returns the remainder. If the operation
-/// overflows, or cannot fit into type `R`, this function will wrap.
-template <typename T, typename U, typename R>
-R wrapping_mod(const T& dividend, const U& divisor) {
-  // TODO
-  (void)dividend;
-  (void)divisor;
-  return 0;
+/// Divides `dividend` by `divisor` and returns the remainder, which has the
+/// sign of `dividend` (even for mixed-sign operands, as with `wrapping_div`).
+/// If the remainder cannot fit into type `R`, this function will wrap. (The
+/// minimum value modulo -1 is 0, instead of being UB.)
+///
+/// If `divisor` is 0, this function will `trap`.
+template <typename R, typename T, typename U>
+constexpr R wrapping_mod(T dividend, U divisor) {
+  assert_is_integral(R);
+  assert_is_integral(T);
+  assert_is_integral(U);
+  if (divisor == 0) {
+    trap();
+  }
+  using C = decltype(dividend % divisor);
+  if constexpr (internal::kDivisionConvertsSign<T, U>) {
+    const C remainder = internal::unsigned_abs<C>(dividend) %
+                        internal::unsigned_abs<C>(divisor);
+    return internal::is_negative(dividend) ? wrapping_sub<R>(C{0}, remainder)
+                                           : internal::wrap_to<R>(remainder);
+  } else {
+    if constexpr (internal::is_signed_v<C>) {
+      if (static_cast<C>(divisor) == C{-1}) {
+        return 0;
+      }
+    }
+    return internal::wrap_to<R>(dividend % divisor);
+  }
 }
 
 /// ## `wrapping<T>`
@@ -100,6 +188,20 @@ R wrapping_mod(const T& dividend, const U& divisor) {
 /// the guarantee that integers are represented using 2’s complement (6.8.1
 /// again), that suggests wrapping on overflow. Our tests assert this.
 ///
+/// `wrapping<T>` has the same operators as `trapping<T>`, so you can switch
+/// between the policies without changing call sites. The differences are:
+///
+/// * Arithmetic and conversions wrap (modulo 2ⁿ) instead of `trap`ping.
+/// * Shift amounts are taken modulo the number of bits in `T`, as in Rust’s
+///   `wrapping_shl` (and as x86 and ARM shift instructions do).
+/// * Division or modulo by 0 still `trap`s, since there is no sensible result.
+/// * Comparisons with other integer types compare the mathematical values
+///   (so `wrapping<uint8_t>(255) < 256`), rather than `trap`ping when the
+///   other value is out of `T`’s range.
+///
+/// All operations are `constexpr`. To format values, see format.h (`to_chars`
+/// and `std::format`) and ostream.h.
+///
 /// For guaranteed trapping behavior, see the companion template class
 /// `trapping<T>`.
 ///
@@ -111,11 +213,602 @@ class wrapping {
 
   using Self = wrapping<T>;
 
+  static constexpr unsigned kShiftMask = CHAR_BIT * sizeof(T) - 1U;
+
  public:
+  /// ### `wrapping`
+  ///
+  /// The default constructor. The contents of the object are undefined. 😕
+  /// Best practice is to use `-ftrivial-auto-var-init=zero` or to
+  /// explicitly initialize the object.
+  wrapping() = default;
+
+  /// ### `wrapping`
+  ///
+  /// Constructs and initializes.
+  template <typename U, std::enable_if_t<std::is_same_v<T, U>, int> = 0>
+  constexpr wrapping(U value) : value_(value) {}
+
+  /// ### `wrapping`
+  ///
+  /// Constructs and initializes, keeping only the low bits of `value` that fit
+  /// in `T`.
+  template <typename U, std::enable_if_t<!std::is_same_v<T, U>, int> = 0>
+  constexpr explicit wrapping(U value) : value_(wrapping_cast<T>(value)) {}
+
+  /// ### `operator+=`
+  ///
+  /// Increments by `x`, wrapping on overflow.
+  constexpr Self& operator+=(T x) {
+    value_ = wrapping_add<T>(value_, x);
+    return *this;
+  }
+
+  /// ### `operator+`
+  ///
+  /// Adds `rhs` to `lhs`, assigns the result to `lhs`, and returns it. Wraps
+  /// on overflow.
+  friend constexpr Self operator+(Self lhs, Self rhs) {
+    lhs += rhs;
+    return lhs;
+  }
+
+  /// ### `operator+`
+  ///
+  /// Adds `rhs` to `lhs`, assigns the result to `lhs`, and returns it. Wraps
+  /// on overflow.
+  template <typename U>
+  friend constexpr Self operator+(Self lhs, U rhs) {
+    lhs.value_ = wrapping_add<T>(lhs.value_, rhs);
+    return lhs;
+  }
+
+  /// ### `operator+`
+  ///
+  /// Adds `rhs` to `lhs` and returns the result. Wraps on overflow.
+  template <typename U>
+  friend constexpr Self operator+(U lhs, Self rhs) {
+    rhs.value_ = wrapping_add<T>(lhs, rhs.value_);
+    return rhs;
+  }
+
+  /// ### `operator+`
+  ///
+  /// Does nothing. (But it’s explicit about it!)
+  constexpr Self& operator+() { return *this; }
+
+  /// ### `operator-=`
+  ///
+  /// Subtracts `x`, wrapping on overflow.
+  constexpr Self& operator-=(T x) {
+    value_ = wrapping_sub<T>(value_, x);
+    return *this;
+  }
+
+  /// ### `operator-`
+  ///
+  /// Subtracts `rhs` from `lhs`, assigns the result to `lhs`, and returns
+  /// it. Wraps on overflow.
+  friend constexpr Self operator-(Self lhs, Self rhs) {
+    lhs -= rhs;
+    return lhs;
+  }
+
+  /// ### `operator-`
+  ///
+  /// Subtracts `rhs` from `lhs`, assigns the result to `lhs`, and returns
+  /// it. Wraps on overflow.
+  template <typename U>
+  friend constexpr Self operator-(Self lhs, U rhs) {
+    lhs.value_ = wrapping_sub<T>(lhs.value_, rhs);
+    return lhs;
+  }
+
+  /// ### `operator-`
+  ///
+  /// Subtracts `rhs` from `lhs` and returns the result. Wraps on overflow.
+  template <typename U>
+  friend constexpr Self operator-(U lhs, Self rhs) {
+    rhs.value_ = wrapping_sub<T>(lhs, rhs.value_);
+    return rhs;
+  }
+
+  /// ### `operator-`
+  ///
+  /// Returns the value with its sign reversed, i.e. 0 minus the value modulo
+  /// 2ⁿ. The minimum value of a signed `T` wraps back to itself. Unlike
+  /// `trapping<T>`, this is also defined for unsigned `T`s.
+  constexpr Self operator-() const {
+    return Self{wrapping_sub<T>(T{0}, value_)};
+  }
+
+  /// ### `operator*=`
+  ///
+  /// Multiplies by `x`, wrapping on overflow.
+  constexpr Self& operator*=(T x) {
+    value_ = wrapping_mul<T>(value_, x);
+    return *this;
+  }
+
+  /// ### `operator*`
+  ///
+  /// Multiplies `lhs` by `rhs`, assigns the result to `lhs`, and returns
+  /// it. Wraps on overflow.
+  friend constexpr Self operator*(Self lhs, Self rhs) {
+    lhs *= rhs;
+    return lhs;
+  }
+
+  /// ### `operator*`
+  ///
+  /// Multiplies `lhs` by `rhs`, assigns the result to `lhs`, and returns
+  /// it. Wraps on overflow.
+  template <typename U>
+  friend constexpr Self operator*(Self lhs, U rhs) {
+    lhs.value_ = wrapping_mul<T>(lhs.value_, rhs);
+    return lhs;
+  }
+
+  /// ### `operator*`
+  ///
+  /// Multiplies `lhs` by `rhs` and returns the result. Wraps on overflow.
+  template <typename U>
+  friend constexpr Self operator*(U lhs, Self rhs) {
+    rhs.value_ = wrapping_mul<T>(lhs, rhs.value_);
+    return rhs;
+  }
+
+  /// ### `operator/=`
+  ///
+  /// Divides by `divisor`, storing the quotient in `*this`. Wraps on overflow,
+  /// and `trap`s if `divisor` is 0.
+  constexpr Self& operator/=(T divisor) {
+    value_ = wrapping_div<T>(value_, divisor);
+    return *this;
+  }
+
+  /// ### `operator/`
+  ///
+  /// Divides `dividend` by `divisor`, storing the quotient in `dividend`, and
+  /// returns `dividend`. Wraps on overflow, and `trap`s if `divisor` is 0.
+  friend constexpr Self operator/(Self dividend, Self divisor) {
+    dividend /= divisor;
+    return dividend;
+  }
+
+  /// ### `operator/`
+  ///
+  /// Divides `dividend` by `divisor`, storing the quotient in `dividend`, and
+  /// returns `dividend`. Wraps on overflow, and `trap`s if `divisor` is 0.
+  template <typename U>
+  friend constexpr Self operator/(Self dividend, U divisor) {
+    dividend.value_ = wrapping_div<T>(dividend.value_, divisor);
+    return dividend;
+  }
+
+  /// ### `operator/`
+  ///
+  /// Divides `dividend` by `divisor` and returns the quotient. Wraps on
+  /// overflow, and `trap`s if `divisor` is 0.
+  template <typename U>
+  friend constexpr Self operator/(U dividend, Self divisor) {
+    divisor.value_ = wrapping_div<T>(dividend, divisor.value_);
+    return divisor;
+  }
+
+  /// ### `operator%=`
+  ///
+  /// Divides by `divisor`, storing the remainder in `*this`. Wraps on
+  /// overflow, and `trap`s if `divisor` is 0.
+  constexpr Self& operator%=(T divisor) {
+    value_ = wrapping_mod<T>(value_, divisor);
+    return *this;
+  }
+
+  /// ### `operator%`
+  ///
+  /// Divides `dividend` by `divisor`, storing the remainder in `dividend`, and
+  /// returns `dividend`. Wraps on overflow, and `trap`s if `divisor` is 0.
+  friend constexpr Self operator%(Self dividend, Self divisor) {
+    dividend %= divisor;
+    return dividend;
+  }
+
+  /// ### `operator%`
+  ///
+  /// Divides `dividend` by `divisor`, storing the remainder in `dividend`, and
+  /// returns `dividend`. Wraps on overflow, and `trap`s if `divisor` is 0.
+  template <typename U>
+  friend constexpr Self operator%(Self dividend, U divisor) {
+    dividend.value_ = wrapping_mod<T>(dividend.value_, divisor);
+    return dividend;
+  }
+
+  /// ### `operator%`
+  ///
+  /// Divides `dividend` by `divisor` and returns the remainder. Wraps on
+  /// overflow, and `trap`s if `divisor` is 0.
+  template <typename U>
+  friend constexpr Self operator%(U dividend, Self divisor) {
+    divisor.value_ = wrapping_mod<T>(dividend, divisor.value_);
+    return divisor;
+  }
+
+  /// ### `operator|=`
+  ///
+  /// Takes the bitwise `|` of the value and `x`, and assigns it to `value_`.
+  /// Returns `*this`.
+  constexpr Self& operator|=(Self x) {
+    value_ |= x.value_;
+    return *this;
+  }
+
+  /// ### `operator|`
+  ///
+  /// Takes the bitwise `|` of `lhs` and `rhs`, assigns it to `lhs`, and returns
+  /// it.
+  friend constexpr Self operator|(Self lhs, Self rhs) {
+    lhs |= rhs;
+    return lhs;
+  }
+
+  /// ### `operator|`
+  ///
+  /// Takes the bitwise `|` of `lhs` and `rhs`, assigns it to `lhs`, and returns
+  /// it. `rhs` is first converted to `T` with `wrapping_cast`.
+  template <typename U>
+  friend constexpr Self operator|(Self lhs, U rhs) {
+    lhs |= Self{rhs};
+    return lhs;
+  }
+
+  /// ### `operator|`
+  ///
+  /// Takes the bitwise `|` of `lhs` and `rhs`, and returns it. `lhs` is first
+  /// converted to `T` with `wrapping_cast`.
+  template <typename U>
+  friend constexpr Self operator|(U lhs, Self rhs) {
+    rhs |= Self{lhs};
+    return rhs;
+  }
+
+  /// ### `operator&=`
+  ///
+  /// Takes the bitwise `&` of the value and `x`, and assigns it to `value_`.
+  /// Returns `*this`.
+  constexpr Self& operator&=(Self x) {
+    value_ &= x.value_;
+    return *this;
+  }
+
+  /// ### `operator&`
+  ///
+  /// Takes the bitwise `&` of `lhs` and `rhs`, assigns it to `lhs`, and returns
+  /// it.
+  friend constexpr Self operator&(Self lhs, Self rhs) {
+    lhs &= rhs;
+    return lhs;
+  }
+
+  /// ### `operator&`
+  ///
+  /// Takes the bitwise `&` of `lhs` and `rhs`, assigns it to `lhs`, and returns
+  /// it. `rhs` is first converted to `T` with `wrapping_cast`.
+  template <typename U>
+  friend constexpr Self operator&(Self lhs, U rhs) {
+    lhs &= Self{rhs};
+    return lhs;
+  }
+
+  /// ### `operator&`
+  ///
+  /// Takes the bitwise `&` of `lhs` and `rhs`, and returns it. `lhs` is first
+  /// converted to `T` with `wrapping_cast`.
+  template <typename U>
+  friend constexpr Self operator&(U lhs, Self rhs) {
+    rhs &= Self{lhs};
+    return rhs;
+  }
+
+  /// ### `operator^=`
+  ///
+  /// Takes the bitwise `^` of the value and `x`, and assigns it to `value_`.
+  /// Returns `*this`.
+  constexpr Self& operator^=(Self x) {
+    value_ ^= x.value_;
+    return *this;
+  }
+
+  /// ### `operator^`
+  ///
+  /// Takes the bitwise `^` of `lhs` and `rhs`, assigns it to `lhs`, and returns
+  /// it.
+  friend constexpr Self operator^(Self lhs, Self rhs) {
+    lhs ^= rhs;
+    return lhs;
+  }
+
+  /// ### `operator^`
+  ///
+  /// Takes the bitwise `^` of `lhs` and `rhs`, assigns it to `lhs`, and returns
+  /// it. `rhs` is first converted to `T` with `wrapping_cast`.
+  template <typename U>
+  friend constexpr Self operator^(Self lhs, U rhs) {
+    lhs ^= Self{rhs};
+    return lhs;
+  }
+
+  /// ### `operator^`
+  ///
+  /// Takes the bitwise `^` of `lhs` and `rhs`, and returns it. `lhs` is first
+  /// converted to `T` with `wrapping_cast`.
+  template <typename U>
+  friend constexpr Self operator^(U lhs, Self rhs) {
+    rhs ^= Self{lhs};
+    return rhs;
+  }
+
+  /// ### `operator~`
+  ///
+  /// Returns the bitwise complement of the value.
+  constexpr Self operator~() const { return Self{wrapping_cast<T>(~value_)}; }
+
+  /// ### `operator>>=`
+  ///
+  /// Shifts the value right by `x` bits, modulo the number of bits in `T`, and
+  /// assigns the result to `value_`. Returns `*this`. Signed values shift in
+  /// copies of the sign bit.
+  template <typename U>
+  constexpr Self& operator>>=(U x) {
+    assert_is_integral(U);
+    value_ = static_cast<T>(value_ >> (static_cast<unsigned>(x) & kShiftMask));
+    return *this;
+  }
+
+  /// ### `operator>>=`
+  ///
+  /// Shifts the value right by `x` bits, modulo the number of bits in `T`, and
+  /// assigns the result to `value_`. Returns `*this`.
+  constexpr Self& operator>>=(Self x) { return *this >>= x.value_; }
+
+  /// ### `operator>>`
+  ///
+  /// Shifts `lhs` right by `rhs` bits, modulo the number of bits in `T`,
+  /// assigns the result to `lhs`, and returns it.
+  template <typename U>
+  friend constexpr Self operator>>(Self lhs, U rhs) {
+    lhs >>= rhs;
+    return lhs;
+  }
+
+  /// ### `operator<<=`
+  ///
+  /// Shifts the value left by `x` bits, modulo the number of bits in `T`, and
+  /// assigns the result to `value_`. Returns `*this`. Bits shifted out of the
+  /// left side (including into and out of the sign bit) are discarded.
+  template <typename U>
+  constexpr Self& operator<<=(U x) {
+    assert_is_integral(U);
+    using W = internal::wrapping_t<T>;
+    value_ = internal::wrap_to<T>(static_cast<W>(
+        static_cast<W>(value_) << (static_cast<unsigned>(x) & kShiftMask)));
+    return *this;
+  }
+
+  /// ### `operator<<=`
+  ///
+  /// Shifts the value left by `x` bits, modulo the number of bits in `T`, and
+  /// assigns the result to `value_`. Returns `*this`.
+  constexpr Self& operator<<=(Self x) { return *this <<= x.value_; }
+
+  /// ### `operator<<`
+  ///
+  /// Shifts `lhs` left by `rhs` bits, modulo the number of bits in `T`,
+  /// assigns the result to `lhs`, and returns it.
+  template <typename U>
+  friend constexpr Self operator<<(Self lhs, U rhs) {
+    lhs <<= rhs;
+    return lhs;
+  }
+
+  /// ### `operator<`
+  ///
+  /// Returns true if `lhs` is less than `rhs`.
+  friend constexpr bool operator<(Self lhs, Self rhs) {
+    return lhs.value_ < rhs.value_;
+  }
+
+  /// ### `operator<`
+  ///
+  /// Returns true if `lhs` is mathematically less than `rhs`. (Like
+  /// `operator==`, this never converts either operand.)
+  template <typename U>
+  friend constexpr bool operator<(Self lhs, U rhs) {
+    return internal::less(lhs.value_, rhs);
+  }
+
+  /// ### `operator<`
+  ///
+  /// Returns true if `lhs` is mathematically less than `rhs`.
+  template <typename U>
+  friend constexpr bool operator<(U lhs, Self rhs) {
+    return internal::less(lhs, rhs.value_);
+  }
+
+  /// ### `operator>`
+  ///
+  /// Returns true if `lhs` is greater than `rhs`.
+  friend constexpr bool operator>(Self lhs, Self rhs) { return rhs < lhs; }
+
+  /// ### `operator>`
+  ///
+  /// Returns true if `lhs` is mathematically greater than `rhs`.
+  template <typename U>
+  friend constexpr bool operator>(Self lhs, U rhs) {
+    return rhs < lhs;
+  }
+
+  /// ### `operator>`
+  ///
+  /// Returns true if `lhs` is mathematically greater than `rhs`.
+  template <typename U>
+  friend constexpr bool operator>(U lhs, Self rhs) {
+    return rhs < lhs;
+  }
+
+  /// ### `operator<=`
+  ///
+  /// Returns true if `lhs` is less than or equal to `rhs`.
+  friend constexpr bool operator<=(Self lhs, Self rhs) { return !(lhs > rhs); }
+
+  /// ### `operator<=`
+  ///
+  /// Returns true if `lhs` is mathematically less than or equal to `rhs`.
+  template <typename U>
+  friend constexpr bool operator<=(Self lhs, U rhs) {
+    return !(lhs > rhs);
+  }
+
+  /// ### `operator<=`
+  ///
+  /// Returns true if `lhs` is mathematically less than or equal to `rhs`.
+  template <typename U>
+  friend constexpr bool operator<=(U lhs, Self rhs) {
+    return !(lhs > rhs);
+  }
+
+  /// ### `operator>=`
+  ///
+  /// Returns true if `lhs` is greater than or equal to `rhs`.
+  friend constexpr bool operator>=(Self lhs, Self rhs) { return !(rhs > lhs); }
+
+  /// ### `operator>=`
+  ///
+  /// Returns true if `lhs` is mathematically greater than or equal to `rhs`.
+  template <typename U>
+  friend constexpr bool operator>=(Self lhs, U rhs) {
+    return !(rhs > lhs);
+  }
+
+  /// ### `operator>=`
+  ///
+  /// Returns true if `lhs` is mathematically greater than or equal to `rhs`.
+  template <typename U>
+  friend constexpr bool operator>=(U lhs, Self rhs) {
+    return !(rhs > lhs);
+  }
+
+  /// ### `operator==`
+  ///
+  /// Returns true if `lhs` is equal to `rhs`.
+  friend constexpr bool operator==(Self lhs, Self rhs) {
+    return lhs.value_ == rhs.value_;
+  }
+
+  /// ### `operator==`
+  ///
+  /// Returns true if `lhs` is mathematically equal to `rhs`. (E.g. a
+  /// `wrapping<uint8_t>` holding 255 is not equal to -1.)
+  template <typename U>
+  friend constexpr bool operator==(Self lhs, U rhs) {
+    assert_is_integral(U);
+    return internal::in_range<T>(rhs) && lhs.value_ == static_cast<T>(rhs);
+  }
+
+  /// ### `operator==`
+  ///
+  /// Returns true if `lhs` is mathematically equal to `rhs`.
+  template <typename U>
+  friend constexpr bool operator==(U lhs, Self rhs) {
+    return rhs == lhs;
+  }
+
+  /// ### `operator!=`
+  ///
+  /// Returns true if `lhs` is not equal to `rhs`.
+  friend constexpr bool operator!=(Self lhs, Self rhs) { return !(lhs == rhs); }
+
+  /// ### `operator!=`
+  ///
+  /// Returns true if `lhs` is not equal to `rhs`.
+  template <typename U>
+  friend constexpr bool operator!=(Self lhs, U rhs) {
+    return !(lhs == rhs);
+  }
+
+  /// ### `operator!=`
+  ///
+  /// Returns true if `lhs` is not equal to `rhs`.
+  template <typename U>
+  friend constexpr bool operator!=(U lhs, Self rhs) {
+    return !(lhs == rhs);
+  }
+
+  /// ### `operator++`
+  ///
+  /// Prefix increment. Increments the value, wrapping on overflow, and
+  /// returns `*this` with the new value.
+  constexpr Self& operator++() {
+    *this += T{1};
+    return *this;
+  }
+
+  /// ### `operator++`
+  ///
+  /// Postfix increment. Increments the value, wrapping on overflow, and
+  /// returns an object containing the previous value.
+  constexpr Self operator++(int) {
+    Self previous = *this;
+    *this += T{1};
+    return previous;
+  }
+
+  /// ### `operator--`
+  ///
+  /// Prefix decrement. Decrements the value, wrapping on overflow, and
+  /// returns `*this` with the new value.
+  constexpr Self& operator--() {
+    *this -= T{1};
+    return *this;
+  }
+
+  /// ### `operator--`
+  ///
+  /// Postfix decrement. Decrements the value, wrapping on overflow, and
+  /// returns an object containing the previous value.
+  constexpr Self operator--(int) {
+    Self previous = *this;
+    *this -= T{1};
+    return previous;
+  }
+
+  /// ### `operator U`
+  ///
+  /// Returns the plain `T` value as a `U`, keeping only the low bits that fit
+  /// in `U`.
+  template <typename U>
+  constexpr operator U() const {
+    return wrapping_cast<U>(value_);
+  }
+
+  /// ### `abs`
+  ///
+  /// Returns the absolute value of `x`. The minimum value of a signed `T`
+  /// wraps back to itself.
+  friend constexpr Self abs(Self x) {
+    if constexpr (internal::is_unsigned_v<T>) {
+      return x;
+    } else {
+      return x.value_ < 0 ? -x : x;
+    }
+  }
+
  private:
   T value_;
 };
 
+static_assert(std::is_trivial_v<wrapping<int>>,
+              "`wrapping<T>` must be trivial");
 static_assert(sizeof(wrapping<int8_t>) == sizeof(int8_t),
               "sizeof(wrapping<int8_t>) must == sizeof(int8_t)");
 static_assert(sizeof(wrapping<int16_t>) == sizeof(int16_t),
@@ -124,6 +817,10 @@ static_assert(sizeof(wrapping<int32_t>) == sizeof(int32_t),
               "sizeof(wrapping<int32_t>) must == sizeof(int32_t)");
 static_assert(sizeof(wrapping<int64_t>) == sizeof(int64_t),
               "sizeof(wrapping<int64_t>) must == sizeof(int64_t)");
+static_assert(alignof(wrapping<int64_t>) == alignof(int64_t),
+              "alignof(wrapping<int64_t>) must == alignof(int64_t)");
+static_assert(std::is_standard_layout_v<wrapping<int>>,
+              "`wrapping<T>` must be standard-layout");
 
 }  // namespace integers
 
@@ -14,11 +14,334 @@
 
 #include <iostream>
 #include <limits>
+#include <sstream>
 
+#include "ostream.h"
 #include "test_support.h"
 #include "wrapping.h"
 
 using namespace integers;
 using namespace std;
 
-int main() {}
+namespace {
+
+using i8 = int8_t;
+using u8 = uint8_t;
+using i16 = int16_t;
+using u16 = uint16_t;
+using i32 = int32_t;
+using u32 = uint32_t;
+using i64 = int64_t;
+using u64 = uint64_t;
+
+constexpr i8 i8_max = numeric_limits<i8>::max();
+constexpr u8 u8_max = numeric_limits<u8>::max();
+constexpr i16 i16_max = numeric_limits<i16>::max();
+constexpr u16 u16_max = numeric_limits<u16>::max();
+constexpr i32 i32_max = numeric_limits<i32>::max();
+constexpr u32 u32_max = numeric_limits<u32>::max();
+constexpr i64 i64_max = numeric_limits<i64>::max();
+constexpr u64 u64_max = numeric_limits<u64>::max();
+
+constexpr i8 i8_min = numeric_limits<i8>::min();
+constexpr i16 i16_min = numeric_limits<i16>::min();
+constexpr i32 i32_min = numeric_limits<i32>::min();
+constexpr i64 i64_min = numeric_limits<i64>::min();
+
+// The helpers are usable in constant expressions.
+static_assert(wrapping_add<u8>(u8{200}, u8{100}) == 44);
+static_assert(wrapping_mul<i8>(i8{64}, i8{2}) == i8_min);
+static_assert((wrapping<u16>{u16_max} + 1) == 0);
+
+void TestCast() {
+  EXPECT(wrapping_cast<u8>(0x1234) == 0x34);
+  EXPECT(wrapping_cast<i8>(0xFF) == -1);
+  EXPECT(wrapping_cast<u32>(-1) == u32_max);
+  EXPECT(wrapping_cast<i16>(u32{0x18000}) == i16_min);
+  EXPECT(wrapping_cast<i64>(u64_max) == -1);
+  EXPECT(wrapping_cast<u64>(i8{-1}) == u64_max);
+}
+
+template <typename T>
+void GenericTestAddSubMul() {
+  constexpr T max = numeric_limits<T>::max();
+  constexpr T min = numeric_limits<T>::min();
+  EXPECT((wrapping_add<T>(max, T{1})) == min);
+  EXPECT((wrapping_sub<T>(min, T{1})) == max);
+  EXPECT((wrapping_add<T>(max, max)) == static_cast<T>(max - 1 + min));
+  EXPECT((wrapping_mul<T>(max, T{2})) == wrapping_sub<T>(max, T{1}) + min);
+  EXPECT((wrapping_mul<T>(max, max)) == T{1});
+  EXPECT((wrapping_mul<T>(min, min)) == T{0});
+}
+
+template <class... T>
+void CallGenericTestAddSubMul() {
+  (GenericTestAddSubMul<T>(), ...);
+}
+
+void TestAddSubMul() {
+  CallGenericTestAddSubMul<i8, u8, i16, u16, i32, u32, i64, u64>();
+
+  // These promote to `int` with the built-in operators, where 65535 * 65535
+  // would overflow. `wrapping_mul` must not.
+  EXPECT((wrapping_mul<u16>(u16_max, u16_max)) == 1);
+  EXPECT((wrapping_mul<u8>(u8_max, u8_max)) == 1);
+
+  // The result type determines where the result wraps.
+  EXPECT((wrapping_add<u8>(i32{250}, i32{10})) == 4);
+  EXPECT((wrapping_add<i64>(i32_max, i32{1})) == i64{i32_max} + 1);
+  EXPECT((wrapping_sub<u32>(u8{0}, u8{1})) == u32_max);
+  EXPECT((wrapping_mul<i16>(i64{0x10001}, i64{3})) == 3);
+  EXPECT((wrapping_add<u64>(i64{-1}, u8{1})) == 0);
+}
+
+template <typename T>
+void GenericTestDivMod() {
+  constexpr T max = numeric_limits<T>::max();
+  constexpr T min = numeric_limits<T>::min();
+  EXPECT((wrapping_div<T>(max, T{2})) == max / 2);
+  EXPECT((wrapping_mod<T>(max, T{2})) == 1);
+  EXPECT_DEATH((void)(wrapping_div<T>(max, T{0})));
+  EXPECT_DEATH((void)(wrapping_mod<T>(max, T{0})));
+  if constexpr (is_signed_v<T>) {
+    EXPECT((wrapping_div<T>(min, T{-1})) == min);
+    EXPECT((wrapping_mod<T>(min, T{-1})) == 0);
+    EXPECT((wrapping_div<T>(max, T{-1})) == -max);
+  }
+}
+
+template <class... T>
+void CallGenericTestDivMod() {
+  (GenericTestDivMod<T>(), ...);
+}
+
+void TestDivMod() {
+  CallGenericTestDivMod<i8, u8, i16, u16, i32, u32, i64, u64>();
+
+  // `i8_min / -1` computes 128 in `int`, which wraps to -128 in `i8`, but fits
+  // in `i16`.
+  EXPECT((wrapping_div<i16>(i8_min, i8{-1})) == 128);
+  EXPECT((wrapping_div<i64>(i32_min, i32{-1})) == i64{i32_max} + 1);
+  EXPECT((wrapping_div<u8>(1000, 2)) == 500 % 256);
+
+  // Mixed-sign operands divide the mathematical values, instead of
+  // converting the negative one to unsigned.
+  EXPECT((wrapping_div<i32>(-7, 2U)) == -3);
+  EXPECT((wrapping_mod<i32>(-7, 2U)) == -1);
+  EXPECT((wrapping_div<i32>(7U, -2)) == -3);
+  EXPECT((wrapping_mod<i32>(7U, -2)) == 1);
+  EXPECT((wrapping_div<u32>(-7, 2U)) == 0xfffffffdU);
+  EXPECT((wrapping_div<i64>(i64_min, u64_max)) == 0);
+  EXPECT((wrapping_mod<i64>(i64_min, u64_max)) == i64_min);
+  EXPECT((wrapping<i32>(-7) / 2U) == -3);
+  EXPECT((wrapping<i32>(-7) % 2U) == -1);
+  EXPECT((7U / wrapping<i32>(-2)) == -3);
+}
+
+void TestConstructor() {
+  {
+    wrapping<int> x = 42;
+    EXPECT(x == 42);
+  }
+  {
+    wrapping<i8> x{512 + 7};
+    EXPECT(x == 7);
+  }
+  {
+    wrapping<u16> x{-1};
+    EXPECT(x == u16_max);
+  }
+}
+
+template <typename T>
+void GenericTestOperators() {
+  using W = wrapping<T>;
+  constexpr T max = numeric_limits<T>::max();
+  constexpr T min = numeric_limits<T>::min();
+
+  {
+    W x = max;
+    x += T{1};
+    EXPECT(x == min);
+    x -= T{1};
+    EXPECT(x == max);
+    EXPECT(x + W{T{1}} == min);
+    EXPECT(W{min} - 1 == max);
+    EXPECT(1 + W{max} == min);
+  }
+  {
+    W x = max;
+    ++x;
+    EXPECT(x == min);
+    EXPECT(x-- == min);
+    EXPECT(x == max);
+    EXPECT(++x == min);
+  }
+  {
+    W x = max;
+    x *= T{2};
+    EXPECT(x == wrapping_mul<T>(max, T{2}));
+    EXPECT(W{max} * W{max} == 1);
+  }
+  {
+    W x = max;
+    x /= T{2};
+    EXPECT(x == max / 2);
+    EXPECT(W{max} % T{2} == 1);
+    EXPECT_DEATH(x /= T{0});
+    EXPECT_DEATH(x %= T{0});
+  }
+  if constexpr (is_signed_v<T>) {
+    W x = min;
+    EXPECT(-x == min);
+    EXPECT(abs(x) == min);
+    EXPECT(x / T{-1} == min);
+    EXPECT(x % T{-1} == 0);
+    EXPECT(abs(W{T{-5}}) == 5);
+  } else {
+    EXPECT(-W{T{1}} == max);
+  }
+}
+
+template <class... T>
+void CallGenericTestOperators() {
+  (GenericTestOperators<T>(), ...);
+}
+
+void TestOperators() {
+  CallGenericTestOperators<i8, u8, i16, u16, i32, u32, i64, u64>();
+}
+
+void TestMixedTypes() {
+  {
+    wrapping<u8> x = u8{250};
+    EXPECT(x + 10 == 4);
+    EXPECT(10 + x == 4);
+    EXPECT(x - 251 == u8_max);
+    EXPECT(x * 2 == 244);
+    // The divisor is not truncated to `T` first.
+    EXPECT(x / 256 == 0);
+    EXPECT(x % 256 == 250);
+  }
+  {
+    wrapping<i32> x = i32_max;
+    EXPECT(x + i64{1} == i32_min);
+    EXPECT(x * u64{2} == -2);
+  }
+}
+
+void TestBitwise() {
+  {
+    wrapping<u8> x = u8{0xF0};
+    EXPECT((x | u8{0x0F}) == 0xFF);
+    EXPECT((x & u8{0x30}) == 0x30);
+    EXPECT((x ^ u8{0xFF}) == 0x0F);
+    EXPECT(~x == 0x0F);
+    EXPECT((x | 0x10F) == 0xFF);
+  }
+  {
+    wrapping<i8> x = i8{-1};
+    EXPECT((x & 0x7F) == i8_max);
+  }
+}
+
+void TestShift() {
+  {
+    wrapping<u32> x = 1U;
+    EXPECT((x << 31) == 0x80000000U);
+    // The shift amount is taken modulo the width.
+    EXPECT((x << 32) == 1U);
+    EXPECT((x << 33) == 2U);
+    EXPECT((x << -1) == 0x80000000U);
+    EXPECT((wrapping<u32>{u32_max} >> 36) == 0x0FFFFFFFU);
+  }
+  {
+    wrapping<i32> x = 1;
+    x <<= 31;
+    EXPECT(x == i32_min);
+    x <<= 1;
+    EXPECT(x == 0);
+  }
+  {
+    wrapping<i8> x = i8{-128};
+    EXPECT((x >> 7) == -1);
+    EXPECT((x >> 8) == -128);
+    EXPECT((wrapping<u8>{u8{0x81}} << 1) == 2);
+  }
+  {
+    wrapping<u64> x = u64{1};
+    EXPECT((x << 63) == 0x8000000000000000ULL);
+    EXPECT((x << 64) == 1ULL);
+    EXPECT((x << wrapping<u64>{65ULL}) == 2ULL);
+  }
+}
+
+void TestComparison() {
+  {
+    wrapping<u8> x = u8_max;
+    EXPECT(x != -1);
+    EXPECT(-1 != x);
+    EXPECT(x == 255);
+    EXPECT(x != 511);
+    EXPECT(x > u8{1});
+    EXPECT(u8{1} < x);
+    EXPECT(x <= u8_max);
+    EXPECT(x >= x);
+    // Mixed-type comparisons compare the mathematical values.
+    EXPECT(x < 256);
+    EXPECT(-1 < x);
+    EXPECT(x > -1);
+    EXPECT(!(x >= 256));
+    EXPECT(256U >= x);
+  }
+  {
+    wrapping<i64> x = i64_min;
+    EXPECT(x < u64{0});
+    EXPECT(u64_max > x);
+    EXPECT(x < i64_max);
+    EXPECT(x != u64{0x8000000000000000ULL});
+    EXPECT(x == i64_min);
+  }
+}
+
+void TestOperatorU() {
+  wrapping<i32> x = -1;
+  EXPECT(static_cast<u8>(x) == u8_max);
+  EXPECT(static_cast<u64>(x) == u64_max);
+  EXPECT(static_cast<i16>(x) == -1);
+  EXPECT(static_cast<i16>(wrapping<i32>{i32{i16_max} + 1}) == i16_min);
+}
+
+void TestHash() {
+  // FNV-1a, which depends on 32-bit multiplication wrapping.
+  const char text[] = "hello";
+  wrapping<u32> hash = 2166136261U;
+  for (const char* p = text; *p; p++) {
+    hash = hash ^ static_cast<u8>(*p);
+    hash *= 16777619U;
+  }
+  EXPECT(hash == 0x4F9F2CABU);
+}
+
+void TestOstream() {
+  ostringstream os;
+  os << wrapping<i16>{i16_max} + 1;
+  EXPECT(os.str() == "-32768");
+}
+
+}  // namespace
+
+int main() {
+  TestCast();
+  TestAddSubMul();
+  TestDivMod();
+  TestConstructor();
+  TestOperators();
+  TestMixedTypes();
+  TestBitwise();
+  TestShift();
+  TestComparison();
+  TestOperatorU();
+  TestHash();
+  TestOstream();
+}